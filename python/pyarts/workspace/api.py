@@ -144,6 +144,46 @@ def data_path_pop():
     """
     arts_api.data_path_pop()
 
+def set_parse_cache(path):
+    """
+    Set the directory in which parsed controlfiles are cached.
+
+    Args:
+        path(str): The cache directory, or None to switch the cache off.
+    """
+    if path is None:
+        arts_api.set_parse_cache(None)
+    else:
+        arts_api.set_parse_cache(c.c_char_p(path.encode()))
+
+def set_profiling(filename):
+    """
+    Switch profiling of agendas and workspace methods on or off.
+
+    Args:
+        filename(str): File that the report is written to at exit, as JSON
+            or in the folded stack format if it ends with ".folded". An
+            empty string switches profiling on without a report at exit,
+            and None switches it off.
+    """
+    if filename is None:
+        arts_api.set_profiling(None)
+    else:
+        arts_api.set_profiling(c.c_char_p(filename.encode()))
+
+def write_profile(filename):
+    """
+    Write the profiling report of all calls so far.
+
+    Args:
+        filename(str): The report file.
+    Raises:
+        Exception: If the report can not be written.
+    """
+    e = arts_api.write_profile(c.c_char_p(filename.encode()))
+    if e:
+        raise Exception(e.decode())
+
 ################################################################################
 # Python values that represent empty elements.
 ################################################################################
@@ -271,6 +311,23 @@ class VariableValueStruct(c.Structure):
         self.initialized = initialized
         self.dimensions  = (c.c_long * 7)(*dimensions)
 
+class VariableBufferStruct(c.Structure):
+    """
+    c struct describing the memory of a workspace variable.
+
+    The ptr field points to the first element, the shape and strides fields
+    hold the extents and the distances in bytes along the first ndim
+    dimensions. The kind field is 'f' for floating point and 'i' for
+    integer elements of size itemsize. If the variable does not provide
+    such a buffer, ndim is -1. If it has no elements, ptr is None.
+    """
+    _fields_ = [("ptr", c.c_void_p),
+                ("ndim", c.c_long),
+                ("shape", 7 * c.c_long),
+                ("strides", 7 * c.c_long),
+                ("itemsize", c.c_long),
+                ("kind", c.c_char)]
+
 class CovarianceMatrixBlockStruct(c.Structure):
     """
     c struct representing block of covariance matrices.
@@ -351,6 +408,9 @@ arts_api.data_path_push.argtypes = [c.c_char_p]
 arts_api.data_path_pop.restype = None
 arts_api.data_path_pop.argtypes = None
 
+arts_api.set_parse_cache.restype = None
+arts_api.set_parse_cache.argtypes = [c.c_char_p]
+
 # Set include ad data path of the arts runtime.
 arts_api.get_error.restype  = c.c_char_p
 arts_api.get_error.argtypes = None
@@ -358,6 +418,13 @@ arts_api.get_error.argtypes = None
 arts_api.set_basename.restype  = None
 arts_api.set_basename.argtypes = [c.c_char_p]
 
+# Profiling
+arts_api.set_profiling.restype  = None
+arts_api.set_profiling.argtypes = [c.c_char_p]
+
+arts_api.write_profile.restype  = c.c_char_p
+arts_api.write_profile.argtypes = [c.c_char_p]
+
 # Agendas
 #
 #
@@ -420,6 +487,17 @@ arts_api.get_variable_value.restype  = VariableValueStruct
 arts_api.set_variable_value.argtypes = [c.c_void_p, c.c_long, c.c_long, VariableValueStruct]
 arts_api.set_variable_value.restype  =  c.c_char_p
 
+# Return a view on the memory of a variable in a given workspace given the variable
+# id, the group id and the part of the variable.
+arts_api.get_variable_buffer.argtypes = [c.c_void_p, c.c_long, c.c_long, c.c_long]
+arts_api.get_variable_buffer.restype  = VariableBufferStruct
+
+# Resize a variable in a given workspace given the variable id, the group id, the
+# number of dimensions and the new shape.
+arts_api.resize_variable.argtypes = [c.c_void_p, c.c_long, c.c_long, c.c_long,
+                                     c.POINTER(c.c_long)]
+arts_api.resize_variable.restype  = c.c_char_p
+
 # Adds a value of a given group to a given workspace.
 arts_api.add_variable.restype  = c.c_long
 arts_api.add_variable.argtypes = [c.c_void_p, c.c_long, c.c_char_p]
@@ -505,4 +583,7 @@ for p in arts_data_path:
 include_path_push(os.getcwd())
 data_path_push(os.getcwd())
 
+if environ.get("ARTS_PARSE_CACHE"):
+    set_parse_cache(environ.get("ARTS_PARSE_CACHE"))
+
 nodef = arts_api.get_g_in_nodef().decode("utf8")
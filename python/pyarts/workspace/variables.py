@@ -18,6 +18,7 @@ import os
 import numpy as np
 import re
 import scipy as sp
+import sys
 import tempfile
 import weakref
 
@@ -26,6 +27,22 @@ from pyarts.workspace.agendas import Agenda
 from pyarts.xml.names import tensor_names
 
 
+class _BufferView:
+    """
+    Exposes a VariableBufferStruct through the numpy array interface, so
+    that numpy.asarray returns an array that refers to the memory of the
+    workspace variable.
+    """
+    def __init__(self, b):
+        typestr = ("<" if sys.byteorder == "little" else ">") \
+                  + b.kind.decode() + str(b.itemsize)
+        self.__array_interface__ = {"shape"   : tuple(b.shape[:b.ndim]),
+                                    "typestr" : typestr,
+                                    "data"    : (b.ptr, False),
+                                    "strides" : tuple(b.strides[:b.ndim]),
+                                    "version" : 3}
+
+
 class WorkspaceVariable:
     """
     The WorkspaceVariable represents ARTS workspace variables in a symbolic way. This
@@ -334,29 +351,14 @@ class WorkspaceVariable:
             if nnz == 0:
                 return sp.sparse.csr_matrix(0)
             else:
-                data = np.ctypeslib.as_array(c.cast(v.ptr,
-                                                    c.POINTER(c.c_double)),
-                                             (nnz,))
-                row_indices = np.ctypeslib.as_array(v.inner_ptr, (nnz,))
-                col_starts  = np.ctypeslib.as_array(v.outer_ptr, (m + 1,))
-                return sp.sparse.csr_matrix((data, row_indices, col_starts),
-                                            shape=(m,n))
+                return sp.sparse.csr_matrix((self.buffer(0),
+                                             self.buffer(1),
+                                             self.buffer(2)),
+                                            shape=(m,n), copy=False)
         elif self.group == "Agenda":
             return Agenda(v.ptr)
         elif self.ndim:
-            shape = []
-            size  = 1
-            for i in range(self.ndim):
-                shape.append(v.dimensions[i])
-                size *= v.dimensions[i]
-            if size > 0:
-                self.__array_interface__ = {"shape"  : tuple(shape),
-                                            "typestr" : "|f8",
-                                            "data" : (v.ptr, False),
-                                            "version" : 3}
-                return np.asarray(self)
-            else:
-                return np.zeros(shape)
+            return self.buffer()
         else:
             try:
                 return self.to_arts()
@@ -364,6 +366,68 @@ class WorkspaceVariable:
                 raise Exception("Type of workspace variable is not supported "
                                 + " by the interface.")
 
+    def buffer(self, part=0):
+        """ Return a numpy array that refers to the memory of the variable.
+
+        Nothing is copied, changing the array changes the variable in the
+        workspace. The array must not be used after the variable was set,
+        resized or erased. Vector, Matrix, Tensor3 to Tensor7, ArrayOfIndex
+        and GasAbsLookup (its cross sections) have a single part. A Sparse
+        has three: the elements, their column indices and the offsets of
+        the rows, as in scipy.sparse.csr_matrix.
+
+        Args:
+            part(int): The part of the variable.
+
+        Returns:
+            A numpy.ndarray that refers to the memory of the variable.
+
+        Raises:
+            Exception: If the variable is uninitialized or does not have
+            the given part.
+        """
+        if not self.ws:
+            raise ValueError("WorkspaceVariable object needs associated"
+                             " Workspace to access its memory.")
+        b = arts_api.get_variable_buffer(self.ws.ptr, self.ws_id,
+                                         self.group_id, part)
+        if b.ndim < 0:
+            raise Exception("WorkspaceVariable " + self.name + " is "
+                            "uninitialized or has no buffer " + str(part)
+                            + ".")
+        if not b.ptr:
+            dtype = "f8" if b.kind == b"f" else "i" + str(b.itemsize)
+            return np.zeros(tuple(b.shape[:b.ndim]), dtype=dtype)
+        return np.asarray(_BufferView(b))
+
+    def allocate(self, shape):
+        """ Resize the variable and return its memory as numpy array.
+
+        This is the counterpart of :code:`buffer` for setting data: instead
+        of creating an array in Python and copying it into the workspace,
+        the array is allocated by ARTS and filled in place, for example by
+        :code:`numpy.copyto` or the :code:`out` argument of numpy functions.
+        Only Vector, Matrix and Tensor3 to Tensor7 can be allocated. The
+        values of the array are undefined.
+
+        Args:
+            shape(tuple): The new shape of the variable.
+
+        Returns:
+            A numpy.ndarray that refers to the memory of the variable.
+        """
+        if not self.ws:
+            raise ValueError("WorkspaceVariable object needs associated"
+                             " Workspace to allocate its memory.")
+        shape = tuple(shape)
+        dims = (c.c_long * max(len(shape), 1))(*shape)
+        err = arts_api.resize_variable(self.ws.ptr, self.ws_id, self.group_id,
+                                       len(shape), dims)
+        if not err is None:
+            raise Exception("Cannot allocate WSV " + self.name + ": "
+                            + err.decode())
+        return self.buffer()
+
     def update(self):
         """ Update data references of the object.
 
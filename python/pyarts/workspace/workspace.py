@@ -440,6 +440,12 @@ class Workspace:
                                 " value  '{}'.".format(wsv.group, value))
             value = converted
 
+        # Real arrays are copied once, directly into the memory of the WSV
+        if (isinstance(value, np.ndarray) and value.ndim == wsv.ndim
+                and value.dtype.kind in "biuf" and wsv.ws is self):
+            np.copyto(wsv.allocate(value.shape), value)
+            return None
+
         s = VariableValueStruct(value)
         if s.ptr:
             err = arts_api.set_variable_value(self.ptr, wsv.ws_id, wsv.group_id, s)
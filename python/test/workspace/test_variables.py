@@ -152,6 +152,32 @@ class TestVariables:
         self.ws.tensor_7 = t_0
         assert np.all(t_0 == self.ws.tensor_7.value)
 
+    def test_buffer(self):
+        """
+        Access and fill the memory of WSVs without copies.
+        """
+        self.ws.Tensor4Create("tensor_4")
+        t = self.ws.tensor_4.allocate((2, 3, 4, 5))
+        t[:] = np.arange(120).reshape(2, 3, 4, 5)
+        v = self.ws.tensor_4.value
+        assert v.shape == (2, 3, 4, 5)
+        assert v.ctypes.data == t.ctypes.data
+        v[1, 2, 3, 4] = -1.0
+        assert self.ws.tensor_4.buffer()[1, 2, 3, 4] == -1.0
+
+        # Non-contiguous and integer arrays
+        m = np.arange(12).reshape(3, 4)
+        self.ws.MatrixCreate("matrix_variable")
+        self.ws.matrix_variable = m.T
+        assert np.all(self.ws.matrix_variable.value == m.T)
+
+        self.ws.VectorCreate("vector_variable")
+        self.ws.vector_variable.allocate((0,))
+        assert self.ws.vector_variable.value.shape == (0,)
+
+        with pytest.raises(Exception):
+            self.ws.tensor_4.allocate((2, 3))
+
     def test_creation(self):
         """
         Test creation of WSVs.
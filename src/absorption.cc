@@ -37,6 +37,7 @@
 #include <cstdlib>
 #include <map>
 #include "arts.h"
+#include "arts_omp.h"
 #include "auto_md.h"
 #include "file.h"
 #include "interpolation_poly.h"
@@ -613,6 +614,147 @@ const SpeciesRecord& SpeciesDataOfBand(const AbsorptionLines& band)
   return global_data::species_data[band.Species()];
 }
 
+/** Adds the summed band cross-sections of one level to the output
+ * 
+ * The sum may cover only a block of the frequency grid starting at f0
+ * 
+ * @param[in,out] xsec As for xsec_species
+ * @param[in,out] source As for xsec_species
+ * @param[in,out] phase As for xsec_species
+ * @param[in,out] dxsec_dx As for xsec_species
+ * @param[in,out] dsource_dx As for xsec_species
+ * @param[in,out] dphase_dx As for xsec_species
+ * @param[in] sum The summed up band
+ * @param[in] nj Number of partial derivatives
+ * @param[in] ip Pressure level index
+ * @param[in] f0 First frequency index of sum
+ * @param[in] do_nonlte Add the source terms
+ */
+static void add_band_sum_to_level(Matrix& xsec,
+                           Matrix& source,
+                           Matrix& phase,
+                           ArrayOfMatrix& dxsec_dx,
+                           ArrayOfMatrix& dsource_dx,
+                           ArrayOfMatrix& dphase_dx,
+                           const Linefunctions::InternalData& sum,
+                           const Index nj,
+                           const Index ip,
+                           const Index f0,
+                           const bool do_nonlte) {
+  const Index nf = sum.F.size();
+
+  // absorption cross-section
+  MapToEigen(xsec).col(ip).segment(f0, nf).noalias() += sum.F.real();
+  for (Index j = 0; j < nj; j++)
+    MapToEigen(dxsec_dx[j]).col(ip).segment(f0, nf).noalias() +=
+        sum.dF.col(j).real();
+
+  // phase cross-section
+  if (not phase.empty()) {
+    MapToEigen(phase).col(ip).segment(f0, nf).noalias() += sum.F.imag();
+    for (Index j = 0; j < nj; j++)
+      MapToEigen(dphase_dx[j]).col(ip).segment(f0, nf).noalias() +=
+          sum.dF.col(j).imag();
+  }
+
+  // source ratio cross-section
+  if (do_nonlte) {
+    MapToEigen(source).col(ip).segment(f0, nf).noalias() += sum.N.real();
+    for (Index j = 0; j < nj; j++)
+      MapToEigen(dsource_dx[j]).col(ip).segment(f0, nf).noalias() +=
+          sum.dN.col(j).real();
+  }
+}
+
+/** Level-constant input to Linefunctions::set_cross_section_of_band */
+struct BandLevelConstants {
+  Numeric QT;
+  Numeric dQTdT;
+  Numeric DC;
+  Numeric dDCdT;
+  Vector line_shape_vmr;
+  Absorption::LineParameterCache::Value lines;
+};
+
+/** Computes the level-constant input of a band
+ * 
+ * @param[in] band The absorption band
+ * @param[in] compiled The compiled absorption band
+ * @param[in] jacobian_quantities As WSV
+ * @param[in] abs_species As WSV
+ * @param[in] vmrs The VMRs at the level
+ * @param[in] pressure The pressure at the level
+ * @param[in] temperature The temperature at the level
+ * @param[in] isot_ratio Isotopologue ratio of this species
+ * @param[in] QT0 Partition function at the reference temperature
+ * @param[in] partfun_type Partition function type for this species
+ * @param[in] partfun_data Partition function model data for this species
+ * @param[in,out] cache Line parameters of earlier calls of this band, or nullptr
+ * @return The level constants
+ */
+static BandLevelConstants band_level_constants(
+    const AbsorptionLines& band,
+    const Absorption::CompiledLines& compiled,
+    const ArrayOfRetrievalQuantity& jacobian_quantities,
+    const ArrayOfArrayOfSpeciesTag& abs_species,
+    const ConstVectorView vmrs,
+    const Numeric& pressure,
+    const Numeric& temperature,
+    const Numeric& isot_ratio,
+    const Numeric& QT0,
+    const SpeciesAuxData::AuxType& partfun_type,
+    const ArrayOfGriddedField1& partfun_data,
+    Absorption::LineParameterCache* cache) {
+  BandLevelConstants out;
+  out.QT = single_partition_function(temperature, partfun_type, partfun_data);
+  out.dQTdT = dsingle_partition_function_dT(
+      out.QT,
+      temperature,
+      temperature_perturbation(jacobian_quantities),
+      partfun_type,
+      partfun_data);
+  out.DC = Linefunctions::DopplerConstant(temperature, band.SpeciesMass());
+  out.dDCdT = Linefunctions::dDopplerConstant_dT(temperature, out.DC);
+  out.line_shape_vmr = band.BroadeningSpeciesVMR(vmrs, abs_species);
+  
+  const bool do_temperature = do_temperature_jacobian(jacobian_quantities);
+  const auto do_vmr = do_vmr_jacobian(jacobian_quantities, band.QuantumIdentity());
+  
+  // The full state that the line parameters depend on
+  Absorption::LineParameterCache::Key key;
+  if (cache) {
+    key = {temperature, pressure, isot_ratio, out.QT, QT0, out.dQTdT,
+           Numeric(do_temperature), Numeric(do_vmr.test),
+           Numeric(do_vmr.test ? do_vmr.qid.Species() : -1)};
+    for (auto& x: out.line_shape_vmr) key.push_back(x);
+    
+    out.lines = cache -> Find(key);
+    if (out.lines) return out;
+  }
+  
+  auto lines = std::make_shared<Absorption::CompiledLineParameters>();
+  compiled.SetShapeParameters(*lines,
+                              band,
+                              temperature,
+                              pressure,
+                              out.line_shape_vmr,
+                              do_temperature,
+                              do_vmr.test,
+                              do_vmr.qid);
+  compiled.SetStrengthParameters(*lines,
+                                 temperature,
+                                 band.T0(),
+                                 isot_ratio,
+                                 out.QT,
+                                 QT0,
+                                 out.dQTdT,
+                                 do_temperature);
+  out.lines = lines;
+  
+  if (cache) cache -> Insert(key, out.lines);
+  return out;
+}
+
 void xsec_species(Matrix& xsec,
                   Matrix& source,
                   Matrix& phase,
@@ -630,7 +772,11 @@ void xsec_species(Matrix& xsec,
                   const AbsorptionLines& band,
                   const Numeric& isot_ratio,
                   const SpeciesAuxData::AuxType& partfun_type,
-                  const ArrayOfGriddedField1& partfun_data) {
+                  const ArrayOfGriddedField1& partfun_data,
+                  const Linefunctions::FaddeevaAccuracy faddeeva_accuracy,
+                  const Index line_parameter_cache,
+                  const Numeric sparse_accuracy,
+                  const XsecParallelMode parallel_mode) {
   // Size of problem
   const Index np = abs_p.nelem();      // number of pressure levels
   const Index nf = f_grid.nelem();     // number of Dirac frequencies
@@ -642,88 +788,234 @@ void xsec_species(Matrix& xsec,
   // Type of problem
   const bool do_nonlte = nt;
 
-  Linefunctions::InternalData scratch(nf, nj);
-  Linefunctions::InternalData sum(nf, nj);
-  
   // Test if the size of the problem is 0
   if (not np or not nf or not nl) return;
   
   // Constant for all lines
   const Numeric QT0 = single_partition_function(band.T0(), partfun_type, partfun_data);
+  
+  // Packed copy of the lines, shared by all levels and threads.  It is
+  // compiled by lbl_checkedCalc and kept with the band
+  const Absorption::CompiledLines& compiled = band.Compiled();
+  Absorption::LineParameterCache* cache = nullptr;
+  if (line_parameter_cache > 0) {
+    cache = &compiled.ParameterCache();
+    cache -> Capacity(line_parameter_cache);
+  }
+
+  // Threads available to this call.  If there are fewer pressure levels than
+  // threads, the levels are computed one by one and the threads are instead
+  // distributed over blocks of lines or blocks of frequencies.  Inside a
+  // parallel region, e.g., when called per point by a parallel radiative
+  // transfer method, the same work is split into tasks instead of threads
+  const Index nthreads = arts_omp_get_max_threads();
+  const XsecParallelMode mode =
+      parallel_mode == XsecParallelMode::Auto
+          ? xsec_species_parallel_mode(np, nf, nl, nthreads)
+          : parallel_mode;
 
   ArrayOfString fail_msg;
   bool do_abort = false;
 
-#pragma omp parallel for if (!arts_omp_in_parallel() && np > 1) \
-    firstprivate(scratch, sum)
-  for (Index ip = 0; ip < np; ip++) {
-    if (do_abort) continue;
-    try {
-      // Constants for this level
-      const Numeric& temperature = abs_t[ip];
-      const Numeric& pressure = abs_p[ip];
-
-      // Constants for this level
-      const Numeric QT =
-          single_partition_function(temperature, partfun_type, partfun_data);
-      const Numeric dQTdT = dsingle_partition_function_dT(
-          QT,
-          temperature,
-          temperature_perturbation(jacobian_quantities),
-          partfun_type,
-          partfun_data);
-      const Numeric DC =
-          Linefunctions::DopplerConstant(temperature, band.SpeciesMass());
-      const Numeric dDCdT = Linefunctions::dDopplerConstant_dT(temperature, DC);
-      const Vector line_shape_vmr =
-          band.BroadeningSpeciesVMR(abs_vmrs(joker, ip), abs_species);
-
-      Linefunctions::set_cross_section_of_band(scratch,
-                                               sum,
-                                               f_grid,
-                                               band,
-                                               jacobian_quantities,
-                                               jacobian_propmat_positions,
-                                               line_shape_vmr,
-                                               abs_nlte[ip],
-                                               pressure,
-                                               temperature,
-                                               isot_ratio,
-                                               0,
-                                               DC,
-                                               dDCdT,
-                                               QT,
-                                               dQTdT,
-                                               QT0,
-                                               false);
-
-      // absorption cross-section
-      MapToEigen(xsec).col(ip).noalias() += sum.F.real();
-      for (Index j = 0; j < nj; j++)
-        MapToEigen(dxsec_dx[j]).col(ip).noalias() += sum.dF.col(j).real();
-
-      // phase cross-section
-      if (not phase.empty()) {
-        MapToEigen(phase).col(ip).noalias() += sum.F.imag();
-        for (Index j = 0; j < nj; j++)
-          MapToEigen(dphase_dx[j]).col(ip).noalias() += sum.dF.col(j).imag();
+  if (mode == XsecParallelMode::Levels) {
+    Linefunctions::InternalData scratch(nf, nj);
+    Linefunctions::InternalData sum(nf, nj);
+
+    // Computes the full band at one level
+    auto level = [&](const Index ip,
+                     Linefunctions::InternalData& this_scratch,
+                     Linefunctions::InternalData& this_sum) {
+      if (do_abort) return;
+      try {
+        // Constants for this level
+        const BandLevelConstants lc =
+            band_level_constants(band,
+                                 compiled,
+                                 jacobian_quantities,
+                                 abs_species,
+                                 abs_vmrs(joker, ip),
+                                 abs_p[ip],
+                                 abs_t[ip],
+                                 isot_ratio,
+                                 QT0,
+                                 partfun_type,
+                                 partfun_data,
+                                 cache);
+
+        Linefunctions::set_cross_section_of_band(this_scratch,
+                                                 this_sum,
+                                                 f_grid,
+                                                 band,
+                                                 jacobian_quantities,
+                                                 jacobian_propmat_positions,
+                                                 lc.line_shape_vmr,
+                                                 abs_nlte[ip],
+                                                 abs_p[ip],
+                                                 abs_t[ip],
+                                                 isot_ratio,
+                                                 0,
+                                                 lc.DC,
+                                                 lc.dDCdT,
+                                                 lc.QT,
+                                                 lc.dQTdT,
+                                                 QT0,
+                                                 false,
+                                                 false,
+                                                 Zeeman::Polarization::Pi,
+                                                 0,
+                                                 -1,
+                                                 faddeeva_accuracy,
+                                                 lc.lines.get(),
+                                                 sparse_accuracy);
+
+        add_band_sum_to_level(
+            xsec, source, phase, dxsec_dx, dsource_dx, dphase_dx, this_sum, nj, ip, 0, do_nonlte);
+      } catch (const std::runtime_error& e) {
+        ostringstream os;
+        os << "Runtime-error in cross-section calculation at p_abs index " << ip
+           << ": \n";
+        os << e.what();
+#pragma omp critical(xsec_species_cross_sections)
+        {
+          do_abort = true;
+          fail_msg.push_back(os.str());
+        }
       }
+    };
 
-      // source ratio cross-section
-      if (do_nonlte) {
-        MapToEigen(source).col(ip).noalias() += sum.N.real();
-        for (Index j = 0; j < nj; j++)
-          MapToEigen(dsource_dx[j]).col(ip).noalias() += sum.dN.col(j).real();
-      }
-    } catch (const std::runtime_error& e) {
-      ostringstream os;
-      os << "Runtime-error in cross-section calculation at p_abs index " << ip
-         << ": \n";
-      os << e.what();
+    arts_omp_parallel_for(np, [&level, scratch, sum](const Index ip) mutable {
+      level(ip, scratch, sum);
+    });
+  } else {
+    // Number of line or frequency blocks, one per thread
+    const Index nb = std::max(
+        Index(1),
+        std::min(nthreads, mode == XsecParallelMode::Lines ? nl : nf));
+
+    // Per-block accumulators for line blocks.  They are summed in block
+    // order afterwards so the result does not depend on thread scheduling
+    std::vector<Linefunctions::InternalData> partial;
+    if (mode == XsecParallelMode::Lines)
+      partial.assign(nb, Linefunctions::InternalData(nf, nj));
+
+    // Computes one block of lines or frequencies at one level
+    auto block = [&](const Index ip, const Index ib, const BandLevelConstants& lc) {
+      if (do_abort) return;
+      try {
+        if (mode == XsecParallelMode::Lines) {
+          const Index l0 = (ib * nl) / nb;
+          const Index l1 = ((ib + 1) * nl) / nb;
+          Linefunctions::InternalData scratch(nf, nj);
+          Linefunctions::set_cross_section_of_band(scratch,
+                                                   partial[ib],
+                                                   f_grid,
+                                                   band,
+                                                   jacobian_quantities,
+                                                   jacobian_propmat_positions,
+                                                   lc.line_shape_vmr,
+                                                   abs_nlte[ip],
+                                                   abs_p[ip],
+                                                   abs_t[ip],
+                                                   isot_ratio,
+                                                   0,
+                                                   lc.DC,
+                                                   lc.dDCdT,
+                                                   lc.QT,
+                                                   lc.dQTdT,
+                                                   QT0,
+                                                   false,
+                                                   false,
+                                                   Zeeman::Polarization::Pi,
+                                                   l0,
+                                                   l1 - l0,
+                                                   faddeeva_accuracy,
+                                                   lc.lines.get(),
+                                                   sparse_accuracy);
+        } else {
+          const Index f0 = (ib * nf) / nb;
+          const Index f1 = ((ib + 1) * nf) / nb;
+          Linefunctions::InternalData scratch(f1 - f0, nj);
+          Linefunctions::InternalData sum(f1 - f0, nj);
+          Linefunctions::set_cross_section_of_band(scratch,
+                                                   sum,
+                                                   f_grid[Range(f0, f1 - f0)],
+                                                   band,
+                                                   jacobian_quantities,
+                                                   jacobian_propmat_positions,
+                                                   lc.line_shape_vmr,
+                                                   abs_nlte[ip],
+                                                   abs_p[ip],
+                                                   abs_t[ip],
+                                                   isot_ratio,
+                                                   0,
+                                                   lc.DC,
+                                                   lc.dDCdT,
+                                                   lc.QT,
+                                                   lc.dQTdT,
+                                                   QT0,
+                                                   false,
+                                                   false,
+                                                   Zeeman::Polarization::Pi,
+                                                   0,
+                                                   -1,
+                                                   faddeeva_accuracy,
+                                                   lc.lines.get(),
+                                                   sparse_accuracy);
+
+          // Blocks write to separate frequencies so no reduction is needed
+          add_band_sum_to_level(
+              xsec, source, phase, dxsec_dx, dsource_dx, dphase_dx, sum, nj, ip, f0, do_nonlte);
+        }
+      } catch (const std::runtime_error& e) {
+        ostringstream os;
+        os << "Runtime-error in cross-section calculation at p_abs index "
+           << ip << ": \n";
+        os << e.what();
 #pragma omp critical(xsec_species_cross_sections)
-      {
-        do_abort = true;
-        fail_msg.push_back(os.str());
+        {
+          do_abort = true;
+          fail_msg.push_back(os.str());
+        }
+      }
+    };
+
+    // Deterministic reduction of the line blocks over one frequency block
+    auto reduce = [&](const Index ib) {
+      const Index f0 = (ib * nf) / nb;
+      const Index fn = ((ib + 1) * nf) / nb - f0;
+      for (Index jb = 1; jb < nb; jb++) {
+        partial[0].F.segment(f0, fn) += partial[jb].F.segment(f0, fn);
+        partial[0].N.segment(f0, fn) += partial[jb].N.segment(f0, fn);
+        partial[0].dF.middleRows(f0, fn) += partial[jb].dF.middleRows(f0, fn);
+        partial[0].dN.middleRows(f0, fn) += partial[jb].dN.middleRows(f0, fn);
+      }
+    };
+
+    for (Index ip = 0; ip < np; ip++) {
+      // Constants for this level
+      const BandLevelConstants lc = band_level_constants(band,
+                                                         compiled,
+                                                         jacobian_quantities,
+                                                         abs_species,
+                                                         abs_vmrs(joker, ip),
+                                                         abs_p[ip],
+                                                         abs_t[ip],
+                                                         isot_ratio,
+                                                         QT0,
+                                                         partfun_type,
+                                                         partfun_data,
+                                                         cache);
+
+      arts_omp_parallel_for(
+          nb, [&](const Index ib) { block(ip, ib, lc); }, 1);
+
+      if (do_abort) break;
+
+      if (mode == XsecParallelMode::Lines) {
+        arts_omp_parallel_for(nb, reduce, 1);
+
+        add_band_sum_to_level(
+            xsec, source, phase, dxsec_dx, dsource_dx, dphase_dx, partial[0], nj, ip, 0, do_nonlte);
       }
     }
   }
@@ -737,3 +1029,19 @@ void xsec_species(Matrix& xsec,
     throw std::runtime_error(os.str());
   }
 }
+
+XsecParallelMode xsec_species_parallel_mode(const Index np,
+                                            const Index nf,
+                                            const Index nl,
+                                            const Index nthreads) {
+  if (nthreads < 2 or np >= nthreads) return XsecParallelMode::Levels;
+
+  // Line blocks need one accumulator per thread but share the per-line work
+  if (nl >= nthreads) return XsecParallelMode::Lines;
+
+  // Frequency blocks repeat the per-line work in every block so they are
+  // only worth it if each block has a reasonable number of frequencies
+  if (nf >= 16 * nthreads) return XsecParallelMode::Frequencies;
+
+  return XsecParallelMode::Levels;
+}
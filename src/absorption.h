@@ -39,6 +39,7 @@
 #include "messages.h"
 #include "mystring.h"
 #include "absorptionlines.h"
+#include "linefunctions.h"
 
 /** Contains the lookup data for one isotopologue.
     \author Stefan Buehler */
@@ -377,7 +378,35 @@ void set_vmr_from_first_species(Vector& vmr,
                                 const ArrayOfArrayOfSpeciesTag& abs_species,
                                 const Matrix& abs_vmrs);
 
+/** Work distribution of xsec_species */
+enum class XsecParallelMode {
+  Auto,         // Selected by xsec_species_parallel_mode
+  Levels,       // Parallel over pressure levels
+  Lines,        // Per level, parallel over blocks of lines with ordered reduction
+  Frequencies,  // Per level, parallel over blocks of frequencies
+};
+
+inline XsecParallelMode string2xsecparallelmode(const String& in) {
+  if (in == "Auto")
+    return XsecParallelMode::Auto;
+  else if (in == "Levels")
+    return XsecParallelMode::Levels;
+  else if (in == "Lines")
+    return XsecParallelMode::Lines;
+  else if (in == "Frequencies")
+    return XsecParallelMode::Frequencies;
+  else
+    throw std::runtime_error("Cannot recognize the parallel mode: \"" + in +
+                             "\"\nValid options are: \"Auto\", \"Levels\", \"Lines\", and \"Frequencies\"");
+}
+
 /** Cross-section algorithm
+ * 
+ *  The work is distributed over pressure levels if there are at least as
+ *  many levels as threads.  Otherwise, each level is in turn distributed over
+ *  blocks of lines or blocks of frequencies, see xsec_species_parallel_mode.
+ *  Inside a parallel region, the same work is split into tasks that the
+ *  idle threads of the enclosing team pick up
  * 
  *  @param[in,out] xsec Cross section of one tag group. This is now the true attenuation cross section in units of m^2.
  *  @param[in,out] sourceCross section of one tag group. This is now the true source cross section in units of m^2.
@@ -397,6 +426,10 @@ void set_vmr_from_first_species(Vector& vmr,
  *  \param[in] isot_ratio Isotopologue ratio of this species
  *  \param[in] partfun_type Partition function type for this species
  *  \param[in] partfun_data Partition function model data for this species
+ *  \param[in] faddeeva_accuracy Accuracy of the Faddeeva function in Voigt line shapes
+ *  \param[in] line_parameter_cache Number of atmospheric states to keep in the cache of the band, or 0 to not cache them
+ *  \param[in] sparse_accuracy Relative accuracy of line wings from a coarse grid, or 0 to not use one
+ *  \param[in] parallel_mode Work distribution, or Auto to select it by the size of the problem
  * 
  *  @author Richard Larsson
  *  @date   2019-10-10
@@ -418,7 +451,25 @@ void xsec_species(Matrix& xsec,
                   const AbsorptionLines& band,
                   const Numeric& isot_ratio,
                   const SpeciesAuxData::AuxType& partfun_type,
-                  const ArrayOfGriddedField1& partfun_data);
+                  const ArrayOfGriddedField1& partfun_data,
+                  const Linefunctions::FaddeevaAccuracy faddeeva_accuracy =
+                      Linefunctions::FaddeevaAccuracy::Reference,
+                  const Index line_parameter_cache = 0,
+                  const Numeric sparse_accuracy = 0,
+                  const XsecParallelMode parallel_mode = XsecParallelMode::Auto);
+
+/** Selects how xsec_species distributes its work over the threads
+ * 
+ * @param[in] np Number of pressure levels
+ * @param[in] nf Number of frequencies
+ * @param[in] nl Number of lines in the band
+ * @param[in] nthreads Number of available threads
+ * @return The mode of parallelization
+ */
+XsecParallelMode xsec_species_parallel_mode(const Index np,
+                                            const Index nf,
+                                            const Index nl,
+                                            const Index nthreads);
 
 /** Returns the species data
  * 
@@ -35,6 +35,7 @@
 #include "constants.h"
 #include "file.h"
 #include "global_data.h"
+#include "linescaling.h"
 #include "quantum_parser_hitran.h"
 
 Rational Absorption::Lines::LowerQuantumNumber(size_t k, QuantumNumberType qnt) const noexcept {
@@ -52,6 +53,7 @@ Rational Absorption::Lines::UpperQuantumNumber(size_t k, QuantumNumberType qnt)
 }
 
 Rational& Absorption::Lines::LowerQuantumNumber(size_t k, QuantumNumberType qnt) noexcept {
+  Modified();
   for(size_t i=0; i<mlocalquanta.size(); i++)
     if(mlocalquanta[i] == qnt)
       return mlines[k].LowerQuantumNumber(i);  
@@ -59,6 +61,7 @@ Rational& Absorption::Lines::LowerQuantumNumber(size_t k, QuantumNumberType qnt)
 }
 
 Rational& Absorption::Lines::UpperQuantumNumber(size_t k, QuantumNumberType qnt) noexcept {
+  Modified();
   for(size_t i=0; i<mlocalquanta.size(); i++)
     if(mlocalquanta[i] == qnt)
       return mlines[k].UpperQuantumNumber(i);
@@ -2642,6 +2645,7 @@ String Absorption::Lines::MetaData() const
 
 void Absorption::Lines::RemoveUnusedLocalQuantums()
 {
+  Modified();
   // Find all hits
   std::vector<size_t> hits(0);
   
@@ -2668,6 +2672,7 @@ void Absorption::Lines::RemoveUnusedLocalQuantums()
 
 void Absorption::Lines::RemoveLocalQuantum(size_t x)
 {
+  Modified();
   mlocalquanta.erase(mlocalquanta.begin() + x);
   for (auto& line: mlines) {
     line.LowerQuantumNumbers().erase(line.LowerQuantumNumbers().begin() + x);
@@ -2686,12 +2691,14 @@ bool Absorption::SingleLine::SameQuantumNumbers(const Absorption::SingleLine& sl
 
 void Absorption::Lines::RemoveLine(Index i) noexcept
 {
+  Modified();
   mlines.erase(mlines.begin() + i);
 }
 
 
 Absorption::SingleLine Absorption::Lines::PopLine(Index i) noexcept
 {
+  Modified();
   auto line = mlines[i];
   RemoveLine(i);
   return line;
@@ -2708,6 +2715,7 @@ Absorption::Lines Absorption::createEmptyCopy(const Absorption::Lines& al) noexc
 
 Absorption::SingleLine& Absorption::Lines::Line(Index i) noexcept
 {
+  Modified();
   return mlines[i];
 }
 
@@ -2719,6 +2727,7 @@ const Absorption::SingleLine& Absorption::Lines::Line(Index i) const noexcept
 
 void Absorption::Lines::ReverseLines() noexcept
 {
+  Modified();
   std::reverse(mlines.begin(), mlines.end());
 }
 
@@ -3548,3 +3557,210 @@ bool Absorption::Lines::OK() const noexcept
   // Otherwise everything is fine!
   return true;
 }
+
+const Absorption::CompiledLines& Absorption::Lines::Compiled() const {
+  auto compiled = std::atomic_load(&mcompiled);
+  if (not compiled) {
+    // Threads that race here compile the band each, but all keep the first copy
+    auto fresh = std::make_shared<const CompiledLines>(*this);
+    if (std::atomic_compare_exchange_strong(&mcompiled, &compiled, fresh))
+      compiled = fresh;
+  }
+  return *compiled;
+}
+
+/** 64-bit FNV-1a hash of n bytes, continuing from h */
+static std::size_t hash_bytes(const void* data, std::size_t n,
+                              std::size_t h=14695981039346656037ull) noexcept {
+  const auto* x = static_cast<const unsigned char*>(data);
+  for (std::size_t i=0; i<n; i++) {
+    h ^= x[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+Absorption::CompiledLines::CompiledLines(const Lines& band)
+    : mF0(band.NumLines()),
+      mI0(band.NumLines()),
+      mE0(band.NumLines()),
+      mA(band.NumLines()),
+      mglow(band.NumLines()),
+      mgupp(band.NumLines()),
+      mshape(band.NumBroadeners()) {
+  const Index nl = band.NumLines();
+  const Index nb = band.NumBroadeners();
+  
+  for (Index k=0; k<nl; k++) {
+    mF0[k] = band.F0(k);
+    mI0[k] = band.I0(k);
+    mE0[k] = band.E0(k);
+    mA[k] = band.A(k);
+    mglow[k] = band.g_low(k);
+    mgupp[k] = band.g_upp(k);
+  }
+  
+  for (Index is=0; is<nb; is++) {
+    for (Index iv=0; iv<LineShape::nVars; iv++) {
+      const bool any = std::any_of(band.AllLines().cbegin(), band.AllLines().cend(), [is, iv](auto& line){
+        return line.LineShape().Data()[is].Data()[iv].type not_eq LineShape::TemperatureModel::None;});
+      if (any) {
+        auto& model = mshape[is][iv];
+        model.reserve(nl);
+        for (Index k=0; k<nl; k++)
+          model.push_back(band.Line(k).LineShape().Data()[is].Data()[iv]);
+      }
+    }
+  }
+}
+
+void Absorption::CompiledLines::add_shape_variable(Vector& x,
+                                                   LineShape::Variable var,
+                                                   Numeric T,
+                                                   Numeric T0,
+                                                   ConstVectorView weights,
+                                                   bool dT) const noexcept {
+  for (Index is=0; is<NumBroadeners(); is++) {
+    const Numeric w = weights[is];
+    if (w == 0) continue;
+    
+    const auto& model = mshape[is][Index(var)];
+    const Index n = Index(model.size());
+    if (dT)
+      for (Index k=0; k<n; k++) x[k] += w * LineShape::compute_model_dT(model[k], T, T0);
+    else
+      for (Index k=0; k<n; k++) x[k] += w * LineShape::compute_model(model[k], T, T0);
+  }
+}
+
+void Absorption::CompiledLines::SetShapeParameters(CompiledLineParameters& x,
+                                                   const Lines& band,
+                                                   Numeric T,
+                                                   Numeric P,
+                                                   const Vector& vmrs,
+                                                   bool do_temperature,
+                                                   bool do_vmr,
+                                                   const QuantumIdentifier& vmr_qid) const {
+  assert(band.NumLines() == NumLines() and band.NumBroadeners() == NumBroadeners());
+  const Index nl = NumLines();
+  const Index nb = NumBroadeners();
+  const bool do_linemixing = band.DoLineMixing(P);
+  
+  // The vmr derivative as weights of the broadeners, see ShapeParameters_dVMR
+  Vector dvmr(nb, 0);
+  if (do_vmr and not (band.Bath() and not band.Self() and vmr_qid.Species() == band.Species())) {
+    const Index pos = band.LineShapePos(vmr_qid);
+    if (pos >= 0) dvmr[pos] += 1;
+    if (band.Bath()) dvmr[nb - 1] -= 1;
+  }
+  
+  for (Index iv=0; iv<LineShape::nVars; iv++) {
+    const auto var = LineShape::Variable(iv);
+    const bool zero = not do_linemixing and (var == LineShape::Variable::Y or
+                                             var == LineShape::Variable::G or
+                                             var == LineShape::Variable::DV);
+    const Numeric pressure_scaling = (var == LineShape::Variable::ETA) ? 1 :
+      (var == LineShape::Variable::G or var == LineShape::Variable::DV) ? P * P : P;
+    
+    auto set = [&](Vector& y, ConstVectorView weights, bool dT) {
+      y.resize(nl);
+      y = 0;
+      if (not zero) {
+        add_shape_variable(y, var, T, band.T0(), weights, dT);
+        y *= pressure_scaling;
+      }
+    };
+    
+    set(x.X[iv], vmrs, false);
+    if (do_temperature) set(x.dXdT[iv], vmrs, true);
+    if (do_vmr) set(x.dXdVMR[iv], dvmr, false);
+  }
+}
+
+void Absorption::CompiledLines::SetStrengthParameters(CompiledLineParameters& x,
+                                                      Numeric T,
+                                                      Numeric T0,
+                                                      Numeric isotopic_ratio,
+                                                      Numeric QT,
+                                                      Numeric QT0,
+                                                      Numeric dQTdT,
+                                                      bool do_temperature) const {
+  const Index nl = NumLines();
+  const Numeric invQT = 1.0 / QT;
+  
+  x.S.resize(nl);
+  x.dSdT_div_S.resize(do_temperature ? nl : 0);
+  for (Index k=0; k<nl; k++) {
+    const Numeric gamma = stimulated_emission(T, mF0[k]);
+    const Numeric gamma_ref = stimulated_emission(T0, mF0[k]);
+    const Numeric K1 = boltzman_ratio(T, T0, mE0[k]);
+    const Numeric K2 = stimulated_relative_emission(gamma, gamma_ref);
+    
+    x.S[k] = mI0[k] * isotopic_ratio * QT0 * invQT * K1 * K2;
+    if (do_temperature)
+      x.dSdT_div_S[k] = dstimulated_relative_emission_dT(gamma, gamma_ref, mF0[k], T) / K2 +
+                        dboltzman_ratio_dT_div_boltzmann_ratio(T, mE0[k]) - invQT * dQTdT;
+  }
+}
+
+std::size_t Absorption::LineParameterCache::KeyHash::operator()(const Key& key) const noexcept {
+  return hash_bytes(key.data(), key.size() * sizeof(Numeric));
+}
+
+void Absorption::LineParameterCache::shrink(Index n) {
+  while (Index(mentries.size()) > n) {
+    mindex.erase(mentries.back().first);
+    mentries.pop_back();
+  }
+}
+
+void Absorption::LineParameterCache::Capacity(Index n) {
+#pragma omp critical(Absorption_LineParameterCache)
+  if (n not_eq mcapacity) {
+    mcapacity = n;
+    shrink(mcapacity);
+  }
+}
+
+Index Absorption::LineParameterCache::size() const {
+  Index n;
+#pragma omp critical(Absorption_LineParameterCache)
+  n = Index(mentries.size());
+  return n;
+}
+
+Absorption::LineParameterCache::Value Absorption::LineParameterCache::Find(const Key& key) {
+  Value out;
+#pragma omp critical(Absorption_LineParameterCache)
+  {
+    auto pos = mindex.find(key);
+    if (pos not_eq mindex.end()) {
+      mentries.splice(mentries.begin(), mentries, pos->second);
+      out = pos->second->second;
+    }
+  }
+  return out;
+}
+
+void Absorption::LineParameterCache::Insert(const Key& key, Value value) {
+#pragma omp critical(Absorption_LineParameterCache)
+  {
+    auto pos = mindex.find(key);
+    if (pos not_eq mindex.end()) {
+      pos->second->second = std::move(value);
+      mentries.splice(mentries.begin(), mentries, pos->second);
+    } else if (mcapacity > 0) {
+      mentries.emplace_front(key, std::move(value));
+      mindex[key] = mentries.begin();
+      shrink(mcapacity);
+    }
+  }
+}
+
+void Absorption::LineParameterCache::Clear() {
+#pragma omp critical(Absorption_LineParameterCache)
+  {
+    mindex.clear();
+    mentries.clear();
+  }
+}
@@ -32,6 +32,10 @@
 #ifndef absorptionlines_h
 #define absorptionlines_h
 
+#include <array>
+#include <list>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "bifstream.h"
 #include "bofstream.h"
@@ -544,6 +548,8 @@ struct SingleLineExternal {
   SingleLine line;
 };
 
+class CompiledLines;
+
 class Lines {
 private:
   /** Does the line broadening have self broadening */
@@ -588,6 +594,12 @@ private:
   /** A list of individual lines */
   std::vector<SingleLine> mlines;
   
+  /** Packed copy of the lines, or nullptr if it must be compiled again */
+  mutable std::shared_ptr<const CompiledLines> mcompiled;
+  
+  /** Drops the packed copy, called by all methods that can change the lines */
+  void Modified() noexcept {mcompiled.reset();}
+  
 public:
   /** Default initialization
    * 
@@ -698,6 +710,7 @@ public:
    * @param[in] sl A single line
    */
   void AppendSingleLine(SingleLine&& sl) {
+    Modified();
     if(NumLocalQuanta() not_eq sl.LowerQuantumElems() or
        NumLocalQuanta() not_eq sl.UpperQuantumElems())
       throw std::runtime_error("Error calling appending function, bad size of quantum numbers");
@@ -722,6 +735,7 @@ public:
    * @param[in] sl A single line
    */
   void AppendSingleLine(const SingleLine& sl) {
+    Modified();
     if(NumLocalQuanta() not_eq sl.LowerQuantumElems() or
        NumLocalQuanta() not_eq sl.UpperQuantumElems())
       throw std::runtime_error("Error calling appending function, bad size of quantum numbers");
@@ -811,18 +825,21 @@ public:
   
   /** Sort inner line list by frequency */
   void sort_by_frequency() {
+    Modified();
     std::sort(mlines.begin(), mlines.end(),
               [](const SingleLine& a, const SingleLine& b){return a.F0() < b.F0();});
   }
   
   /** Sort inner line list by Einstein coefficient */
   void sort_by_einstein() {
+    Modified();
     std::sort(mlines.begin(), mlines.end(),
               [](const SingleLine& a, const SingleLine& b){return a.A() < b.A();});
   }
   
   /** Removes all global quantum numbers */
   void truncate_global_quantum_numbers() {
+    Modified();
     mquantumidentity.SetTransition(QuantumNumbers(), QuantumNumbers());
   }
   
@@ -855,7 +872,7 @@ public:
   const std::vector<SingleLine>& AllLines() const noexcept {return mlines;}
   
   /** Lines */
-  std::vector<SingleLine>& AllLines() noexcept {return mlines;}
+  std::vector<SingleLine>& AllLines() noexcept {Modified(); return mlines;}
   
   /** Number of broadening species */
   Index NumBroadeners() const noexcept {return Index(mbroadeningspecies.nelem());}
@@ -958,6 +975,7 @@ public:
   
   /** Set Zeeman effect for all lines that have the correct quantum numbers */
   void SetAutomaticZeeman() noexcept {
+    Modified();
     for(auto& line: mlines)
       line.SetAutomaticZeeman(mquantumidentity, mlocalquanta);
   }
@@ -974,7 +992,7 @@ public:
    * @param[in] k Line number (less than NumLines())
    * @return Central frequency
    */
-  Numeric& F0(size_t k) noexcept {return mlines[k].F0();}
+  Numeric& F0(size_t k) noexcept {Modified(); return mlines[k].F0();}
   
   /** Mean frequency by weight of line strengt
    * 
@@ -1014,7 +1032,7 @@ public:
    * @param[in] k Line number (less than NumLines())
    * @return Lower level energy
    */
-  Numeric& E0(size_t k) noexcept {return mlines[k].E0();}
+  Numeric& E0(size_t k) noexcept {Modified(); return mlines[k].E0();}
   
   /** Reference line strength
    * 
@@ -1028,7 +1046,7 @@ public:
    * @param[in] k Line number (less than NumLines())
    * @return Reference line strength
    */
-  Numeric& I0(size_t k) noexcept {return mlines[k].I0();}
+  Numeric& I0(size_t k) noexcept {Modified(); return mlines[k].I0();}
   
   /** Einstein spontaneous emission
    * 
@@ -1042,7 +1060,7 @@ public:
    * @param[in] k Line number (less than NumLines())
    * @return Einstein spontaneous emission
    */
-  Numeric& A(size_t k) noexcept {return mlines[k].A();}
+  Numeric& A(size_t k) noexcept {Modified(); return mlines[k].A();}
   
   /** Lower level statistical weight
    * 
@@ -1056,7 +1074,7 @@ public:
    * @param[in] k Line number (less than NumLines())
    * @return Lower level statistical weight
    */
-  Numeric& g_low(size_t k) noexcept {return mlines[k].g_low();}
+  Numeric& g_low(size_t k) noexcept {Modified(); return mlines[k].g_low();}
   
   /** Upper level statistical weight
    * 
@@ -1070,13 +1088,13 @@ public:
    * @param[in] k Line number (less than NumLines())
    * @return Upper level statistical weight
    */
-  Numeric& g_upp(size_t k) noexcept {return mlines[k].g_upp();}
+  Numeric& g_upp(size_t k) noexcept {Modified(); return mlines[k].g_upp();}
   
   /** Returns mirroring style */
   MirroringType Mirroring() const noexcept {return mmirroring;}
   
   /** Returns mirroring style */
-  void Mirroring(MirroringType x) noexcept {mmirroring = x;}
+  void Mirroring(MirroringType x) noexcept {Modified(); mmirroring = x;}
   
   /** Checks if index is a valid mirroring */
   static bool validIndexForMirroring(Index x) noexcept {
@@ -1102,7 +1120,7 @@ public:
   NormalizationType Normalization() const noexcept {return mnormalization;}
   
   /** Returns normalization style */
-  void Normalization(NormalizationType x) noexcept {mnormalization = x;}
+  void Normalization(NormalizationType x) noexcept {Modified(); mnormalization = x;}
   
   /** Checks if index is a valid normalization */
   static bool validIndexForNormalization(Index x) noexcept {
@@ -1128,7 +1146,7 @@ public:
   CutoffType Cutoff() const noexcept {return mcutoff;}
   
   /** Sets cutoff style */
-  void Cutoff(CutoffType x) noexcept {mcutoff = x;}
+  void Cutoff(CutoffType x) noexcept {Modified(); mcutoff = x;}
   
   /** Checks if index is a valid cutoff */
   static bool validIndexForCutoff(Index x) noexcept {
@@ -1152,7 +1170,7 @@ public:
   PopulationType Population() const noexcept {return mpopulation;}
   
   /** Sets population style */
-  void Population(PopulationType x) noexcept {mpopulation = x;}
+  void Population(PopulationType x) noexcept {Modified(); mpopulation = x;}
   
   /** Checks if index is a valid population */
   static bool validIndexForPopulation(Index x) noexcept {
@@ -1180,7 +1198,7 @@ public:
   LineShape::Type LineShapeType() const noexcept {return mlineshapetype;}
   
   /** Sets lineshapetype style */
-  void LineShapeType(LineShape::Type x) noexcept {mlineshapetype = x;}
+  void LineShapeType(LineShape::Type x) noexcept {Modified(); mlineshapetype = x;}
   
   /** Checks if index is a valid lineshapetype */
   static bool validIndexForLineShapeType(Index x) noexcept {
@@ -1314,6 +1332,7 @@ public:
   
   /** Sets reference temperature */
   void T0(Numeric x) noexcept {
+    Modified();
     mT0 = x;
   }
   
@@ -1324,6 +1343,7 @@ public:
   
   /** Sets internal cutoff frequency value */
   void CutoffFreqValue(Numeric x) noexcept {
+    Modified();
     mcutofffreq = x;
   }
   
@@ -1334,6 +1354,7 @@ public:
   
   /** Sets line mixing limit */
   void LinemixingLimit(Numeric x) noexcept {
+    Modified();
     mlinemixinglimit = x;
   }
   
@@ -1344,6 +1365,7 @@ public:
   
   /** Returns local quantum numbers */
   std::vector<QuantumNumberType>& LocalQuanta() noexcept {
+    Modified();
     return mlocalquanta;
   }
   
@@ -1354,6 +1376,7 @@ public:
   
   /** Returns the broadening species */
   ArrayOfSpeciesTag& BroadeningSpecies() noexcept {
+    Modified();
     return mbroadeningspecies;
   }
   
@@ -1364,6 +1387,7 @@ public:
   
   /** Returns self broadening status */
   void Self(bool x) noexcept {
+    Modified();
     mselfbroadening = x;
   }
   
@@ -1374,6 +1398,7 @@ public:
   
   /** Returns bath broadening status */
   void Bath(bool x) noexcept {
+    Modified();
     mbathbroadening = x;
   }
   
@@ -1384,6 +1409,7 @@ public:
   
   /** Returns identity status */
   QuantumIdentifier& QuantumIdentity() noexcept {
+    Modified();
     return mquantumidentity;
   }
   
@@ -1436,6 +1462,7 @@ public:
   
   /** Binary read for Lines */
   bifstream& read(bifstream& is) {
+    Modified();
     for (auto& line: mlines)
       line.read(is);
     return is;
@@ -1449,11 +1476,240 @@ public:
   }
   
   bool OK() const noexcept;
+  
+  /** Packed structure-of-arrays copy of the lines
+   * 
+   * Compiled on first use, e.g., by lbl_checkedCalc, and then kept until
+   * the band is changed by any of its non-const methods.  Changes made
+   * through a reference that is kept after such a call are not seen
+   * 
+   * May be called concurrently from OpenMP threads
+   */
+  const CompiledLines& Compiled() const;
 };  // Lines
 
 std::ostream& operator<<(std::ostream&, const Lines&);
 std::istream& operator>>(std::istream&, Lines&);
 
+/** Line parameters of all lines of a band at one atmospheric state
+ * 
+ * Structure-of-arrays output of CompiledLines::SetShapeParameters.  Each
+ * Vector holds one line shape variable for all lines of the band.  The
+ * derivatives are only set if they were requested
+ */
+struct CompiledLineParameters {
+  std::array<Vector, LineShape::nVars> X;
+  std::array<Vector, LineShape::nVars> dXdT;
+  std::array<Vector, LineShape::nVars> dXdVMR;
+  
+  /** LTE line strength, including isotopologue ratio and partition function */
+  Vector S;
+  
+  /** Temperature derivative of the LTE line strength divided by S */
+  Vector dSdT_div_S;
+  
+  /** Line shape parameters of line k */
+  LineShape::Output ShapeParameters(Index k) const noexcept {return output(X, k);}
+  
+  /** Line shape parameters temperature derivatives of line k */
+  LineShape::Output ShapeParameters_dT(Index k) const noexcept {return output(dXdT, k);}
+  
+  /** Line shape parameters vmr derivative of line k */
+  LineShape::Output ShapeParameters_dVMR(Index k) const noexcept {return output(dXdVMR, k);}
+  
+ private:
+  static LineShape::Output output(const std::array<Vector, LineShape::nVars>& x, Index k) noexcept {
+    return {x[0][k], x[1][k], x[2][k], x[3][k], x[4][k], x[5][k], x[6][k], x[7][k], x[8][k]};
+  }
+};
+
+/** Cache of evaluated line parameters of a band at atmospheric states
+ * 
+ * Keeps the CompiledLineParameters of the most recently used atmospheric
+ * states of one band, so that repeated evaluations of the same state,
+ * e.g., by several frequency blocks, measurement blocks or perturbation
+ * Jacobians, only redo the frequency dependent part of the cross-section
+ * calculations.
+ * 
+ * Each CompiledLines owns one cache, so the band is never part of the key.
+ * A changed band is compiled again and starts with an empty cache.  The
+ * least recently used entries are removed once more than Capacity()
+ * entries are stored.
+ * 
+ * All methods may be called concurrently from OpenMP threads
+ */
+class LineParameterCache {
+ public:
+  /** The cached line parameters */
+  using Value = std::shared_ptr<const CompiledLineParameters>;
+  
+  /** The atmospheric state, with everything the line parameters depend on */
+  using Key = std::vector<Numeric>;
+  
+  /** Creates an empty cache that can hold n entries */
+  explicit LineParameterCache(Index n=0) : mcapacity(n) {}
+  
+  /** Maximum number of entries */
+  Index Capacity() const noexcept {return mcapacity;}
+  
+  /** Sets the maximum number of entries, removing the oldest as needed
+   * 
+   * Does nothing if the capacity is already n
+   */
+  void Capacity(Index n);
+  
+  /** Number of stored entries */
+  Index size() const;
+  
+  /** Returns the parameters stored for key, or nullptr if there are none */
+  Value Find(const Key& key);
+  
+  /** Stores the parameters of key */
+  void Insert(const Key& key, Value value);
+  
+  /** Removes all entries */
+  void Clear();
+  
+ private:
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const noexcept;
+  };
+  
+  using List = std::list<std::pair<Key, Value>>;
+  
+  void shrink(Index n);
+  
+  Index mcapacity;
+  List mentries;  // Most recently used first
+  std::unordered_map<Key, List::iterator, KeyHash> mindex;
+};  // LineParameterCache
+
+/** Packed structure-of-arrays copy of the per-line data of a band
+ * 
+ * Lines keeps each line as a SingleLine with its own quantum numbers,
+ * Zeeman model and line shape model.  This class copies the catalog
+ * parameters and the line shape model coefficients of all lines into
+ * contiguous arrays, one per parameter and broadening species, so that
+ * the line shape parameters of the entire band can be evaluated in a
+ * single pass over memory.
+ * 
+ * The temperature models are evaluated by LineShape::compute_model and
+ * LineShape::compute_model_dT, as for the lines themselves.
+ * 
+ * The copy is not updated with the band.  Lines::Compiled keeps one copy
+ * with each band and compiles it again after the band has changed
+ */
+class CompiledLines {
+ public:
+  /** Default initialization of an empty band */
+  CompiledLines() = default;
+  
+  /** Packs the lines of a band
+   * 
+   * @param[in] band The absorption band
+   */
+  explicit CompiledLines(const Lines& band);
+  
+  /** Number of lines */
+  Index NumLines() const noexcept {return mF0.nelem();}
+  
+  /** Number of broadening species */
+  Index NumBroadeners() const noexcept {return Index(mshape.size());}
+  
+  /** Central frequency of all lines */
+  const Vector& F0() const noexcept {return mF0;}
+  
+  /** Reference line strength of all lines */
+  const Vector& I0() const noexcept {return mI0;}
+  
+  /** Lower level energy of all lines */
+  const Vector& E0() const noexcept {return mE0;}
+  
+  /** Einstein spontaneous emission coefficient of all lines */
+  const Vector& A() const noexcept {return mA;}
+  
+  /** Lower level statistical weight of all lines */
+  const Vector& g_low() const noexcept {return mglow;}
+  
+  /** Upper level statistical weight of all lines */
+  const Vector& g_upp() const noexcept {return mgupp;}
+  
+  /** Sets the LTE line strength of all lines
+   * 
+   * Gives the same values as Linefunctions::apply_linestrength_scaling_by_lte
+   * 
+   * @param[in,out] x The line parameters
+   * @param[in] T Atmospheric temperature
+   * @param[in] T0 Reference temperature of the band
+   * @param[in] isotopic_ratio Isotopologue ratio of the band
+   * @param[in] QT Partition function at temperature
+   * @param[in] QT0 Partition function at reference temperature
+   * @param[in] dQTdT Temperature derivative of QT
+   * @param[in] do_temperature Set the temperature derivatives
+   */
+  void SetStrengthParameters(CompiledLineParameters& x,
+                             Numeric T,
+                             Numeric T0,
+                             Numeric isotopic_ratio,
+                             Numeric QT,
+                             Numeric QT0,
+                             Numeric dQTdT,
+                             bool do_temperature) const;
+  
+  /** Line parameters of this band at earlier atmospheric states
+   * 
+   * Kept for as long as the compiled band, so it is emptied whenever the
+   * band is changed
+   */
+  LineParameterCache& ParameterCache() const noexcept {return mcache;}
+  
+  /** Sets the line shape parameters of all lines
+   * 
+   * Gives the same values as Lines::ShapeParameters, Lines::ShapeParameters_dT
+   * and Lines::ShapeParameters_dVMR for each line
+   * 
+   * @param[in,out] x The line shape parameters
+   * @param[in] band The band that was compiled
+   * @param[in] T Atmospheric temperature
+   * @param[in] P Atmospheric pressure
+   * @param[in] vmrs Line broadener species's volume mixing ratio
+   * @param[in] do_temperature Set the temperature derivatives
+   * @param[in] do_vmr Set the vmr derivatives
+   * @param[in] vmr_qid Identity of species whose VMR derivative is requested
+   */
+  void SetShapeParameters(CompiledLineParameters& x,
+                          const Lines& band,
+                          Numeric T,
+                          Numeric P,
+                          const Vector& vmrs,
+                          bool do_temperature,
+                          bool do_vmr,
+                          const QuantumIdentifier& vmr_qid) const;
+  
+ private:
+  /** One line shape variable of one broadening species for all lines,
+   * empty if the model is None for all lines */
+  using ShapeModel = std::vector<LineShape::ModelParameters>;
+  
+  /** Adds the weighted sum over broadeners of a variable or its temperature derivative to x */
+  void add_shape_variable(Vector& x,
+                          LineShape::Variable var,
+                          Numeric T,
+                          Numeric T0,
+                          ConstVectorView weights,
+                          bool dT) const noexcept;
+  
+  Vector mF0;
+  Vector mI0;
+  Vector mE0;
+  Vector mA;
+  Vector mglow;
+  Vector mgupp;
+  std::vector<std::array<ShapeModel, LineShape::nVars>> mshape;
+  mutable LineParameterCache mcache;
+};  // CompiledLines
+
+
 /** Read from ARTSCAT-3
  * 
  * @param[in] is Input stream
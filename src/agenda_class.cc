@@ -37,6 +37,7 @@
 #include "global_data.h"
 #include "messages.h"
 #include "methods.h"
+#include "profiler.h"
 #include "workspace_ng.h"
 
 //! Appends methods to an agenda
@@ -70,6 +71,7 @@ void Agenda::append(const String& methodname, const TokVal& keywordvalue) {
 
   mml.push_back(MRecord(id, output, input, keywordvalue, Agenda()));
   mchecked = false;
+  mcompiled = false;
 }
 
 //! Checks consistency of an agenda.
@@ -93,6 +95,7 @@ void Agenda::check(Workspace& ws, const Verbosity& verbosity) {
   // until it is copied to a predefined agenda.
   if (mi == AgendaMap.end()) {
     mchecked = false;
+    mcompiled = false;
     return;
   }
 
@@ -135,6 +138,7 @@ void Agenda::check(Workspace& ws, const Verbosity& verbosity) {
   }
 
   set_outputs_to_push_and_dup(verbosity);
+  set_inputs_to_check();
 
   mchecked = true;
 }
@@ -176,7 +180,8 @@ void Agenda::execute(Workspace& ws) const {
   // The array holding the pointers to the getaway functions:
   extern void (*getaways[])(Workspace&, const MRecord&);
 
-  const Index wsv_id_verbosity = get_wsv_id("verbosity");
+  // The verbosity id never changes, so look it up only once
+  static const Index wsv_id_verbosity = get_wsv_id("verbosity");
   ws.duplicate(wsv_id_verbosity);
 
   Verbosity& averbosity = *((Verbosity*)ws[wsv_id_verbosity]);
@@ -193,8 +198,17 @@ void Agenda::execute(Workspace& ws) const {
           << "{\n";
   }
 
+  const Profiler::Scope agenda_scope(Profiler::Kind::Agenda, mname);
+
+  // Without a compiled agenda, or in debug mode, all inputs are checked
+#ifdef NDEBUG
+  const bool check_all_inputs = !mcompiled;
+#else
+  const bool check_all_inputs = true;
+#endif
+
   for (Index i = 0; i < mml.nelem(); ++i) {
-    const Verbosity& verbosity = *((Verbosity*)ws[wsv_id_verbosity]);
+    const Verbosity& verbosity = averbosity;
     CREATE_OUT1;
     CREATE_OUT3;
 
@@ -206,33 +220,44 @@ void Agenda::execute(Workspace& ws) const {
     try {
       {
         if (mrr.isInternal()) {
-          out3 << "- " + mdd.Name() + "\n";
+          if (out3.sufficient_priority()) out3 << "- " + mdd.Name() + "\n";
         } else {
-          out1 << "- " + mdd.Name() + "\n";
+          if (out1.sufficient_priority()) out1 << "- " + mdd.Name() + "\n";
         }
       }
 
-      {  // Check if all input variables are initialized:
-        const ArrayOfIndex& v(mrr.In());
-        for (Index s = 0; s < v.nelem(); ++s)
-          if ((s != v.nelem() - 1 || !mdd.SetMethod()) &&
-              !ws.is_initialized(v[s]))
-            throw runtime_error(
-                "Method " + mdd.Name() +
-                " needs input variable: " + Workspace::wsv_data[v[s]].Name());
-      }
+      if (check_all_inputs) {
+        {  // Check if all input variables are initialized:
+          const ArrayOfIndex& v(mrr.In());
+          for (Index s = 0; s < v.nelem(); ++s)
+            if ((s != v.nelem() - 1 || !mdd.SetMethod()) &&
+                !ws.is_initialized(v[s]))
+              throw runtime_error("Method " + mdd.Name() +
+                                  " needs input variable: " +
+                                  Workspace::wsv_data[v[s]].Name());
+        }
 
-      {  // Check if all output variables which are also used as input
-        // are initialized
-        const ArrayOfIndex& v = mdd.InOut();
-        for (Index s = 0; s < v.nelem(); ++s)
-          if (!ws.is_initialized(mrr.Out()[v[s]]))
+        {  // Check if all output variables which are also used as input
+          // are initialized
+          const ArrayOfIndex& v = mdd.InOut();
+          for (Index s = 0; s < v.nelem(); ++s)
+            if (!ws.is_initialized(mrr.Out()[v[s]]))
+              throw runtime_error("Method " + mdd.Name() +
+                                  " needs input variable: " +
+                                  Workspace::wsv_data[mrr.Out()[v[s]]].Name());
+        }
+      } else {
+        // Only the inputs that are neither agenda input nor output of a
+        // previous method:
+        for (const Index v : minputs_to_check[i])
+          if (!ws.is_initialized(v))
             throw runtime_error("Method " + mdd.Name() +
                                 " needs input variable: " +
-                                Workspace::wsv_data[mrr.Out()[v[s]]].Name());
+                                Workspace::wsv_data[v].Name());
       }
 
       // Call the getaway function:
+      const Profiler::Scope method_scope(Profiler::Kind::Method, mdd.Name());
       getaways[mrr.Id()](ws, mrr);
 
     } catch (const std::bad_alloc& x) {
@@ -260,6 +285,50 @@ void Agenda::execute(Workspace& ws) const {
   ws.pop_free(wsv_id_verbosity);
 }
 
+//! Find the inputs that need an initialization check
+/*!
+  Builds for each method the list of its input variables that must be
+  checked for initialization when the agenda is executed. Agenda input
+  is pushed initialized by the agenda wrapper, and the output of a method
+  is initialized once it has been called, so these need no check unless
+  they have been deleted in between. The checks that remain at runtime
+  are usually only for variables set outside of the agenda.
+*/
+void Agenda::set_inputs_to_check() {
+  using global_data::agenda_data;
+  using global_data::AgendaMap;
+  using global_data::md_data;
+  using global_data::MdMap;
+
+  const Index WsmDeleteIndex = MdMap.find("Delete")->second;
+
+  const AgRecord& agr = agenda_data[AgendaMap.find(name())->second];
+  set<Index> initialized(agr.In().begin(), agr.In().end());
+
+  minputs_to_check.resize(mml.nelem());
+  for (Index i = 0; i < mml.nelem(); ++i) {
+    const MRecord& mrr = mml[i];
+    const MdRecord& mdd = md_data[mrr.Id()];
+
+    set<Index> needed;
+    const ArrayOfIndex& v = mrr.In();
+    for (Index s = 0; s < v.nelem(); ++s)
+      if (s != v.nelem() - 1 || !mdd.SetMethod()) needed.insert(v[s]);
+    for (const Index s : mdd.InOut()) needed.insert(mrr.Out()[s]);
+
+    minputs_to_check[i].resize(0);
+    for (const Index wsv : needed)
+      if (initialized.find(wsv) == initialized.end())
+        minputs_to_check[i].push_back(wsv);
+
+    initialized.insert(mrr.Out().begin(), mrr.Out().end());
+    if (mrr.Id() == WsmDeleteIndex)
+      for (const Index wsv : v) initialized.erase(wsv);
+  }
+
+  mcompiled = true;
+}
+
 //! Retrieve indexes of all input and output WSVs
 /*!
   Builds arrays of WSM output variables which need to be
@@ -647,6 +716,7 @@ bool Agenda::is_output(Index var) const {
 void Agenda::set_name(const String& nname) {
   mname = nname;
   mchecked = false;
+  mcompiled = false;
 }
 
 //! Agenda name.
@@ -48,8 +48,10 @@ class Agenda {
         mml(),
         moutput_push(),
         moutput_dup(),
+        minputs_to_check(),
         main_agenda(false),
-        mchecked(false) { /* Nothing to do here */
+        mchecked(false),
+        mcompiled(false) { /* Nothing to do here */
   }
 
   /*! 
@@ -60,8 +62,10 @@ class Agenda {
         mml(x.mml),
         moutput_push(x.moutput_push),
         moutput_dup(x.moutput_dup),
+        minputs_to_check(x.minputs_to_check),
         main_agenda(x.main_agenda),
-        mchecked(x.mchecked) { /* Nothing to do here */
+        mchecked(x.mchecked),
+        mcompiled(x.mcompiled) { /* Nothing to do here */
   }
 
   void append(const String& methodname, const TokVal& keywordvalue);
@@ -76,8 +80,10 @@ class Agenda {
   void set_methods(const Array<MRecord>& ml) {
     mml = ml;
     mchecked = false;
+    mcompiled = false;
   }
   void set_outputs_to_push_and_dup(const Verbosity& verbosity);
+  void set_inputs_to_check();
   bool is_input(Workspace& ws, Index var) const;
   bool is_output(Index var) const;
   void set_name(const String& nname);
@@ -100,11 +106,17 @@ class Agenda {
 
   ArrayOfIndex moutput_dup;
 
+  /** Per method, the inputs that may be uninitialized when it is called */
+  ArrayOfArrayOfIndex minputs_to_check;
+
   //! Is set to true if this is the main agenda.
   bool main_agenda;
 
   /** Flag indicating that the agenda was checked for consistency */
   bool mchecked;
+
+  /** Flag indicating that minputs_to_check is valid for mml */
+  bool mcompiled;
 };
 
 // Documentation with implementation.
@@ -254,7 +266,10 @@ class MRecord {
 /*!
   Resizes the agenda's method list to n elements
  */
-inline void Agenda::resize(Index n) { mml.resize(n); }
+inline void Agenda::resize(Index n) {
+  mml.resize(n);
+  mcompiled = false;
+}
 
 //! Return the number of agenda elements.
 /*!  
@@ -274,6 +289,7 @@ inline Index Agenda::nelem() const { return mml.nelem(); }
 inline void Agenda::push_back(const MRecord& n) {
   mml.push_back(n);
   mchecked = false;
+  mcompiled = false;
 }
 
 //! Assignment operator.
@@ -285,7 +301,9 @@ inline Agenda& Agenda::operator=(const Agenda& x) {
   mname = x.mname;
   moutput_push = x.moutput_push;
   moutput_dup = x.moutput_dup;
+  minputs_to_check = x.minputs_to_check;
   mchecked = x.mchecked;
+  mcompiled = x.mcompiled;
   return *this;
 }
 
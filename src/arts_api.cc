@@ -8,6 +8,7 @@
 #include "interactive_workspace.h"
 #include "parameters.h"
 #include "parser.h"
+#include "profiler.h"
 #include "workspace_ng.h"
 
 using global_data::md_data;
@@ -43,6 +44,33 @@ void copy_output_and_input(ArrayOfIndex &output,
   }
 }
 
+/** Describes a contiguous array in row-major order
+ *
+ * @param ptr Pointer to the first element, ignored if there are none.
+ * @param kind Kind of the elements, see VariableBufferStruct.
+ * @param shape The extents of the dimensions.
+ */
+template <typename T>
+VariableBufferStruct contiguous_buffer(T *ptr,
+                                       char kind,
+                                       std::initializer_list<Index> shape) {
+  VariableBufferStruct b{};
+  b.ndim = static_cast<long>(shape.size());
+  b.itemsize = sizeof(T);
+  b.kind = kind;
+
+  long stride = b.itemsize;
+  bool empty = false;
+  for (long i = b.ndim - 1; i >= 0; --i) {
+    b.shape[i] = shape.begin()[i];
+    b.strides[i] = stride;
+    stride *= b.shape[i];
+    empty = empty || !b.shape[i];
+  }
+  b.ptr = empty ? nullptr : ptr;
+  return b;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // Setup and Finalization.
 ////////////////////////////////////////////////////////////////////////////
@@ -57,6 +85,8 @@ void data_path_push(const char *path) { parameters.datapath.push_back(path); }
 
 void data_path_pop() { parameters.datapath.pop_back(); }
 
+void set_parse_cache(const char *dir) { parameters.parsecache = dir ? dir : ""; }
+
 void initialize() { InteractiveWorkspace::initialize(); }
 
 void finalize() {
@@ -67,6 +97,23 @@ const char *get_error() { return string_buffer.c_str(); }
 
 void set_basename(const char *name) { out_basename = name; }
 
+void set_profiling(const char *filename) {
+  if (filename)
+    Profiler::enable(filename);
+  else
+    Profiler::disable();
+}
+
+const char *write_profile(const char *filename) {
+  try {
+    Profiler::write_report(filename);
+  } catch (const std::exception &e) {
+    string_buffer = std::string(e.what());
+    return string_buffer.c_str();
+  }
+  return nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // Parsing and executing agendas.
 ////////////////////////////////////////////////////////////////////////////
@@ -464,6 +511,167 @@ void *get_variable_data_pointer(InteractiveWorkspace *workspace, Index id) {
   return workspace->operator[](id);
 }
 
+VariableBufferStruct get_variable_buffer(InteractiveWorkspace *workspace,
+                                         long id,
+                                         long group_id,
+                                         long part) {
+  VariableBufferStruct b{};
+  b.ndim = -1;
+  if (!workspace->is_initialized(id)) {
+    return b;
+  }
+
+  const String &group = wsv_group_names[group_id];
+  void *wsv = workspace->operator[](id);
+
+  if (part == 0) {
+    if (group == "Vector") {
+      Vector &v = *reinterpret_cast<Vector *>(wsv);
+      return contiguous_buffer(
+          v.empty() ? nullptr : v.get_c_array(), 'f', {v.nelem()});
+    } else if (group == "Matrix") {
+      Matrix &m = *reinterpret_cast<Matrix *>(wsv);
+      return contiguous_buffer(m.empty() ? nullptr : m.get_c_array(),
+                               'f',
+                               {m.nrows(), m.ncols()});
+    } else if (group == "Tensor3") {
+      Tensor3 &t = *reinterpret_cast<Tensor3 *>(wsv);
+      return contiguous_buffer(t.empty() ? nullptr : t.get_c_array(),
+                               'f',
+                               {t.npages(), t.nrows(), t.ncols()});
+    } else if (group == "Tensor4") {
+      Tensor4 &t = *reinterpret_cast<Tensor4 *>(wsv);
+      return contiguous_buffer(t.empty() ? nullptr : t.get_c_array(),
+                               'f',
+                               {t.nbooks(), t.npages(), t.nrows(), t.ncols()});
+    } else if (group == "Tensor5") {
+      Tensor5 &t = *reinterpret_cast<Tensor5 *>(wsv);
+      return contiguous_buffer(
+          t.empty() ? nullptr : t.get_c_array(),
+          'f',
+          {t.nshelves(), t.nbooks(), t.npages(), t.nrows(), t.ncols()});
+    } else if (group == "Tensor6") {
+      Tensor6 &t = *reinterpret_cast<Tensor6 *>(wsv);
+      return contiguous_buffer(t.empty() ? nullptr : t.get_c_array(),
+                               'f',
+                               {t.nvitrines(),
+                                t.nshelves(),
+                                t.nbooks(),
+                                t.npages(),
+                                t.nrows(),
+                                t.ncols()});
+    } else if (group == "Tensor7") {
+      Tensor7 &t = *reinterpret_cast<Tensor7 *>(wsv);
+      return contiguous_buffer(t.empty() ? nullptr : t.get_c_array(),
+                               'f',
+                               {t.nlibraries(),
+                                t.nvitrines(),
+                                t.nshelves(),
+                                t.nbooks(),
+                                t.npages(),
+                                t.nrows(),
+                                t.ncols()});
+    } else if (group == "ArrayOfIndex") {
+      ArrayOfIndex &a = *reinterpret_cast<ArrayOfIndex *>(wsv);
+      return contiguous_buffer(a.data(), 'i', {a.nelem()});
+    } else if (group == "GasAbsLookup") {
+      Tensor4 &t = reinterpret_cast<GasAbsLookup *>(wsv)->Xsec();
+      return contiguous_buffer(t.empty() ? nullptr : t.get_c_array(),
+                               'f',
+                               {t.nbooks(), t.npages(), t.nrows(), t.ncols()});
+    }
+  }
+
+  if (group == "Sparse") {
+    Sparse &s = *reinterpret_cast<Sparse *>(wsv);
+    if (part == 0) {
+      return contiguous_buffer(s.get_element_pointer(), 'f', {s.nnz()});
+    } else if (part == 1) {
+      return contiguous_buffer(s.get_column_index_pointer(), 'i', {s.nnz()});
+    } else if (part == 2) {
+      return contiguous_buffer(
+          s.get_row_start_pointer(), 'i', {s.nrows() + 1});
+    }
+  }
+
+  return b;
+}
+
+const char *resize_variable(InteractiveWorkspace *workspace,
+                            long id,
+                            long group_id,
+                            long ndim,
+                            const long *shape) {
+  const String &group = wsv_group_names[group_id];
+
+  Index expected = -1;
+  if (group == "Vector") {
+    expected = 1;
+  } else if (group == "Matrix") {
+    expected = 2;
+  } else if (group.substr(0, 6) == "Tensor" && group.size() == 7) {
+    expected = group[6] - '0';
+  }
+
+  if (expected < 0) {
+    string_buffer = "Variables of group " + group + " can not be resized.";
+    return string_buffer.c_str();
+  }
+  if (ndim != expected) {
+    std::ostringstream ss;
+    ss << "A " << group << " has " << expected << " dimensions, not " << ndim
+       << ".";
+    string_buffer = ss.str();
+    return string_buffer.c_str();
+  }
+  for (long i = 0; i < ndim; ++i) {
+    if (shape[i] < 0) {
+      string_buffer = "Dimensions must not be negative.";
+      return string_buffer.c_str();
+    }
+  }
+
+  void *wsv = workspace->operator[](id);
+  try {
+    switch (ndim) {
+      case 1:
+        reinterpret_cast<Vector *>(wsv)->resize(shape[0]);
+        break;
+      case 2:
+        reinterpret_cast<Matrix *>(wsv)->resize(shape[0], shape[1]);
+        break;
+      case 3:
+        reinterpret_cast<Tensor3 *>(wsv)->resize(shape[0], shape[1], shape[2]);
+        break;
+      case 4:
+        reinterpret_cast<Tensor4 *>(wsv)->resize(
+            shape[0], shape[1], shape[2], shape[3]);
+        break;
+      case 5:
+        reinterpret_cast<Tensor5 *>(wsv)->resize(
+            shape[0], shape[1], shape[2], shape[3], shape[4]);
+        break;
+      case 6:
+        reinterpret_cast<Tensor6 *>(wsv)->resize(
+            shape[0], shape[1], shape[2], shape[3], shape[4], shape[5]);
+        break;
+      case 7:
+        reinterpret_cast<Tensor7 *>(wsv)->resize(shape[0],
+                                                 shape[1],
+                                                 shape[2],
+                                                 shape[3],
+                                                 shape[4],
+                                                 shape[5],
+                                                 shape[6]);
+        break;
+    }
+  } catch (const std::exception &e) {
+    string_buffer = e.what();
+    return string_buffer.c_str();
+  }
+  return nullptr;
+}
+
 CovarianceMatrixBlockStruct get_covariance_matrix_block(CovarianceMatrix *m,
                                                         long block_index,
                                                         bool inverse) {
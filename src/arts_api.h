@@ -90,6 +90,28 @@ struct VariableValueStruct {
   const int *outer_ptr;
 };
 
+/** Strided view on the data of an ARTS value
+ *
+ * This struct describes memory that belongs to a workspace variable, in
+ * the form used by the Python buffer protocol and the numpy array
+ * interface, so that an outside application can access the data without
+ * copying it.
+ */
+struct VariableBufferStruct {
+  /** Pointer to the first element, or NULL if there are no elements. */
+  void *ptr;
+  /** Number of dimensions, or -1 if there is no such buffer. */
+  long ndim;
+  /** Number of elements along each dimension. */
+  long shape[7];
+  /** Distance in bytes between neighbouring elements along each dimension. */
+  long strides[7];
+  /** Size of an element in bytes. */
+  long itemsize;
+  /** Kind of the elements: 'f' for floating point and 'i' for integers. */
+  char kind;
+};
+
 /** Representation of workspace methods
  *
  * This struct is used to return descriptions of a workspace method.
@@ -262,6 +284,18 @@ void data_path_push(const char *path);
 DLL_PUBLIC
 void data_path_pop();
 
+/** Set the parse cache directory.
+ *
+ * Parsed control files are kept in this directory and reused by
+ * parse_agenda while neither the control file, its includes nor the
+ * ARTS build have changed.
+ *
+ * @param[in] dir The cache directory, or NULL or an empty string to
+ * switch the cache off.
+ */
+DLL_PUBLIC
+void set_parse_cache(const char *dir);
+
 /** Initalize ARTS runtime.
  *
  * This function must be called before any other function to initialize the
@@ -292,6 +326,28 @@ const char *get_error();
 DLL_PUBLIC
 void set_basename(const char *name);
 
+/** Switch profiling on or off.
+ *
+ * While profiling is on, the wall time and call counts of all agendas
+ * and workspace methods are recorded, nested by their callers and per
+ * thread. The report is written at exit, as JSON or in the folded stack
+ * format if the file name ends with ".folded".
+ *
+ * @param[in] filename The report file, or NULL to switch profiling off.
+ * An empty string switches profiling on without writing a report at
+ * exit.
+ */
+DLL_PUBLIC
+void set_profiling(const char *filename);
+
+/** Write the profiling report now.
+ *
+ * @param[in] filename The report file.
+ * @return NULL on success, otherwise a pointer to the error message.
+ */
+DLL_PUBLIC
+const char *write_profile(const char *filename);
+
 ////////////////////////////////////////////////////////////////////////////
 // Parsing and executing agendas.
 ////////////////////////////////////////////////////////////////////////////
@@ -560,6 +616,58 @@ DLL_PUBLIC
 void * get_variable_data_pointer(InteractiveWorkspace *workspace,
                                  Index id);
 
+/** Get a view on the data of a WSV.
+ *
+ * The view refers to the memory of the variable itself, nothing is
+ * copied. It remains valid until the variable is set, resized or erased,
+ * or the workspace is destroyed. Values written through the view change
+ * the variable.
+ *
+ * Supported groups are:
+ *
+ * - Vector, Matrix, Tensor3, ..., Tensor7 and ArrayOfIndex: part 0 is the
+ *   data.
+ * - Sparse: part 0 are the non-zero elements, part 1 their column indices
+ *   and part 2 the offsets of the rows in the two others, which is the
+ *   CSR format.
+ * - GasAbsLookup: part 0 are the absorption cross sections. A mapped or
+ *   single precision table is first copied to memory in double precision.
+ *
+ * @param workspace Pointer to a InteractiveWorkspace object.
+ * @param id Index of the workspace variable.
+ * @param group_id Index of the group the variable belongs to.
+ * @param part The part of the variable, see above.
+ * @return The view, with ndim set to -1 if the variable is uninitialized or
+ * the group or part is not supported.
+ */
+DLL_PUBLIC
+VariableBufferStruct get_variable_buffer(InteractiveWorkspace *workspace,
+                                         long id,
+                                         long group_id,
+                                         long part);
+
+/** Resize a WSV.
+ *
+ * Resizes a variable of group Vector, Matrix or Tensor3, ..., Tensor7 and
+ * marks it as initialized. The values of the elements are undefined
+ * unless the size did not change. Together with get_variable_buffer this
+ * lets an outside application write data directly into the memory of the
+ * workspace, instead of passing it to set_variable_value, which copies it.
+ *
+ * @param workspace Pointer to a InteractiveWorkspace object.
+ * @param id Index of the workspace variable.
+ * @param group_id Index of the group the variable belongs to.
+ * @param ndim Number of dimensions, must match the group.
+ * @param shape The new extents of the dimensions.
+ * @return NULL on success, otherwise a pointer to the error message.
+ */
+DLL_PUBLIC
+const char *resize_variable(InteractiveWorkspace *workspace,
+                            long id,
+                            long group_id,
+                            long ndim,
+                            const long *shape);
+
 /** Return block of covariance matrix.
  *
  *
@@ -138,3 +138,22 @@ void arts_omp_set_dynamic(int i _U_)
   // Nothing to do here.
 #endif
 }
+
+//! Wrapper for omp_set_num_threads
+/*! 
+  This wrapper works with and without OMP support.
+
+  \param i Number of threads to use for parallel regions.
+*/
+#ifdef _OPENMP
+void arts_omp_set_num_threads(int i)
+#else
+void arts_omp_set_num_threads(int i _U_)
+#endif
+{
+#ifdef _OPENMP
+  omp_set_num_threads(i);
+#else
+  // Nothing to do here.
+#endif
+}
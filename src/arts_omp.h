@@ -38,6 +38,8 @@
 #include <omp.h>
 #endif
 
+#include "arts.h"
+
 int arts_omp_get_max_threads();
 
 bool arts_omp_in_parallel();
@@ -50,4 +52,52 @@ void arts_omp_set_nested(int i);
 
 void arts_omp_set_dynamic(int i);
 
+void arts_omp_set_num_threads(int i);
+
+//! Parallel loop that also works inside parallel regions
+/*!
+  Calls f(i) for i = 0, ..., n-1 in parallel.
+
+  Outside of a parallel region, this is a parallel for loop. Inside of
+  a parallel region, where a nested parallel for would run on a single
+  thread, the iterations become tasks of the enclosing team instead.
+  Threads of that team that are idle, e.g. because they have finished
+  their part of an outer loop and wait at its barrier, pick them up.
+  Tasks created by f itself are shared the same way.
+
+  Like firstprivate, each thread or task calls its own copy of f, so
+  what f captures by value is private to it. f must not throw.
+
+  \param n Number of iterations.
+  \param f Function object called with the iteration index.
+  \param chunk Iterations per thread or task, 0 lets OpenMP decide.
+*/
+template <typename F>
+void arts_omp_parallel_for(const Index n, const F& f, const Index chunk = 0) {
+  F g(f);
+#ifdef _OPENMP
+  if (n > 1 && omp_in_parallel()) {
+    if (chunk > 0) {
+#pragma omp taskloop grainsize(chunk) firstprivate(g)
+      for (Index i = 0; i < n; i++) g(i);
+    } else {
+#pragma omp taskloop firstprivate(g)
+      for (Index i = 0; i < n; i++) g(i);
+    }
+    return;
+  }
+  if (n > 1) {
+    if (chunk > 0) {
+#pragma omp parallel for schedule(static, chunk) firstprivate(g)
+      for (Index i = 0; i < n; i++) g(i);
+    } else {
+#pragma omp parallel for firstprivate(g)
+      for (Index i = 0; i < n; i++) g(i);
+    }
+    return;
+  }
+#endif
+  for (Index i = 0; i < n; i++) g(i);
+}
+
 #endif  // arts_omp_h
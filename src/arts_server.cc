@@ -0,0 +1,339 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   arts_server.cc
+  \author agent
+  \date   2026-10-16
+
+  \brief  Server mode that runs control files in a preloaded workspace.
+*/
+
+#include "arts_server.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "agenda_class.h"
+#include "arts_omp.h"
+#include "auto_md.h"
+#include "file.h"
+#include "parser.h"
+#include "workspace_ng.h"
+
+extern String out_basename;
+extern ofstream report_file;
+
+namespace ArtsServer {
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) { stop_requested = 1; }
+
+String error_text(const String& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+bool send_all(const int fd, const char* data, std::size_t size) {
+  while (size) {
+    const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= std::size_t(n);
+  }
+  return true;
+}
+
+bool recv_all(const int fd, char* data, std::size_t size) {
+  while (size) {
+    const ssize_t n = ::recv(fd, data, size, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= std::size_t(n);
+  }
+  return true;
+}
+
+sockaddr_un socket_address(const String& path) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path))
+    throw std::runtime_error("Socket path is too long: " + path);
+  std::strcpy(addr.sun_path, path.c_str());
+  return addr;
+}
+
+bool connect_to(const int fd, const String& path) {
+  const sockaddr_un addr = socket_address(path);
+  return ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ==
+         0;
+}
+
+/** The size of a job, with the standard output and error of the client */
+struct JobHeader {
+  std::int64_t size;
+  int fds[2];
+};
+
+/** Sends the job, its size and the standard output and error */
+bool send_job(const int fd, const String& job) {
+  std::int64_t size = std::int64_t(job.size());
+  iovec iov = {&size, sizeof(size)};
+
+  char control[CMSG_SPACE(2 * sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+
+  msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  const int fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  return ::sendmsg(fd, &msg, MSG_NOSIGNAL) == ssize_t(sizeof(size)) &&
+         send_all(fd, job.data(), job.size());
+}
+
+/** Receives what send_job sent */
+bool recv_job(const int fd, String& job, JobHeader& header) {
+  iovec iov = {&header.size, sizeof(header.size)};
+
+  char control[CMSG_SPACE(2 * sizeof(int))];
+  msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  if (::recvmsg(fd, &msg, 0) != ssize_t(sizeof(header.size))) return false;
+
+  const cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+    return false;
+  std::memcpy(header.fds, CMSG_DATA(cmsg), sizeof(header.fds));
+
+  if (header.size < 0 || header.size > (1 << 20)) return false;
+  job.resize(std::size_t(header.size));
+  return job.empty() || recv_all(fd, &job[0], job.size());
+}
+
+/** Runs the job of a client in a forked child
+ *
+ * @return The exit status of the job
+ */
+int run_job(Workspace& ws,
+            const int conn,
+            const Index nthreads,
+            const Verbosity& verbosity) {
+  CREATE_OUT0;
+
+  String job;
+  JobHeader header;
+  if (!recv_job(conn, job, header)) return EXIT_FAILURE;
+
+  // From here on, all messages go to the client
+  ::dup2(header.fds[0], STDOUT_FILENO);
+  ::dup2(header.fds[1], STDERR_FILENO);
+  ::close(header.fds[0]);
+  ::close(header.fds[1]);
+
+  arts_omp_set_num_threads(int(nthreads));
+
+  // The job is the working directory and the control file
+  const std::size_t sep = job.find('\0');
+  const String cwd = job.substr(0, sep);
+  const String controlfile = sep == std::string::npos ? "" : job.substr(sep + 1);
+
+  int status = EXIT_SUCCESS;
+  try {
+    if (::chdir(cwd.c_str()) != 0)
+      throw std::runtime_error(error_text("Cannot change to directory " + cwd));
+
+    // Output files are named after the control file, as in a normal run
+    ArrayOfString fileparts;
+    controlfile.split(fileparts, "/");
+    out_basename = fileparts.nelem() ? fileparts[fileparts.nelem() - 1] : "";
+    const String::size_type p = out_basename.rfind(".arts");
+    if (String::npos != p) out_basename.erase(p);
+    report_file.close();
+    open_output_file(report_file, out_basename + ".rep");
+
+    Agenda tasklist;
+    ArtsParser arts_parser(tasklist, controlfile, verbosity);
+    arts_parser.parse_tasklist();
+    tasklist.set_name("Arts");
+    tasklist.set_main_agenda();
+
+    ws.initialize();
+    Arts2(ws, tasklist, verbosity);
+  } catch (const std::exception& x) {
+    ostringstream os;
+    os << "Run-time error in controlfile: " << controlfile << '\n'
+       << x.what() << '\n';
+    out0 << os.str();
+    status = EXIT_FAILURE;
+  }
+
+  report_file.flush();
+  cout.flush();
+  cerr.flush();
+
+  const std::int64_t result = status;
+  send_all(conn, reinterpret_cast<const char*>(&result), sizeof(result));
+  return status;
+}
+
+}  // namespace
+
+void serve(Workspace& ws,
+           const String& socket_path,
+           const Index nthreads,
+           const Verbosity& verbosity) {
+  CREATE_OUT0;
+  CREATE_OUT1;
+
+  const sockaddr_un addr = socket_address(socket_path);
+
+  // A socket file that nobody listens on is left over from an old server
+  struct stat st;
+  if (::stat(socket_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    const bool running = probe >= 0 && connect_to(probe, socket_path);
+    if (probe >= 0) ::close(probe);
+    if (running)
+      throw std::runtime_error("Another server is running on " + socket_path);
+    ::unlink(socket_path.c_str());
+  }
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) throw std::runtime_error(error_text("Cannot create socket"));
+
+  if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) !=
+          0 ||
+      ::listen(fd, 64) != 0) {
+    const String msg = error_text("Cannot listen on " + socket_path);
+    ::close(fd);
+    throw std::runtime_error(msg);
+  }
+
+  // Without SA_RESTART, so that poll returns on the signal
+  struct sigaction sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = request_stop;
+  sigemptyset(&sa.sa_mask);
+  ::sigaction(SIGINT, &sa, nullptr);
+  ::sigaction(SIGTERM, &sa, nullptr);
+
+  out1 << "Serving jobs on " << socket_path << "\n";
+
+  while (!stop_requested) {
+    pollfd p = {fd, POLLIN, 0};
+    const int n = ::poll(&p, 1, 1000);
+
+    while (::waitpid(-1, nullptr, WNOHANG) > 0) {
+    }
+
+    if (n <= 0 || !(p.revents & POLLIN)) continue;
+
+    const int conn = ::accept(fd, nullptr, nullptr);
+    if (conn < 0) continue;
+
+    // Buffered output would otherwise be written by the child as well
+    report_file.flush();
+    cout.flush();
+    cerr.flush();
+
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(fd);
+      std::signal(SIGINT, SIG_DFL);
+      std::signal(SIGTERM, SIG_DFL);
+      ::_exit(run_job(ws, conn, nthreads, verbosity));
+    }
+    if (pid < 0) {
+      ostringstream os;
+      os << error_text("Cannot fork a job") << '\n';
+      out0 << os.str();
+    }
+    ::close(conn);
+  }
+
+  ::close(fd);
+  ::unlink(socket_path.c_str());
+  out1 << "Server stopped.\n";
+}
+
+Index submit(const String& socket_path, const String& controlfile) {
+  char* path = ::realpath(controlfile.c_str(), nullptr);
+  if (!path)
+    throw std::runtime_error(error_text("Cannot find control file " +
+                                        controlfile));
+  String job;
+  char cwd[4096];
+  if (::getcwd(cwd, sizeof(cwd))) job = cwd;
+  job += '\0';
+  job += path;
+  std::free(path);
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) throw std::runtime_error(error_text("Cannot create socket"));
+  if (!connect_to(fd, socket_path)) {
+    const String msg = error_text("Cannot connect to server " + socket_path);
+    ::close(fd);
+    throw std::runtime_error(msg);
+  }
+
+  // Our own messages must not end up after those of the job
+  cout.flush();
+  cerr.flush();
+
+  std::int64_t status;
+  const bool ok = send_job(fd, job) &&
+                  recv_all(fd, reinterpret_cast<char*>(&status), sizeof(status));
+  ::close(fd);
+  if (!ok)
+    throw std::runtime_error("The server job for " + controlfile +
+                             " ended without a result");
+  return status;
+}
+
+}  // namespace ArtsServer
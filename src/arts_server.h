@@ -0,0 +1,75 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   arts_server.h
+  \author agent
+  \date   2026-10-16
+
+  \brief  Server mode that runs control files in a preloaded workspace.
+
+  The server first runs its own control files, which typically read
+  lookup tables, scattering data and other large inputs. Then it listens
+  on a Unix socket. A client sends the path of a control file. The server
+  forks, and the child runs the control file in the workspace that the
+  server has prepared. The child works on a copy-on-write image of the
+  server, so jobs see the preloaded data without reading it again, and no
+  job sees the changes of another one.
+
+  The client also passes its standard output and error, so that the
+  messages of the job appear where the client runs. The job runs in the
+  working directory of the client and writes its report file there.
+*/
+
+#ifndef arts_server_h
+#define arts_server_h
+
+#include "matpackI.h"
+#include "messages.h"
+#include "mystring.h"
+
+class Workspace;
+
+namespace ArtsServer {
+
+/** Runs jobs until the server gets SIGINT or SIGTERM
+ *
+ * OpenMP can not be used in a forked child if the parent has already
+ * started OpenMP threads. The server must therefore run on one thread,
+ * and the jobs are given the number of threads to use.
+ *
+ * @param[in] ws The preloaded workspace
+ * @param[in] socket_path Path of the Unix socket
+ * @param[in] nthreads Number of OpenMP threads of each job
+ * @param[in] verbosity Verbosity
+ */
+void serve(Workspace& ws,
+           const String& socket_path,
+           const Index nthreads,
+           const Verbosity& verbosity);
+
+/** Runs a control file on a server
+ *
+ * @param[in] socket_path Path of the Unix socket of the server
+ * @param[in] controlfile The control file
+ * @return The exit status of the job
+ */
+Index submit(const String& socket_path, const String& controlfile);
+
+}  // namespace ArtsServer
+
+#endif  // arts_server_h
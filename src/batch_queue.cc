@@ -0,0 +1,340 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   batch_queue.cc
+  \author agent
+  \date   2026-10-16
+
+  \brief  A work queue that hands batch jobs to worker processes.
+*/
+
+#include "batch_queue.h"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+namespace BatchQueue {
+
+namespace {
+
+enum class Message : std::int64_t {
+  Request = 1,  //!< Worker asks for a job
+  Result = 2,   //!< Worker sends the result of its job
+  Failed = 3,   //!< Worker sends the error message of its job
+  Job = 4,      //!< Coordinator sends the index of a job
+  Done = 5      //!< Coordinator has no more jobs
+};
+
+/** How long a worker tries to connect, in seconds */
+const int connect_timeout = 60;
+
+String error_text(const String& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+bool send_all(const int fd, const char* data, std::size_t size) {
+  while (size) {
+    const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= std::size_t(n);
+  }
+  return true;
+}
+
+bool recv_all(const int fd, char* data, std::size_t size) {
+  while (size) {
+    const ssize_t n = ::recv(fd, data, size, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= std::size_t(n);
+  }
+  return true;
+}
+
+bool send_message(const int fd, const Message type, const std::string& payload) {
+  const std::int64_t head[2] = {std::int64_t(type),
+                                std::int64_t(payload.size())};
+  return send_all(fd, reinterpret_cast<const char*>(head), sizeof(head)) &&
+         send_all(fd, payload.data(), payload.size());
+}
+
+bool send_index(const int fd, const Message type, const Index index) {
+  const std::int64_t i = index;
+  return send_message(
+      fd, type, std::string(reinterpret_cast<const char*>(&i), sizeof(i)));
+}
+
+bool recv_message(const int fd, Message& type, std::string& payload) {
+  std::int64_t head[2];
+  if (!recv_all(fd, reinterpret_cast<char*>(head), sizeof(head))) return false;
+  if (head[1] < 0) return false;
+  type = Message(head[0]);
+  payload.resize(std::size_t(head[1]));
+  return payload.empty() || recv_all(fd, &payload[0], payload.size());
+}
+
+Index payload_index(const std::string& payload) {
+  std::int64_t i;
+  if (payload.size() != sizeof(i))
+    throw std::runtime_error("Malformed job message from batch coordinator");
+  std::memcpy(&i, payload.data(), sizeof(i));
+  return i;
+}
+
+/** One connected worker */
+struct Client {
+  int fd;
+  Index job;
+  bool waiting;
+};
+
+}  // namespace
+
+Coordinator::Coordinator(const Index port)
+    : mfd(-1), mport(port), mremote(port != 0) {
+  if (port < 0 || port > 65535)
+    throw std::runtime_error("Batch coordinator port must be in [0, 65535]");
+
+  mfd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (mfd < 0) throw std::runtime_error(error_text("Cannot create socket"));
+
+  const int on = 1;
+  ::setsockopt(mfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<std::uint16_t>(port));
+  addr.sin_addr.s_addr = htonl(mremote ? INADDR_ANY : INADDR_LOOPBACK);
+
+  socklen_t len = sizeof(addr);
+  if (::bind(mfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(mfd, 64) != 0 ||
+      ::getsockname(mfd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    const String msg =
+        error_text("Cannot listen on port " + std::to_string(port));
+    ::close(mfd);
+    throw std::runtime_error(msg);
+  }
+  mport = ntohs(addr.sin_port);
+}
+
+Coordinator::~Coordinator() {
+  if (mfd >= 0) ::close(mfd);
+}
+
+void Coordinator::run(const ArrayOfIndex& jobs,
+                      const Index max_attempts,
+                      const Handlers& handlers,
+                      const std::vector<pid_t>& local) {
+  std::deque<Index> queue(jobs.begin(), jobs.end());
+  std::map<Index, Index> attempts;
+  std::vector<Client> clients;
+  std::vector<pid_t> running(local);
+  Index remaining = jobs.nelem();
+  String abort_msg;
+
+  // A failed attempt puts the job back into the queue, or gives it up
+  const auto fail = [&](const Index job, const String& msg) {
+    if (++attempts[job] < max_attempts) {
+      queue.push_back(job);
+    } else {
+      remaining--;
+      if (!handlers.failure(job, msg) && abort_msg.empty()) abort_msg = msg;
+    }
+  };
+
+  try {
+    while (remaining > 0 && abort_msg.empty()) {
+      std::vector<pollfd> fds(clients.size() + 1);
+      fds[0] = {mfd, POLLIN, 0};
+      for (std::size_t i = 0; i < clients.size(); i++)
+        fds[i + 1] = {clients[i].fd, POLLIN, 0};
+
+      if (::poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR)
+        throw std::runtime_error(error_text("Batch coordinator poll failed"));
+
+      if (fds[0].revents & POLLIN) {
+        const int fd = ::accept(mfd, nullptr, nullptr);
+        if (fd >= 0) {
+          const int on = 1;
+          ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+          clients.push_back({fd, -1, false});
+        }
+      }
+
+      // Iterate backwards, as disconnected clients are removed
+      for (std::size_t i = fds.size() - 1; i > 0; i--) {
+        if (!fds[i].revents) continue;
+        Client& c = clients[i - 1];
+
+        Message type;
+        std::string payload;
+        if (!recv_message(c.fd, type, payload)) {
+          if (c.job >= 0) fail(c.job, "Worker disconnected");
+          ::close(c.fd);
+          clients.erase(clients.begin() + long(i - 1));
+          continue;
+        }
+
+        if (type == Message::Request) {
+          c.waiting = true;
+        } else if (type == Message::Result && c.job >= 0) {
+          handlers.result(c.job, payload);
+          remaining--;
+          c.job = -1;
+        } else if (type == Message::Failed && c.job >= 0) {
+          fail(c.job, payload);
+          c.job = -1;
+        }
+      }
+
+      for (auto& c : clients)
+        if (c.waiting && c.job < 0 && !queue.empty()) {
+          c.job = queue.front();
+          queue.pop_front();
+          c.waiting = false;
+          // A failed send shows up as a disconnect in the next poll
+          send_index(c.fd, Message::Job, c.job);
+        }
+
+      for (auto p = running.begin(); p != running.end();)
+        if (::waitpid(*p, nullptr, WNOHANG) != 0)
+          p = running.erase(p);
+        else
+          ++p;
+
+      if (!mremote && running.empty() && clients.empty() && remaining > 0)
+        abort_msg = "All batch workers have exited before the batch was done";
+    }
+  } catch (const std::exception& e) {
+    abort_msg = e.what();
+  }
+
+  for (auto& c : clients) {
+    send_message(c.fd, Message::Done, "");
+    ::close(c.fd);
+  }
+
+  // Local workers that are still busy with a job are not needed anymore
+  if (abort_msg.nelem())
+    for (const pid_t p : running) ::kill(p, SIGTERM);
+
+  // Local workers that connect late would wait for an answer forever
+  while (!running.empty()) {
+    pollfd fd = {mfd, POLLIN, 0};
+    if (::poll(&fd, 1, 200) > 0 && (fd.revents & POLLIN)) {
+      const int c = ::accept(mfd, nullptr, nullptr);
+      if (c >= 0) {
+        send_message(c, Message::Done, "");
+        ::close(c);
+      }
+    }
+    for (auto p = running.begin(); p != running.end();)
+      if (::waitpid(*p, nullptr, WNOHANG) != 0)
+        p = running.erase(p);
+      else
+        ++p;
+  }
+
+  if (abort_msg.nelem()) throw std::runtime_error(abort_msg);
+}
+
+Index work(const String& host,
+           const Index port,
+           const std::function<std::string(Index)>& job) {
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* addrs = nullptr;
+  const int rc = ::getaddrinfo(
+      host.c_str(), std::to_string(port).c_str(), &hints, &addrs);
+  if (rc != 0)
+    throw std::runtime_error("Cannot resolve batch coordinator " + host +
+                             ": " + ::gai_strerror(rc));
+
+  int fd = -1;
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::seconds(connect_timeout);
+  while (fd < 0) {
+    for (addrinfo* a = addrs; a && fd < 0; a = a->ai_next) {
+      fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+    if (fd < 0) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        ::freeaddrinfo(addrs);
+        throw std::runtime_error(error_text(
+            "Cannot connect to batch coordinator " + host + ":" +
+            std::to_string(port)));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+  }
+  ::freeaddrinfo(addrs);
+
+  const int on = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+  // The coordinator closes the connection when it is done, so a failed
+  // send or receive ends the work as well
+  Index n = 0;
+  Message type;
+  std::string payload;
+  while (send_message(fd, Message::Request, "") &&
+         recv_message(fd, type, payload) && type == Message::Job) {
+    const Index index = payload_index(payload);
+    std::string result;
+    bool ok = true;
+    try {
+      result = job(index);
+    } catch (const std::exception& e) {
+      result = e.what();
+      ok = false;
+    }
+    if (!send_message(fd, ok ? Message::Result : Message::Failed, result))
+      break;
+    n++;
+  }
+
+  ::close(fd);
+  return n;
+}
+
+}  // namespace BatchQueue
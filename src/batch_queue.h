@@ -0,0 +1,118 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   batch_queue.h
+  \author agent
+  \date   2026-10-16
+
+  \brief  A work queue that hands batch jobs to worker processes.
+
+  The coordinator listens on a TCP port. Workers connect, ask for a
+  job, get a batch index, and send back the result or a failure. A job
+  whose worker fails or disconnects is handed out again, up to a maximum
+  number of attempts. When all jobs are finished, the coordinator tells
+  the workers to stop.
+
+  Every message is a 64 bit type, a 64 bit payload size and the payload,
+  in the native format of the machine. All hosts must therefore have
+  the same byte order. There is no authentication, the port should only
+  be reachable from trusted hosts.
+*/
+
+#ifndef batch_queue_h
+#define batch_queue_h
+
+#include <sys/types.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "array.h"
+#include "mystring.h"
+
+namespace BatchQueue {
+
+/** Handles the results of the coordinator
+ *
+ * result is called with the index and the payload of a finished job.
+ * failure is called with the index and the error message of a job that
+ * failed in all attempts, if it returns false the batch is aborted.
+ */
+struct Handlers {
+  std::function<void(Index, const std::string&)> result;
+  std::function<bool(Index, const String&)> failure;
+};
+
+/** The coordinator of a batch */
+class Coordinator {
+ public:
+  /** Starts listening
+   *
+   * @param[in] port The port, 0 to pick a free port. With 0, only
+   * connections from this host are accepted, otherwise from all hosts.
+   */
+  explicit Coordinator(const Index port);
+
+  Coordinator(const Coordinator&) = delete;
+  Coordinator& operator=(const Coordinator&) = delete;
+
+  ~Coordinator();
+
+  /** The port that is listened on */
+  Index port() const { return mport; }
+
+  /** Hands out the jobs until all are finished
+   *
+   * Returns when all jobs are finished and all local workers have
+   * exited. On abort, busy local workers are terminated.
+   *
+   * @param[in] jobs The batch indices
+   * @param[in] max_attempts How often a job is tried
+   * @param[in] handlers Receive results and failures
+   * @param[in] local Local worker processes. If they have all exited,
+   * no worker is connected and jobs remain, an error is thrown, unless
+   * the port was given explicitly and remote workers may still come.
+   */
+  void run(const ArrayOfIndex& jobs,
+           const Index max_attempts,
+           const Handlers& handlers,
+           const std::vector<pid_t>& local);
+
+ private:
+  int mfd;
+  Index mport;
+  bool mremote;
+};
+
+/** Works on jobs of a coordinator until it has no more
+ *
+ * Connection attempts are repeated for some time, so workers can be
+ * started before the coordinator.
+ *
+ * @param[in] host Host of the coordinator
+ * @param[in] port Port of the coordinator
+ * @param[in] job Computes a job and returns the payload of the result.
+ * An exception is reported to the coordinator as a failed job.
+ * @return The number of jobs that were computed
+ */
+Index work(const String& host,
+           const Index port,
+           const std::function<std::string(Index)>& job);
+
+}  // namespace BatchQueue
+
+#endif  // batch_queue_h
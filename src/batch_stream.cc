@@ -0,0 +1,215 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   batch_stream.cc
+  \author agent
+  \date   2026-10-16
+
+  \brief  Files that receive the results of ybatch jobs as they finish.
+*/
+
+#include "batch_stream.h"
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char magic[] = "ARTSYBATCH1\n";
+const std::streamsize magic_size = sizeof(magic) - 1;
+
+void put_int(std::string& buffer, const Index i) {
+  const std::int64_t v = i;
+  buffer.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void put_vector(std::string& buffer, const ConstVectorView& x) {
+  put_int(buffer, x.nelem());
+  for (const Numeric v : x)
+    buffer.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+bool get_int(std::istream& is, Index& i) {
+  std::int64_t v;
+  if (!is.read(reinterpret_cast<char*>(&v), sizeof(v))) return false;
+  if (v < 0) throw std::runtime_error("Corrupt record in ybatch stream file");
+  i = v;
+  return true;
+}
+
+bool get_data(std::istream& is, Numeric* data, const Index n, const bool load) {
+  const std::streamsize size = std::streamsize(n * sizeof(Numeric));
+  if (load) return bool(is.read(reinterpret_cast<char*>(data), size));
+
+  // Skipping past the end is not an error for seekg, so check the size
+  const std::istream::pos_type pos = is.tellg();
+  is.seekg(0, std::ios::end);
+  const std::istream::pos_type end = is.tellg();
+  if (end - pos < size) return false;
+  return bool(is.seekg(pos + std::istream::off_type(size)));
+}
+
+bool get_vector(std::istream& is, Vector& x, const bool load) {
+  Index n;
+  if (!get_int(is, n)) return false;
+  if (load) x.resize(n);
+  return get_data(is, load ? x.get_c_array() : nullptr, n, load);
+}
+
+bool check_magic(std::istream& is) {
+  char head[magic_size];
+  return is.read(head, magic_size) &&
+         std::memcmp(head, magic, magic_size) == 0;
+}
+
+}  // namespace
+
+void ybatch_record_append(std::string& buffer,
+                          const Index index,
+                          const ConstVectorView& y,
+                          const ArrayOfVector& y_aux,
+                          const ConstMatrixView& jacobian) {
+  put_int(buffer, index);
+  put_vector(buffer, y);
+  put_int(buffer, y_aux.nelem());
+  for (const Vector& aux : y_aux) put_vector(buffer, aux);
+  put_int(buffer, jacobian.nrows());
+  put_int(buffer, jacobian.ncols());
+  for (Index r = 0; r < jacobian.nrows(); r++)
+    for (Index c = 0; c < jacobian.ncols(); c++) {
+      const Numeric v = jacobian(r, c);
+      buffer.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+}
+
+bool ybatch_record_read(std::istream& is,
+                        YbatchRecord& record,
+                        const bool load) {
+  if (!get_int(is, record.index)) return false;
+  if (!get_vector(is, record.y, load)) return false;
+
+  Index naux;
+  if (!get_int(is, naux)) return false;
+  if (load) record.y_aux.resize(naux);
+  Vector skipped;
+  for (Index i = 0; i < naux; i++)
+    if (!get_vector(is, load ? record.y_aux[i] : skipped, load)) return false;
+
+  Index nr, nc;
+  if (!get_int(is, nr) || !get_int(is, nc)) return false;
+  if (load) record.jacobian.resize(nr, nc);
+  return get_data(
+      is, load ? record.jacobian.get_c_array() : nullptr, nr * nc, load);
+}
+
+YbatchStream::YbatchStream(const String& filename, const bool resume)
+    : mfilename(filename), mfile(), mdone() {
+  std::streamoff keep = 0;
+
+  if (resume) {
+    std::ifstream is(filename.c_str(), std::ios::binary);
+    if (is) {
+      if (!check_magic(is)) {
+        // An empty file or a cut magic string is what a crash right
+        // after creating the file leaves behind
+        is.clear();
+        is.seekg(0, std::ios::end);
+        if (is.tellg() > magic_size)
+          throw std::runtime_error("File " + filename +
+                                   " is not a ybatch stream file");
+      } else {
+        keep = magic_size;
+        YbatchRecord record;
+        while (ybatch_record_read(is, record, false)) {
+          mdone.insert(record.index);
+          keep = is.tellg();
+        }
+      }
+    }
+  }
+
+  if (keep) {
+    errno = 0;
+    if (::truncate(filename.c_str(), keep) != 0)
+      throw std::runtime_error("Cannot cut incomplete record from " +
+                               filename + ": " + std::strerror(errno));
+    mfile.open(filename.c_str(), std::ios::binary | std::ios::app);
+  } else {
+    mfile.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    mfile.write(magic, magic_size);
+    mfile.flush();
+  }
+
+  if (!mfile)
+    throw std::runtime_error("Cannot open ybatch stream file " + filename);
+}
+
+void YbatchStream::append(const Index index,
+                          const ConstVectorView& y,
+                          const ArrayOfVector& y_aux,
+                          const ConstMatrixView& jacobian) {
+  std::string record;
+  ybatch_record_append(record, index, y, y_aux, jacobian);
+  append_serialized(index, record);
+}
+
+void YbatchStream::append_serialized(const Index index,
+                                     const std::string& record) {
+  mfile.write(record.data(), std::streamsize(record.size()));
+  mfile.flush();
+  if (!mfile)
+    throw std::runtime_error("Error writing ybatch stream file " + mfilename);
+  mdone.insert(index);
+}
+
+Index ybatch_stream_read(ArrayOfVector& ybatch,
+                         ArrayOfArrayOfVector& ybatch_aux,
+                         ArrayOfMatrix& ybatch_jacobians,
+                         const String& filename,
+                         const Index start,
+                         const Index n) {
+  std::ifstream is(filename.c_str(), std::ios::binary);
+  if (!is) throw std::runtime_error("Cannot open ybatch stream file " + filename);
+  if (!check_magic(is))
+    throw std::runtime_error("File " + filename +
+                             " is not a ybatch stream file");
+
+  ybatch.resize(n);
+  ybatch_aux.resize(n);
+  ybatch_jacobians.resize(n);
+  for (Index i = 0; i < n; i++) {
+    ybatch[i].resize(0);
+    ybatch_aux[i].resize(0);
+    ybatch_jacobians[i].resize(0, 0);
+  }
+
+  std::set<Index> found;
+  YbatchRecord record;
+  while (ybatch_record_read(is, record)) {
+    const Index i = record.index - start;
+    if (i < 0 || i >= n) continue;
+    ybatch[i] = std::move(record.y);
+    ybatch_aux[i] = std::move(record.y_aux);
+    ybatch_jacobians[i] = std::move(record.jacobian);
+    found.insert(i);
+  }
+
+  return Index(found.size());
+}
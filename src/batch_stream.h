@@ -0,0 +1,137 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   batch_stream.h
+  \author agent
+  \date   2026-10-16
+
+  \brief  Files that receive the results of ybatch jobs as they finish.
+
+  A ybatch stream file starts with a short magic string, followed by one
+  record per finished job. A record holds the absolute ybatch index, y,
+  y_aux and the Jacobian. All numbers are written in the native binary
+  format of the machine, 64 bit integers for sizes and indices and
+  doubles for the data. Records are only ever appended, so a file that
+  was being written when the program died ends at most with one
+  incomplete record, which is dropped when the file is read or resumed.
+*/
+
+#ifndef batch_stream_h
+#define batch_stream_h
+
+#include <fstream>
+#include <iosfwd>
+#include <set>
+#include "array.h"
+#include "matpackI.h"
+#include "mystring.h"
+
+/** One finished ybatch job */
+struct YbatchRecord {
+  Index index;
+  Vector y;
+  ArrayOfVector y_aux;
+  Matrix jacobian;
+};
+
+/** Appends one record to a string buffer
+ *
+ * @param[in,out] buffer The record is appended to this
+ * @param[in] index The absolute ybatch index
+ * @param[in] y The measurement vector
+ * @param[in] y_aux The auxiliary data
+ * @param[in] jacobian The Jacobian
+ */
+void ybatch_record_append(std::string& buffer,
+                          const Index index,
+                          const ConstVectorView& y,
+                          const ArrayOfVector& y_aux,
+                          const ConstMatrixView& jacobian);
+
+/** Reads one record from a stream
+ *
+ * @param[in,out] is The stream, positioned at the start of a record
+ * @param[out] record The record, only the index is set if load is false
+ * @param[in] load If false, the data is skipped instead of read
+ * @return False if the stream ended before the record was complete
+ */
+bool ybatch_record_read(std::istream& is,
+                        YbatchRecord& record,
+                        const bool load = true);
+
+/** A ybatch stream file opened for appending
+ *
+ * The file is created, or with resume the complete records of an
+ * existing file are kept, and an incomplete record at its end is cut
+ * off. The indices of the kept records are known to contains().
+ */
+class YbatchStream {
+ public:
+  YbatchStream(const String& filename, const bool resume);
+
+  YbatchStream(const YbatchStream&) = delete;
+  YbatchStream& operator=(const YbatchStream&) = delete;
+
+  /** True if the file has a record for this absolute ybatch index */
+  bool contains(const Index index) const {
+    return mdone.find(index) != mdone.end();
+  }
+
+  /** Number of records in the file */
+  Index nelem() const { return Index(mdone.size()); }
+
+  /** Appends a record and flushes it to the file
+   *
+   * Not thread safe, calls must be serialized by the caller.
+   */
+  void append(const Index index,
+              const ConstVectorView& y,
+              const ArrayOfVector& y_aux,
+              const ConstMatrixView& jacobian);
+
+  /** Appends an already serialized record, see ybatch_record_append */
+  void append_serialized(const Index index, const std::string& record);
+
+ private:
+  String mfilename;
+  std::ofstream mfile;
+  std::set<Index> mdone;
+};
+
+/** Reads the records of a ybatch stream file into ybatch arrays
+ *
+ * Records for absolute indices in [start, start+n) are placed at position
+ * index-start. Positions without a record are left empty. If a job is in
+ * the file more than once, the last record is used.
+ *
+ * @param[out] ybatch The y of each job
+ * @param[out] ybatch_aux The y_aux of each job
+ * @param[out] ybatch_jacobians The Jacobian of each job
+ * @param[in] filename The file
+ * @param[in] start The first absolute index
+ * @param[in] n The number of jobs
+ * @return The number of jobs that were found in the file
+ */
+Index ybatch_stream_read(ArrayOfVector& ybatch,
+                         ArrayOfArrayOfVector& ybatch_aux,
+                         ArrayOfMatrix& ybatch_jacobians,
+                         const String& filename,
+                         const Index start,
+                         const Index n);
+
+#endif  // batch_stream_h
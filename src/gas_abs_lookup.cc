@@ -24,8 +24,16 @@
 */
 
 #include "gas_abs_lookup.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
 #include <cfloat>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include "check_input.h"
 #include "interpolation.h"
 #include "interpolation_poly.h"
@@ -82,6 +90,32 @@ void find_new_grid_in_old_grid(ArrayOfIndex& pos,
   }
 }
 
+//! Runtime check of the dimensions of the absorption cross sections.
+/*!
+  Same as chk_size, for cross sections that may not be a Tensor4.
+
+  \param[in] n The dimensions of the cross sections.
+  \param[in] b Required number of books.
+  \param[in] p Required number of pages.
+  \param[in] r Required number of rows.
+  \param[in] c Required number of columns.
+*/
+void chk_xsec_size(const std::array<Index, 4>& n,
+                   const Index& b,
+                   const Index& p,
+                   const Index& r,
+                   const Index& c) {
+  if (n[0] != b or n[1] != p or n[2] != r or n[3] != c) {
+    ostringstream os;
+    os << "The object *xsec* does not have the right size.\n"
+       << "Dimensions should be:"
+       << " " << b << " " << p << " " << r << " " << c
+       << ",\nbut they are:         "
+       << " " << n[0] << " " << n[1] << " " << n[2] << " " << n[3] << ".";
+    throw runtime_error(os.str());
+  }
+}
+
 //! Adapt lookup table to current calculation.
 /*!
   This method has the following tasks:
@@ -112,12 +146,16 @@ void find_new_grid_in_old_grid(ArrayOfIndex& pos,
   \param[in] current_species The list of species for the current calculation.
   \param[in] current_f_grid  The list of frequencies for the current calculation.
   \param[in] verbosity       Verbosity settings.
+  \param[in] single_precision Store the new table in single precision (1),
+                              double precision (0), or in the precision of
+                              this table (-1).
 
   \date 2002-12-12
 */
 void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
                          ConstVectorView current_f_grid,
-                         const Verbosity& verbosity) {
+                         const Verbosity& verbosity,
+                         const Index& single_precision) {
   CREATE_OUT2;
   CREATE_OUT3;
 
@@ -156,6 +194,17 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
   // it back to *this in the end.
   GasAbsLookup new_table;
 
+  // The dimensions of the cross sections, however they are stored:
+  const std::array<Index, 4> table_shape = xsec_shape();
+
+  // The cross sections, either owned or mapped, if in double precision:
+  const ConstTensor4View table_xsec =
+      xsec_single ? ConstTensor4View(xsec) : xsec_data();
+
+  // The precision of the new table:
+  const bool single =
+      single_precision < 0 ? IsSinglePrecision() : bool(single_precision);
+
   // First some checks on the lookup table itself:
 
   // Species:
@@ -226,7 +275,7 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
       //     b = n_species
       //     c = n_f_grid
       //     d = n_p_grid
-      chk_size("xsec", xsec, 1, n_species, n_f_grid, n_p_grid);
+      chk_xsec_size(table_shape, 1, n_species, n_f_grid, n_p_grid);
     } else {
       //     Standard case (temperature perturbations,
       //     but no vmr perturbations):
@@ -234,7 +283,7 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
       //     b = n_species
       //     c = n_f_grid
       //     d = n_p_grid
-      chk_size("xsec", xsec, t_pert.nelem(), n_species, n_f_grid, n_p_grid);
+      chk_xsec_size(table_shape, t_pert.nelem(), n_species, n_f_grid, n_p_grid);
     }
   } else {
     //     Full case (with temperature perturbations and
@@ -248,7 +297,7 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
     Index c = n_f_grid;
     Index d = n_p_grid;
 
-    chk_size("xsec", xsec, a, b, c, d);
+    chk_xsec_size(table_shape, a, b, c, d);
   }
 
   // We also need indices to the positions of the original species
@@ -400,19 +449,37 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
     new_table.nls_pert = nls_pert;
   }
 
-  // Absorption coefficients:
-  new_table.xsec.resize(
-      xsec.nbooks(),
-      n_current_species + n_current_nonlinear_species * (n_nls_pert - 1),
-      n_current_f_grid,
-      xsec.ncols());
+  // A mapped or single precision table that is used as it is keeps
+  // referencing its data, so that it is neither copied nor read from disk:
+  bool same_table = (xsec_mapping or xsec_single) and
+                    single == IsSinglePrecision() and
+                    n_current_species == n_species and
+                    n_current_f_grid == n_f_grid;
+  for (Index i = 0; same_table and i < n_current_species; ++i)
+    same_table = i_current_species[i] == i;
+  for (Index i = 0; same_table and i < n_current_f_grid; ++i)
+    same_table = i_current_f_grid[i] == i;
+
+  if (same_table) {
+    new_table.xsec_mapping = xsec_mapping;
+    new_table.xsec_single = xsec_single;
+    new_table.xsec_single_shape = xsec_single_shape;
+  } else {
+    // Absorption coefficients:
+    new_table.xsec.resize(
+        table_shape[0],
+        n_current_species + n_current_nonlinear_species * (n_nls_pert - 1),
+        n_current_f_grid,
+        table_shape[3]);
+  }
 
   // We have to copy the right species and frequencies from the old to
   // the new table. Temperature perturbations and pressure grid remain
   // the same.
 
   // Do species:
-  for (Index i_s = 0, sp = 0; i_s < n_current_species; ++i_s) {
+  for (Index i_s = 0, sp = 0; not same_table and i_s < n_current_species;
+       ++i_s) {
     // n_v is the number of VMR perturbations
     Index n_v;
     if (current_non_linear[i_s])
@@ -425,12 +492,26 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
 
     // Do frequencies:
     for (Index i_f = 0; i_f < n_current_f_grid; ++i_f) {
-      if (i_current_species[i_s] >= 0) {
+      if (i_current_species[i_s] >= 0 and xsec_single) {
+        // Promote single precision values one pressure row at a time:
+        for (Index i_t = 0; i_t < table_shape[0]; ++i_t)
+          for (Index i_v = 0; i_v < n_v; ++i_v) {
+            const float* x =
+                xsec_single.get() +
+                ((i_t * table_shape[1] +
+                  original_spec_pos_in_xsec[i_current_species[i_s]] + i_v) *
+                     table_shape[2] +
+                 i_current_f_grid[i_f]) *
+                    table_shape[3];
+            for (Index i_p = 0; i_p < table_shape[3]; ++i_p)
+              new_table.xsec(i_t, sp + i_v, i_f, i_p) = x[i_p];
+          }
+      } else if (i_current_species[i_s] >= 0) {
         new_table.xsec(Range(joker), Range(sp, n_v), i_f, Range(joker)) =
-            xsec(Range(joker),
-                 Range(original_spec_pos_in_xsec[i_current_species[i_s]], n_v),
-                 i_current_f_grid[i_f],
-                 Range(joker));
+            table_xsec(Range(joker),
+                       Range(original_spec_pos_in_xsec[i_current_species[i_s]], n_v),
+                       i_current_f_grid[i_f],
+                       Range(joker));
       } else {
         // Here we handle the case of the trivial species, which we simply
         // set to NAN:
@@ -446,6 +527,9 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
     sp += n_v;
   }
 
+  // 3.a Store the new table in the requested precision.
+  if (single and not same_table) new_table.SetSinglePrecision(true);
+
   // 4. Replace original table by the new one.
   *this = new_table;
 
@@ -458,94 +542,33 @@ void GasAbsLookup::Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
   gridpos_poly(fgp_default, f_grid, f_grid, 0);
 }
 
-//! Extract scalar gas absorption coefficients from the lookup table.
-/*!  
-  This carries out a simple interpolation in temperature,
-  pressure, and sometimes frequency. The interpolated value is then 
-  scaled by the ratio between
-  actual VMR and reference VMR. In the case of nonlinear species the
-  interpolation goes also over H2O VMR.
-
-  All input parameters 
-  must be in the range covered by the table. Violation will result in a
-  runtime error. Those checks are here, because they are a bit
-  difficult to make outside, due to the irregularity of the
-  grids. Otherwise there are no runtime checks in this function, only
-  assertions. This is, because the function is called many times
-  inside the RT calculation.
-
-  In this case pressure is not an altitude coordinate, so we are free
-  to choose the type of interpolation that gives lowest interpolation
-  errors or is easiest. I tested both linear and log p interpolation
-  with the result that log p interpolation is slightly better, so that
-  is used.
+//! Check that the lookup table can be used for an extraction.
+/*!
+  Checks the internal consistency of the table, that there are enough
+  grid points for the desired interpolation orders, and that the
+  number of VMRs matches the species of the table.
 
-  \param[out] sga A Matrix with scalar gas absorption coefficients
-              [1/m]. Dimension is adjusted automatically to [n_species,f_grid].
- 
   \param[in] p_interp_order Interpolation order for pressure.
-
   \param[in] t_interp_order Interpolation order for temperature.
- 
   \param[in] h2o_interp_order Interpolation order for water vapor.
- 
-  \param[in] f_interp_order Interpolation order for frequency. This should
-             normally be zero, except for calculations with Doppler shift.
- 
-  \param[in] p The pressures [Pa].
-
-  \param[in] T The temperature [K].
-
-  \param[in] abs_vmrs The VMRs [absolute number]. Dimension: [species].  
-
-  \param[in] new_f_grid The frequency grid where absorption should be 
-             extracted. With frequency interpolation order 0, this has
-             to match the lookup table's internal grid, or have exactly
-             1 element. With higher frequency interpolation order it can be
-             an arbitrary grid.
- 
-  \param[in] extpolfac How much extrapolation to allow. Useful for Doppler 
-             calculations. (But there even better to make the lookup table
-             grid wider and denser than the calculation grid.)
- 
-  \date 2002-09-20, 2003-02-22, 2007-05-22, 2013-04-29
+  \param[in] f_interp_order Interpolation order for frequency.
+  \param[in] n_vmrs The number of VMRs given for the extraction.
 
-  \author Stefan Buehler
+  \return The index of the H2O species, or -1 if there are no nonlinear
+          species.
 */
-void GasAbsLookup::Extract(Matrix& sga,
-                           const Index& p_interp_order,
-                           const Index& t_interp_order,
-                           const Index& h2o_interp_order,
-                           const Index& f_interp_order,
-                           const Numeric& p,
-                           const Numeric& T,
-                           ConstVectorView abs_vmrs,
-                           ConstVectorView new_f_grid,
-                           const Numeric& extpolfac) const {
-  // 1. Obtain some properties of the lookup table:
-
-  // Number of gas species in the table:
+Index GasAbsLookup::check_extraction(const Index& p_interp_order,
+                                     const Index& t_interp_order,
+                                     const Index& h2o_interp_order,
+                                     const Index& f_interp_order,
+                                     const Index& n_vmrs) const {
   const Index n_species = species.nelem();
-
-  // Number of nonlinear species:
   const Index n_nls = nonlinear_species.nelem();
-
-  // Number of frequencies in the table:
   const Index n_f_grid = f_grid.nelem();
-
-  // Number of pressure grid points in the table:
   const Index n_p_grid = p_grid.nelem();
-
-  // Number of temperature perturbations:
   const Index n_t_pert = t_pert.nelem();
-
-  // Number of nonlinear species perturbations:
   const Index n_nls_pert = nls_pert.nelem();
 
-  // Number of frequencies in new_f_grid, the frequency grid for which we
-  // want to extract.
-  const Index n_new_f_grid = new_f_grid.nelem();
-
   // 2. First some checks on the lookup table itself:
 
   // Most checks here are asserts, because they check the internal
@@ -597,7 +620,7 @@ void GasAbsLookup::Extract(Matrix& sga,
     //            << b << ", "
     //            << c << ", "
     //            << d << "\n";
-    assert(is_size(xsec, a, b, c, d));
+    assert((xsec_shape() == std::array<Index, 4>{{a, b, c, d}}));
   })
 
   // Make sure that log_p_grid is initialized:
@@ -650,7 +673,7 @@ void GasAbsLookup::Extract(Matrix& sga,
   // 3. Checks on the input variables:
 
   // Check that abs_vmrs has the right dimension:
-  if (!is_size(abs_vmrs, n_species)) {
+  if (n_vmrs != n_species) {
     ostringstream os;
     os << "Number of species in lookup table does not match number\n"
        << "of species for which you want to extract absorption.\n"
@@ -659,14 +682,27 @@ void GasAbsLookup::Extract(Matrix& sga,
     throw runtime_error(os.str());
   }
 
-  // 4. Set up some things we will need later on:
+  return h2o_index;
+}
 
-  // 4.a Frequency grid positions
+//! Frequency grid positions for an extraction.
+/*!
+  \param[out] fgp_local Storage for the grid positions, if they
+              are not the default ones of the table.
+  \param[in] f_interp_order Interpolation order for frequency.
+  \param[in] new_f_grid The frequency grid where absorption should be
+             extracted. See Extract.
+
+  \return The grid positions, either fgp_default or fgp_local.
+*/
+const ArrayOfGridPosPoly& GasAbsLookup::frequency_gridpos(
+    ArrayOfGridPosPoly& fgp_local,
+    const Index& f_interp_order,
+    ConstVectorView new_f_grid) const {
+  const Index n_f_grid = f_grid.nelem();
+  const Index n_new_f_grid = new_f_grid.nelem();
 
-  // Frequency grid positions. The pointer is used to save copying of the
-  // default from the lookup table.
   const ArrayOfGridPosPoly* fgp;
-  ArrayOfGridPosPoly fgp_local;
 
   // With f_interp_order 0 the frequency grid has to have the same size as in the
   // lookup table, or exactly one element. If it matches the lookup table, we
@@ -756,24 +792,22 @@ void GasAbsLookup::Extract(Matrix& sga,
     gridpos_poly(fgp_local, f_grid, new_f_grid, f_interp_order);
   }
 
-  // 4.b Other stuff
-
-  // Flag for temperature interpolation, if this is not 0 we want
-  // to do T interpolation:
-  const Index do_T = n_t_pert;
-
-  // Set up a logical array for the nonlinear species
-  ArrayOfIndex non_linear(n_species, 0);
-  for (Index s = 0; s < n_nls; ++s) {
-    non_linear[nonlinear_species[s]] = 1;
-  }
+  return *fgp;
+}
 
-  // Calculate the number density for the given pressure and
-  // temperature:
-  // n = n0*T0/p0 * p/T or n = p/kB/t, ideal gas law
-  const Numeric n = number_density(p, T);
+//! Pressure grid position for an extraction.
+/*!
+  The interpolation is done in log(p). Test have shown that this
+  gives slightly better accuracy than interpolating in p directly.
 
-  // 5. Determine pressure grid position and interpolation weights:
+  \param[out] pgp The grid position in log_p_grid.
+  \param[in] p_interp_order Interpolation order for pressure.
+  \param[in] p The pressure [Pa].
+*/
+void GasAbsLookup::pressure_gridpos(GridPosPoly& pgp,
+                                    const Index& p_interp_order,
+                                    const Numeric& p) const {
+  const Index n_p_grid = p_grid.nelem();
 
   // Check that p is inside the grid. (p_grid is sorted in decreasing order.)
   {
@@ -793,11 +827,277 @@ void GasAbsLookup::Extract(Matrix& sga,
     }
   }
 
+  gridpos_poly(pgp, log_p_grid, log(p), p_interp_order);
+}
+
+//! Temperature grid position for an extraction.
+/*!
+  \param[out] tgp The grid position in t_pert.
+  \param[in] t_interp_order Interpolation order for temperature.
+  \param[in] p The pressure [Pa], only used for error messages.
+  \param[in] T The temperature [K].
+  \param[in] p_grid_index The table pressure level to interpolate at.
+  \param[in] extpolfac How much extrapolation to allow.
+*/
+void GasAbsLookup::temperature_gridpos(GridPosPoly& tgp,
+                                       const Index& t_interp_order,
+                                       const Numeric& p,
+                                       const Numeric& T,
+                                       const Index& p_grid_index,
+                                       const Numeric& extpolfac) const {
+  const Index n_t_pert = t_pert.nelem();
+
+  // Temperature in the atmosphere is altitude
+  // dependent. When we do the interpolation for the pressure level
+  // below and above our point, we should correct the target value of
+  // the interpolation to the altitude (pressure) difference. This
+  // ensures that there is for example no T interpolation if the
+  // desired T is right on the reference profile curve.
+  //
+  // I explicitly compared this with the old option to calculate
+  // the temperature offset relative to the temperature at
+  // this level. The performance in both cases is very
+  // similar. The reason, why I decided to keep this new
+  // version, is that it avoids the problem of needing
+  // oversized temperature perturbations if the pressure
+  // grid is coarse.
+  //
+  // No! The above approach leads to problems when combined with
+  // higher order pressure interpolation. The problem is that
+  // the reference T and VMR profiles may be very
+  // irregular. (For example the H2O profile often has a big
+  // jump near the bottom.) That sometimes leads to negative
+  // effective reference values when the reference profile is
+  // interpolated. I therefore reverted back to the original
+  // version of using the real temperature and humidity, not
+  // the interpolated one.
+
+  //          const Numeric effective_T_ref = interp(pitw,t_ref,pgp);
+  const Numeric effective_T_ref = t_ref[p_grid_index];
+
+  // Convert temperature to offset from t_ref:
+  const Numeric T_offset = T - effective_T_ref;
+
+  //          cout << "T_offset = " << T_offset << endl;
+
+  // Check that temperature offset is inside the allowed range.
+  {
+    const Numeric t_min = t_pert[0] - extpolfac * (t_pert[1] - t_pert[0]);
+    const Numeric t_max =
+        t_pert[n_t_pert - 1] +
+        extpolfac * (t_pert[n_t_pert - 1] - t_pert[n_t_pert - 2]);
+    if ((T_offset > t_max) || (T_offset < t_min)) {
+      ostringstream os;
+      os << "Problem with gas absorption lookup table.\n"
+         << "Temperature T is outside the range covered by the lookup table.\n"
+         << "Your temperature was " << T << " K at a pressure of " << p
+         << " Pa.\n"
+         << "The temperature offset value is " << T_offset << ".\n"
+         << "The allowed range is " << t_min << " to " << t_max << ".\n"
+         << "The temperature perturbation grid range in the table is "
+         << t_pert[0] << " to " << t_pert[n_t_pert - 1] << ".\n"
+         << "We allow a bit of extrapolation, but NOT SO MUCH!";
+      throw runtime_error(os.str());
+    }
+  }
+
+  gridpos_poly(tgp, t_pert, T_offset, t_interp_order, extpolfac);
+}
+
+//! H2O VMR grid position for an extraction.
+/*!
+  \param[out] vgp The grid position in nls_pert.
+  \param[in] h2o_interp_order Interpolation order for water vapor.
+  \param[in] p The pressure [Pa], only used for error messages.
+  \param[in] h2o_vmr The H2O VMR [absolute number].
+  \param[in] h2o_index The index of the H2O species.
+  \param[in] p_grid_index The table pressure level to interpolate at.
+  \param[in] extpolfac How much extrapolation to allow.
+*/
+void GasAbsLookup::h2o_gridpos(GridPosPoly& vgp,
+                               const Index& h2o_interp_order,
+                               const Numeric& p,
+                               const Numeric& h2o_vmr,
+                               const Index& h2o_index,
+                               const Index& p_grid_index,
+                               const Numeric& extpolfac) const {
+  const Index n_nls_pert = nls_pert.nelem();
+
+  // Similar to the T case, we first interpolate the reference
+  // VMR to the pressure of extraction, then compare with
+  // the extraction VMR to determine the offset/fractional
+  // difference for the VMR interpolation.
+  //
+  // No! The above approach leads to problems when combined with
+  // higher order pressure interpolation. The problem is that
+  // the reference T and VMR profiles may be very
+  // irregular. (For example the H2O profile often has a big
+  // jump near the bottom.) That sometimes leads to negative
+  // effective reference values when the reference profile is
+  // interpolated. I therefore reverted back to the original
+  // version of using the real temperature and humidity, not
+  // the interpolated one.
+
+  //           const Numeric effective_vmr_ref = interp(pitw,
+  //                                                    vmrs_ref(h2o_index, Range(joker)),
+  //                                                    pgp);
+  const Numeric effective_vmr_ref = vmrs_ref(h2o_index, p_grid_index);
+
+  // Fractional VMR:
+  const Numeric VMR_frac = h2o_vmr / effective_vmr_ref;
+
+  // Check that VMR_frac is inside the allowed range.
+  {
+    // FIXME: This check depends on how I interpolate VMR.
+    const Numeric x_min =
+        nls_pert[0] - extpolfac * (nls_pert[1] - nls_pert[0]);
+    const Numeric x_max =
+        nls_pert[n_nls_pert - 1] +
+        extpolfac * (nls_pert[n_nls_pert - 1] - nls_pert[n_nls_pert - 2]);
+
+    if ((VMR_frac > x_max) || (VMR_frac < x_min)) {
+      ostringstream os;
+      os << "Problem with gas absorption lookup table.\n"
+         << "VMR for H2O (species " << h2o_index
+         << ") is outside the range covered by the lookup table.\n"
+         << "Your VMR was " << h2o_vmr << " at a pressure of "
+         << p << " Pa.\n"
+         << "The reference VMR value there is " << effective_vmr_ref << "\n"
+         << "The fractional VMR relative to the reference value is "
+         << VMR_frac << ".\n"
+         << "The allowed range is " << x_min << " to " << x_max << ".\n"
+         << "The fractional VMR perturbation grid range in the table is "
+         << nls_pert[0] << " to " << nls_pert[n_nls_pert - 1] << ".\n"
+         << "We allow a bit of extrapolation, but NOT SO MUCH!";
+      throw runtime_error(os.str());
+    }
+  }
+
+  // For now, do linear interpolation in the fractional VMR.
+  gridpos_poly(vgp, nls_pert, VMR_frac, h2o_interp_order, extpolfac);
+}
+
+//! Extract scalar gas absorption coefficients from the lookup table.
+/*!  
+  This carries out a simple interpolation in temperature,
+  pressure, and sometimes frequency. The interpolated value is then 
+  scaled by the ratio between
+  actual VMR and reference VMR. In the case of nonlinear species the
+  interpolation goes also over H2O VMR.
+
+  All input parameters 
+  must be in the range covered by the table. Violation will result in a
+  runtime error. Those checks are here, because they are a bit
+  difficult to make outside, due to the irregularity of the
+  grids. Otherwise there are no runtime checks in this function, only
+  assertions. This is, because the function is called many times
+  inside the RT calculation.
+
+  In this case pressure is not an altitude coordinate, so we are free
+  to choose the type of interpolation that gives lowest interpolation
+  errors or is easiest. I tested both linear and log p interpolation
+  with the result that log p interpolation is slightly better, so that
+  is used.
+
+  \param[out] sga A Matrix with scalar gas absorption coefficients
+              [1/m]. Dimension is adjusted automatically to [n_species,f_grid].
+ 
+  \param[in] p_interp_order Interpolation order for pressure.
+
+  \param[in] t_interp_order Interpolation order for temperature.
+ 
+  \param[in] h2o_interp_order Interpolation order for water vapor.
+ 
+  \param[in] f_interp_order Interpolation order for frequency. This should
+             normally be zero, except for calculations with Doppler shift.
+ 
+  \param[in] p The pressures [Pa].
+
+  \param[in] T The temperature [K].
+
+  \param[in] abs_vmrs The VMRs [absolute number]. Dimension: [species].  
+
+  \param[in] new_f_grid The frequency grid where absorption should be 
+             extracted. With frequency interpolation order 0, this has
+             to match the lookup table's internal grid, or have exactly
+             1 element. With higher frequency interpolation order it can be
+             an arbitrary grid.
+ 
+  \param[in] extpolfac How much extrapolation to allow. Useful for Doppler 
+             calculations. (But there even better to make the lookup table
+             grid wider and denser than the calculation grid.)
+ 
+  \date 2002-09-20, 2003-02-22, 2007-05-22, 2013-04-29
+
+  \author Stefan Buehler
+*/
+void GasAbsLookup::Extract(Matrix& sga,
+                           const Index& p_interp_order,
+                           const Index& t_interp_order,
+                           const Index& h2o_interp_order,
+                           const Index& f_interp_order,
+                           const Numeric& p,
+                           const Numeric& T,
+                           ConstVectorView abs_vmrs,
+                           ConstVectorView new_f_grid,
+                           const Numeric& extpolfac) const {
+  // 1. Obtain some properties of the lookup table:
+
+  // Number of gas species in the table:
+  const Index n_species = species.nelem();
+
+  // Number of nonlinear species:
+  const Index n_nls = nonlinear_species.nelem();
+
+  // Number of temperature perturbations:
+  const Index n_t_pert = t_pert.nelem();
+
+  // Number of nonlinear species perturbations:
+  const Index n_nls_pert = nls_pert.nelem();
+
+  // Number of frequencies in new_f_grid, the frequency grid for which we
+  // want to extract.
+  const Index n_new_f_grid = new_f_grid.nelem();
+
+  // 2. and 3. Checks on the lookup table and on the input variables:
+  const Index h2o_index = check_extraction(p_interp_order,
+                                           t_interp_order,
+                                           h2o_interp_order,
+                                           f_interp_order,
+                                           abs_vmrs.nelem());
+
+  // 4. Set up some things we will need later on:
+
+  // 4.a Frequency grid positions
+
+  // Frequency grid positions. The pointer is used to save copying of the
+  // default from the lookup table.
+  ArrayOfGridPosPoly fgp_local;
+  const ArrayOfGridPosPoly* fgp =
+      &frequency_gridpos(fgp_local, f_interp_order, new_f_grid);
+
+  // 4.b Other stuff
+
+  // Flag for temperature interpolation, if this is not 0 we want
+  // to do T interpolation:
+  const Index do_T = n_t_pert;
+
+  // Set up a logical array for the nonlinear species
+  ArrayOfIndex non_linear(n_species, 0);
+  for (Index s = 0; s < n_nls; ++s) {
+    non_linear[nonlinear_species[s]] = 1;
+  }
+
+  // Calculate the number density for the given pressure and
+  // temperature:
+  // n = n0*T0/p0 * p/T or n = p/kB/t, ideal gas law
+  const Numeric n = number_density(p, T);
+
+  // 5. Determine pressure grid position and interpolation weights:
+
   // For sure, we need to store the pressure grid position.
-  // We do the interpolation in log(p). Test have shown that this
-  // gives slightly better accuracy than interpolating in p directly.
   ArrayOfGridPosPoly pgp(1);
-  gridpos_poly(pgp, log_p_grid, log(p), p_interp_order);
+  pressure_gridpos(pgp[0], p_interp_order, p);
 
   // Pressure interpolation weights:
   Vector pitw;
@@ -854,6 +1154,9 @@ void GasAbsLookup::Extract(Matrix& sga,
   //   Frequency
 
   Tensor5 xsec_pre_interpolated;
+
+  // Buffer for cross sections that are stored in single precision:
+  Tensor3 xsec_buffer;
   xsec_pre_interpolated.resize(
       p_interp_order + 1, n_species, 1, 1, n_new_f_grid);
 
@@ -887,61 +1190,8 @@ void GasAbsLookup::Extract(Matrix& sga,
     // want temperature interpolation, but the variable tgp has to
     // be visible also outside for later use:
     if (do_T) {
-      // Temperature in the atmosphere is altitude
-      // dependent. When we do the interpolation for the pressure level
-      // below and above our point, we should correct the target value of
-      // the interpolation to the altitude (pressure) difference. This
-      // ensures that there is for example no T interpolation if the
-      // desired T is right on the reference profile curve.
-      //
-      // I explicitly compared this with the old option to calculate
-      // the temperature offset relative to the temperature at
-      // this level. The performance in both cases is very
-      // similar. The reason, why I decided to keep this new
-      // version, is that it avoids the problem of needing
-      // oversized temperature perturbations if the pressure
-      // grid is coarse.
-      //
-      // No! The above approach leads to problems when combined with
-      // higher order pressure interpolation. The problem is that
-      // the reference T and VMR profiles may be very
-      // irregular. (For example the H2O profile often has a big
-      // jump near the bottom.) That sometimes leads to negative
-      // effective reference values when the reference profile is
-      // interpolated. I therefore reverted back to the original
-      // version of using the real temperature and humidity, not
-      // the interpolated one.
-
-      //          const Numeric effective_T_ref = interp(pitw,t_ref,pgp);
-      const Numeric effective_T_ref = t_ref[this_p_grid_index];
-
-      // Convert temperature to offset from t_ref:
-      const Numeric T_offset = T - effective_T_ref;
-
-      //          cout << "T_offset = " << T_offset << endl;
-
-      // Check that temperature offset is inside the allowed range.
-      {
-        const Numeric t_min = t_pert[0] - extpolfac * (t_pert[1] - t_pert[0]);
-        const Numeric t_max =
-            t_pert[n_t_pert - 1] +
-            extpolfac * (t_pert[n_t_pert - 1] - t_pert[n_t_pert - 2]);
-        if ((T_offset > t_max) || (T_offset < t_min)) {
-          ostringstream os;
-          os << "Problem with gas absorption lookup table.\n"
-             << "Temperature T is outside the range covered by the lookup table.\n"
-             << "Your temperature was " << T << " K at a pressure of " << p
-             << " Pa.\n"
-             << "The temperature offset value is " << T_offset << ".\n"
-             << "The allowed range is " << t_min << " to " << t_max << ".\n"
-             << "The temperature perturbation grid range in the table is "
-             << t_pert[0] << " to " << t_pert[n_t_pert - 1] << ".\n"
-             << "We allow a bit of extrapolation, but NOT SO MUCH!";
-          throw runtime_error(os.str());
-        }
-      }
-
-      gridpos_poly(tgp_withT, t_pert, T_offset, t_interp_order, extpolfac);
+      temperature_gridpos(
+          tgp_withT[0], t_interp_order, p, T, this_p_grid_index, extpolfac);
     }
 
     // Determine the H2O VMR grid position. We need to do this only
@@ -949,58 +1199,13 @@ void GasAbsLookup::Extract(Matrix& sga,
     // H2O. We do this only if there are nonlinear species, but the
     // variable has to be visible later.
     if (n_nls > 0) {
-      // Similar to the T case, we first interpolate the reference
-      // VMR to the pressure of extraction, then compare with
-      // the extraction VMR to determine the offset/fractional
-      // difference for the VMR interpolation.
-      //
-      // No! The above approach leads to problems when combined with
-      // higher order pressure interpolation. The problem is that
-      // the reference T and VMR profiles may be very
-      // irregular. (For example the H2O profile often has a big
-      // jump near the bottom.) That sometimes leads to negative
-      // effective reference values when the reference profile is
-      // interpolated. I therefore reverted back to the original
-      // version of using the real temperature and humidity, not
-      // the interpolated one.
-
-      //           const Numeric effective_vmr_ref = interp(pitw,
-      //                                                    vmrs_ref(h2o_index, Range(joker)),
-      //                                                    pgp);
-      const Numeric effective_vmr_ref = vmrs_ref(h2o_index, this_p_grid_index);
-
-      // Fractional VMR:
-      const Numeric VMR_frac = abs_vmrs[h2o_index] / effective_vmr_ref;
-
-      // Check that VMR_frac is inside the allowed range.
-      {
-        // FIXME: This check depends on how I interpolate VMR.
-        const Numeric x_min =
-            nls_pert[0] - extpolfac * (nls_pert[1] - nls_pert[0]);
-        const Numeric x_max =
-            nls_pert[n_nls_pert - 1] +
-            extpolfac * (nls_pert[n_nls_pert - 1] - nls_pert[n_nls_pert - 2]);
-
-        if ((VMR_frac > x_max) || (VMR_frac < x_min)) {
-          ostringstream os;
-          os << "Problem with gas absorption lookup table.\n"
-             << "VMR for H2O (species " << h2o_index
-             << ") is outside the range covered by the lookup table.\n"
-             << "Your VMR was " << abs_vmrs[h2o_index] << " at a pressure of "
-             << p << " Pa.\n"
-             << "The reference VMR value there is " << effective_vmr_ref << "\n"
-             << "The fractional VMR relative to the reference value is "
-             << VMR_frac << ".\n"
-             << "The allowed range is " << x_min << " to " << x_max << ".\n"
-             << "The fractional VMR perturbation grid range in the table is "
-             << nls_pert[0] << " to " << nls_pert[n_nls_pert - 1] << ".\n"
-             << "We allow a bit of extrapolation, but NOT SO MUCH!";
-          throw runtime_error(os.str());
-        }
-      }
-
-      // For now, do linear interpolation in the fractional VMR.
-      gridpos_poly(vgp_h2o, nls_pert, VMR_frac, h2o_interp_order, extpolfac);
+      h2o_gridpos(vgp_h2o[0],
+                  h2o_interp_order,
+                  p,
+                  abs_vmrs[h2o_index],
+                  h2o_index,
+                  this_p_grid_index,
+                  extpolfac);
     }
 
     // Precalculate interpolation weights.
@@ -1070,10 +1275,10 @@ void GasAbsLookup::Extract(Matrix& sga,
 
       // Get the right view on xsec.
       ConstTensor3View this_xsec =
-          xsec(Range(joker),                 // Temperature range
-               Range(fpi, this_h2o_extent),  // VMR profile range
-               Range(joker),                 // Frequency range
-               this_p_grid_index);           // Pressure index
+          xsec_slice(xsec_buffer,
+                     fpi,                // VMR profile range
+                     this_h2o_extent,
+                     this_p_grid_index);  // Pressure index
 
       // Do interpolation.
       interp(res,        // result
@@ -1095,7 +1300,7 @@ void GasAbsLookup::Extract(Matrix& sga,
 
     // fpi should have reached the end of that dimension of xsec. Check
     // this with an assertion:
-    assert(fpi == xsec.npages());
+    assert(fpi == xsec_shape()[1]);
 
   }  // End of pressure index loop (below and above gp)
 
@@ -1133,6 +1338,739 @@ void GasAbsLookup::Extract(Matrix& sga,
   // That's it, we're done!
 }
 
+//! Extract scalar gas absorption coefficients for many atmospheric points.
+/*!
+  Does the same as Extract, for a whole set of (p, T, VMR)
+  points at once. All grid positions and interpolation weights are
+  determined before the interpolation starts, and the result is
+  written directly into the preallocated output. The results agree with
+  Extract to within rounding errors.
+
+  The table stores pressure as its innermost dimension, so a cross
+  section column over frequency is strided. Each column that is needed
+  is gathered once into a contiguous buffer and reused by all points of
+  the batch on the same pressure level, so the accumulation over
+  frequency is contiguous.
+
+  \param[out] sga Scalar gas absorption coefficients [1/m]. Must have
+              dimension [n_species, new_f_grid, n_points], and may be a
+              view into a larger field.
+
+  \param[in] p_interp_order Interpolation order for pressure.
+
+  \param[in] t_interp_order Interpolation order for temperature.
+
+  \param[in] h2o_interp_order Interpolation order for water vapor.
+
+  \param[in] f_interp_order Interpolation order for frequency.
+
+  \param[in] p The pressures [Pa]. Dimension: [n_points].
+
+  \param[in] T The temperatures [K]. Dimension: [n_points].
+
+  \param[in] abs_vmrs The VMRs [absolute number]. Dimension: [species,
+             n_points].
+
+  \param[in] new_f_grid The frequency grid where absorption should be
+             extracted. Same requirements as for Extract.
+
+  \param[in] extpolfac How much extrapolation to allow.
+
+  \date 2026-10-16
+*/
+void GasAbsLookup::ExtractBatch(Tensor3View sga,
+                                const Index& p_interp_order,
+                                const Index& t_interp_order,
+                                const Index& h2o_interp_order,
+                                const Index& f_interp_order,
+                                ConstVectorView p,
+                                ConstVectorView T,
+                                ConstMatrixView abs_vmrs,
+                                ConstVectorView new_f_grid,
+                                const Numeric& extpolfac) const {
+  const Index n_points = p.nelem();
+  const Index n_species = species.nelem();
+  const Index n_nls = nonlinear_species.nelem();
+  const Index n_t_pert = t_pert.nelem();
+  const Index n_nls_pert = nls_pert.nelem();
+  const Index n_new_f_grid = new_f_grid.nelem();
+
+  const Index h2o_index = check_extraction(p_interp_order,
+                                           t_interp_order,
+                                           h2o_interp_order,
+                                           f_interp_order,
+                                           abs_vmrs.nrows());
+
+  if (T.nelem() != n_points or abs_vmrs.ncols() != n_points) {
+    ostringstream os;
+    os << "Inconsistent number of points for the extraction.\n"
+       << "Pressures: " << n_points << ", temperatures: " << T.nelem()
+       << ", VMRs: " << abs_vmrs.ncols() << ".";
+    throw runtime_error(os.str());
+  }
+
+  if (not is_size(sga, n_species, n_new_f_grid, n_points)) {
+    ostringstream os;
+    os << "The output of the extraction must have dimension [" << n_species
+       << ", " << n_new_f_grid << ", " << n_points << "].";
+    throw runtime_error(os.str());
+  }
+
+  // Frequency grid positions, flattened so that the inner loop only does
+  // indexing and multiplication. Without frequency interpolation on the
+  // table's own grid, the positions are the identity.
+  ArrayOfGridPosPoly fgp_local;
+  const ArrayOfGridPosPoly& fgp =
+      frequency_gridpos(fgp_local, f_interp_order, new_f_grid);
+  const bool f_identity = &fgp == &fgp_default;
+  const Index n_fw = f_interp_order + 1;
+  ArrayOfIndex fidx(n_new_f_grid * n_fw);
+  Vector fw(n_new_f_grid * n_fw);
+  for (Index iv = 0; iv < n_new_f_grid; iv++) {
+    assert(fgp[iv].idx.nelem() == n_fw);
+    for (Index k = 0; k < n_fw; k++) {
+      fidx[iv * n_fw + k] = fgp[iv].idx[k];
+      fw[iv * n_fw + k] = fgp[iv].w[k];
+    }
+  }
+
+  // Pressure, temperature and H2O grid positions, and number densities,
+  // for all points.
+  ArrayOfGridPosPoly pgp(n_points);
+  Array<ArrayOfGridPosPoly> tgp(n_points), vgp(n_points);
+  Vector n(n_points);
+  for (Index ip = 0; ip < n_points; ip++) {
+    pressure_gridpos(pgp[ip], p_interp_order, p[ip]);
+    n[ip] = number_density(p[ip], T[ip]);
+
+    if (n_t_pert) {
+      tgp[ip].resize(p_interp_order + 1);
+      for (Index pi = 0; pi < p_interp_order + 1; ++pi)
+        temperature_gridpos(tgp[ip][pi],
+                            t_interp_order,
+                            p[ip],
+                            T[ip],
+                            pgp[ip].idx[pi],
+                            extpolfac);
+    }
+
+    if (n_nls > 0) {
+      vgp[ip].resize(p_interp_order + 1);
+      for (Index pi = 0; pi < p_interp_order + 1; ++pi)
+        h2o_gridpos(vgp[ip][pi],
+                    h2o_interp_order,
+                    p[ip],
+                    abs_vmrs(h2o_index, ip),
+                    h2o_index,
+                    pgp[ip].idx[pi],
+                    extpolfac);
+    }
+  }
+
+  // Set up a logical array for the nonlinear species
+  ArrayOfIndex non_linear(n_species, 0);
+  for (Index s = 0; s < n_nls; ++s) {
+    non_linear[nonlinear_species[s]] = 1;
+  }
+
+  // The grid position that corresponds to "no interpolation at all".
+  GridPosPoly gp_trivial;
+  gp_trivial.idx.resize(1);
+  gp_trivial.w.resize(1);
+  gp_trivial.idx[0] = 0;
+  gp_trivial.w[0] = 1;
+
+  // Contiguous copies of the cross section columns of a few pressure
+  // levels, filled when first needed. Points on the same pressure level
+  // use the same columns, and neighbouring levels share all but one.
+  struct ColumnCache {
+    Index p_index = -1;
+    ArrayOfIndex filled;
+    Array<Vector> columns;
+  };
+  const Index n_books = xsec_shape()[0];
+  const Index n_pages = xsec_shape()[1];
+  Array<ColumnCache> caches(p_interp_order + 2);
+  Index next_cache = 0;
+  Vector xsec_buffer;
+  auto column = [&](Index book, Index page, Index p_index) -> ConstVectorView {
+    ColumnCache* c = nullptr;
+    for (auto& x : caches)
+      if (x.p_index == p_index) c = &x;
+    if (not c) {
+      c = &caches[next_cache];
+      next_cache = (next_cache + 1) % caches.nelem();
+      c->p_index = p_index;
+      c->filled.assign(n_books * n_pages, 0);
+      c->columns.resize(n_books * n_pages);
+    }
+
+    const Index i = book * n_pages + page;
+    if (not c->filled[i]) {
+      const ConstVectorView x = xsec_column(xsec_buffer, book, page, p_index);
+      c->columns[i].resize(x.nelem());
+      c->columns[i] = x;
+      c->filled[i] = 1;
+    }
+    return c->columns[i];
+  };
+
+  // The absorption of one species at one point:
+  Vector this_sga(n_new_f_grid);
+
+  for (Index ip = 0; ip < n_points; ip++) {
+    Index fpi = 0;
+    for (Index si = 0; si < n_species; ++si) {
+      const Index do_VMR = non_linear[si];
+
+      // Species that are not stored in the table give zero absorption.
+      if (is_zeeman(species[si]) ||
+          species[si][0].Type() == SpeciesTag::TYPE_FREE_ELECTRONS ||
+          species[si][0].Type() == SpeciesTag::TYPE_PARTICLES) {
+        if (do_VMR) {
+          ostringstream os;
+          os << "Problem with gas absorption lookup table.\n"
+             << "VMR interpolation is not allowed for species \""
+             << species[si][0].Name() << "\"";
+          throw runtime_error(os.str());
+        }
+        sga(si, joker, ip) = 0;
+        fpi++;
+        continue;
+      }
+
+      this_sga = 0;
+      for (Index pi = 0; pi < p_interp_order + 1; ++pi) {
+        const Index this_p_grid_index = pgp[ip].idx[pi];
+        const GridPosPoly& this_tgp = n_t_pert ? tgp[ip][pi] : gp_trivial;
+        const GridPosPoly& this_vgp = do_VMR ? vgp[ip][pi] : gp_trivial;
+
+        // The pressure weight and the number density of the species are
+        // folded into the weights of the T and H2O interpolation.
+        const Numeric scale = pgp[ip].w[pi] * n[ip] * abs_vmrs(si, ip);
+
+        for (Index ti = 0; ti < this_tgp.idx.nelem(); ti++) {
+          for (Index vi = 0; vi < this_vgp.idx.nelem(); vi++) {
+            const Numeric w = scale * this_tgp.w[ti] * this_vgp.w[vi];
+            if (w == 0) continue;
+
+            const ConstVectorView this_xsec = column(
+                this_tgp.idx[ti], fpi + this_vgp.idx[vi], this_p_grid_index);
+
+            if (f_identity) {
+              for (Index iv = 0; iv < n_new_f_grid; iv++)
+                this_sga[iv] += w * this_xsec[iv];
+            } else {
+              for (Index iv = 0; iv < n_new_f_grid; iv++) {
+                Numeric x = 0;
+                for (Index k = 0; k < n_fw; k++)
+                  x += fw[iv * n_fw + k] * this_xsec[fidx[iv * n_fw + k]];
+                this_sga[iv] += w * x;
+              }
+            }
+          }
+        }
+      }
+      sga(si, joker, ip) = this_sga;
+
+      if (do_VMR)
+        fpi += n_nls_pert;
+      else
+        fpi++;
+    }
+
+    assert(fpi == n_pages);
+  }
+}
+
+//! A read-only memory mapping of a whole file.
+struct GasAbsLookupMapping {
+  const char* data;
+  size_t size;
+
+  GasAbsLookupMapping(const String& filename) : data(nullptr), size(0) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      ostringstream os;
+      os << "Cannot open lookup table file " << filename << ": "
+         << strerror(errno);
+      throw runtime_error(os.str());
+    }
+
+    struct stat st;
+    void* ptr = MAP_FAILED;
+    if (0 == fstat(fd, &st) and st.st_size > 0) {
+      size = size_t(st.st_size);
+      ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (ptr == MAP_FAILED) {
+      ostringstream os;
+      os << "Cannot map lookup table file " << filename << " into memory";
+      throw runtime_error(os.str());
+    }
+    data = static_cast<const char*>(ptr);
+  }
+
+  GasAbsLookupMapping(const GasAbsLookupMapping&) = delete;
+  GasAbsLookupMapping& operator=(const GasAbsLookupMapping&) = delete;
+
+  ~GasAbsLookupMapping() { munmap(const_cast<char*>(data), size); }
+};
+
+//! Layout of the mapped lookup table format.
+/*!
+  The file starts with this header, followed by the grids and
+  reference profiles (see WriteMapped), followed by the cross sections
+  as raw native Numeric in the row-major order of xsec. The cross
+  sections start at a page-aligned offset, so that they can be used
+  directly from the mapping.
+ */
+namespace MappedLookupFormat {
+constexpr char magic[8] = {'A', 'R', 'T', 'S', 'G', 'A', 'L', '\0'};
+constexpr Index version = 2;
+constexpr Index byte_order = 0x0102030405060708;
+constexpr Index alignment = 4096;
+
+struct Header {
+  char magic[8];
+  Index version;
+  Index byte_order;
+  Index nbooks, npages, nrows, ncols;
+  Index element_size;
+  Index xsec_offset;
+};
+
+//! Sequential reader of the mapped data with bounds checks.
+struct Reader {
+  const char* pos;
+  const char* end;
+
+  void read(void* out, size_t n) {
+    if (size_t(end - pos) < n)
+      throw runtime_error("Lookup table file is truncated or corrupt");
+    std::memcpy(out, pos, n);
+    pos += n;
+  }
+
+  Index index() {
+    Index x;
+    read(&x, sizeof(Index));
+    if (x < 0) throw runtime_error("Lookup table file is corrupt");
+    return x;
+  }
+
+  String string() {
+    std::string x(index(), ' ');
+    read(&x[0], x.size());
+    return x;
+  }
+
+  void vector(Vector& x) {
+    x.resize(index());
+    for (Index i = 0; i < x.nelem(); i++) read(&x[i], sizeof(Numeric));
+  }
+};
+
+//! Sequential writer of the mapped format.
+struct Writer {
+  std::ofstream& os;
+
+  void write(const void* x, size_t n) {
+    os.write(static_cast<const char*>(x), std::streamsize(n));
+  }
+
+  void index(Index x) { write(&x, sizeof(Index)); }
+
+  void string(const String& x) {
+    index(Index(x.size()));
+    write(x.data(), x.size());
+  }
+
+  void numeric(Numeric x) { write(&x, sizeof(Numeric)); }
+
+  void vector(ConstVectorView x) {
+    index(x.nelem());
+    for (Index i = 0; i < x.nelem(); i++) numeric(x[i]);
+  }
+};
+}  // namespace MappedLookupFormat
+
+//! A view of cross sections that are stored outside of a Tensor4.
+class MappedTensor4View : public ConstTensor4View {
+ public:
+  MappedTensor4View(const Numeric* data, Index b, Index p, Index r, Index c)
+      : ConstTensor4View(const_cast<Numeric*>(data),
+                         Range(0, b, p * r * c),
+                         Range(0, p, r * c),
+                         Range(0, r, c),
+                         Range(0, c)) {}
+};
+
+//! The absorption cross sections.
+/*!
+  \return A view of xsec, or of the file mapping if the table is mapped.
+*/
+ConstTensor4View GasAbsLookup::xsec_data() const {
+  assert(not xsec_single);
+  if (not xsec_mapping) return xsec;
+
+  MappedLookupFormat::Header header;
+  std::memcpy(&header, xsec_mapping->data, sizeof(header));
+  assert(header.element_size == Index(sizeof(Numeric)));
+  return MappedTensor4View(
+      reinterpret_cast<const Numeric*>(xsec_mapping->data + header.xsec_offset),
+      header.nbooks,
+      header.npages,
+      header.nrows,
+      header.ncols);
+}
+
+Tensor4& GasAbsLookup::Xsec() {
+  if (xsec_mapping or xsec_single) {
+    xsec = xsec_copy();
+    xsec_mapping.reset();
+    xsec_single.reset();
+  }
+  return xsec;
+}
+
+//! The dimensions of the absorption cross sections.
+/*!
+  \return The dimensions of xsec, however the cross sections are stored.
+*/
+std::array<Index, 4> GasAbsLookup::xsec_shape() const {
+  if (xsec_single) return xsec_single_shape;
+
+  const ConstTensor4View table_xsec = xsec_data();
+  return {{table_xsec.nbooks(),
+           table_xsec.npages(),
+           table_xsec.nrows(),
+           table_xsec.ncols()}};
+}
+
+//! A double precision copy of the absorption cross sections.
+/*!
+  \return The cross sections, however they are stored.
+*/
+Tensor4 GasAbsLookup::xsec_copy() const {
+  if (not xsec_single) return Tensor4(xsec_data());
+
+  const std::array<Index, 4>& n = xsec_single_shape;
+  Tensor4 x(n[0], n[1], n[2], n[3]);
+  const float* data = xsec_single.get();
+  for (Index b = 0; b < n[0]; b++)
+    for (Index p = 0; p < n[1]; p++)
+      for (Index r = 0; r < n[2]; r++)
+        for (Index c = 0; c < n[3]; c++) x(b, p, r, c) = *data++;
+  return x;
+}
+
+//! The absorption cross sections at one pressure level.
+/*!
+  Single precision values are promoted into the buffer.
+
+  \param[in,out] buffer Storage for promoted values.
+  \param[in] first_page The first page (VMR profile) of xsec.
+  \param[in] n_pages The number of pages.
+  \param[in] p_index The pressure index.
+
+  \return The cross sections with dimension [T, n_pages, frequency].
+*/
+ConstTensor3View GasAbsLookup::xsec_slice(Tensor3& buffer,
+                                          const Index& first_page,
+                                          const Index& n_pages,
+                                          const Index& p_index) const {
+  if (not xsec_single)
+    return xsec_data()(joker, Range(first_page, n_pages), joker, p_index);
+
+  const std::array<Index, 4>& n = xsec_single_shape;
+  buffer.resize(n[0], n_pages, n[2]);
+  for (Index b = 0; b < n[0]; b++)
+    for (Index p = 0; p < n_pages; p++) {
+      const float* data = xsec_single.get() +
+                          ((b * n[1] + first_page + p) * n[2]) * n[3] + p_index;
+      for (Index r = 0; r < n[2]; r++) buffer(b, p, r) = data[r * n[3]];
+    }
+  return buffer;
+}
+
+//! The absorption cross sections at one pressure level, for one profile.
+/*!
+  Single precision values are promoted into the buffer.
+
+  \param[in,out] buffer Storage for promoted values.
+  \param[in] book The temperature perturbation index.
+  \param[in] page The page (VMR profile) of xsec.
+  \param[in] p_index The pressure index.
+
+  \return The cross sections with dimension [frequency].
+*/
+ConstVectorView GasAbsLookup::xsec_column(Vector& buffer,
+                                          const Index& book,
+                                          const Index& page,
+                                          const Index& p_index) const {
+  if (not xsec_single) return xsec_data()(book, page, joker, p_index);
+
+  const std::array<Index, 4>& n = xsec_single_shape;
+  buffer.resize(n[2]);
+  const float* data =
+      xsec_single.get() + ((book * n[1] + page) * n[2]) * n[3] + p_index;
+  for (Index r = 0; r < n[2]; r++) buffer[r] = data[r * n[3]];
+  return buffer;
+}
+
+//! Change the precision in which the absorption cross sections are stored.
+/*!
+  Single precision halves the memory of the table. The values are
+  promoted to Numeric when they are extracted, so the interpolation
+  itself is done in double precision. The rounding error of single
+  precision is far below the interpolation error of the table.
+
+  Changing the precision copies the cross sections, and detaches
+  the table from a file mapping.
+
+  \param[in] single Store in single precision if true, else in double.
+
+  \date 2026-10-16
+*/
+void GasAbsLookup::SetSinglePrecision(const bool single) {
+  if (single == IsSinglePrecision()) return;
+
+  if (single) {
+    const ConstTensor4View table_xsec = xsec_data();
+    const std::array<Index, 4> n = xsec_shape();
+    std::shared_ptr<float> data(new float[n[0] * n[1] * n[2] * n[3]],
+                                std::default_delete<float[]>());
+    float* x = data.get();
+    for (Index b = 0; b < n[0]; b++)
+      for (Index p = 0; p < n[1]; p++)
+        for (Index r = 0; r < n[2]; r++)
+          for (Index c = 0; c < n[3]; c++)
+            *x++ = float(table_xsec(b, p, r, c));
+
+    xsec_single = data;
+    xsec_single_shape = n;
+    xsec.resize(0, 0, 0, 0);
+  } else {
+    xsec = xsec_copy();
+    xsec_single.reset();
+  }
+  xsec_mapping.reset();
+}
+
+//! Read the table from a file in the mapped binary format.
+/*!
+  The file is mapped read-only into memory. The grids and reference
+  profiles are copied, but the cross sections are used directly from
+  the mapping, so that loading is fast and all processes on a node
+  share the same page-cached data. Adapt keeps the mapping if the
+  table is used for exactly its own species and frequencies.
+
+  The format stores native Numeric and Index. Files cannot be moved
+  between machines of different byte order, which is checked here.
+  The cross sections of a table in single precision are stored as
+  float, and the table read from the file keeps that precision.
+
+  \param[in] filename The file, as written by WriteMapped.
+
+  \date 2026-10-16
+*/
+void GasAbsLookup::ReadMapped(const String& filename) {
+  using namespace MappedLookupFormat;
+
+  auto mapping = std::make_shared<const GasAbsLookupMapping>(filename);
+
+  Reader in{mapping->data, mapping->data + mapping->size};
+  Header header;
+  in.read(&header, sizeof(header));
+
+  if (std::memcmp(header.magic, magic, sizeof(magic))) {
+    ostringstream os;
+    os << filename << " is not a mapped lookup table file";
+    throw runtime_error(os.str());
+  }
+  if (header.version not_eq version) {
+    ostringstream os;
+    os << filename << " has mapped lookup table version " << header.version
+       << ", but only version " << version << " is supported";
+    throw runtime_error(os.str());
+  }
+  if (header.byte_order not_eq byte_order) {
+    ostringstream os;
+    os << filename << " was written on a machine of different byte order";
+    throw runtime_error(os.str());
+  }
+
+  // The size of the cross sections, which must fit in the mapping.  Each
+  // factor is checked before it is multiplied in, so that a corrupt header
+  // cannot overflow the product
+  bool corrupt = header.xsec_offset < Index(sizeof(header)) or
+                 header.xsec_offset % alignment or
+                 size_t(header.xsec_offset) > mapping->size or
+                 (header.element_size not_eq Index(sizeof(Numeric)) and
+                  header.element_size not_eq Index(sizeof(float)));
+  size_t xsec_bytes = corrupt ? 0 : size_t(header.element_size);
+  for (const Index n :
+       {header.nbooks, header.npages, header.nrows, header.ncols}) {
+    if (corrupt) break;
+    corrupt = n < 0 or (n > 0 and xsec_bytes >
+                                      (mapping->size - header.xsec_offset) /
+                                          size_t(n));
+    xsec_bytes *= size_t(n);
+  }
+  if (corrupt or header.xsec_offset + xsec_bytes > mapping->size)
+    throw runtime_error("Lookup table file is truncated or corrupt");
+  in.end = mapping->data + header.xsec_offset;
+
+  GasAbsLookup table;
+
+  table.species.resize(in.index());
+  for (auto& group : table.species) {
+    group.resize(in.index());
+    for (auto& tag : group) tag = SpeciesTag(in.string());
+  }
+
+  table.nonlinear_species.resize(in.index());
+  for (auto& i : table.nonlinear_species) i = in.index();
+
+  in.vector(table.f_grid);
+  in.vector(table.p_grid);
+
+  const Index nrows = in.index();
+  const Index ncols = in.index();
+  table.vmrs_ref.resize(nrows, ncols);
+  for (Index i = 0; i < nrows; i++)
+    for (Index j = 0; j < ncols; j++)
+      in.read(&table.vmrs_ref(i, j), sizeof(Numeric));
+
+  in.vector(table.t_ref);
+  in.vector(table.t_pert);
+  in.vector(table.nls_pert);
+
+  table.xsec_mapping = mapping;
+  if (header.element_size == Index(sizeof(float))) {
+    table.xsec_single = std::shared_ptr<const float>(
+        mapping,
+        reinterpret_cast<const float*>(mapping->data + header.xsec_offset));
+    table.xsec_single_shape = {
+        {header.nbooks, header.npages, header.nrows, header.ncols}};
+  }
+  *this = table;
+}
+
+//! Write the table to a file in the mapped binary format.
+/*!
+  See ReadMapped.
+
+  The table is written to filename.tmp, which is flushed to disk and
+  then renamed to filename. Processes that have the old file mapped
+  keep reading the old data, instead of getting SIGBUS from a file
+  that is truncated under them.
+
+  \param[in] filename The file.
+
+  \date 2026-10-16
+*/
+void GasAbsLookup::WriteMapped(const String& filename) const {
+  using namespace MappedLookupFormat;
+
+  const String tmpname = filename + ".tmp";
+  std::ofstream os(tmpname.c_str(), std::ios::out | std::ios::binary);
+  if (not os) {
+    ostringstream es;
+    es << "Cannot open lookup table file " << tmpname << " for writing";
+    throw runtime_error(es.str());
+  }
+
+  const std::array<Index, 4> table_shape = xsec_shape();
+
+  // The header, with the offset of xsec set below:
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.byte_order = byte_order;
+  header.nbooks = table_shape[0];
+  header.npages = table_shape[1];
+  header.nrows = table_shape[2];
+  header.ncols = table_shape[3];
+  header.element_size = Index(xsec_single ? sizeof(float) : sizeof(Numeric));
+  header.xsec_offset = 0;
+
+  Writer out{os};
+  out.write(&header, sizeof(header));
+
+  out.index(species.nelem());
+  for (auto& group : species) {
+    out.index(group.nelem());
+    for (auto& tag : group) out.string(tag.Name());
+  }
+
+  out.index(nonlinear_species.nelem());
+  for (auto& i : nonlinear_species) out.index(i);
+
+  out.vector(f_grid);
+  out.vector(p_grid);
+
+  out.index(vmrs_ref.nrows());
+  out.index(vmrs_ref.ncols());
+  for (Index i = 0; i < vmrs_ref.nrows(); i++)
+    for (Index j = 0; j < vmrs_ref.ncols(); j++)
+      out.numeric(vmrs_ref(i, j));
+
+  out.vector(t_ref);
+  out.vector(t_pert);
+  out.vector(nls_pert);
+
+  // Pad to the page-aligned cross sections:
+  const Index end = Index(os.tellp());
+  header.xsec_offset = ((end + alignment - 1) / alignment) * alignment;
+  const std::vector<char> padding(header.xsec_offset - end, '\0');
+  out.write(padding.data(), padding.size());
+
+  if (xsec_single) {
+    // Already in the layout of the file:
+    out.write(xsec_single.get(),
+              header.nbooks * header.npages * header.nrows * header.ncols *
+                  sizeof(float));
+  } else {
+    // One row of pressures at a time:
+    const ConstTensor4View table_xsec = xsec_data();
+    std::vector<Numeric> row(header.ncols);
+    for (Index b = 0; b < header.nbooks; b++)
+      for (Index p = 0; p < header.npages; p++)
+        for (Index r = 0; r < header.nrows; r++) {
+          for (Index c = 0; c < header.ncols; c++)
+            row[c] = table_xsec(b, p, r, c);
+          out.write(row.data(), row.size() * sizeof(Numeric));
+        }
+  }
+
+  os.seekp(0);
+  out.write(&header, sizeof(header));
+  os.close();
+
+  // The data must be on disk before the rename makes it visible:
+  errno = 0;
+  bool ok = not os.fail();
+  if (ok) {
+    const int fd = open(tmpname.c_str(), O_WRONLY);
+    ok = fd >= 0 and fsync(fd) == 0;
+    if (fd >= 0) ok = close(fd) == 0 and ok;
+  }
+  if (ok) ok = std::rename(tmpname.c_str(), filename.c_str()) == 0;
+
+  if (not ok) {
+    const int error = errno;
+    std::remove(tmpname.c_str());
+    ostringstream es;
+    es << "Error writing lookup table file " << filename;
+    if (error) es << ": " << std::strerror(error);
+    throw runtime_error(es.str());
+  }
+}
+
 const Vector& GasAbsLookup::GetFgrid() const { return f_grid; }
 
 const Vector& GasAbsLookup::GetPgrid() const { return p_grid; }
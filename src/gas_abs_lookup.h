@@ -26,6 +26,8 @@
 #ifndef gas_abs_lookup_h
 #define gas_abs_lookup_h
 
+#include <array>
+#include <memory>
 #include "abs_species_tags.h"
 #include "absorption.h"
 #include "interpolation_poly.h"
@@ -33,6 +35,7 @@
 #include "messages.h"
 
 // Declare existance of some classes:
+struct GasAbsLookupMapping;
 class bifstream;
 class bofstream;
 class Agenda;
@@ -53,13 +56,17 @@ class GasAbsLookup {
         t_ref(),
         t_pert(),
         nls_pert(),
-        xsec() { /* Nothing to do here */
+        xsec(),
+        xsec_mapping(),
+        xsec_single(),
+        xsec_single_shape() { /* Nothing to do here */
   }
 
   // Documentation is with the implementation!
   void Adapt(const ArrayOfArrayOfSpeciesTag& current_species,
              ConstVectorView current_f_grid,
-             const Verbosity& verbosity);
+             const Verbosity& verbosity,
+             const Index& single_precision = -1);
 
   // Documentation is with the implementation!
   void Extract(Matrix& sga,
@@ -73,10 +80,37 @@ class GasAbsLookup {
                ConstVectorView new_f_grid,
                const Numeric& extpolfac) const;
 
+  // Documentation is with the implementation!
+  void ExtractBatch(Tensor3View sga,
+                    const Index& p_interp_order,
+                    const Index& t_interp_order,
+                    const Index& h2o_interp_order,
+                    const Index& f_interp_order,
+                    ConstVectorView p,
+                    ConstVectorView T,
+                    ConstMatrixView abs_vmrs,
+                    ConstVectorView new_f_grid,
+                    const Numeric& extpolfac) const;
+
   const Vector& GetFgrid() const;
 
   const Vector& GetPgrid() const;
 
+  // Documentation is with the implementation!
+  void ReadMapped(const String& filename);
+
+  // Documentation is with the implementation!
+  void WriteMapped(const String& filename) const;
+
+  /** True if the cross sections reference a read-only file mapping */
+  bool IsMapped() const { return bool(xsec_mapping); }
+
+  /** True if the cross sections are stored in single precision */
+  bool IsSinglePrecision() const { return bool(xsec_single); }
+
+  // Documentation is with the implementation!
+  void SetSinglePrecision(const bool single);
+
   Index GetSpeciesIndex(const Index& isp) const {
     return species[isp][0].Species();
   }
@@ -107,6 +141,8 @@ class GasAbsLookup {
       const Vector& abs_t_pert,
       const Vector& abs_nls_pert,
       const Agenda& abs_xsec_agenda,
+      // WS Generic Input:
+      const Index& single_precision,
       // Verbosity object:
       const Verbosity& verbosity);
 
@@ -188,10 +224,70 @@ class GasAbsLookup {
   /** The vector of perturbations for the VMRs of the nonlinear species */
   Vector& NLSPert() {return nls_pert;}
   
-  /** Absorption cross sections */
-  Tensor4& Xsec() {return xsec;}
+  /** Absorption cross sections
+   * 
+   * A mapped or single precision table is first copied to memory in
+   * double precision so that it can be changed
+   */
+  Tensor4& Xsec();
   
  private:
+  // Documentation is with the implementation!
+  ConstTensor4View xsec_data() const;
+
+  // Documentation is with the implementation!
+  std::array<Index, 4> xsec_shape() const;
+
+  // Documentation is with the implementation!
+  Tensor4 xsec_copy() const;
+
+  // Documentation is with the implementation!
+  ConstTensor3View xsec_slice(Tensor3& buffer,
+                              const Index& first_page,
+                              const Index& n_pages,
+                              const Index& p_index) const;
+
+  // Documentation is with the implementation!
+  ConstVectorView xsec_column(Vector& buffer,
+                              const Index& book,
+                              const Index& page,
+                              const Index& p_index) const;
+
+  // Documentation is with the implementation!
+  Index check_extraction(const Index& p_interp_order,
+                         const Index& t_interp_order,
+                         const Index& h2o_interp_order,
+                         const Index& f_interp_order,
+                         const Index& n_vmrs) const;
+
+  // Documentation is with the implementation!
+  const ArrayOfGridPosPoly& frequency_gridpos(
+      ArrayOfGridPosPoly& fgp_local,
+      const Index& f_interp_order,
+      ConstVectorView new_f_grid) const;
+
+  // Documentation is with the implementation!
+  void pressure_gridpos(GridPosPoly& pgp,
+                        const Index& p_interp_order,
+                        const Numeric& p) const;
+
+  // Documentation is with the implementation!
+  void temperature_gridpos(GridPosPoly& tgp,
+                           const Index& t_interp_order,
+                           const Numeric& p,
+                           const Numeric& T,
+                           const Index& p_grid_index,
+                           const Numeric& extpolfac) const;
+
+  // Documentation is with the implementation!
+  void h2o_gridpos(GridPosPoly& vgp,
+                   const Index& h2o_interp_order,
+                   const Numeric& p,
+                   const Numeric& h2o_vmr,
+                   const Index& h2o_index,
+                   const Index& p_grid_index,
+                   const Numeric& extpolfac) const;
+
   //! The species tags for which the table is valid.
   ArrayOfArrayOfSpeciesTag species;
 
@@ -307,6 +403,21 @@ class GasAbsLookup {
     dimensions of abs_per_tg in ARTS-1-0. This should simplify
     computation of the lookup table with the old ARTS version.  */
   Tensor4 xsec;
+
+  //! Read-only file mapping holding the absorption cross sections.
+  /*! If set, xsec is empty and the cross sections are instead read from
+    this mapping, which is shared by all copies of the table. See
+    ReadMapped. */
+  std::shared_ptr<const GasAbsLookupMapping> xsec_mapping;
+
+  //! Absorption cross sections in single precision.
+  /*! If set, xsec is empty and the cross sections are instead stored
+    here as float, in the same layout as xsec. The data is either owned
+    or points into xsec_mapping. See SetSinglePrecision. */
+  std::shared_ptr<const float> xsec_single;
+
+  //! The dimensions of xsec_single, in the order of those of xsec.
+  std::array<Index, 4> xsec_single_shape;
 };
 
 ostream& operator<<(ostream& os, const GasAbsLookup& gal);
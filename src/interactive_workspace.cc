@@ -298,7 +298,7 @@ void InteractiveWorkspace::set_sparse_variable(Index id,
 }
 
 void InteractiveWorkspace::resize() {
-  Array<stack<WsvStruct *>> ws_new(wsv_data.nelem());
+  Array<WsvStack> ws_new(wsv_data.nelem());
   std::copy(ws.begin(), ws.end(), ws_new.begin());
   std::swap(ws, ws_new);
 }
@@ -317,7 +317,7 @@ Index InteractiveWorkspace::add_variable(Index group_id, const char *name) {
 
   Index id = static_cast<Index>(ws.size());
 
-  ws.push_back(stack<WsvStruct *>());
+  ws.push_back(WsvStack());
   push(ws.size() - 1, nullptr);
   ws.back().top()->wsv = wsmh.allocate(group_id);
   ws.back().top()->auto_allocated = true;
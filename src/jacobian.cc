@@ -339,10 +339,15 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
                              ConstTensor3View diy_dpath,
                              const Index& atmosphere_dim,
                              const Ppath& ppath,
-                             ConstVectorView ppath_p) {
+                             ConstVectorView ppath_p,
+                             const Index ip0) {
   // If this is an integration target then diy_dx is just the sum of all in diy_dpath
+  // (later parts of a path add to the sum of the first part)
   if (jacobian_quantity.Integration()) {
-    diy_dx(0, joker, joker) = diy_dpath(0, joker, joker);
+    if (ip0 == 0)
+      diy_dx(0, joker, joker) = diy_dpath(0, joker, joker);
+    else
+      diy_dx(0, joker, joker) += diy_dpath(0, joker, joker);
     for (Index i = 1; i < diy_dpath.npages(); i++)
       diy_dx(0, joker, joker) += diy_dpath(i, joker, joker);
     return;
@@ -356,11 +361,16 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
 
   if (ppath.np > 1)  // Otherwise nothing to do here
   {
+    // The points of diy_dpath
+    const Index np = diy_dpath.npages();
+    const Range path_part(ip0, np);
+
     // Pressure
     Index nr1 = jacobian_quantity.Grids()[0].nelem();
-    ArrayOfGridPos gp_p(ppath.np);
+    ArrayOfGridPos gp_p(np);
     if (nr1 > 1) {
-      p2gridpos(gp_p, jacobian_quantity.Grids()[0], ppath_p, extpolfac);
+      p2gridpos(
+          gp_p, jacobian_quantity.Grids()[0], ppath_p[path_part], extpolfac);
       jacobian_type_extrapol(gp_p);
     } else {
       gp4length1grid(gp_p);
@@ -370,12 +380,12 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
     Index nr2 = 1;
     ArrayOfGridPos gp_lat;
     if (atmosphere_dim > 1) {
-      gp_lat.resize(ppath.np);
+      gp_lat.resize(np);
       nr2 = jacobian_quantity.Grids()[1].nelem();
       if (nr2 > 1) {
         gridpos(gp_lat,
                 jacobian_quantity.Grids()[1],
-                ppath.pos(joker, 1),
+                ppath.pos(path_part, 1),
                 extpolfac);
         jacobian_type_extrapol(gp_lat);
       } else {
@@ -386,11 +396,11 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
     // Longitude
     ArrayOfGridPos gp_lon;
     if (atmosphere_dim > 2) {
-      gp_lon.resize(ppath.np);
+      gp_lon.resize(np);
       if (jacobian_quantity.Grids()[2].nelem() > 1) {
         gridpos(gp_lon,
                 jacobian_quantity.Grids()[2],
-                ppath.pos(joker, 2),
+                ppath.pos(path_part, 2),
                 extpolfac);
         jacobian_type_extrapol(gp_lon);
       } else {
@@ -400,7 +410,7 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
 
     //- 1D
     if (atmosphere_dim == 1) {
-      for (Index ip = 0; ip < ppath.np; ip++) {
+      for (Index ip = 0; ip < np; ip++) {
         if (gp_p[ip].fd[1] > 0) {
           from_dpath_to_dx(diy_dx(gp_p[ip].idx, joker, joker),
                            diy_dpath(ip, joker, joker),
@@ -416,7 +426,7 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
 
     //- 2D
     else if (atmosphere_dim == 2) {
-      for (Index ip = 0; ip < ppath.np; ip++) {
+      for (Index ip = 0; ip < np; ip++) {
         Index ix = nr1 * gp_lat[ip].idx + gp_p[ip].idx;
         // Low lat, low p
         if (gp_lat[ip].fd[1] > 0 && gp_p[ip].fd[1] > 0)
@@ -443,7 +453,7 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
 
     //- 3D
     else if (atmosphere_dim == 3) {
-      for (Index ip = 0; ip < ppath.np; ip++) {
+      for (Index ip = 0; ip < np; ip++) {
         Index ix =
             nr2 * nr1 * gp_lon[ip].idx + nr1 * gp_lat[ip].idx + gp_p[ip].idx;
         // Low lon, low lat, low p
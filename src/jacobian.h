@@ -572,6 +572,9 @@ bool check_retrieval_grids(ArrayOfVector& grids,
     @param[in]   atmosphere_dim      As the WSV.
     @param[in]   ppath               As the WSV.
     @param[in]   ppath_p             The pressure at each ppath point.
+    @param[in]   ip0                 Index of the ppath point of the first
+                                     page of diy_dpath, if the path is
+                                     mapped in parts.
 
     @author Patrick Eriksson 
     @date   2009-10-08
@@ -581,7 +584,8 @@ void diy_from_path_to_rgrids(Tensor3View diy_dx,
                              ConstTensor3View diy_dpath,
                              const Index& atmosphere_dim,
                              const Ppath& ppath,
-                             ConstVectorView ppath_p);
+                             ConstVectorView ppath_p,
+                             const Index ip0 = 0);
 
 /** diy_from_pos_to_rgrids
 
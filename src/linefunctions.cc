@@ -33,14 +33,100 @@
  */
 
 #include "linefunctions.h"
+#include <array>
 #include <Eigen/Core>
 #include <Faddeeva/Faddeeva.hh>
 #include "constants.h"
 #include "linescaling.h"
+#include "logic.h"
 
 /** The Faddeeva function */
 inline Complex w(Complex z) noexcept { return Faddeeva::w(z); }
 
+/** Coefficients of Weideman's rational approximation of the Faddeeva function
+ * 
+ * Computed once from the discrete Fourier transform in J.A.C. Weideman,
+ * Computation of the complex error function, SIAM J. Numer. Anal. 31, 1994
+ * 
+ * @tparam N Number of terms
+ */
+template <Index N>
+struct WeidemanCoefficients {
+  Numeric L;
+  std::array<Numeric, N> a;
+
+  WeidemanCoefficients() noexcept {
+    constexpr Index M = 2 * N;
+    constexpr Index M2 = 2 * M;
+    L = std::sqrt(Numeric(N) / Constant::sqrt_2);
+
+    std::array<Numeric, M2> f;
+    f[0] = 0;
+    for (Index k = -M + 1; k < M; k++) {
+      const Numeric t = L * std::tan(Numeric(k) * Constant::pi / Numeric(M2));
+      f[k + M] = std::exp(-t * t) * (L * L + t * t);
+    }
+
+    // Real part of the shifted DFT in reversed order for Horner's scheme
+    for (Index n = 0; n < N; n++) {
+      const Index k = N - n;
+      Numeric sum = 0;
+      for (Index j = 0; j < M2; j++)
+        sum += f[(j + M) % M2] *
+               std::cos(2 * Constant::pi * Numeric(k * j) / Numeric(M2));
+      a[n] = sum / Numeric(M2);
+    }
+  }
+};
+
+/** Weideman's approximation of the Faddeeva function for n points
+ * 
+ * Valid for Im(z) >= 0.  The loop works on the real and imaginary parts
+ * directly so that it is vectorized across points
+ * 
+ * @tparam N Number of terms
+ * @param[out] W The Faddeeva function
+ * @param[in] z The arguments
+ * @param[in] n The number of points
+ */
+template <Index N>
+void weideman_faddeeva(Complex* W, const Complex* z, const Index n) noexcept {
+  static const WeidemanCoefficients<N> c;
+  const Numeric L = c.L;
+  const Numeric* zd = reinterpret_cast<const Numeric*>(z);
+  Numeric* Wd = reinterpret_cast<Numeric*>(W);
+
+#pragma omp simd
+  for (Index i = 0; i < n; i++) {
+    const Numeric x = zd[2 * i], y = zd[2 * i + 1];
+
+    // L - iz and L + iz
+    const Numeric ar = L + y, ai = -x;
+    const Numeric br = L - y, bi = x;
+    const Numeric inv = 1 / (ar * ar + ai * ai);
+
+    // Z = (L + iz) / (L - iz)
+    const Numeric Zr = (br * ar + bi * ai) * inv;
+    const Numeric Zi = (bi * ar - br * ai) * inv;
+
+    // p = polyval(a, Z)
+    Numeric pr = c.a[0], pi = 0;
+    for (Index k = 1; k < N; k++) {
+      const Numeric t = pr * Zr - pi * Zi + c.a[k];
+      pi = pr * Zi + pi * Zr;
+      pr = t;
+    }
+
+    // 1 / (L - iz) and its square
+    const Numeric ir = ar * inv, ii = -ai * inv;
+    const Numeric qr = ir * ir - ii * ii, qi = 2 * ir * ii;
+
+    // w = 2p / (L - iz)^2 + 1 / (sqrt(pi) (L - iz))
+    Wd[2 * i] = 2 * (pr * qr - pi * qi) + Constant::inv_sqrt_pi * ir;
+    Wd[2 * i + 1] = 2 * (pr * qi + pi * qr) + Constant::inv_sqrt_pi * ii;
+  }
+}
+
 /** The Faddeeva function partial derivative */
 constexpr Complex dw(Complex z, Complex w) noexcept {
   return Complex(0, 2) * (Constant::inv_sqrt_pi - z * w);
@@ -84,6 +170,49 @@ constexpr Complex pCqSDHC_to_arts_D2_deriv(Complex x) noexcept {
   pow4(c);
 }
 
+/** Points that the rational approximation should leave to the Faddeeva package
+ * 
+ * This is the lower half-plane, where the approximation is not valid, and
+ * the region where the Faddeeva package uses its continued fraction.  The
+ * continued fraction is cheap and accurate far from the line center, and
+ * the derivative of the line shape relies on the full accuracy there
+ */
+constexpr bool faddeeva_by_reference(Complex z) noexcept {
+  const Numeric x = z.real() < 0 ? -z.real() : z.real();
+  const Numeric y = z.imag();
+  return y < 0 or y > 7 or
+         (x > 6 and (y > 0.1 or (x > 8 and y > 1e-10) or x > 28));
+}
+
+void Linefunctions::set_faddeeva(Eigen::Ref<Eigen::VectorXcd> W,
+                                 const Eigen::Ref<const Eigen::VectorXcd> z,
+                                 const FaddeevaAccuracy accuracy) {
+  const Index n = z.size();
+
+  if (accuracy == FaddeevaAccuracy::Reference) {
+    W.noalias() = z.unaryExpr(&w);
+    return;
+  }
+
+  // Alternate between runs of points for the Faddeeva package and runs of
+  // points for the approximation.  A sorted frequency grid gives at most
+  // three runs per line
+  Index i = 0;
+  while (i < n) {
+    for (; i < n and faddeeva_by_reference(z[i]); i++) W[i] = w(z[i]);
+
+    Index j = i;
+    for (; j < n and not faddeeva_by_reference(z[j]); j++) {
+    }
+
+    if (accuracy == FaddeevaAccuracy::High)
+      weideman_faddeeva<32>(W.data() + i, z.data() + i, j - i);
+    else
+      weideman_faddeeva<16>(W.data() + i, z.data() + i, j - i);
+    i = j;
+  }
+}
+
 void Linefunctions::set_lineshape(
     Eigen::Ref<Eigen::VectorXcd> F,
     const Eigen::Ref<const Eigen::VectorXd> f_grid,
@@ -311,7 +440,8 @@ void Linefunctions::set_voigt(
     const ArrayOfIndex& derivatives_data_position,
     const Numeric& dGD_div_F0_dT,
     const LineShape::Output& dT,
-    const LineShape::Output& dVMR) {
+    const LineShape::Output& dVMR,
+    const FaddeevaAccuracy accuracy) {
   constexpr Complex iz(0.0, 1.0);
 
   // Size of problem
@@ -334,7 +464,8 @@ void Linefunctions::set_voigt(
   z.noalias() = invGD * (Complex(-F0, lso.G0) + f_grid.array()).matrix();
 
   // Line shape
-  F.noalias() = fac * z.unaryExpr(&w);
+  set_faddeeva(F, z, accuracy);
+  F *= fac;
 
   if (nppd) {
     dw.noalias() = 2 * (Complex(0, fac * Constant::inv_sqrt_pi) -
@@ -681,6 +812,47 @@ void Linefunctions::apply_linestrength_scaling_by_lte(
   dN.setZero();
 }
 
+void Linefunctions::apply_linestrength_scaling_by_lte(
+    Eigen::Ref<Eigen::VectorXcd> F,
+    Eigen::Ref<Eigen::MatrixXcd> dF,
+    Eigen::Ref<Eigen::VectorXcd> N,
+    Eigen::Ref<Eigen::MatrixXcd> dN,
+    const Numeric& S,
+    const Numeric& dSdT_div_S,
+    const Numeric& T,
+    const Numeric& T0,
+    const AbsorptionLines& band,
+    const Index& line_ind,
+    const ArrayOfRetrievalQuantity& derivatives_data,
+    const ArrayOfIndex& derivatives_data_position) {
+  auto nppd = derivatives_data_position.nelem();
+
+  F *= S;
+  dF *= S;
+  for (auto iq = 0; iq < nppd; iq++) {
+    const auto& deriv = derivatives_data[derivatives_data_position[iq]];
+
+    if (deriv == JacPropMatType::Temperature)
+      dF.col(iq).noalias() += F * dSdT_div_S;
+    else if (deriv == JacPropMatType::LineStrength and
+             Absorption::id_in_line(band, deriv.QuantumIdentity(), line_ind))
+      dF.col(iq).noalias() = F / band.I0(line_ind);  //nb. overwrite
+    else if (deriv == JacPropMatType::LineCenter and
+             Absorption::id_in_line(band, deriv.QuantumIdentity(), line_ind)) {
+      const Numeric gamma = stimulated_emission(T, band.F0(line_ind));
+      const Numeric gamma_ref = stimulated_emission(T0, band.F0(line_ind));
+      dF.col(iq).noalias() +=
+          F *
+          dstimulated_relative_emission_dF0(gamma, gamma_ref, T, T0) /
+          stimulated_relative_emission(gamma, gamma_ref);
+    }
+  }
+
+  // No NLTE variables
+  N.setZero();
+  dN.setZero();
+}
+
 void Linefunctions::apply_linestrength_scaling_by_vibrational_nlte(
     Eigen::Ref<Eigen::VectorXcd> F,
     Eigen::Ref<Eigen::MatrixXcd> dF,
@@ -1288,6 +1460,83 @@ void Linefunctions::set_htp(Eigen::Ref<Eigen::VectorXcd> F,
   }
 }
 
+/** Ratio of the line core half-width to the coarse grid spacing
+ * 
+ * Linear interpolation with spacing h of a Lorentzian wing at distance x
+ * from the line center has a relative error below 3/4 (h/x)^2, also with
+ * first order line mixing
+ * 
+ * @param[in] accuracy The relative accuracy of the wings
+ * @return The ratio x/h giving this accuracy
+ */
+static Numeric sparse_core_ratio(const Numeric accuracy) noexcept {
+  return std::sqrt(0.75 / accuracy);
+}
+
+/** Spacing of the coarse grid for line wings
+ * 
+ * Minimizes the number of points per line, i.e., the points of the coarse
+ * grid plus the points of the line core on f_grid
+ * 
+ * @param[in] f_grid Increasing frequency grid
+ * @param[in] accuracy The relative accuracy of the wings
+ * @return The spacing, or 0 if computing all of f_grid is about as cheap
+ */
+static Numeric sparse_grid_spacing(const ConstVectorView f_grid,
+                                   const Numeric accuracy) noexcept {
+  const Index nf = f_grid.nelem();
+  if (nf < 2) return 0;
+  
+  const Numeric width = f_grid[nf - 1] - f_grid[0];
+  const Numeric df = width / Numeric(nf - 1);
+  const Numeric h = std::sqrt(width * df / (2 * sparse_core_ratio(accuracy)));
+  return (h < 4 * df) ? 0 : h;
+}
+
+/** First index of an increasing grid that is not below v, or its size */
+static Index first_not_below(const ConstVectorView x, const Numeric v) noexcept {
+  Index lo = 0, hi = x.nelem();
+  while (lo < hi) {
+    const Index mid = (lo + hi) / 2;
+    if (x[mid] < v)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/** Adds w times the linear interpolation of coarse to fine
+ * 
+ * @param[in,out] fine Data to add to, starting at row k0
+ * @param[in] k0 First row of fine
+ * @param[in] f Frequencies of the rows of fine to add to
+ * @param[in] coarse Data on the uniform grid x0 + j * dx
+ * @param[in] x0 First frequency of coarse
+ * @param[in] dx Spacing of coarse
+ * @param[in] w The weight
+ */
+static void add_interpolated(Linefunctions::InternalData& fine,
+                             const Index k0,
+                             const ConstVectorView f,
+                             const Linefunctions::InternalData& coarse,
+                             const Numeric x0,
+                             const Numeric dx,
+                             const Numeric w) {
+  const Index nc = coarse.F.size();
+  for (Index k = 0; k < f.nelem(); k++) {
+    const Numeric x = (f[k] - x0) / dx;
+    const Index j = std::min(std::max(Index(std::floor(x)), Index(0)), nc - 2);
+    const Numeric b = w * (x - Numeric(j));
+    const Numeric a = w - b;
+    
+    fine.F[k0 + k] += a * coarse.F[j] + b * coarse.F[j + 1];
+    fine.N[k0 + k] += a * coarse.N[j] + b * coarse.N[j + 1];
+    fine.dF.row(k0 + k).noalias() += a * coarse.dF.row(j) + b * coarse.dF.row(j + 1);
+    fine.dN.row(k0 + k).noalias() += a * coarse.dN.row(j) + b * coarse.dN.row(j + 1);
+  }
+}
+
 void Linefunctions::set_cross_section_of_band(
     InternalData& scratch,
     InternalData& sum,
@@ -1308,9 +1557,17 @@ void Linefunctions::set_cross_section_of_band(
     const Numeric& QT0,
     const bool no_negatives,
     const bool zeeman,
-    const Zeeman::Polarization zeeman_polarization)
+    const Zeeman::Polarization zeeman_polarization,
+    const Index line_start,
+    const Index line_count,
+    const FaddeevaAccuracy faddeeva_accuracy,
+    const Absorption::CompiledLineParameters* line_parameters,
+    const Numeric sparse_accuracy)
 {
   const Index nj = derivatives_data_active.nelem();
+  const Index line_end = (line_count < 0) ? band.NumLines() : line_start + line_count;
+  assert(line_start >= 0 and line_end <= band.NumLines());
+  assert(not no_negatives or (line_start == 0 and line_end == band.NumLines()));
   const bool do_temperature = do_temperature_jacobian(derivatives_data);
   
   // Sum up variable reset
@@ -1320,6 +1577,62 @@ void Linefunctions::set_cross_section_of_band(
     return;  // No line-by-line computations required/wanted
   }
   
+  // Per-line catalog data from the packed copy of the band, which the line
+  // parameters were computed from
+  const Absorption::CompiledLines* compiled = line_parameters ? &band.Compiled() : nullptr;
+  
+  // Line wings from a coarse grid, line cores on f_grid
+  const Numeric sparse_df = (sparse_accuracy > 0 and not no_negatives and not zeeman and is_increasing(f_grid)) ?
+    sparse_grid_spacing(f_grid, sparse_accuracy) : 0;
+  if (sparse_df > 0) {
+    const Index nf = f_grid.nelem();
+    const Index ns = 1 + Index(std::ceil((f_grid[nf - 1] - f_grid[0]) / sparse_df));
+    const Numeric fs0 = f_grid[0];
+    const Numeric dfs = (f_grid[nf - 1] - fs0) / Numeric(ns - 1);
+    Vector f_sparse(ns);
+    for (Index j=0; j<ns; j++) f_sparse[j] = fs0 + Numeric(j) * dfs;
+    
+    // The lines from line_start to line_end on any grid f
+    auto compute = [&](InternalData& out, const ConstVectorView f, Index l0, Index nl) {
+      InternalData tmp(f.nelem(), nj);
+      set_cross_section_of_band(tmp, out, f, band, derivatives_data, derivatives_data_active, vmrs, nlte, P, T, isot_ratio, H, DC, dDCdT, QT, dQTdT, QT0, false, false, zeeman_polarization, l0, nl, faddeeva_accuracy, line_parameters);
+    };
+    
+    // All lines interpolated from the coarse grid
+    InternalData coarse(ns, nj);
+    compute(coarse, f_sparse, line_start, line_end - line_start);
+    add_interpolated(sum, 0, f_grid, coarse, fs0, dfs, 1);
+    
+    // Replace the interpolated line cores by their exact values
+    const Numeric core_df = sparse_core_ratio(sparse_accuracy) * dfs;
+    for (Index i=line_start; i<line_end; i++) {
+      const auto X = line_parameters ?
+        line_parameters -> ShapeParameters(i) : band.ShapeParameters(i, T, P, vmrs);
+      const Numeric F0 = compiled ? compiled -> F0()[i] : band.F0(i);
+      const Numeric f0 = F0 + X.D0 + X.DV;
+      const Numeric df = std::max(core_df, 10 * DC * F0);
+      
+      const Index k0 = first_not_below(f_grid, f0 - df);
+      const Index k1 = first_not_below(f_grid, f0 + df);
+      if (k0 == k1) continue;
+      
+      const Index j0 = std::min(std::max(Index(std::floor((f_grid[k0] - fs0) / dfs)), Index(0)), ns - 2);
+      const Index j1 = std::min(Index(std::floor((f_grid[k1 - 1] - fs0) / dfs)) + 1, ns - 1);
+      
+      InternalData core(k1 - k0, nj);
+      compute(core, f_grid[Range(k0, k1 - k0)], i, 1);
+      sum.F.segment(k0, k1 - k0).noalias() += core.F;
+      sum.N.segment(k0, k1 - k0).noalias() += core.N;
+      sum.dF.middleRows(k0, k1 - k0).noalias() += core.dF;
+      sum.dN.middleRows(k0, k1 - k0).noalias() += core.dN;
+      
+      InternalData wing(j1 - j0 + 1, nj);
+      compute(wing, f_sparse[Range(j0, j1 - j0 + 1)], i, 1);
+      add_interpolated(sum, k0, f_grid[Range(k0, k1 - k0)], wing, f_sparse[j0], dfs, -1);
+    }
+    return;
+  }
+  
   // Cutoff for Eigen-library types
   Eigen::Matrix<Numeric, 1, 1> fc;
   auto& Fc = scratch.Fc;
@@ -1346,7 +1659,7 @@ void Linefunctions::set_cross_section_of_band(
   // Placeholder nothingness
   constexpr LineShape::Output empty_output = {0, 0, 0, 0, 0, 0, 0, 0, 0};
   
-  for (Index i=0; i<band.NumLines(); i++) {
+  for (Index i=line_start; i<line_end; i++) {
     
     // Select the range of cutoff if different for each line
     if (band.Cutoff() == Absorption::CutoffType::LineByLineOffset and i>0) {
@@ -1364,16 +1677,20 @@ void Linefunctions::set_cross_section_of_band(
     auto data = scratch.data.middleRows(start, nelem);
     const auto f = f_full.middleRows(start, nelem);
     
+    // Central frequency
+    const Numeric F0 = compiled ? compiled -> F0()[i] : band.F0(i);
+    
     // Pressure broadening and line mixing terms
-    const auto X = band.ShapeParameters(i, T, P, vmrs);
+    const auto X = line_parameters ?
+      line_parameters -> ShapeParameters(i) : band.ShapeParameters(i, T, P, vmrs);
     
     // Partial derivatives for temperature
-    const auto dXdT = do_temperature ?
-      band.ShapeParameters_dT(i, T, P, vmrs) : empty_output;
+    const auto dXdT = not do_temperature ? empty_output : line_parameters ?
+      line_parameters -> ShapeParameters_dT(i) : band.ShapeParameters_dT(i, T, P, vmrs);
     
     // Partial derivatives for VMR of self (function works for any species but only do self for now)
-    const auto dXdVMR = do_vmr.test ?
-      band.ShapeParameters_dVMR(i, T, P, do_vmr.qid) : empty_output;
+    const auto dXdVMR = not do_vmr.test ? empty_output : line_parameters ?
+      line_parameters -> ShapeParameters_dVMR(i) : band.ShapeParameters_dVMR(i, T, P, do_vmr.qid);
     
     // Zeeman lines if necessary
     const Index nz = zeeman ?
@@ -1390,25 +1707,25 @@ void Linefunctions::set_cross_section_of_band(
       // Set the line shape and its derivatives
       switch (band.LineShapeType()) {
         case LineShape::Type::DP:
-          set_doppler(F, dF, data, f, dfdH, H, band.F0(i), DC, band, i, derivatives_data, derivatives_data_active, dDCdT);
+          set_doppler(F, dF, data, f, dfdH, H, F0, DC, band, i, derivatives_data, derivatives_data_active, dDCdT);
           if (band.Cutoff() not_eq Absorption::CutoffType::None)
-            set_doppler(Fc, dFc, datac, fc, dfdH, H, band.F0(i), DC, band, i, derivatives_data, derivatives_data_active, dDCdT);
+            set_doppler(Fc, dFc, datac, fc, dfdH, H, F0, DC, band, i, derivatives_data, derivatives_data_active, dDCdT);
           break;
         case LineShape::Type::HTP:
         case LineShape::Type::SDVP:
-          set_htp(F, dF, f, dfdH, H, band.F0(i), DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR);
+          set_htp(F, dF, f, dfdH, H, F0, DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR);
           if (band.Cutoff() not_eq Absorption::CutoffType::None)
-            set_htp(Fc, dFc, fc, dfdH, H, band.F0(i), DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR);
+            set_htp(Fc, dFc, fc, dfdH, H, F0, DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR);
           break;
         case LineShape::Type::LP:
-          set_lorentz(F, dF, data, f, dfdH, H, band.F0(i), X, band, i, derivatives_data, derivatives_data_active, dXdT, dXdVMR);
+          set_lorentz(F, dF, data, f, dfdH, H, F0, X, band, i, derivatives_data, derivatives_data_active, dXdT, dXdVMR);
           if (band.Cutoff() not_eq Absorption::CutoffType::None)
-            set_lorentz(Fc, dFc, datac, fc, dfdH, H, band.F0(i), X, band, i, derivatives_data, derivatives_data_active, dXdT, dXdVMR);
+            set_lorentz(Fc, dFc, datac, fc, dfdH, H, F0, X, band, i, derivatives_data, derivatives_data_active, dXdT, dXdVMR);
           break;
         case LineShape::Type::VP:
-          set_voigt(F, dF, data, f, dfdH, H, band.F0(i), DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR);
+          set_voigt(F, dF, data, f, dfdH, H, F0, DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR, faddeeva_accuracy);
           if (band.Cutoff() not_eq Absorption::CutoffType::None)
-            set_voigt(Fc, dFc, datac, fc, dfdH, H, band.F0(i), DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR);
+            set_voigt(Fc, dFc, datac, fc, dfdH, H, F0, DC, X, band, i, derivatives_data, derivatives_data_active, dDCdT, dXdT, dXdVMR, faddeeva_accuracy);
           break;
       }
       
@@ -1429,33 +1746,33 @@ void Linefunctions::set_cross_section_of_band(
         case Absorption::MirroringType::Manual:
           break;
         case Absorption::MirroringType::Lorentz:
-          set_lorentz(N, dN, data, f, -dfdH, H, -band.F0(i), LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+          set_lorentz(N, dN, data, f, -dfdH, H, -F0, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
           if (band.Cutoff() not_eq Absorption::CutoffType::None)
-            set_lorentz(Nc, dNc, datac, fc, -dfdH, H, -band.F0(i), LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+            set_lorentz(Nc, dNc, datac, fc, -dfdH, H, -F0, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
           break;
         case Absorption::MirroringType::SameAsLineShape:
           switch (band.LineShapeType()) {
             case LineShape::Type::DP:
-              set_doppler(N, dN, data, f, -dfdH, H, -band.F0(i), -DC, band, i, derivatives_data, derivatives_data_active, -dDCdT);
+              set_doppler(N, dN, data, f, -dfdH, H, -F0, -DC, band, i, derivatives_data, derivatives_data_active, -dDCdT);
               if (band.Cutoff() not_eq Absorption::CutoffType::None)
-                set_doppler(Nc, dNc, datac, fc, -dfdH, H, -band.F0(i), -DC, band, i, derivatives_data, derivatives_data_active, -dDCdT);
+                set_doppler(Nc, dNc, datac, fc, -dfdH, H, -F0, -DC, band, i, derivatives_data, derivatives_data_active, -dDCdT);
               break;
             case LineShape::Type::LP:
-              set_lorentz(N, dN, data, f, -dfdH, H, -band.F0(i), LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+              set_lorentz(N, dN, data, f, -dfdH, H, -F0, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
               if (band.Cutoff() not_eq Absorption::CutoffType::None)
-                set_lorentz(Nc, dNc, datac, fc, -dfdH, H, -band.F0(i), LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+                set_lorentz(Nc, dNc, datac, fc, -dfdH, H, -F0, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
               break;
             case LineShape::Type::VP:
-              set_voigt(N, dN, data, f, -dfdH, H, -band.F0(i), -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+              set_voigt(N, dN, data, f, -dfdH, H, -F0, -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output, faddeeva_accuracy);
               if (band.Cutoff() not_eq Absorption::CutoffType::None)
-                set_voigt(Nc, dNc, datac, fc, -dfdH, H, -band.F0(i), -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+                set_voigt(Nc, dNc, datac, fc, -dfdH, H, -F0, -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output, faddeeva_accuracy);
               break;
             case LineShape::Type::HTP:
             case LineShape::Type::SDVP:
               // WARNING: This mirroring is not tested and it might require, e.g., FVC to be treated differently
-              set_htp(N, dN, f, -dfdH, H, -band.F0(i), -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+              set_htp(N, dN, f, -dfdH, H, -F0, -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
               if (band.Cutoff() not_eq Absorption::CutoffType::None)
-                set_htp(Nc, dNc, fc, -dfdH, H, -band.F0(i), -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
+                set_htp(Nc, dNc, fc, -dfdH, H, -F0, -DC, LineShape::mirroredOutput(X), band, i, derivatives_data, derivatives_data_active, -dDCdT, do_temperature ? LineShape::mirroredOutput(dXdT) : empty_output, do_vmr.test ? LineShape::mirroredOutput(dXdVMR) : empty_output);
               break;
           }
           break;
@@ -1482,13 +1799,13 @@ void Linefunctions::set_cross_section_of_band(
         case Absorption::NormalizationType::None:
           break;
         case Absorption::NormalizationType::VVH:
-          apply_VVH_scaling(F, dF, data, f, band.F0(i), T, band, i, derivatives_data, derivatives_data_active);
+          apply_VVH_scaling(F, dF, data, f, F0, T, band, i, derivatives_data, derivatives_data_active);
           break;
         case Absorption::NormalizationType::VVW:
-          apply_VVW_scaling(F, dF, f, band.F0(i), band, i, derivatives_data, derivatives_data_active);
+          apply_VVW_scaling(F, dF, f, F0, band, i, derivatives_data, derivatives_data_active);
           break;
         case Absorption::NormalizationType::RosenkranzQuadratic:
-          apply_rosenkranz_quadratic_scaling(F, dF, f, band.F0(i), T, band, i, derivatives_data, derivatives_data_active);
+          apply_rosenkranz_quadratic_scaling(F, dF, f, F0, T, band, i, derivatives_data, derivatives_data_active);
           break;
       }
 
@@ -1497,7 +1814,10 @@ void Linefunctions::set_cross_section_of_band(
         case Absorption::PopulationType::ByHITRANFullRelmat:
         case Absorption::PopulationType::ByHITRANRosenkranzRelmat:
         case Absorption::PopulationType::ByLTE:
-          apply_linestrength_scaling_by_lte(F, dF, N, dN, band.Line(i), T, band.T0(), isot_ratio, QT, QT0, band, i, derivatives_data, derivatives_data_active, dQTdT);
+          if (line_parameters and line_parameters -> S.nelem())
+            apply_linestrength_scaling_by_lte(F, dF, N, dN, line_parameters -> S[i], do_temperature ? line_parameters -> dSdT_div_S[i] : 0, T, band.T0(), band, i, derivatives_data, derivatives_data_active);
+          else
+            apply_linestrength_scaling_by_lte(F, dF, N, dN, band.Line(i), T, band.T0(), isot_ratio, QT, QT0, band, i, derivatives_data, derivatives_data_active, dQTdT);
           break;
         case Absorption::PopulationType::ByNLTEVibrationalTemperatures: {
           auto nlte_data = nlte.get_vibtemp_params(band, i, T);
@@ -1505,7 +1825,11 @@ void Linefunctions::set_cross_section_of_band(
         } break;
         case Absorption::PopulationType::ByNLTEPopulationDistribution: {
           auto nlte_data = nlte.get_ratio_params(band, i);
-          apply_linestrength_from_nlte_level_distributions(F, dF, N, dN, nlte_data.r_low, nlte_data.r_upp, band.g_low(i), band.g_upp(i), band.A(i), band.F0(i), T, band, i, derivatives_data, derivatives_data_active);
+          apply_linestrength_from_nlte_level_distributions(F, dF, N, dN, nlte_data.r_low, nlte_data.r_upp,
+                                                           compiled ? compiled -> g_low()[i] : band.g_low(i),
+                                                           compiled ? compiled -> g_upp()[i] : band.g_upp(i),
+                                                           compiled ? compiled -> A()[i] : band.A(i),
+                                                           F0, T, band, i, derivatives_data, derivatives_data_active);
         } break;
       }
       
@@ -41,6 +41,45 @@ namespace Linefunctions {
 /** Size required for data buffer */
 constexpr Index ExpectedDataSize() { return 2; }
 
+/** Accuracy of the Faddeeva function evaluation in the Voigt line shape */
+enum class FaddeevaAccuracy : Index {
+  Reference,  // The Faddeeva package, one point at a time
+  High,       // Weideman's rational approximation with 32 terms, vectorized
+  Fast,       // Weideman's rational approximation with 16 terms, vectorized
+};
+
+inline FaddeevaAccuracy string2faddeevaaccuracy(const String& in) {
+  if (in == "Reference")
+    return FaddeevaAccuracy::Reference;
+  else if (in == "High")
+    return FaddeevaAccuracy::High;
+  else if (in == "Fast")
+    return FaddeevaAccuracy::Fast;
+  else
+    throw std::runtime_error("Cannot recognize the Faddeeva accuracy: \"" + in +
+                             "\"\nValid options are: \"Reference\", \"High\", and \"Fast\"");
+}
+
+/** Sets the Faddeeva function for a whole vector of arguments
+ * 
+ * The Reference accuracy calls the Faddeeva package for every point.  The
+ * other options use the rational approximation by Weideman (SIAM J. Numer.
+ * Anal. 31, 1994) written as a single branch-free loop that the compiler
+ * vectorizes for the instruction set it targets (e.g., AVX2 or AVX-512 with
+ * -march=native).  High has a relative error below 1e-12 and Fast below 1e-6.
+ * The approximation is only used near the line center, i.e., where the
+ * Faddeeva package itself is expensive.  Elsewhere, including Im(z) < 0,
+ * the Faddeeva package is used so that the line wings and the derivatives
+ * there keep the reference accuracy.
+ * 
+ * @param[out] W The Faddeeva function.  Must be right size
+ * @param[in]  z The arguments
+ * @param[in]  accuracy The accuracy of the evaluation
+ */
+void set_faddeeva(Eigen::Ref<Eigen::VectorXcd> W,
+                  const Eigen::Ref<const Eigen::VectorXcd> z,
+                  const FaddeevaAccuracy accuracy);
+
 /** Sets the lineshape normalized to unity.
  * 
  * No line mixing or linestrength is computed.
@@ -159,6 +198,7 @@ void set_htp(Eigen::Ref<Eigen::VectorXcd> F,
  * @param[in]     dGD_div_F0_dT Temperature derivative of GD_div_F0
  * @param[in]     dT Temperature derivatives of line shape parameters
  * @param[in]     dVMR VMR derivatives of line shape parameters
+ * @param[in]     accuracy Accuracy of the Faddeeva function
  */
 void set_voigt(
     Eigen::Ref<Eigen::VectorXcd> F,
@@ -177,7 +217,8 @@ void set_voigt(
     const ArrayOfIndex& derivatives_data_position = ArrayOfIndex(),
     const Numeric& dGD_div_F0_dT = 0.0,
     const LineShape::Output& dT = {0, 0, 0, 0, 0, 0, 0, 0, 0},
-    const LineShape::Output& dVMR = {0, 0, 0, 0, 0, 0, 0, 0, 0});
+    const LineShape::Output& dVMR = {0, 0, 0, 0, 0, 0, 0, 0, 0},
+    const FaddeevaAccuracy accuracy = FaddeevaAccuracy::Reference);
 
 /** Sets the Doppler line shape. Normalization is unity.
  * 
@@ -377,6 +418,38 @@ void apply_linestrength_scaling_by_lte(
     const ArrayOfIndex& derivatives_data_position = ArrayOfIndex(),
     const Numeric& dQT_dT = 0.0);
 
+/** Applies precomputed LTE linestrength to already set line shape
+ * 
+ * Same as the other apply_linestrength_scaling_by_lte but with the line
+ * strength taken from Absorption::CompiledLines::SetStrengthParameters
+ * 
+ * @param[in,out] F Lineshape.  Must be right size
+ * @param[in,out] dF Lineshape derivative.  Must be right size
+ * @param[in,out] N Source lineshape
+ * @param[in,out] dN Source lineshape derivative
+ * @param[in]     S The line strength
+ * @param[in]     dSdT_div_S Temperature derivative of S divided by S
+ * @param[in]     T The atmospheric temperature
+ * @param[in]     T0 The reference temperature
+ * @param[in]     band The absorption lines
+ * @param[in]     line_ind The current line's ID
+ * @param[in]     derivatives_data The derivatives in dF
+ * @param[in]     derivatives_data_position The derivatives positions in dF
+ */
+void apply_linestrength_scaling_by_lte(
+    Eigen::Ref<Eigen::VectorXcd> F,
+    Eigen::Ref<Eigen::MatrixXcd> dF,
+    Eigen::Ref<Eigen::VectorXcd> N,
+    Eigen::Ref<Eigen::MatrixXcd> dN,
+    const Numeric& S,
+    const Numeric& dSdT_div_S,
+    const Numeric& T,
+    const Numeric& T0,
+    const AbsorptionLines& band,
+    const Index& line_ind,
+    const ArrayOfRetrievalQuantity& derivatives_data,
+    const ArrayOfIndex& derivatives_data_position);
+
 /** Applies linestrength to already set line shape by vibrational level temperatures
  * 
  * @param[in,out] F Lineshape.  Must be right size
@@ -574,6 +647,19 @@ public:
  * @param[in] no_negatives Check sum.F before output of any real negative values, and removes them if present
  * @param[in] zeeman Attempts adding up the fine Zeeman lines
  * @param[in] zeeman_polarization The polarization of Zeeman model (to know how many Zeeman lines there will be)
+ * @param[in] line_start First line of the band to compute
+ * @param[in] line_count Number of lines to compute; negative means all lines from line_start
+ * @param[in] faddeeva_accuracy Accuracy of the Faddeeva function in Voigt line shapes
+ * @param[in] line_parameters Line parameters of all lines of the band at (T, P, vmrs), or nullptr to compute them line by line
+ * @param[in] sparse_accuracy Relative accuracy of line wings interpolated from a coarse grid, or 0 to compute all of f_grid
+ * 
+ * Note that no_negatives is only meaningful when all lines of the band are summed
+ * 
+ * If sparse_accuracy is positive and f_grid is increasing and large enough
+ * to benefit, each line is computed exactly on f_grid only near its center.
+ * Its wings are computed on a uniform coarse grid, chosen from
+ * sparse_accuracy and the size of f_grid, and linearly interpolated onto
+ * f_grid.  This is ignored together with no_negatives or zeeman.
  */
 void set_cross_section_of_band(
   InternalData& scratch,
@@ -595,7 +681,12 @@ void set_cross_section_of_band(
   const Numeric& QT0,
   const bool no_negatives=false,
   const bool zeeman=false,
-  const Zeeman::Polarization zeeman_polarization=Zeeman::Polarization::Pi);
+  const Zeeman::Polarization zeeman_polarization=Zeeman::Polarization::Pi,
+  const Index line_start=0,
+  const Index line_count=-1,
+  const FaddeevaAccuracy faddeeva_accuracy=FaddeevaAccuracy::Reference,
+  const Absorption::CompiledLineParameters* line_parameters=nullptr,
+  const Numeric sparse_accuracy=0);
 };  // namespace Linefunctions
 
 #endif  //linefunctions_h
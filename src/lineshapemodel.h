@@ -355,46 +355,118 @@ constexpr Index nmaxTempModelParams = 4;
 /** Current max number of line shape variables */
 constexpr Index nVars = 9;
 
-/** Compute the line shape parameters for a single broadening species */
-class SingleSpeciesModel {
- private:
-  std::array<ModelParameters, nVars> X;
+/** Line mixing as done by AER data in ARTS
+ * 
+ * Uses piece-wise linear interpolation and extrapolates at the edges
+ * 
+ * @param[in] T The temperature
+ * @param[in] mp The model parameters
+ * 
+ * @return The broadening parameter at temperature
+ */
+constexpr Numeric special_linemixing_aer(Numeric T, ModelParameters mp) noexcept {
+  if (T < 250)
+    return mp.X0 + (T - 200) * (mp.X1 - mp.X0) / (250 - 200);
+  else if (T > 296)
+    return mp.X2 + (T - 296) * (mp.X3 - mp.X2) / (340 - 296);
+  else
+    return mp.X1 + (T - 250) * (mp.X2 - mp.X1) / (296 - 250);
+}
 
-  /** Line mixing as done by AER data in ARTS
-   * 
-   * Uses piece-wise linear interpolation and extrapolates at the edges
-   * 
-   * var must be G or Y
-   * 
-   * @param[in] T The temperature
-   * @param[in] var The variable
-   * 
-   * @return The broadening parameter at temperature
-   */
-  constexpr Numeric special_linemixing_aer(Numeric T, ModelParameters mp) const noexcept {
-    if (T < 250)
-      return mp.X0 + (T - 200) * (mp.X1 - mp.X0) / (250 - 200);
-    else if (T > 296)
-      return mp.X2 + (T - 296) * (mp.X3 - mp.X2) / (340 - 296);
-    else
-      return mp.X1 + (T - 250) * (mp.X2 - mp.X1) / (296 - 250);
+/** The temperature derivative of special_linemixing_aer
+ * 
+ * @param[in] T The temperature
+ * @param[in] mp The model parameters
+ * 
+ * @return The temperature derivative of the broadening parameter at temperature
+ */
+constexpr Numeric special_linemixing_aer_dT(Numeric T, ModelParameters mp) noexcept {
+  if (T < 250)
+    return (mp.X1 - mp.X0) / (250 - 200);
+  else if (T > 296)
+    return (mp.X3 - mp.X2) / (340 - 296);
+  else
+    return (mp.X2 - mp.X1) / (296 - 250);
+}
+
+/** Compute a temperature model at the input
+ * 
+ * @param[in] mp The model parameters
+ * @param[in] T The temperature
+ * @param[in] T0 The temperature used to derive the coefficients
+ * 
+ * @return The parameter at temperature
+ */
+inline Numeric compute_model(const ModelParameters& mp, Numeric T, Numeric T0) noexcept {
+  using std::log;
+  using std::pow;
+  
+  Numeric out=std::numeric_limits<Numeric>::quiet_NaN();
+  switch (mp.type) {
+    case TemperatureModel::None:
+      out = 0; break;
+    case TemperatureModel::T0:
+      out = mp.X0; break;
+    case TemperatureModel::T1:
+      out = mp.X0 * pow(T0 / T, mp.X1); break;
+    case TemperatureModel::T2:
+      out = mp.X0 * pow(T0 / T, mp.X1) * (1 + mp.X2 * log(T / T0)); break;
+    case TemperatureModel::T3:
+      out = mp.X0 + mp.X1 * (T - T0); break;
+    case TemperatureModel::T4:
+      out = (mp.X0 + mp.X1 * (T0 / T - 1.)) * pow(T0 / T, mp.X2); break;
+    case TemperatureModel::T5:
+      out = mp.X0 * pow(T0 / T, 0.25 + 1.5 * mp.X1); break;
+    case TemperatureModel::LM_AER:
+      out = special_linemixing_aer(T, mp); break;
+    case TemperatureModel::DPL:
+      out = mp.X0 * pow(T0 / T, mp.X1) + mp.X2 * pow(T0 / T, mp.X3); break;
   }
+  return out;
+}
+
+/** Derivative of compute_model(...) wrt T
+ * 
+ * @param[in] mp The model parameters
+ * @param[in] T The temperature
+ * @param[in] T0 The temperature used to derive the coefficients
+ * 
+ * @return Derivative of compute_model(...) wrt T
+ */
+inline Numeric compute_model_dT(const ModelParameters& mp, Numeric T, Numeric T0) noexcept {
+  using std::log;
+  using std::pow;
   
-  /** The temperature derivative of special_linemixing_aer
-   * 
-   * @param[in] T The temperature
-   * @param[in] var The variable
-   * 
-   * @return The temperature derivative of the broadening parameter at temperature
-   */
-  constexpr Numeric special_linemixing_aer_dT(Numeric T, ModelParameters mp) const noexcept {
-    if (T < 250)
-      return (mp.X1 - mp.X0) / (250 - 200);
-    else if (T > 296)
-      return (mp.X3 - mp.X2) / (340 - 296);
-    else
-      return (mp.X2 - mp.X1) / (296 - 250);
+  Numeric out=std::numeric_limits<Numeric>::quiet_NaN();
+  switch (mp.type) {
+    case TemperatureModel::None:
+      out = 0; break;
+    case TemperatureModel::T0:
+      out = 0; break;
+    case TemperatureModel::T1:
+      out = -mp.X0 * mp.X1 * pow(T0 / T, mp.X1) / T; break;
+    case TemperatureModel::T2:
+      out = -mp.X0 * mp.X1 * pow(T0 / T, mp.X1) * (mp.X2 * log(T / T0) + 1.) / T +
+      mp.X0 * mp.X2 * pow(T0 / T, mp.X1) / T; break;
+    case TemperatureModel::T3:
+      out = mp.X1; break;
+    case TemperatureModel::T4:
+      out = -mp.X2 * pow(T0 / T, mp.X2) * (mp.X0 + mp.X1 * (T0 / T - 1.)) / T -
+      T0 * mp.X1 * pow(T0 / T, mp.X2) / pow(T, 2); break;
+    case TemperatureModel::T5:
+      out = -mp.X0 * pow(T0 / T, 1.5 * mp.X1 + 0.25) * (1.5 * mp.X1 + 0.25) / T; break;
+    case TemperatureModel::LM_AER:
+      out = special_linemixing_aer_dT(T, mp); break;
+    case TemperatureModel::DPL:
+      out = -mp.X0 * mp.X1 * pow(T0 / T, mp.X1) / T + -mp.X2 * mp.X3 * pow(T0 / T, mp.X3) / T; break;
   }
+  return out;
+}
+
+/** Compute the line shape parameters for a single broadening species */
+class SingleSpeciesModel {
+ private:
+  std::array<ModelParameters, nVars> X;
 
  public:
   /** Default initialization */
@@ -424,31 +496,7 @@ class SingleSpeciesModel {
  * @return The broadening parameter at temperature
  */
 Numeric compute(Numeric T, Numeric T0, Variable var) const noexcept {
-  using std::log;
-  using std::pow;
-  
-  Numeric out=std::numeric_limits<Numeric>::quiet_NaN();
-  switch (X[Index(var)].type) {
-    case TemperatureModel::None:
-      out = 0; break;
-    case TemperatureModel::T0:
-      out = x0; break;
-    case TemperatureModel::T1:
-      out = x0 * pow(T0 / T, x1); break;
-    case TemperatureModel::T2:
-      out = x0 * pow(T0 / T, x1) * (1 + x2 * log(T / T0)); break;
-    case TemperatureModel::T3:
-      out = x0 + x1 * (T - T0); break;
-    case TemperatureModel::T4:
-      out = (x0 + x1 * (T0 / T - 1.)) * pow(T0 / T, x2); break;
-    case TemperatureModel::T5:
-      out = x0 * pow(T0 / T, 0.25 + 1.5 * x1); break;
-    case TemperatureModel::LM_AER:
-      out = special_linemixing_aer(T, X[Index(var)]); break;
-    case TemperatureModel::DPL:
-      out = x0 * pow(T0 / T, x1) + x2 * pow(T0 / T, x3); break;
-  }
-  return out;
+  return compute_model(X[Index(var)], T, T0);
 }
 
 /** Derivative of compute(...) wrt x0
@@ -604,33 +652,7 @@ Numeric compute_dX3(Numeric T, Numeric T0, Variable var) const noexcept {
  * @return Derivative of compute(...) wrt T
  */
 Numeric compute_dT(Numeric T, Numeric T0, Variable var) const noexcept {
-  using std::log;
-  using std::pow;
-  
-  Numeric out=std::numeric_limits<Numeric>::quiet_NaN();
-  switch (X[Index(var)].type) {
-    case TemperatureModel::None:
-      out = 0; break;
-    case TemperatureModel::T0:
-      out = 0; break;
-    case TemperatureModel::T1:
-      out = -x0 * x1 * pow(T0 / T, x1) / T; break;
-    case TemperatureModel::T2:
-      out = -x0 * x1 * pow(T0 / T, x1) * (x2 * log(T / T0) + 1.) / T +
-      x0 * x2 * pow(T0 / T, x1) / T; break;
-    case TemperatureModel::T3:
-      out = x1; break;
-    case TemperatureModel::T4:
-      out = -x2 * pow(T0 / T, x2) * (x0 + x1 * (T0 / T - 1.)) / T -
-      T0 * x1 * pow(T0 / T, x2) / pow(T, 2); break;
-    case TemperatureModel::T5:
-      out = -x0 * pow(T0 / T, 1.5 * x1 + 0.25) * (1.5 * x1 + 0.25) / T; break;
-    case TemperatureModel::LM_AER:
-      out = special_linemixing_aer_dT(T, X[Index(var)]); break;
-    case TemperatureModel::DPL:
-      out = -x0 * x1 * pow(T0 / T, x1) / T + -x2 * x3 * pow(T0 / T, x3) / T; break;
-  }
-  return out;
+  return compute_model_dT(X[Index(var)], T, T0);
 }
 
 /** Derivative of compute(...) wrt T0
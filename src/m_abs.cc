@@ -1825,11 +1825,21 @@ void abs_xsec_per_speciesAddLines(
     const SpeciesAuxData& isotopologue_ratios,
     const SpeciesAuxData& partition_functions,
     const Index& lbl_checked,
+    const String& faddeeva_accuracy,
+    const Index& line_parameter_cache,
+    const Numeric& sparse_accuracy,
+    const String& parallel_mode,
     const Verbosity&) {
   if (not abs_lines_per_species.nelem()) return;
   
   if (not lbl_checked)
     throw std::runtime_error("Please set lbl_checked true to use this function");
+  
+  if (line_parameter_cache < 0)
+    throw std::runtime_error("*line_parameter_cache* must be non-negative");
+  
+  if (sparse_accuracy < 0 or sparse_accuracy >= 1)
+    throw std::runtime_error("*sparse_accuracy* must be in [0, 1)");
 
   // Check that all temperatures are above 0 K
   if (min(abs_t) < 0) {
@@ -1859,6 +1869,8 @@ void abs_xsec_per_speciesAddLines(
   }
 
   // Meta variables that explain the calculations required
+  const auto voigt_accuracy = Linefunctions::string2faddeevaaccuracy(faddeeva_accuracy);
+  const auto xsec_parallel_mode = string2xsecparallelmode(parallel_mode);
   const bool do_jac = supports_propmat_clearsky(jacobian_quantities);
   const bool do_lte = abs_nlte.Data().empty();
   const ArrayOfIndex jac_pos = equivalent_propmattype_indexes(jacobian_quantities);
@@ -1866,7 +1878,7 @@ void abs_xsec_per_speciesAddLines(
   // Skipping uninteresting data
   static Matrix dummy1(0, 0);
   static ArrayOfMatrix dummy2(0);
-
+  
   // Call xsec_species for each tag group.
   for (Index ii = 0; ii < abs_species_active.nelem(); ++ii) {
     const Index i = abs_species_active[ii];
@@ -1893,7 +1905,11 @@ void abs_xsec_per_speciesAddLines(
           lines,
           isotopologue_ratios.getIsotopologueRatio(lines.QuantumIdentity()),
           partition_functions.getParamType(lines.QuantumIdentity()),
-          partition_functions.getParam(lines.QuantumIdentity()));
+          partition_functions.getParam(lines.QuantumIdentity()),
+          voigt_accuracy,
+          line_parameter_cache,
+          sparse_accuracy,
+          xsec_parallel_mode);
     }
   }  // End of species for loop.
 }
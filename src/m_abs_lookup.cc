@@ -24,6 +24,7 @@
 */
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <map>
 
@@ -34,6 +35,7 @@
 #include "auto_md.h"
 #include "check_input.h"
 #include "cloudbox.h"
+#include "file.h"
 #include "gas_abs_lookup.h"
 #include "global_data.h"
 #include "interpolation_poly.h"
@@ -56,6 +58,203 @@ void abs_lookupInit(GasAbsLookup& x, const Verbosity& verbosity) {
   out2 << "  Created an empty gas absorption lookup table.\n";
 }
 
+//! Calculate the absorption cross sections of a lookup table.
+/*!
+  The calculations for the different species, H2O VMR perturbations,
+  and temperature perturbations are independent of each other, and are
+  done together in one parallel loop. Each calculation covers all
+  pressures at once.
+
+  \param[in,out] ws Workspace.
+  \param[out] xsec The cross sections, with the dimensions of
+              GasAbsLookup::xsec. Values that are not calculated are NaN.
+  \param[in] abs_species The species of the table.
+  \param[in] non_linear Flags for the nonlinear species.
+  \param[in] h2o_index The index of the H2O species, or -1.
+  \param[in] calc_species Flags for the species to calculate.
+  \param[in] f_grid The frequency grid.
+  \param[in] abs_p The pressure grid.
+  \param[in] abs_vmrs The reference VMR profiles.
+  \param[in] abs_t The reference temperature profile.
+  \param[in] abs_t_pert The temperature perturbations, can be empty.
+  \param[in] abs_nls_pert The H2O VMR perturbations, can be empty.
+  \param[in] abs_xsec_agenda The agenda to calculate cross sections.
+  \param[in] verbosity Verbosity settings.
+
+  \date 2026-10-16
+*/
+void abs_lookup_calc_xsec(Workspace& ws,
+                          Tensor4& xsec,
+                          const ArrayOfArrayOfSpeciesTag& abs_species,
+                          const ArrayOfIndex& non_linear,
+                          const Index& h2o_index,
+                          const ArrayOfIndex& calc_species,
+                          const Vector& f_grid,
+                          const Vector& abs_p,
+                          const Matrix& abs_vmrs,
+                          const Vector& abs_t,
+                          const Vector& abs_t_pert,
+                          const Vector& abs_nls_pert,
+                          const Agenda& abs_xsec_agenda,
+                          const Verbosity& verbosity) {
+  CREATE_OUT2;
+  CREATE_OUT3;
+
+  const Index n_species = abs_species.nelem();
+  const Index n_nls = std::count(non_linear.begin(), non_linear.end(), 1);
+  const Index n_nls_pert = abs_nls_pert.nelem();
+
+  // Set up these_t_pert. This is done so that we can use the
+  // same loop over the perturbations, independent of
+  // whether we have temperature perturbations or not.
+  Vector these_t_pert;
+  if (abs_t_pert.nelem()) {
+    these_t_pert = abs_t_pert;
+  } else {
+    these_t_pert.resize(1);
+    these_t_pert = 0;
+  }
+
+  xsec.resize(these_t_pert.nelem(),
+              n_species + n_nls * (n_nls_pert - 1),
+              f_grid.nelem(),
+              abs_p.nelem());
+  xsec = NAN;
+
+  // One task per species, H2O VMR perturbation, and temperature
+  // perturbation. page is the index for the second dimension of xsec.
+  struct Task {
+    Index species, nls, page, t;
+  };
+  std::vector<Task> tasks;
+  for (Index i = 0, page = 0; i < n_species; ++i) {
+    // Skipping Zeeman and free_electrons species.
+    // (Mixed tag groups between those and other species are not allowed.)
+    if (is_zeeman(abs_species[i]) ||
+        abs_species[i][0].Type() == SpeciesTag::TYPE_FREE_ELECTRONS ||
+        abs_species[i][0].Type() == SpeciesTag::TYPE_PARTICLES) {
+      page++;
+      continue;
+    }
+
+    const Index these_nls_pert = non_linear[i] ? n_nls_pert : 1;
+    if (not calc_species[i]) {
+      page += these_nls_pert;
+      continue;
+    }
+
+    for (Index s = 0; s < these_nls_pert; ++s, ++page)
+      for (Index j = 0; j < these_t_pert.nelem(); ++j)
+        tasks.push_back({i, s, page, j});
+  }
+  const Index n_tasks = Index(tasks.size());
+
+  out2 << "  Doing " << n_tasks << " absorption calculations for "
+       << n_species << " species and " << abs_p.nelem() << " pressures.\n";
+
+  String fail_msg;
+  bool failed = false;
+
+  // We have to make a local copy of the Workspace and the agenda because
+  // only non-reference types can be declared firstprivate in OpenMP
+  Workspace l_ws(ws);
+  Agenda l_abs_xsec_agenda(abs_xsec_agenda);
+
+  // Absorption cross sections per tag group.
+  ArrayOfMatrix abs_xsec_per_species, src_xsec_per_species;
+  ArrayOfArrayOfMatrix dabs_xsec_per_species_dx, dsrc_xsec_per_species_dx;
+
+  // Local copy of all VMRs, where we perturb the H2O profile as needed,
+  // and the perturbed temperature:
+  Matrix these_all_vmrs;
+  Vector this_t;
+  const EnergyLevelMap this_nlte_dummy;
+
+  // List of active species for agenda call. Will always be filled with only
+  // one species.
+  ArrayOfIndex abs_species_active(1);
+
+#pragma omp parallel for if (!arts_omp_in_parallel() &&                      \
+                             n_tasks >= arts_omp_get_max_threads())          \
+    private(this_t,                                                          \
+            these_all_vmrs,                                                  \
+            abs_xsec_per_species,                                            \
+            src_xsec_per_species,                                            \
+            dabs_xsec_per_species_dx,                                        \
+            dsrc_xsec_per_species_dx)                                        \
+    firstprivate(l_ws, l_abs_xsec_agenda, abs_species_active)
+  for (Index k = 0; k < n_tasks; ++k) {
+    // Skip remaining iterations if an error occurred
+    if (failed) continue;
+
+    // The try block here is necessary to correctly handle
+    // exceptions inside the parallel region.
+    try {
+      const Task& task = tasks[k];
+
+      // We first prepare the output in a string here, so that we can
+      // write it to out3 with a single operation. This avoids messy
+      // output from multiple threads.
+      {
+        ostringstream os;
+        os << "  Doing species " << task.species + 1 << " of " << n_species
+           << ": " << abs_species[task.species];
+        if (non_linear[task.species])
+          os << ", H2O VMR variant " << abs_nls_pert[task.nls];
+        if (abs_t_pert.nelem())
+          os << ", temperature variant " << these_t_pert[task.t];
+        os << ".\n";
+        out3 << os.str();
+      }
+
+      // Set active species:
+      abs_species_active[0] = task.species;
+
+      // Make a local copy of the VMRs, and manipulate the H2O VMR within it.
+      // Note: We do not need a runtime error check that h2o_index is ok
+      // here, because the caller throws an error if there is no H2O
+      // species although we need it.
+      these_all_vmrs = abs_vmrs;
+      if (h2o_index >= 0 and non_linear[task.species])
+        these_all_vmrs(h2o_index, joker) *= abs_nls_pert[task.nls];
+
+      // Create perturbed temperature profile:
+      this_t = abs_t;
+      this_t += these_t_pert[task.t];
+
+      // Call agenda to calculate absorption:
+      abs_xsec_agendaExecute(l_ws,
+                             abs_xsec_per_species,
+                             src_xsec_per_species,
+                             dabs_xsec_per_species_dx,
+                             dsrc_xsec_per_species_dx,
+                             abs_species,
+                             ArrayOfRetrievalQuantity(0),
+                             abs_species_active,
+                             f_grid,
+                             abs_p,
+                             this_t,
+                             this_nlte_dummy,
+                             these_all_vmrs,
+                             l_abs_xsec_agenda);
+
+      // Store in the right place. abs_xsec_per_species contains true
+      // absorption cross sections, so there is no division by the
+      // number density here.
+      xsec(task.t, task.page, joker, joker) =
+          abs_xsec_per_species[task.species];
+    } catch (const std::runtime_error& e) {
+#pragma omp critical(abs_lookup_calc_xsec_fail)
+      {
+        fail_msg = e.what();
+        failed = true;
+      }
+    }
+  }
+
+  if (failed) throw runtime_error(fail_msg);
+}
+
 /* Workspace method: Doxygen documentation will be auto-generated */
 void abs_lookupCalc(  // Workspace reference:
     Workspace& ws,
@@ -72,58 +271,24 @@ void abs_lookupCalc(  // Workspace reference:
     const Vector& abs_t_pert,
     const Vector& abs_nls_pert,
     const Agenda& abs_xsec_agenda,
+    // WS Generic Input:
+    const Index& single_precision,
     // Verbosity object:
     const Verbosity& verbosity) {
   CREATE_OUT2;
-  CREATE_OUT3;
-
-  // We need this temporary variable to make a local copy of all VMRs,
-  // where we then perturb the H2O profile as needed
-  Matrix these_all_vmrs = abs_vmrs;
 
   // We will be calling an absorption agenda one species at a
   // time. This is better than doing all simultaneously, because is
   // saves memory and allows for consistent treatment of nonlinear
-  // species. But it means we need local copies of species, line list,
-  // and line shapes for agenda communication.
-
-  // 1. Output of absorption calculations:
-
-  // Absorption coefficients:
-  Matrix these_abs_coef;
-
-  // Absorption cross sections per tag group.
-  ArrayOfMatrix abs_xsec_per_species, src_xsec_per_species;
-  ArrayOfArrayOfMatrix dabs_xsec_per_species_dx, dsrc_xsec_per_species_dx;
+  // species.
 
-  // 2. Determine various important sizes:
+  // Determine various important sizes:
   const Index n_species = abs_species.nelem();  // Number of abs species
   const Index n_nls = abs_nls.nelem();          // Number of nonlinear species
   const Index n_f_grid = f_grid.nelem();      // Number of frequency grid points
   const Index n_p_grid = abs_p.nelem();       // Number of presure grid points
-  const Index n_t_pert = abs_t_pert.nelem();  // Number of temp. perturbations
   const Index n_nls_pert = abs_nls_pert.nelem();  // Number of VMR pert. for NLS
 
-  // 3. Input to absorption calculations:
-
-  // Absorption vmrs and temperature:
-  Matrix this_vmr(1, n_p_grid);
-  Vector abs_h2o(n_p_grid);
-  Vector this_t;  // Has same dimension, but is
-                  // initialized by assignment later.
-  const EnergyLevelMap this_nlte_dummy;
-
-  // Species list, lines, and line shapes, all with only 1 element:
-  ArrayOfArrayOfSpeciesTag this_species(1);
-
-  // List of active species for agenda call. Will always be filled with only
-  // one species.
-  ArrayOfIndex abs_species_active(1);
-
-  // Local copy of nls_pert and t_pert:
-  Vector these_nls_pert;  // Is resized every time when used
-  Vector these_t_pert;    // Is resized later on
-
   // 4. Checks of input parameter correctness:
 
   const Index h2o_index = find_first_species_tg(
@@ -217,236 +382,702 @@ void abs_lookupCalc(  // Workspace reference:
   abs_lookup.log_p_grid.resize(n_p_grid);
   transform(abs_lookup.log_p_grid, log, abs_lookup.p_grid);
 
-  // 6. Create abs_lookup.xsec with the right dimensions:
-  {
-    Index a, b, c, d;
+  // 6. Calculate the cross sections:
+  abs_lookup.xsec_mapping.reset();
+  abs_lookup.xsec_single.reset();
+  abs_lookup_calc_xsec(ws,
+                       abs_lookup.xsec,
+                       abs_species,
+                       non_linear,
+                       h2o_index,
+                       ArrayOfIndex(n_species, 1),
+                       f_grid,
+                       abs_p,
+                       abs_vmrs,
+                       abs_t,
+                       abs_t_pert,
+                       abs_nls_pert,
+                       abs_xsec_agenda,
+                       verbosity);
 
-    if (0 == n_t_pert)
-      a = 1;
-    else
-      a = n_t_pert;
+  // 7. Initialize fgp_default.
+  abs_lookup.fgp_default.resize(f_grid.nelem());
+  gridpos_poly(abs_lookup.fgp_default, abs_lookup.f_grid, abs_lookup.f_grid, 0);
 
-    b = n_species + n_nls * (n_nls_pert - 1);
+  // 8. Store the table in the requested precision.
+  if (single_precision) {
+    out2 << "  Storing the table in single precision.\n";
+    abs_lookup.SetSinglePrecision(true);
+  }
 
-    c = n_f_grid;
+  // Set the abs_lookup_is_adapted flag. After all, the table fits the
+  // current frequency grid and species selection.
+  abs_lookup_is_adapted = 1;
+}
 
-    d = n_p_grid;
+//! Leave-one-out estimate of the interpolation error along a table grid.
+/*!
+  Each inner grid point is left out in turn, and the table values at
+  that point are interpolated from the remaining points. The error for
+  the point is the largest relative deviation between interpolated and
+  true values, in percent. Zero and non-finite values are ignored. The
+  outermost points can not be tested this way, and get zero error.
+
+  Because the interpolation is done over twice the local grid spacing,
+  the estimate is conservative for the grid as it is.
+
+  \param[out] error The error for each grid point [%].
+  \param[in] grid The grid.
+  \param[in] order The interpolation order along the grid.
+  \param[in] n_values The number of table values for each grid point.
+  \param[in] value Callable returning the table value for a grid point
+                   index and a value index.
+
+  \date 2026-10-16
+*/
+template <class Value>
+void leave_one_out_error(Vector& error,
+                         ConstVectorView grid,
+                         const Index& order,
+                         const Index& n_values,
+                         Value value) {
+  const Index n = grid.nelem();
+  error.resize(n);
+  error = 0;
+
+  if (n < 3) return;
+
+  const Index this_order = min(order, n - 2);
+  ArrayOfIndex others(n - 1);
+  Vector other_grid(n - 1);
+  GridPosPoly gp;
+
+  for (Index i = 1; i < n - 1; ++i) {
+    for (Index j = 0, k = 0; j < n; ++j)
+      if (j != i) {
+        others[k] = j;
+        other_grid[k] = grid[j];
+        ++k;
+      }
+    gridpos_poly(gp, other_grid, grid[i], this_order);
 
-    abs_lookup.xsec.resize(a, b, c, d);
-    abs_lookup.xsec = NAN;
-  }
+    for (Index v = 0; v < n_values; ++v) {
+      const Numeric truth = value(i, v);
+      if (truth == 0 or not std::isfinite(truth)) continue;
 
-  // 6.a. Set up these_t_pert. This is done so that we can use the
-  // same loop over the perturbations, independent of
-  // whether we have temperature perturbations or not.
-  if (0 != n_t_pert) {
-    out2 << "  With temperature perturbations.\n";
-    these_t_pert.resize(n_t_pert);
-    these_t_pert = abs_t_pert;
-  } else {
-    out2 << "  No temperature perturbations.\n";
-    these_t_pert.resize(1);
-    these_t_pert = 0;
+      Numeric interpolated = 0;
+      for (Index k = 0; k < gp.idx.nelem(); ++k)
+        interpolated += gp.w[k] * value(others[gp.idx[k]], v);
+
+      error[i] =
+          max(error[i], fabs(interpolated - truth) / fabs(truth) * 100);
+    }
   }
+}
 
-  const Index these_t_pert_nelem = these_t_pert.nelem();
+//! New grid points where a table grid is not fine enough.
+/*!
+  Both grid intervals next to a point with too large error are split in
+  the middle.
 
-  // 7. Now we have to fill abs_lookup.xsec with the right values!
+  \param[out] new_points The new grid points, in the same order as grid.
+  \param[in] grid The grid.
+  \param[in] error The error for each grid point [%].
+  \param[in] accuracy The largest allowed error [%].
+  \param[in] geometric Use the geometric instead of the arithmetic mean
+                       for the new points, if both neighbours are positive.
 
-  String fail_msg;
-  bool failed = false;
+  \date 2026-10-16
+*/
+void abs_lookup_refinement(Vector& new_points,
+                           ConstVectorView grid,
+                           ConstVectorView error,
+                           const Numeric& accuracy,
+                           const bool geometric) {
+  const Index n = grid.nelem();
+
+  // Flags for the intervals to split:
+  ArrayOfIndex split(max(n - 1, Index(0)), 0);
+  for (Index i = 0; i < n; ++i)
+    if (error[i] > accuracy) {
+      if (i > 0) split[i - 1] = 1;
+      if (i < n - 1) split[i] = 1;
+    }
 
-  // We have to make a local copy of the Workspace and the agenda because
-  // only non-reference types can be declared firstprivate in OpenMP
-  Workspace l_ws(ws);
-  Agenda l_abs_xsec_agenda(abs_xsec_agenda);
+  new_points.resize(std::count(split.begin(), split.end(), 1));
+  for (Index i = 0, k = 0; i < n - 1; ++i)
+    if (split[i]) {
+      if (geometric and grid[i] > 0 and grid[i + 1] > 0)
+        new_points[k++] = sqrt(grid[i] * grid[i + 1]);
+      else
+        new_points[k++] = (grid[i] + grid[i + 1]) / 2;
+    }
+}
 
-  // Loop species:
-  for (Index i = 0, spec = 0; i < n_species; ++i) {
-    // Skipping Zeeman and free_electrons species.
-    // (Mixed tag groups between those and other species are not allowed.)
-    if (is_zeeman(abs_species[i]) ||
-        abs_species[i][0].Type() == SpeciesTag::TYPE_FREE_ELECTRONS ||
-        abs_species[i][0].Type() == SpeciesTag::TYPE_PARTICLES) {
-      spec++;
-      continue;
+//! Merge new points into a sorted table grid.
+/*!
+  \param[out] merged The merged grid.
+  \param[out] old_pos The position of each old grid point in merged.
+  \param[out] new_pos The position of each new point in merged.
+  \param[in] grid The old grid, increasing or decreasing.
+  \param[in] new_points The new points, sorted like grid.
+
+  \date 2026-10-16
+*/
+void abs_lookup_merge_grid(Vector& merged,
+                           ArrayOfIndex& old_pos,
+                           ArrayOfIndex& new_pos,
+                           ConstVectorView grid,
+                           ConstVectorView new_points) {
+  const Index n_old = grid.nelem();
+  const Index n_new = new_points.nelem();
+  const bool decreasing = n_old > 1 and grid[0] > grid[n_old - 1];
+
+  merged.resize(n_old + n_new);
+  old_pos.resize(n_old);
+  new_pos.resize(n_new);
+
+  for (Index i = 0, j = 0, k = 0; k < n_old + n_new; ++k) {
+    const bool take_old =
+        j == n_new or
+        (i < n_old and (decreasing ? grid[i] > new_points[j]
+                                   : grid[i] < new_points[j]));
+    if (take_old) {
+      merged[k] = grid[i];
+      old_pos[i++] = k;
+    } else {
+      merged[k] = new_points[j];
+      new_pos[j++] = k;
     }
+  }
+}
+
+//! The first xsec page of each species in a lookup table.
+/*!
+  \param[in] non_linear Flags for the nonlinear species.
+  \param[in] n_nls_pert The number of H2O VMR perturbations.
+
+  \return The index of the first page of each species.
+
+  \date 2026-10-16
+*/
+ArrayOfIndex abs_lookup_first_pages(const ArrayOfIndex& non_linear,
+                                    const Index& n_nls_pert) {
+  ArrayOfIndex first_page(non_linear.nelem());
+  for (Index i = 0, page = 0; i < non_linear.nelem(); ++i) {
+    first_page[i] = page;
+    page += non_linear[i] ? n_nls_pert : 1;
+  }
+  return first_page;
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void abs_lookupCalcAdaptive(  // Workspace reference:
+    Workspace& ws,
+    // WS Output:
+    GasAbsLookup& abs_lookup,
+    Index& abs_lookup_is_adapted,
+    // WS Input:
+    const ArrayOfArrayOfSpeciesTag& abs_species,
+    const ArrayOfArrayOfSpeciesTag& abs_nls,
+    const Vector& f_grid,
+    const Vector& abs_p,
+    const Matrix& abs_vmrs,
+    const Vector& abs_t,
+    const Vector& abs_t_pert,
+    const Vector& abs_nls_pert,
+    const Index& abs_p_interp_order,
+    const Index& abs_t_interp_order,
+    const Index& abs_nls_interp_order,
+    const Agenda& abs_xsec_agenda,
+    // WS Generic Input:
+    const Numeric& accuracy,
+    const Index& max_iterations,
+    const Index& single_precision,
+    // Verbosity object:
+    const Verbosity& verbosity) {
+  CREATE_OUT2;
 
-    // spec is the index for the second dimension of abs_lookup.xsec.
+  if (accuracy <= 0) {
+    ostringstream os;
+    os << "The accuracy must be positive, but it is " << accuracy << ".";
+    throw runtime_error(os.str());
+  }
+  if (max_iterations < 0) {
+    ostringstream os;
+    os << "The number of iterations can not be negative, but it is "
+       << max_iterations << ".";
+    throw runtime_error(os.str());
+  }
 
-    // Prepare absorption agenda input for this species:
-    out2 << "  Doing species " << i + 1 << " of " << n_species << ": "
-         << abs_species[i] << ".\n";
+  // The table on the input grids. This also does all the input checks.
+  abs_lookupCalc(ws,
+                 abs_lookup,
+                 abs_lookup_is_adapted,
+                 abs_species,
+                 abs_nls,
+                 f_grid,
+                 abs_p,
+                 abs_vmrs,
+                 abs_t,
+                 abs_t_pert,
+                 abs_nls_pert,
+                 abs_xsec_agenda,
+                 0,
+                 verbosity);
+
+  const Index n_species = abs_species.nelem();
+  const Index n_f_grid = f_grid.nelem();
 
-    // Set active species:
-    abs_species_active[0] = i;
+  ArrayOfIndex non_linear(n_species, 0);
+  for (Index s : abs_lookup.NonLinearSpecies()) non_linear[s] = 1;
 
-    // Get a dummy list of tag groups with only the current element:
-    this_species[0].resize(abs_species[i].nelem());
-    this_species[0] = abs_species[i];
+  const Index h2o_index = find_first_species_tg(
+      abs_species, species_index_from_species_name("H2O"));
 
-    // Set up these_nls_pert. This is done so that we can use the
-    // same loop over the perturbations, independent of
-    // whether we have nonlinear species or not.
-    if (non_linear[i]) {
-      out2 << "  This is a species with H2O VMR perturbations.\n";
-      these_nls_pert.resize(n_nls_pert);
-      these_nls_pert = abs_nls_pert;
-    } else {
-      these_nls_pert.resize(1);
-      these_nls_pert = 1;
-    }
+  Vector error, new_points, merged;
+  ArrayOfIndex old_pos, new_pos;
+  Tensor4 new_xsec;
 
-    // Loop these_nls_pert:
-    for (Index s = 0; s < these_nls_pert.nelem(); ++s, ++spec) {
-      // Remember, spec is the index for the second dimension of
-      // abs_lookup.xsec
+  for (Index iteration = 0; iteration < max_iterations; ++iteration) {
+    bool refined = false;
 
-      if (non_linear[i]) {
-        out2 << "  Doing H2O VMR variant " << s + 1 << " of " << n_nls_pert
-             << ": " << abs_nls_pert[s] << ".\n";
-      }
+    // 1. Temperature perturbations:
+    {
+      const Tensor4& xsec = abs_lookup.Xsec();
+      const Index n_pages = xsec.npages(), n_p = xsec.ncols();
+      leave_one_out_error(error,
+                          abs_lookup.Tpert(),
+                          abs_t_interp_order,
+                          n_pages * n_f_grid * n_p,
+                          [&](Index i, Index v) {
+                            return xsec(i,
+                                        v / (n_f_grid * n_p),
+                                        v / n_p % n_f_grid,
+                                        v % n_p);
+                          });
+      abs_lookup_refinement(
+          new_points, abs_lookup.Tpert(), error, accuracy, false);
+    }
+    if (new_points.nelem()) {
+      out2 << "  Adding " << new_points.nelem()
+           << " temperature perturbations.\n";
+      abs_lookup_calc_xsec(ws,
+                           new_xsec,
+                           abs_species,
+                           non_linear,
+                           h2o_index,
+                           ArrayOfIndex(n_species, 1),
+                           f_grid,
+                           abs_lookup.Pgrid(),
+                           abs_lookup.VMRs(),
+                           abs_lookup.Tref(),
+                           new_points,
+                           abs_lookup.NLSPert(),
+                           abs_xsec_agenda,
+                           verbosity);
+      abs_lookup_merge_grid(
+          merged, old_pos, new_pos, abs_lookup.Tpert(), new_points);
+
+      Tensor4& xsec = abs_lookup.Xsec();
+      Tensor4 merged_xsec(
+          merged.nelem(), xsec.npages(), xsec.nrows(), xsec.ncols());
+      for (Index i = 0; i < old_pos.nelem(); ++i)
+        merged_xsec(old_pos[i], joker, joker, joker) = xsec(i, joker, joker, joker);
+      for (Index i = 0; i < new_pos.nelem(); ++i)
+        merged_xsec(new_pos[i], joker, joker, joker) =
+            new_xsec(i, joker, joker, joker);
+
+      xsec = std::move(merged_xsec);
+      abs_lookup.Tpert() = merged;
+      refined = true;
+    }
 
-      // Make a local copy of the VMRs, and manipulate the H2O VMR within it.
-      // Note: We do not need a runtime error check that h2o_index is ok here,
-      // because earlier on we throw an error if there is no H2O species although we
-      // need it. So, if h2o_indes is -1, we here simply assume that there
-      // should not be a perturbation
-      if (h2o_index >= 0) {
-        these_all_vmrs(h2o_index, joker) = abs_vmrs(h2o_index, joker);
-        these_all_vmrs(h2o_index, joker) *=
-            these_nls_pert[s];  // Add perturbation
+    // 2. H2O VMR perturbations, for all nonlinear species together:
+    {
+      const Tensor4& xsec = abs_lookup.Xsec();
+      const Index n_t = xsec.nbooks(), n_p = xsec.ncols();
+      const ArrayOfIndex first_page =
+          abs_lookup_first_pages(non_linear, abs_lookup.NLSPert().nelem());
+      Vector species_error;
+      error.resize(abs_lookup.NLSPert().nelem());
+      error = 0;
+      for (Index s : abs_lookup.NonLinearSpecies()) {
+        leave_one_out_error(species_error,
+                            abs_lookup.NLSPert(),
+                            abs_nls_interp_order,
+                            n_t * n_f_grid * n_p,
+                            [&](Index i, Index v) {
+                              return xsec(v / (n_f_grid * n_p),
+                                          first_page[s] + i,
+                                          v / n_p % n_f_grid,
+                                          v % n_p);
+                            });
+        for (Index i = 0; i < error.nelem(); ++i)
+          error[i] = max(error[i], species_error[i]);
+      }
+      abs_lookup_refinement(
+          new_points, abs_lookup.NLSPert(), error, accuracy, true);
+    }
+    if (new_points.nelem()) {
+      out2 << "  Adding " << new_points.nelem()
+           << " H2O VMR perturbations.\n";
+      abs_lookup_calc_xsec(ws,
+                           new_xsec,
+                           abs_species,
+                           non_linear,
+                           h2o_index,
+                           non_linear,
+                           f_grid,
+                           abs_lookup.Pgrid(),
+                           abs_lookup.VMRs(),
+                           abs_lookup.Tref(),
+                           abs_lookup.Tpert(),
+                           new_points,
+                           abs_xsec_agenda,
+                           verbosity);
+      abs_lookup_merge_grid(
+          merged, old_pos, new_pos, abs_lookup.NLSPert(), new_points);
+
+      Tensor4& xsec = abs_lookup.Xsec();
+      const ArrayOfIndex old_first =
+          abs_lookup_first_pages(non_linear, old_pos.nelem());
+      const ArrayOfIndex new_first =
+          abs_lookup_first_pages(non_linear, new_pos.nelem());
+      const ArrayOfIndex merged_first =
+          abs_lookup_first_pages(non_linear, merged.nelem());
+      Tensor4 merged_xsec(xsec.nbooks(),
+                          n_species + abs_lookup.NonLinearSpecies().nelem() *
+                                          (merged.nelem() - 1),
+                          xsec.nrows(),
+                          xsec.ncols());
+      for (Index s = 0; s < n_species; ++s) {
+        if (not non_linear[s]) {
+          merged_xsec(joker, merged_first[s], joker, joker) =
+              xsec(joker, old_first[s], joker, joker);
+          continue;
+        }
+        for (Index i = 0; i < old_pos.nelem(); ++i)
+          merged_xsec(joker, merged_first[s] + old_pos[i], joker, joker) =
+              xsec(joker, old_first[s] + i, joker, joker);
+        for (Index i = 0; i < new_pos.nelem(); ++i)
+          merged_xsec(joker, merged_first[s] + new_pos[i], joker, joker) =
+              new_xsec(joker, new_first[s] + i, joker, joker);
       }
 
-      // VMR for this species (still needed by interfact to continua):
-      // FIXME: This variable may go away eventually, when the continuum
-      // part no longer needs it.
-      this_vmr(0, joker) = these_all_vmrs(i, joker);
-
-      // For abs_h2o, we can always add the perturbations (it will
-      // not make a difference if the species itself is also H2O).
-      // Attention, we need to treat here also the case that there
-      // is no H2O species. We will then set abs_h2o to
-      // -1. Absorption routines that do not really need abs_h2o
-      // will still run.
-      //
-      // FIXME: abs_h2o is currently still needed by the continuum part.
-      // Should go away eventually.
-      if (h2o_index == -1) {
-        // The case without H2O species.
-        abs_h2o.resize(1);
-        abs_h2o = -1;
-      } else {
-        // The normal case.
-        abs_h2o = these_all_vmrs(h2o_index, joker);
+      xsec = std::move(merged_xsec);
+      abs_lookup.NLSPert() = merged;
+      refined = true;
+    }
+
+    // 3. Pressure levels, interpolated in log pressure:
+    {
+      const Tensor4& xsec = abs_lookup.Xsec();
+      const Index n_pages = xsec.npages();
+      leave_one_out_error(error,
+                          abs_lookup.LogPgrid(),
+                          abs_p_interp_order,
+                          xsec.nbooks() * n_pages * n_f_grid,
+                          [&](Index i, Index v) {
+                            return xsec(v / (n_pages * n_f_grid),
+                                        v / n_f_grid % n_pages,
+                                        v % n_f_grid,
+                                        i);
+                          });
+      abs_lookup_refinement(
+          new_points, abs_lookup.Pgrid(), error, accuracy, true);
+    }
+    if (new_points.nelem()) {
+      out2 << "  Adding " << new_points.nelem() << " pressure levels.\n";
+      abs_lookup_merge_grid(
+          merged, old_pos, new_pos, abs_lookup.Pgrid(), new_points);
+
+      // Reference temperatures and VMRs at the new levels are the mean of
+      // their neighbours.
+      const Matrix& vmrs = abs_lookup.VMRs();
+      const Vector& t_ref = abs_lookup.Tref();
+      Matrix new_vmrs(n_species, new_pos.nelem());
+      Vector new_t_ref(new_pos.nelem());
+      Matrix merged_vmrs(n_species, merged.nelem());
+      Vector merged_t_ref(merged.nelem());
+      for (Index i = 0; i < old_pos.nelem(); ++i) {
+        merged_vmrs(joker, old_pos[i]) = vmrs(joker, i);
+        merged_t_ref[old_pos[i]] = t_ref[i];
+      }
+      for (Index i = 0; i < new_pos.nelem(); ++i) {
+        // A new level is always between two old ones.
+        const Index k = new_pos[i];
+        const Index below = std::find(old_pos.begin(), old_pos.end(), k - 1) -
+                            old_pos.begin();
+        new_t_ref[i] = (t_ref[below] + t_ref[below + 1]) / 2;
+        for (Index s = 0; s < n_species; ++s)
+          new_vmrs(s, i) = (vmrs(s, below) + vmrs(s, below + 1)) / 2;
+        merged_vmrs(joker, k) = new_vmrs(joker, i);
+        merged_t_ref[k] = new_t_ref[i];
       }
 
-      // Loop temperature perturbations
-      // ------------------------------
-
-      // We use a parallel for loop for this.
-
-      // There is something strange here: abs_lookup seems to be
-      // "shared" by default, although I have set default(none). I
-      // suspect that the reason for this behavior is that
-      // abs_lookup is a return by reference parameter of this
-      // function. Anyway, shared is the correct setting for
-      // abs_lookup, so there is no problem.
-
-#pragma omp parallel for if (                                         \
-    !arts_omp_in_parallel() &&                                        \
-    these_t_pert_nelem >=                                             \
-        arts_omp_get_max_threads()) private(this_t,                   \
-                                            abs_xsec_per_species,     \
-                                            src_xsec_per_species,     \
-                                            dabs_xsec_per_species_dx, \
-                                            dsrc_xsec_per_species_dx) \
-    firstprivate(l_ws, l_abs_xsec_agenda)
-      for (Index j = 0; j < these_t_pert_nelem; ++j) {
-        // Skip remaining iterations if an error occurred
-        if (failed) continue;
-
-        // The try block here is necessary to correctly handle
-        // exceptions inside the parallel region.
-        try {
-          if (0 != n_t_pert) {
-            // We first prepare the output in a string here,
-            // so that we can write it to out3 with a single
-            // operation. This avoids messy output from
-            // multiple threads.
-            ostringstream os;
-
-            os << "  Doing temperature variant " << j + 1 << " of " << n_t_pert
-               << ": " << these_t_pert[j] << ".\n";
-
-            out3 << os.str();
-          }
+      abs_lookup_calc_xsec(ws,
+                           new_xsec,
+                           abs_species,
+                           non_linear,
+                           h2o_index,
+                           ArrayOfIndex(n_species, 1),
+                           f_grid,
+                           new_points,
+                           new_vmrs,
+                           new_t_ref,
+                           abs_lookup.Tpert(),
+                           abs_lookup.NLSPert(),
+                           abs_xsec_agenda,
+                           verbosity);
+
+      Tensor4& xsec = abs_lookup.Xsec();
+      Tensor4 merged_xsec(
+          xsec.nbooks(), xsec.npages(), xsec.nrows(), merged.nelem());
+      for (Index i = 0; i < old_pos.nelem(); ++i)
+        merged_xsec(joker, joker, joker, old_pos[i]) =
+            xsec(joker, joker, joker, i);
+      for (Index i = 0; i < new_pos.nelem(); ++i)
+        merged_xsec(joker, joker, joker, new_pos[i]) =
+            new_xsec(joker, joker, joker, i);
+
+      xsec = std::move(merged_xsec);
+      abs_lookup.Pgrid() = merged;
+      abs_lookup.LogPgrid().resize(merged.nelem());
+      transform(abs_lookup.LogPgrid(), log, merged);
+      abs_lookup.VMRs() = merged_vmrs;
+      abs_lookup.Tref() = merged_t_ref;
+      refined = true;
+    }
 
-          // Create perturbed temperature profile:
-          this_t = abs_lookup.t_ref;
-          this_t += these_t_pert[j];
-
-          // Call agenda to calculate absorption:
-          abs_xsec_agendaExecute(l_ws,
-                                 abs_xsec_per_species,
-                                 src_xsec_per_species,
-                                 dabs_xsec_per_species_dx,
-                                 dsrc_xsec_per_species_dx,
-                                 abs_species,
-                                 ArrayOfRetrievalQuantity(0),
-                                 abs_species_active,
-                                 f_grid,
-                                 abs_p,
-                                 this_t,
-                                 this_nlte_dummy,
-                                 these_all_vmrs,
-                                 l_abs_xsec_agenda);
-
-          // Store in the right place:
-          // Loop through all altitudes
-          for (Index p = 0; p < n_p_grid; ++p) {
-            abs_lookup.xsec(j, spec, Range(joker), p) =
-                abs_xsec_per_species[i](Range(joker), p);
-
-            // There used to be a division by the number density
-            // n here. This is no longer necessary, since
-            // abs_xsec_per_species now contains true absorption
-            // cross sections.
-
-            // IMPORTANT: There was a bug in my old Matlab
-            // function "create_lookup.m" to generate the lookup
-            // table. (The number density was always the
-            // reference one, and did not change for different
-            // temperatures.) Patricks Atmlab function
-            // "arts_abstable_from_arts1.m" did *not* have this bug.
-
-            // Calculate the number density for the given pressure and
-            // temperature:
-            // n = n0*T0/p0 * p/T or n = p/kB/t, ideal gas law
-            //                  const Numeric n = number_density( abs_lookup.p_grid[p],
-            //                                                    this_t[p]   );
-            //                  abs_lookup.xsec( j, spec, Range(joker), p ) /= n;
-          }
-        }  // end of try block
-        catch (const std::runtime_error& e) {
-#pragma omp critical(abs_lookupCalc_fail)
-          {
-            fail_msg = e.what();
-            failed = true;
-          }
-        }
-      }  // end of parallel for loop
+    if (not refined) {
+      out2 << "  All grids are fine enough after " << iteration
+           << " refinements.\n";
+      break;
+    }
+  }
 
-      if (failed) throw runtime_error(fail_msg);
+  out2 << "  The table has " << abs_lookup.Pgrid().nelem()
+       << " pressure levels, " << abs_lookup.Tpert().nelem()
+       << " temperature perturbations, and " << abs_lookup.NLSPert().nelem()
+       << " H2O VMR perturbations.\n";
+
+  if (single_precision) {
+    out2 << "  Storing the table in single precision.\n";
+    abs_lookup.SetSinglePrecision(true);
+  }
+
+  abs_lookup_is_adapted = 1;
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void abs_lookupCalcIncremental(  // Workspace reference:
+    Workspace& ws,
+    // WS Output:
+    GasAbsLookup& abs_lookup,
+    Index& abs_lookup_is_adapted,
+    // WS Input:
+    const ArrayOfArrayOfSpeciesTag& abs_species,
+    const ArrayOfArrayOfSpeciesTag& abs_nls,
+    const Vector& f_grid,
+    const Vector& abs_p,
+    const Matrix& abs_vmrs,
+    const Vector& abs_t,
+    const Vector& abs_t_pert,
+    const Vector& abs_nls_pert,
+    const Agenda& abs_xsec_agenda,
+    // Verbosity object:
+    const Verbosity& verbosity) {
+  CREATE_OUT2;
+
+  const Index n_species = abs_species.nelem();
+  const Index n_f_grid = f_grid.nelem();
+
+  chk_size("abs_vmrs", abs_vmrs, n_species, abs_p.nelem());
+  for (auto& tags : abs_nls)
+    if (std::find(abs_species.begin(), abs_species.end(), tags) ==
+        abs_species.end()) {
+      ostringstream os;
+      os << "Did not find *abs_nls* tag group \"" << get_tag_group_name(tags)
+         << "\" in *abs_species*.";
+      throw runtime_error(os.str());
     }
+
+  // Exact comparison of grids, as all reused cross-sections must have
+  // been calculated for the same atmospheric states
+  auto same = [](ConstVectorView a, ConstVectorView b) {
+    if (a.nelem() not_eq b.nelem()) return false;
+    for (Index i = 0; i < a.nelem(); ++i)
+      if (a[i] not_eq b[i]) return false;
+    return true;
+  };
+
+  // Position of each species in the old table, or -1 if it is new
+  const ArrayOfArrayOfSpeciesTag& old_species = abs_lookup.Species();
+  ArrayOfIndex old_species_pos(n_species, -1);
+  for (Index i = 0; i < n_species; ++i)
+    for (Index j = 0; j < old_species.nelem(); ++j)
+      if (abs_species[i] == old_species[j]) old_species_pos[i] = j;
+
+  // The nonlinear species must be the same in both tables
+  ArrayOfArrayOfSpeciesTag old_nls;
+  for (Index i : abs_lookup.NonLinearSpecies())
+    old_nls.push_back(old_species[i]);
+  bool same_nls = old_nls.nelem() == abs_nls.nelem();
+  for (auto& tags : abs_nls)
+    same_nls = same_nls and
+               std::find(old_nls.begin(), old_nls.end(), tags) not_eq
+                   old_nls.end();
+
+  // The reference profiles of the species in both tables must agree
+  bool same_vmrs = abs_vmrs.ncols() == abs_lookup.Pgrid().nelem();
+  for (Index i = 0; same_vmrs and i < n_species; ++i)
+    if (old_species_pos[i] >= 0)
+      same_vmrs = same(abs_vmrs(i, joker),
+                       abs_lookup.VMRs()(old_species_pos[i], joker));
+
+  if (not old_species.nelem() or not abs_lookup.Fgrid().nelem() or
+      not same(abs_p, abs_lookup.Pgrid()) or
+      not same(abs_t, abs_lookup.Tref()) or
+      not same(abs_t_pert, abs_lookup.Tpert()) or
+      not same(abs_nls_pert, abs_lookup.NLSPert()) or not same_nls or
+      not same_vmrs) {
+    out2 << "  The table can not be updated incrementally, as its pressure "
+         << "grid, reference profiles\n"
+         << "  or perturbations differ. Calculating the full table.\n";
+    abs_lookupCalc(ws,
+                   abs_lookup,
+                   abs_lookup_is_adapted,
+                   abs_species,
+                   abs_nls,
+                   f_grid,
+                   abs_p,
+                   abs_vmrs,
+                   abs_t,
+                   abs_t_pert,
+                   abs_nls_pert,
+                   abs_xsec_agenda,
+                   abs_lookup.IsSinglePrecision(),
+                   verbosity);
+    return;
   }
 
-  // 6. Initialize fgp_default.
-  abs_lookup.fgp_default.resize(f_grid.nelem());
-  gridpos_poly(abs_lookup.fgp_default, abs_lookup.f_grid, abs_lookup.f_grid, 0);
+  // Position of each frequency in the old table, or -1 if it is new
+  const Vector& old_f_grid = abs_lookup.Fgrid();
+  std::map<Numeric, Index> old_f_index;
+  for (Index j = 0; j < old_f_grid.nelem(); ++j) old_f_index[old_f_grid[j]] = j;
+  ArrayOfIndex old_f_pos(n_f_grid, -1);
+  for (Index i = 0; i < n_f_grid; ++i) {
+    const auto f = old_f_index.find(f_grid[i]);
+    if (f not_eq old_f_index.end()) old_f_pos[i] = f->second;
+  }
+
+  ArrayOfIndex new_f, kept_f, new_species(n_species, 0);
+  for (Index i = 0; i < n_f_grid; ++i)
+    (old_f_pos[i] < 0 ? new_f : kept_f).push_back(i);
+  for (Index i = 0; i < n_species; ++i) new_species[i] = old_species_pos[i] < 0;
+  const Index n_new_species =
+      std::count(new_species.begin(), new_species.end(), 1);
+
+  out2 << "  Calculating " << n_new_species << " new species, and "
+       << new_f.nelem() << " new frequencies for the other "
+       << n_species - n_new_species << " species.\n";
+
+  // The nonlinear species and the first page of each species, in the new
+  // and in the old table
+  ArrayOfIndex non_linear(n_species, 0), abs_nls_idx;
+  for (Index i = 0; i < n_species; ++i)
+    if (std::find(abs_nls.begin(), abs_nls.end(), abs_species[i]) not_eq
+        abs_nls.end()) {
+      non_linear[i] = 1;
+      abs_nls_idx.push_back(i);
+    }
+  ArrayOfIndex old_non_linear(old_species.nelem(), 0);
+  for (Index i : abs_lookup.NonLinearSpecies()) old_non_linear[i] = 1;
+  const Index n_nls_pert = abs_nls_pert.nelem();
+  const ArrayOfIndex first_page =
+      abs_lookup_first_pages(non_linear, n_nls_pert);
+  const ArrayOfIndex old_first_page =
+      abs_lookup_first_pages(old_non_linear, n_nls_pert);
+
+  const Index h2o_index = find_first_species_tg(
+      abs_species, species_index_from_species_name("H2O"));
+
+  // All species at the new frequencies, and the new species at the kept
+  // frequencies
+  Tensor4 xsec_new_f, xsec_new_species;
+  if (new_f.nelem()) {
+    Vector these_f(new_f.nelem());
+    for (Index i = 0; i < new_f.nelem(); ++i) these_f[i] = f_grid[new_f[i]];
+    abs_lookup_calc_xsec(ws,
+                         xsec_new_f,
+                         abs_species,
+                         non_linear,
+                         h2o_index,
+                         ArrayOfIndex(n_species, 1),
+                         these_f,
+                         abs_p,
+                         abs_vmrs,
+                         abs_t,
+                         abs_t_pert,
+                         abs_nls_pert,
+                         abs_xsec_agenda,
+                         verbosity);
+  }
+  if (n_new_species and kept_f.nelem()) {
+    Vector these_f(kept_f.nelem());
+    for (Index i = 0; i < kept_f.nelem(); ++i) these_f[i] = f_grid[kept_f[i]];
+    abs_lookup_calc_xsec(ws,
+                         xsec_new_species,
+                         abs_species,
+                         non_linear,
+                         h2o_index,
+                         new_species,
+                         these_f,
+                         abs_p,
+                         abs_vmrs,
+                         abs_t,
+                         abs_t_pert,
+                         abs_nls_pert,
+                         abs_xsec_agenda,
+                         verbosity);
+  }
+
+  // Merge the old and the new cross-sections
+  const bool single_precision = abs_lookup.IsSinglePrecision();
+  const Tensor4& old_xsec = abs_lookup.Xsec();
+  Tensor4 xsec(old_xsec.nbooks(),
+               n_species + abs_nls_idx.nelem() * (n_nls_pert - 1),
+               n_f_grid,
+               abs_p.nelem());
+  for (Index i = 0; i < n_species; ++i) {
+    const Index n_pages = non_linear[i] ? n_nls_pert : 1;
+    for (Index k = 0; k < n_pages; ++k) {
+      const Index page = first_page[i] + k;
+      for (Index j = 0; j < new_f.nelem(); ++j)
+        xsec(joker, page, new_f[j], joker) = xsec_new_f(joker, page, j, joker);
+      for (Index j = 0; j < kept_f.nelem(); ++j)
+        xsec(joker, page, kept_f[j], joker) =
+            new_species[i]
+                ? xsec_new_species(joker, page, j, joker)
+                : old_xsec(joker,
+                           old_first_page[old_species_pos[i]] + k,
+                           old_f_pos[kept_f[j]],
+                           joker);
+    }
+  }
+
+  // Set the table to the new species and frequencies
+  abs_lookup.Xsec() = std::move(xsec);
+  abs_lookup.Species() = abs_species;
+  abs_lookup.NonLinearSpecies() = abs_nls_idx;
+  abs_lookup.Fgrid() = f_grid;
+  abs_lookup.VMRs() = abs_vmrs;
+  abs_lookup.FGPDefault().resize(n_f_grid);
+  gridpos_poly(abs_lookup.FGPDefault(), f_grid, f_grid, 0);
+
+  if (single_precision) abs_lookup.SetSinglePrecision(true);
 
-  // Set the abs_lookup_is_adapted flag. After all, the table fits the
-  // current frequency grid and species selection.
   abs_lookup_is_adapted = 1;
 }
 
@@ -2013,11 +2644,39 @@ void abs_lookupAdapt(GasAbsLookup& abs_lookup,
                      Index& abs_lookup_is_adapted,
                      const ArrayOfArrayOfSpeciesTag& abs_species,
                      const Vector& f_grid,
+                     const Index& single_precision,
                      const Verbosity& verbosity) {
-  abs_lookup.Adapt(abs_species, f_grid, verbosity);
+  abs_lookup.Adapt(abs_species, f_grid, verbosity, single_precision);
   abs_lookup_is_adapted = 1;
 }
 
+/* Workspace method: Doxygen documentation will be auto-generated */
+void abs_lookupReadMapped(GasAbsLookup& abs_lookup,
+                          Index& abs_lookup_is_adapted,
+                          const String& filename,
+                          const Verbosity& verbosity) {
+  CREATE_OUT2;
+
+  String file = filename;
+  find_xml_file(file, verbosity);
+
+  out2 << "  Mapping " << file << '\n';
+  abs_lookup.ReadMapped(file);
+  abs_lookup_is_adapted = 0;
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void abs_lookupWriteMapped(const GasAbsLookup& abs_lookup,
+                           const String& filename,
+                           const Verbosity& verbosity) {
+  CREATE_OUT2;
+
+  const String file = expand_path(filename);
+
+  out2 << "  Writing " << file << '\n';
+  abs_lookup.WriteMapped(file);
+}
+
 /* Workspace method: Doxygen documentation will be auto-generated */
 void propmat_clearskyAddFromLookup(
     ArrayOfPropagationMatrix& propmat_clearsky,
@@ -2397,6 +3056,314 @@ void propmat_clearsky_fieldCalc(Workspace& ws,
   if (failed) throw runtime_error(fail_msg);
 }
 
+/* Workspace method: Doxygen documentation will be auto-generated */
+void propmat_clearsky_fieldCalcWithDerivatives(
+    Workspace& ws,
+    // WS Output:
+    Tensor7& propmat_clearsky_field,
+    Tensor7& dpropmat_clearsky_field_dx,
+    // WS Input:
+    const Index& atmfields_checked,
+    const Vector& f_grid,
+    const Index& stokes_dim,
+    const Vector& p_grid,
+    const Vector& lat_grid,
+    const Vector& lon_grid,
+    const Tensor3& t_field,
+    const Tensor4& vmr_field,
+    const EnergyLevelMap& nlte_field,
+    const Tensor3& mag_u_field,
+    const Tensor3& mag_v_field,
+    const Tensor3& mag_w_field,
+    const Index& jacobian_do,
+    const ArrayOfRetrievalQuantity& jacobian_quantities,
+    const Agenda& abs_agenda,
+    // WS Generic Input:
+    const Vector& los,
+    const Verbosity& verbosity) {
+  CREATE_OUT2;
+
+  chk_if_in_range("stokes_dim", stokes_dim, 1, 4);
+  if (atmfields_checked != 1)
+    throw runtime_error(
+        "The atmospheric fields must be flagged to have "
+        "passed a consistency check (atmfields_checked=1).");
+  if (not nlte_field.Data().empty())
+    throw runtime_error(
+        "NLTE source terms can not be stored, *nlte_field* must be empty.");
+
+  const Index n_species = vmr_field.nbooks();
+  const Index n_frequencies = f_grid.nelem();
+  const Index n_pressures = p_grid.nelem();
+  const Index n_latitudes = max(Index(1), lat_grid.nelem());
+  const Index n_longitudes = max(Index(1), lon_grid.nelem());
+  const Index n_points = n_pressures * n_latitudes * n_longitudes;
+
+  // The agenda returns the derivatives of the propagation matrix type
+  // quantities, the others are obtained from the field itself
+  const ArrayOfRetrievalQuantity jacobian_agenda =
+      jacobian_do ? jacobian_quantities : ArrayOfRetrievalQuantity(0);
+  const Index n_derivatives =
+      equivalent_propmattype_indexes(jacobian_agenda).nelem();
+
+  out2 << "  Creating propmat field for " << n_species << " species and "
+       << n_derivatives << " derivatives at " << n_points << " points.\n";
+
+  propmat_clearsky_field.resize(n_species,
+                                n_frequencies,
+                                stokes_dim,
+                                stokes_dim,
+                                n_pressures,
+                                n_latitudes,
+                                n_longitudes);
+  dpropmat_clearsky_field_dx.resize(n_derivatives,
+                                    n_frequencies,
+                                    stokes_dim,
+                                    stokes_dim,
+                                    n_pressures,
+                                    n_latitudes,
+                                    n_longitudes);
+
+  // Local copies for firstprivate, as in propmat_clearsky_fieldCalc
+  Workspace l_ws(ws);
+  Agenda l_abs_agenda(abs_agenda);
+
+  ArrayOfPropagationMatrix abs, dabs;
+  ArrayOfStokesVector nlte, dnlte, dnlte_source;
+  Vector a_vmr_list;
+  const EnergyLevelMap a_nlte_list;
+
+  String fail_msg;
+  bool failed = false;
+
+  // All points of the atmosphere are independent
+#pragma omp parallel for if (!arts_omp_in_parallel() &&                   \
+                             n_points >= arts_omp_get_max_threads())      \
+    firstprivate(l_ws, l_abs_agenda) private(abs,                         \
+                                             dabs,                        \
+                                             nlte,                        \
+                                             dnlte,                       \
+                                             dnlte_source,                \
+                                             a_vmr_list)
+  for (Index ipt = 0; ipt < n_points; ipt++) {
+    if (failed) continue;
+
+    const Index ipr = ipt / (n_latitudes * n_longitudes);
+    const Index ila = (ipt / n_longitudes) % n_latitudes;
+    const Index ilo = ipt % n_longitudes;
+
+    try {
+      a_vmr_list = vmr_field(joker, ipr, ila, ilo);
+
+      Vector this_rtp_mag(3, 0.);
+      if (mag_u_field.npages() != 0)
+        this_rtp_mag[0] = mag_u_field(ipr, ila, ilo);
+      if (mag_v_field.npages() != 0)
+        this_rtp_mag[1] = mag_v_field(ipr, ila, ilo);
+      if (mag_w_field.npages() != 0)
+        this_rtp_mag[2] = mag_w_field(ipr, ila, ilo);
+
+      propmat_clearsky_agendaExecute(l_ws,
+                                     abs,
+                                     nlte,
+                                     dabs,
+                                     dnlte,
+                                     dnlte_source,
+                                     jacobian_agenda,
+                                     f_grid,
+                                     this_rtp_mag,
+                                     los,
+                                     p_grid[ipr],
+                                     t_field(ipr, ila, ilo),
+                                     a_nlte_list,
+                                     a_vmr_list,
+                                     l_abs_agenda);
+
+      if (n_species != abs.nelem()) {
+        ostringstream os;
+        os << "The number of gas species in vmr_field is " << n_species
+           << ",\n"
+           << "but the number of species returned by the agenda is "
+           << abs.nelem() << ".";
+        throw runtime_error(os.str());
+      }
+      if (n_derivatives != dabs.nelem()) {
+        ostringstream os;
+        os << "The number of derivatives expected is " << n_derivatives
+           << ",\n"
+           << "but the number of derivatives returned by the agenda is "
+           << dabs.nelem() << ".";
+        throw runtime_error(os.str());
+      }
+      for (Index i = 0; i < abs.nelem(); i++) {
+        if (stokes_dim != abs[i].StokesDimensions() or
+            n_frequencies != abs[i].NumberOfFrequencies())
+          throw runtime_error(
+              "The agenda returned propagation matrices that do not match\n"
+              "*stokes_dim* and *f_grid*.");
+        abs[i].GetTensor3(
+            propmat_clearsky_field(i, joker, joker, joker, ipr, ila, ilo));
+      }
+      for (Index i = 0; i < dabs.nelem(); i++)
+        dabs[i].GetTensor3(
+            dpropmat_clearsky_field_dx(i, joker, joker, joker, ipr, ila, ilo));
+    } catch (const std::runtime_error& e) {
+#pragma omp critical(propmat_clearsky_fieldCalcWithDerivatives_fail)
+      {
+        fail_msg = e.what();
+        failed = true;
+      }
+    }
+  }
+
+  if (failed) throw runtime_error(fail_msg);
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void propmat_clearsky_fieldCalcFromLookup(
+    Tensor7& propmat_clearsky_field,
+    const Index& atmfields_checked,
+    const GasAbsLookup& abs_lookup,
+    const Index& abs_lookup_is_adapted,
+    const Index& abs_p_interp_order,
+    const Index& abs_t_interp_order,
+    const Index& abs_nls_interp_order,
+    const Index& abs_f_interp_order,
+    const Vector& f_grid,
+    const Index& stokes_dim,
+    const Vector& p_grid,
+    const Vector& lat_grid,
+    const Vector& lon_grid,
+    const Tensor3& t_field,
+    const Tensor4& vmr_field,
+    const Vector& doppler,
+    const Numeric& extpolfac,
+    const Verbosity&) {
+  chk_if_in_range("stokes_dim", stokes_dim, 1, 4);
+  if (atmfields_checked != 1)
+    throw runtime_error(
+        "The atmospheric fields must be flagged to have "
+        "passed a consistency check (atmfields_checked=1).");
+
+  if (1 != abs_lookup_is_adapted)
+    throw runtime_error(
+        "Gas absorption lookup table must be adapted,\n"
+        "use method abs_lookupAdapt.");
+
+  const Index n_species = vmr_field.nbooks();
+  const Index n_frequencies = f_grid.nelem();
+  const Index n_pressures = p_grid.nelem();
+  const Index n_latitudes = max(Index(1), lat_grid.nelem());
+  const Index n_longitudes = max(Index(1), lon_grid.nelem());
+
+  if (0 != doppler.nelem() && p_grid.nelem() != doppler.nelem()) {
+    ostringstream os;
+    os << "Variable doppler must either be empty, or match the dimension of "
+       << "p_grid.";
+    throw runtime_error(os.str());
+  }
+
+  // Only the diagonal of the propagation matrix is set by scalar gas
+  // absorption.  The first diagonal element is extracted in place and then
+  // copied to the others
+  propmat_clearsky_field.resize(n_species,
+                                n_frequencies,
+                                stokes_dim,
+                                stokes_dim,
+                                n_pressures,
+                                n_latitudes,
+                                n_longitudes);
+  propmat_clearsky_field = 0;
+
+  // The points of a batch run along one dimension of the field, so that each
+  // batch is extracted straight into a view of it.  In 3D and 2D, a batch is
+  // one line of longitudes or latitudes at one pressure level.  In 1D, the
+  // pressure levels are split into as few batches as there are threads, or
+  // are one batch each with Doppler shifts.
+  const Index n_threads =
+      arts_omp_in_parallel() ? 1 : Index(arts_omp_get_max_threads());
+  Index n_line, n_batches;
+  if (n_longitudes > 1) {
+    n_line = n_longitudes;
+    n_batches = n_pressures * n_latitudes;
+  } else if (n_latitudes > 1) {
+    n_line = n_latitudes;
+    n_batches = n_pressures;
+  } else {
+    n_line = doppler.nelem()
+                 ? 1
+                 : max(Index(1), (n_pressures + n_threads - 1) / n_threads);
+    n_batches = (n_pressures + n_line - 1) / n_line;
+  }
+
+  String fail_msg;
+  bool failed = false;
+
+#pragma omp parallel for if (!arts_omp_in_parallel() && n_batches > 1)
+  for (Index ib = 0; ib < n_batches; ib++) {
+    if (failed) continue;
+
+    try {
+      // The first point of the batch, and the number of points
+      Index ipr = ib, ila = 0, ilo = 0, n = n_line;
+      if (n_longitudes > 1) {
+        ipr = ib / n_latitudes;
+        ila = ib % n_latitudes;
+      } else if (n_latitudes == 1) {
+        ipr = ib * n_line;
+        n = min(n_line, n_pressures - ipr);
+      }
+
+      Tensor3View sga =
+          n_longitudes > 1
+              ? propmat_clearsky_field(
+                    joker, joker, 0, 0, ipr, ila, Range(ilo, n))
+              : n_latitudes > 1
+                    ? propmat_clearsky_field(
+                          joker, joker, 0, 0, ipr, Range(ila, n), ilo)
+                    : propmat_clearsky_field(
+                          joker, joker, 0, 0, Range(ipr, n), ila, ilo);
+
+      Vector p(n), t(n);
+      Matrix vmrs(n_species, n);
+      for (Index i = 0; i < n; i++) {
+        const Index jpr = n_longitudes > 1 or n_latitudes > 1 ? ipr : ipr + i;
+        const Index jla = n_longitudes == 1 and n_latitudes > 1 ? i : ila;
+        const Index jlo = n_longitudes > 1 ? i : ilo;
+        p[i] = p_grid[jpr];
+        t[i] = t_field(jpr, jla, jlo);
+        vmrs(joker, i) = vmr_field(joker, jpr, jla, jlo);
+      }
+
+      Vector this_f_grid = f_grid;
+      if (doppler.nelem()) this_f_grid += doppler[ipr];
+
+      abs_lookup.ExtractBatch(sga,
+                              abs_p_interp_order,
+                              abs_t_interp_order,
+                              abs_nls_interp_order,
+                              abs_f_interp_order,
+                              p,
+                              t,
+                              vmrs,
+                              this_f_grid,
+                              extpolfac);
+    } catch (const std::runtime_error& e) {
+#pragma omp critical(propmat_clearsky_fieldCalcFromLookup_fail)
+      {
+        fail_msg = e.what();
+        failed = true;
+      }
+    }
+  }
+
+  if (failed) throw runtime_error(fail_msg);
+
+  for (Index is = 1; is < stokes_dim; is++)
+    propmat_clearsky_field(joker, joker, is, is, joker, joker, joker) =
+        propmat_clearsky_field(joker, joker, 0, 0, joker, joker, joker);
+}
+
 /* Workspace method: Doxygen documentation will be auto-generated */
 void f_gridFromGasAbsLookup(Vector& f_grid,
                             const GasAbsLookup& abs_lookup,
@@ -36,12 +36,19 @@
   === External declarations
   ===========================================================================*/
 
+#include <unistd.h>
+#include <cerrno>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <sstream>
 using namespace std;
 
 #include "arts.h"
 #include "arts_omp.h"
 #include "auto_md.h"
+#include "batch_queue.h"
+#include "batch_stream.h"
 #include "math_funcs.h"
 #include "physics_funcs.h"
 #include "rte.h"
@@ -87,6 +94,8 @@ void ybatchCalc(Workspace& ws,
                 const Agenda& ybatch_calc_agenda,
                 // Control Parameters:
                 const Index& robust,
+                const String& filename,
+                const Index& resume,
                 const Verbosity& verbosity) {
   CREATE_OUTS;
 
@@ -107,6 +116,22 @@ void ybatchCalc(Workspace& ws,
   // increment this, so that we really get an accurate total count!)
   Index job_counter = 0;
 
+  // With a file, finished jobs are appended to it instead of being kept
+  // in the output arrays. Jobs already in the file are skipped.
+  std::unique_ptr<YbatchStream> stream;
+  std::vector<bool> skip_job(ybatch_n, false);
+  Index n_jobs = ybatch_n;
+  if (filename.nelem()) {
+    stream.reset(new YbatchStream(filename, resume));
+    for (Index i = 0; i < ybatch_n; i++)
+      if (stream->contains(ybatch_start + i)) {
+        skip_job[i] = true;
+        n_jobs--;
+      }
+    out2 << "  Streaming results to " << filename << ", " << ybatch_n - n_jobs
+         << " of " << ybatch_n << " jobs are already done\n";
+  }
+
   // Resize the output arrays:
   ybatch.resize(ybatch_n);
   ybatch_aux.resize(ybatch_n);
@@ -132,13 +157,13 @@ void ybatchCalc(Workspace& ws,
          ybatch_index++) {
       Index l_job_counter;  // Thread-local copy of job counter.
 
-      if (do_abort) continue;
+      if (do_abort || skip_job[ybatch_index]) continue;
 #pragma omp critical(ybatchCalc_job_counter)
       { l_job_counter = ++job_counter; }
 
       {
         ostringstream os;
-        os << "  Job " << l_job_counter << " of " << ybatch_n << ", Index "
+        os << "  Job " << l_job_counter << " of " << n_jobs << ", Index "
            << ybatch_start + ybatch_index << ", Thread-Id "
            << arts_omp_get_thread_num() << "\n";
         out2 << os.str();
@@ -157,10 +182,12 @@ void ybatchCalc(Workspace& ws,
                                   l_ybatch_calc_agenda);
 
         if (y.nelem()) {
+          if (!stream) {
 #pragma omp critical(ybatchCalc_assign_y)
-          ybatch[ybatch_index] = y;
+            ybatch[ybatch_index] = y;
 #pragma omp critical(ybatchCalc_assign_y_aux)
-          ybatch_aux[ybatch_index] = y_aux;
+            ybatch_aux[ybatch_index] = y_aux;
+          }
 
           // Dimensions of Jacobian:
           const Index Knr = jacobian.nrows();
@@ -183,11 +210,31 @@ void ybatchCalc(Workspace& ws,
               throw runtime_error(os.str());
             }
 
-            ybatch_jacobians[ybatch_index] = jacobian;
+            if (!stream) ybatch_jacobians[ybatch_index] = jacobian;
 
             // After creation, all individual Jacobi matrices in the array will be
             // empty (size zero). No need for explicit initialization.
           }
+
+          if (stream) {
+            std::string record;
+            ybatch_record_append(
+                record, ybatch_start + ybatch_index, y, y_aux, jacobian);
+
+            // A failed write is fatal, as the file can not be trusted
+            // anymore. Exceptions must not leave the critical section.
+            String write_error;
+#pragma omp critical(ybatchCalc_stream)
+            {
+              try {
+                stream->append_serialized(ybatch_start + ybatch_index, record);
+              } catch (const std::exception& e) {
+                write_error = e.what();
+                do_abort = true;
+              }
+            }
+            if (write_error.nelem()) throw runtime_error(write_error);
+          }
         }
       } catch (const std::exception& e) {
         if (robust && !do_abort) {
@@ -234,6 +281,180 @@ void ybatchCalc(Workspace& ws,
   }
 }
 
+/** Computes one ybatch job and returns it as a batch stream record */
+static std::string ybatch_job_record(Workspace& ws,
+                                     const Agenda& ybatch_calc_agenda,
+                                     const Index ybatch_index) {
+  Vector y;
+  ArrayOfVector y_aux;
+  Matrix jacobian;
+
+  ybatch_calc_agendaExecute(
+      ws, y, y_aux, jacobian, ybatch_index, ybatch_calc_agenda);
+
+  if ((jacobian.nrows() != 0 || jacobian.ncols() != 0) &&
+      jacobian.nrows() != y.nelem()) {
+    ostringstream os;
+    os << "First dimension of Jacobian must have same length as the measurement *y*.\n"
+       << "Length of *y*: " << y.nelem() << "\n"
+       << "Dimensions of *jacobian*: (" << jacobian.nrows() << ", "
+       << jacobian.ncols() << ")\n";
+    throw runtime_error(os.str());
+  }
+
+  std::string record;
+  ybatch_record_append(record, ybatch_index, y, y_aux, jacobian);
+  return record;
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void ybatchCalcCoordinator(Workspace& ws,
+                           // WS Output:
+                           ArrayOfVector& ybatch,
+                           ArrayOfArrayOfVector& ybatch_aux,
+                           ArrayOfMatrix& ybatch_jacobians,
+                           // WS Input:
+                           const Index& ybatch_start,
+                           const Index& ybatch_n,
+                           const Agenda& ybatch_calc_agenda,
+                           // Control Parameters:
+                           const Index& nworkers,
+                           const Index& port,
+                           const Index& robust,
+                           const Index& max_attempts,
+                           const String& filename,
+                           const Index& resume,
+                           const Verbosity& verbosity) {
+  CREATE_OUTS;
+
+  if (arts_omp_in_parallel())
+    throw runtime_error(
+        "ybatchCalcCoordinator can not be used in a parallel region.");
+  if (max_attempts < 1)
+    throw runtime_error("*max_attempts* must be at least 1.");
+
+  const Index n_local = nworkers < 0 ? arts_omp_get_max_threads() : nworkers;
+  if (n_local == 0 && port == 0)
+    throw runtime_error(
+        "Without local workers, a *port* must be given for remote workers.");
+
+  std::unique_ptr<YbatchStream> stream;
+  if (filename.nelem()) stream.reset(new YbatchStream(filename, resume));
+
+  ybatch.resize(ybatch_n);
+  ybatch_aux.resize(ybatch_n);
+  ybatch_jacobians.resize(ybatch_n);
+  ArrayOfIndex jobs;
+  for (Index i = 0; i < ybatch_n; i++) {
+    ybatch[i].resize(0);
+    ybatch_aux[i].resize(0);
+    ybatch_jacobians[i].resize(0, 0);
+    if (!stream || !stream->contains(ybatch_start + i))
+      jobs.push_back(ybatch_start + i);
+  }
+  if (!jobs.nelem()) return;
+
+  BatchQueue::Coordinator coordinator(port);
+  out1 << "  Batch coordinator listening on port " << coordinator.port()
+       << ", " << jobs.nelem() << " jobs\n";
+
+  // Buffered output would otherwise be written by the children as well
+  cout.flush();
+  cerr.flush();
+
+  std::vector<pid_t> local;
+  for (Index i = 0; i < n_local; i++) {
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+      out0 << "  Cannot start batch worker: " << std::strerror(errno) << "\n";
+      break;
+    }
+    if (pid == 0) {
+      // The OpenMP thread pool does not survive fork, local workers
+      // therefore run single threaded
+      arts_omp_set_num_threads(1);
+      int status = 0;
+      try {
+        BatchQueue::work("127.0.0.1", coordinator.port(), [&](Index index) {
+          out2 << "  Job at ybatch_index " << index << ", Process "
+               << ::getpid() << "\n";
+          return ybatch_job_record(ws, ybatch_calc_agenda, index);
+        });
+      } catch (const std::exception& e) {
+        cerr << e.what() << "\n";
+        status = 1;
+      }
+      cout.flush();
+      cerr.flush();
+      ::_exit(status);
+    }
+    local.push_back(pid);
+  }
+
+  ArrayOfString fail_msg;
+  BatchQueue::Handlers handlers;
+  handlers.result = [&](Index index, const std::string& payload) {
+    std::istringstream is(payload);
+    YbatchRecord record;
+    if (!ybatch_record_read(is, record) || record.index != index)
+      throw runtime_error("Malformed result from batch worker");
+    if (!record.y.nelem()) return;
+    if (stream) {
+      stream->append_serialized(index, payload);
+    } else {
+      const Index i = index - ybatch_start;
+      ybatch[i] = std::move(record.y);
+      ybatch_aux[i] = std::move(record.y_aux);
+      ybatch_jacobians[i] = std::move(record.jacobian);
+    }
+  };
+  handlers.failure = [&](Index index, const String& msg) {
+    ostringstream os;
+    os << "Run-time error at ybatch_index " << index << ": \n" << msg;
+    fail_msg.push_back(os.str());
+    if (robust)
+      out0 << "WARNING! Job at ybatch_index " << index << " failed.\n";
+    return bool(robust);
+  };
+
+  // Returns when all jobs are done and all local workers have exited
+  String error;
+  try {
+    coordinator.run(jobs, max_attempts, handlers, local);
+  } catch (const std::exception& e) {
+    error = e.what();
+  }
+
+  if (fail_msg.nelem() || error.nelem()) {
+    ostringstream os;
+    if (!error.nelem()) os << "\nError messages from failed batch cases:\n";
+    for (const String& msg : fail_msg) os << msg << '\n';
+    if (error.nelem())
+      throw runtime_error(fail_msg.nelem() ? os.str() : error);
+    else
+      out0 << os.str();
+  }
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void ybatchCalcWorker(Workspace& ws,
+                      // WS Input:
+                      const Agenda& ybatch_calc_agenda,
+                      // Control Parameters:
+                      const String& host,
+                      const Index& port,
+                      const Verbosity& verbosity) {
+  CREATE_OUT1;
+  CREATE_OUT2;
+
+  const Index n = BatchQueue::work(host, port, [&](Index index) {
+    out2 << "  Job at ybatch_index " << index << "\n";
+    return ybatch_job_record(ws, ybatch_calc_agenda, index);
+  });
+
+  out1 << "  Batch worker finished " << n << " jobs\n";
+}
+
 /* Workspace method: Doxygen documentation will be auto-generated */
 void ybatchMetProfiles(Workspace& ws,
                        //Output
@@ -648,6 +869,26 @@ void ybatchMetProfilesClear(Workspace& ws,
   }  // closing the loop over profile basenames
 }
 
+/* Workspace method: Doxygen documentation will be auto-generated */
+void ybatchReadStream(  // WS Output:
+    ArrayOfVector& ybatch,
+    ArrayOfArrayOfVector& ybatch_aux,
+    ArrayOfMatrix& ybatch_jacobians,
+    // WS Input:
+    const Index& ybatch_start,
+    const Index& ybatch_n,
+    // Control Parameters:
+    const String& filename,
+    const Verbosity& verbosity) {
+  CREATE_OUT2;
+
+  const Index n_found = ybatch_stream_read(
+      ybatch, ybatch_aux, ybatch_jacobians, filename, ybatch_start, ybatch_n);
+
+  out2 << "  Read " << n_found << " of " << ybatch_n << " jobs from "
+       << filename << "\n";
+}
+
 /* Workspace method: Doxygen documentation will be auto-generated */
 void DOBatchCalc(Workspace& ws,
                  ArrayOfTensor7& dobatch_cloudbox_field,
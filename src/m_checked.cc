@@ -966,6 +966,9 @@ void lbl_checkedCalc(Index& lbl_checked,
       if (band.Mirroring() not_eq Absorption::MirroringType::Manual and std::any_of(band.AllLines().cbegin(), band.AllLines().cend(), [](auto& x){return x.F0() <= 0;})) {
         throw std::runtime_error("Negative or zero frequency in non-Manual mirrored band.\n");
       }
+      
+      // The packed copy of the lines, kept with the band for all later calls
+      if (not any_zeeman) band.Compiled();
     }
   }
   
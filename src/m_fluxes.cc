@@ -638,6 +638,7 @@ void spectral_radiance_fieldClearskyPlaneParallel(
                              iy_transmission,
                              rte_alonglos_v,
                              surface_props_data,
+                             0,
                              verbosity);
         } else {
           iyEmissionStandardSequential(l_ws,
@@ -942,6 +943,7 @@ void spectral_radiance_fieldExpandCloudboxField(
                              iy_transmission,
                              rte_alonglos_v,
                              surface_props_data,
+                             0,
                              verbosity);
         } else {
           iyEmissionStandardSequential(l_ws,
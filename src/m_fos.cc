@@ -957,6 +957,7 @@ void iyHybrid(Workspace& ws,
                        iy_transmission,
                        rte_alonglos_v,
                        surface_props_data,
+                       0,
                        verbosity);
     return;
   }
@@ -1518,6 +1519,7 @@ void iyHybrid2(Workspace& ws,
                        iy_transmission,
                        rte_alonglos_v,
                        surface_props_data,
+                       0,
                        verbosity);
     return;
   }
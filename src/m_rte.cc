@@ -43,6 +43,7 @@
 #include "montecarlo.h"
 #include "physics_funcs.h"
 #include "ppath.h"
+#include "propmat_cache.h"
 #include "rte.h"
 #include "special_interp.h"
 #include "transmissionmatrix.h"
@@ -559,8 +560,22 @@ void iyEmissionStandardSequential(Workspace& ws,
   }
 }
 
-/* Workspace method: Doxygen documentation will be auto-generated */
-void iyEmissionStandard(
+/** Emission RT of iyEmissionStandard and iyEmissionStandardFromPropmatField
+ *
+ * The clearsky propagation matrices are given by propmat_clearsky_agenda,
+ * or with from_propmat_field by propmat_clearsky_field and
+ * dpropmat_clearsky_field_dx.  The unused input is not accessed.
+ *
+ * With stream_jacobian, the derivatives along the path are not stored for
+ * all points.  The radiative transfer is first done without them.  They
+ * are then computed again for a few points at a time, each point from its
+ * own propagation matrix derivatives and the stored radiation and
+ * transmission of the path, and mapped to the retrieval grids before the
+ * next points are done.  This bounds the memory of the derivatives to a
+ * few points, for the price of a second propagation matrix calculation
+ * per point.
+ */
+static void iy_emission_standard(
     Workspace& ws,
     Matrix& iy,
     ArrayOfMatrix& iy_aux,
@@ -607,6 +622,10 @@ void iyEmissionStandard(
     const Tensor3& iy_transmission,
     const Numeric& rte_alonglos_v,
     const Tensor3& surface_props_data,
+    const Tensor7& propmat_clearsky_field,
+    const Tensor7& dpropmat_clearsky_field_dx,
+    const bool from_propmat_field,
+    const bool stream_jacobian,
     const Verbosity& verbosity) {
   // Some basic sizes
   const Index nf = f_grid.nelem();
@@ -637,6 +656,11 @@ void iyEmissionStandard(
   ArrayOfIndex jac_species_i(nq), jac_scat_i(nq), jac_is_t(nq), jac_wind_i(nq);
   ArrayOfIndex jac_mag_i(nq), jac_other(nq);
 
+  // Whether the derivatives are kept for all path points
+  const bool stream = j_analytical_do and stream_jacobian;
+  const bool j_path_do = j_analytical_do and not stream;
+  const Index nq_path = j_path_do ? nq : 0;
+
   if (j_analytical_do) {
     const ArrayOfString scat_species(0);
     const ArrayOfTensor4 dpnd_field_dx(nq);
@@ -651,7 +675,7 @@ void iyEmissionStandard(
                             diy_dpath,
                             ns,
                             nf,
-                            np,
+                            stream ? 0 : np,
                             nq,
                             abs_species,
                             cloudbox_on,
@@ -661,6 +685,32 @@ void iyEmissionStandard(
                             iy_agenda_call1);
   }
 
+  if (from_propmat_field) {
+    if (not nlte_field.Data().empty())
+      throw runtime_error(
+          "*propmat_clearsky_field* holds no NLTE source terms, so\n"
+          "*nlte_field* must be empty.");
+    chk_size("propmat_clearsky_field",
+             propmat_clearsky_field,
+             abs_species.nelem(),
+             nf,
+             ns,
+             ns,
+             t_field.npages(),
+             t_field.nrows(),
+             t_field.ncols());
+    if (j_analytical_do)
+      chk_size("dpropmat_clearsky_field_dx",
+               dpropmat_clearsky_field_dx,
+               equivalent_propmattype_indexes(jacobian_quantities).nelem(),
+               nf,
+               ns,
+               ns,
+               t_field.npages(),
+               t_field.nrows(),
+               t_field.ncols());
+  }
+
   // Init iy_aux and fill where possible
   const Index naux = iy_aux_vars.nelem();
   iy_aux.resize(naux);
@@ -692,17 +742,31 @@ void iyEmissionStandard(
 
   ArrayOfRadiationVector lvl_rad(np, RadiationVector(nf, ns));
   ArrayOfArrayOfRadiationVector dlvl_rad(
-      np, ArrayOfRadiationVector(nq, RadiationVector(nf, ns)));
+      np, ArrayOfRadiationVector(nq_path, RadiationVector(nf, ns)));
 
   ArrayOfRadiationVector src_rad(np, RadiationVector(nf, ns));
   ArrayOfArrayOfRadiationVector dsrc_rad(
-      np, ArrayOfRadiationVector(nq, RadiationVector(nf, ns)));
+      np, ArrayOfRadiationVector(nq_path, RadiationVector(nf, ns)));
 
   ArrayOfTransmissionMatrix lyr_tra(np, TransmissionMatrix(nf, ns));
   ArrayOfArrayOfTransmissionMatrix dlyr_tra_above(
-      np, ArrayOfTransmissionMatrix(nq, TransmissionMatrix(nf, ns)));
+      np, ArrayOfTransmissionMatrix(nq_path, TransmissionMatrix(nf, ns)));
   ArrayOfArrayOfTransmissionMatrix dlyr_tra_below(
-      np, ArrayOfTransmissionMatrix(nq, TransmissionMatrix(nf, ns)));
+      np, ArrayOfTransmissionMatrix(nq_path, TransmissionMatrix(nf, ns)));
+
+  ArrayOfPropagationMatrix K(np);
+
+  // HSE variables
+  Index temperature_derivative_position = -1;
+  bool do_hse = false;
+
+  if (j_analytical_do) {
+    FOR_ANALYTICAL_JACOBIANS_DO(
+        if (jacobian_quantities[iq] == JacPropMatType::Temperature) {
+          temperature_derivative_position = iq;
+          do_hse = jacobian_quantities[iq].Subtag() == "HSE on";
+        })
+  }
 
   if (np == 1 && rbi == 1) {  // i.e. ppath is totally outside the atmosphere:
     ppvar_p.resize(0);
@@ -736,12 +800,20 @@ void iyEmissionStandard(
     get_ppath_f(
         ppvar_f, ppath, f_grid, atmosphere_dim, rte_alonglos_v, ppvar_wind);
 
+    // The fields are only given for f_grid
+    if (from_propmat_field)
+      for (Index ip = 0; ip < np; ip++)
+        for (Index iv = 0; iv < nf; iv++)
+          if (ppvar_f(iv, ip) != f_grid[iv])
+            throw runtime_error(
+                "*propmat_clearsky_field* can not be used with Doppler\n"
+                "shifts. Winds and *rte_alonglos_v* must be zero.");
+
     // Size radiative variables always used
     Vector B(nf);
     StokesVector a(nf, ns), S(nf, ns);
     ArrayOfIndex lte(np);
 
-    ArrayOfPropagationMatrix K(np);
     for (Index ip = 0; ip < np; ip++) {
       K[ip] = PropagationMatrix(nf, ns);
     }
@@ -749,61 +821,73 @@ void iyEmissionStandard(
     // Init variables only used if analytical jacobians done
     Vector dB_dT(0);
     ArrayOfArrayOfPropagationMatrix dK_dx(np);
-    ArrayOfStokesVector da_dx(nq), dS_dx(nq);
+    ArrayOfStokesVector da_dx(nq_path), dS_dx(nq_path);
 
-    // HSE variables
-    Index temperature_derivative_position = -1;
-    bool do_hse = false;
-
-    if (j_analytical_do) {
+    if (j_path_do) {
       dB_dT.resize(nf);
       for (Index ip = 0; ip < np; ip++) {
         dK_dx[ip].resize(nq);
         FOR_ANALYTICAL_JACOBIANS_DO(dK_dx[ip][iq] = PropagationMatrix(nf, ns);)
       }
-      FOR_ANALYTICAL_JACOBIANS_DO(
-          da_dx[iq] = StokesVector(nf, ns); dS_dx[iq] = StokesVector(nf, ns);
-          if (jacobian_quantities[iq] == JacPropMatType::Temperature) {
-            temperature_derivative_position = iq;
-            do_hse = jacobian_quantities[iq].Subtag() == "HSE on";
-          })
+      FOR_ANALYTICAL_JACOBIANS_DO(da_dx[iq] = StokesVector(nf, ns);
+                                  dS_dx[iq] = StokesVector(nf, ns);)
     }
     const bool temperature_jacobian =
-        j_analytical_do and do_temperature_jacobian(jacobian_quantities);
+        j_path_do and do_temperature_jacobian(jacobian_quantities);
+
+    // The agenda gives no derivatives for streamed Jacobians
+    const ArrayOfRetrievalQuantity no_quantities(0);
+    const ArrayOfRetrievalQuantity& path_quantities =
+        stream ? no_quantities : jacobian_quantities;
 
-    Agenda l_propmat_clearsky_agenda(propmat_clearsky_agenda);
     Workspace l_ws(ws);
     ArrayOfString fail_msg;
     bool do_abort = false;
 
-    // Loop ppath points and determine radiative properties
-#pragma omp parallel for if (!arts_omp_in_parallel()) \
-    firstprivate(l_ws, l_propmat_clearsky_agenda, a, B, dB_dT, S, da_dx, dS_dx)
-    for (Index ip = 0; ip < np; ip++) {
-      if (do_abort) continue;
+    // Loop ppath points and determine radiative properties.  When called
+    // inside a parallel region, e.g. per mblock of yCalc, the points are
+    // done as tasks by the idle threads of that region.
+    arts_omp_parallel_for(np, [&, l_ws, a, B, dB_dT, S, da_dx, dS_dx](
+                                  const Index ip) mutable {
+      if (do_abort) return;
       try {
         get_stepwise_blackbody_radiation(
             B, dB_dT, ppvar_f(joker, ip), ppvar_t[ip], temperature_jacobian);
 
-        get_stepwise_clearsky_propmat(l_ws,
-                                      K[ip],
-                                      S,
-                                      lte[ip],
-                                      dK_dx[ip],
-                                      dS_dx,
-                                      l_propmat_clearsky_agenda,
-                                      jacobian_quantities,
-                                      ppvar_f(joker, ip),
-                                      ppvar_mag(joker, ip),
-                                      ppath.los(ip, joker),
-                                      ppvar_nlte[ip],
-                                      ppvar_vmr(joker, ip),
-                                      ppvar_t[ip],
-                                      ppvar_p[ip],
-                                      jac_species_i,
-                                      j_analytical_do);
-
-        if (j_analytical_do)
+        if (from_propmat_field)
+          get_stepwise_clearsky_propmat_from_field(K[ip],
+                                                   S,
+                                                   lte[ip],
+                                                   dK_dx[ip],
+                                                   dS_dx,
+                                                   propmat_clearsky_field,
+                                                   dpropmat_clearsky_field_dx,
+                                                   path_quantities,
+                                                   ppath,
+                                                   ip,
+                                                   atmosphere_dim,
+                                                   jac_species_i,
+                                                   j_path_do);
+        else
+          get_stepwise_clearsky_propmat(l_ws,
+                                        K[ip],
+                                        S,
+                                        lte[ip],
+                                        dK_dx[ip],
+                                        dS_dx,
+                                        propmat_clearsky_agenda,
+                                        path_quantities,
+                                        ppvar_f(joker, ip),
+                                        ppvar_mag(joker, ip),
+                                        ppath.los(ip, joker),
+                                        ppvar_nlte[ip],
+                                        ppvar_vmr(joker, ip),
+                                        ppvar_t[ip],
+                                        ppvar_p[ip],
+                                        jac_species_i,
+                                        j_path_do);
+
+        if (j_path_do)
           adapt_stepwise_partial_derivatives(dK_dx[ip],
                                              dS_dx,
                                              jacobian_quantities,
@@ -816,12 +900,11 @@ void iyEmissionStandard(
                                              jac_wind_i,
                                              lte[ip],
                                              atmosphere_dim,
-                                             j_analytical_do);
+                                             j_path_do);
 
         // Here absorption equals extinction
         a = K[ip];
-        if (j_analytical_do)
-          FOR_ANALYTICAL_JACOBIANS_DO(da_dx[iq] = dK_dx[ip][iq];);
+        if (j_path_do) FOR_ANALYTICAL_JACOBIANS_DO(da_dx[iq] = dK_dx[ip][iq];);
 
         stepwise_source(src_rad[ip],
                         dsrc_rad[ip],
@@ -834,7 +917,7 @@ void iyEmissionStandard(
                         B,
                         dB_dT,
                         jacobian_quantities,
-                        jacobian_do);
+                        jacobian_do and not stream);
       } catch (const std::runtime_error& e) {
         ostringstream os;
         os << "Runtime-error in source calculation at index " << ip
@@ -846,11 +929,11 @@ void iyEmissionStandard(
           fail_msg.push_back(os.str());
         }
       }
-    }
+    });
 
-#pragma omp parallel for if (!arts_omp_in_parallel())
-    for (Index ip = 1; ip < np; ip++) {
-      if (do_abort) continue;
+    arts_omp_parallel_for(np - 1, [&](const Index jp) {
+      const Index ip = jp + 1;
+      if (do_abort) return;
       try {
         const Numeric dr_dT_past =
             do_hse ? ppath.lstep[ip - 1] / (2.0 * ppvar_t[ip - 1]) : 0;
@@ -878,7 +961,7 @@ void iyEmissionStandard(
           fail_msg.push_back(os.str());
         }
       }
-    }
+    });
 
     if (do_abort) {
       std::ostringstream os;
@@ -954,13 +1037,257 @@ void iyEmissionStandard(
     ppvar_trans_cumulat(ip, joker, joker, joker) = tot_tra[ip];
     ppvar_trans_partial(ip, joker, joker, joker) = lyr_tra[ip];
     ppvar_iy(joker, joker, ip) = lvl_rad[ip];
-    if (j_analytical_do)
+    if (j_path_do)
       FOR_ANALYTICAL_JACOBIANS_DO(diy_dpath[iq](ip, joker, joker) =
                                       dlvl_rad[ip][iq];);
   }
 
+  // Streamed analytical Jacobians, a few path points at a time
+  if (stream) {
+    const Index nchunk = max(Index(1), Index(arts_omp_get_max_threads()));
+    const bool temperature_jacobian =
+        do_temperature_jacobian(jacobian_quantities);
+
+    // Derivatives of the neighbouring point are left out of its layer
+    const ArrayOfPropagationMatrix dK_none(nq);
+
+    Workspace l_ws(ws);
+    Vector B(nf), dB_dT(nf);
+    StokesVector a(nf, ns), S(nf, ns);
+    PropagationMatrix K_this(nf, ns);
+    Index lte = 1;
+    ArrayOfPropagationMatrix dK_dx(nq);
+    ArrayOfStokesVector da_dx(nq), dS_dx(nq);
+    FOR_ANALYTICAL_JACOBIANS_DO(dK_dx[iq] = PropagationMatrix(nf, ns);
+                                da_dx[iq] = StokesVector(nf, ns);
+                                dS_dx[iq] = StokesVector(nf, ns);)
+    RadiationVector src(nf, ns);
+    ArrayOfRadiationVector dsrc(nq, RadiationVector(nf, ns));
+    ArrayOfRadiationVector dlvl_other(nq, RadiationVector(nf, ns));
+    TransmissionMatrix tra(nf, ns);
+    ArrayOfTransmissionMatrix dtra_above(nq, TransmissionMatrix(nf, ns));
+    ArrayOfTransmissionMatrix dtra_below(nq, TransmissionMatrix(nf, ns));
+
+    ArrayOfString fail_msg;
+    bool do_abort = false;
+
+    for (Index ip0 = 0; ip0 < np; ip0 += nchunk) {
+      const Index n = min(nchunk, np - ip0);
+      FOR_ANALYTICAL_JACOBIANS_DO(diy_dpath[iq].resize(n, nf, ns);
+                                  diy_dpath[iq] = 0.0;)
+
+      // Nothing to add if the path is outside the atmosphere
+      if (not(np == 1 && rbi == 1))
+        arts_omp_parallel_for(n,
+                              [&,
+                               l_ws,
+                               B,
+                               dB_dT,
+                               a,
+                               S,
+                               K_this,
+                               lte,
+                               dK_dx,
+                               da_dx,
+                               dS_dx,
+                               src,
+                               dsrc,
+                               dlvl_other,
+                               tra,
+                               dtra_above,
+                               dtra_below](const Index i) mutable {
+          const Index ip = ip0 + i;
+          if (do_abort) return;
+          try {
+            get_stepwise_blackbody_radiation(B,
+                                             dB_dT,
+                                             ppvar_f(joker, ip),
+                                             ppvar_t[ip],
+                                             temperature_jacobian);
+
+            // The propagation matrix is already known, only its
+            // derivatives are needed
+            if (from_propmat_field)
+              get_stepwise_clearsky_propmat_from_field(
+                  K_this,
+                  S,
+                  lte,
+                  dK_dx,
+                  dS_dx,
+                  propmat_clearsky_field,
+                  dpropmat_clearsky_field_dx,
+                  jacobian_quantities,
+                  ppath,
+                  ip,
+                  atmosphere_dim,
+                  jac_species_i,
+                  true);
+            else
+              get_stepwise_clearsky_propmat(l_ws,
+                                            K_this,
+                                            S,
+                                            lte,
+                                            dK_dx,
+                                            dS_dx,
+                                            propmat_clearsky_agenda,
+                                            jacobian_quantities,
+                                            ppvar_f(joker, ip),
+                                            ppvar_mag(joker, ip),
+                                            ppath.los(ip, joker),
+                                            ppvar_nlte[ip],
+                                            ppvar_vmr(joker, ip),
+                                            ppvar_t[ip],
+                                            ppvar_p[ip],
+                                            jac_species_i,
+                                            true);
+
+            adapt_stepwise_partial_derivatives(dK_dx,
+                                               dS_dx,
+                                               jacobian_quantities,
+                                               ppvar_f(joker, ip),
+                                               ppath.los(ip, joker),
+                                               ppvar_vmr(joker, ip),
+                                               ppvar_t[ip],
+                                               ppvar_p[ip],
+                                               jac_species_i,
+                                               jac_wind_i,
+                                               lte,
+                                               atmosphere_dim,
+                                               true);
+
+            a = K[ip];
+            FOR_ANALYTICAL_JACOBIANS_DO(da_dx[iq] = dK_dx[iq];);
+
+            stepwise_source(src,
+                            dsrc,
+                            K[ip],
+                            a,
+                            S,
+                            dK_dx,
+                            da_dx,
+                            dS_dx,
+                            B,
+                            dB_dT,
+                            jacobian_quantities,
+                            true);
+
+            // Derivatives of the layers before and after the point
+            if (ip > 0) {
+              const Numeric dr_dT_past =
+                  do_hse ? ppath.lstep[ip - 1] / (2.0 * ppvar_t[ip - 1]) : 0;
+              const Numeric dr_dT_this =
+                  do_hse ? ppath.lstep[ip - 1] / (2.0 * ppvar_t[ip]) : 0;
+              stepwise_transmission(tra,
+                                    dtra_above,
+                                    dtra_below,
+                                    K[ip - 1],
+                                    K[ip],
+                                    dK_none,
+                                    dK_dx,
+                                    ppath.lstep[ip - 1],
+                                    dr_dT_past,
+                                    dr_dT_this,
+                                    temperature_derivative_position);
+            }
+            if (ip < np - 1) {
+              const Numeric dr_dT_this =
+                  do_hse ? ppath.lstep[ip] / (2.0 * ppvar_t[ip]) : 0;
+              const Numeric dr_dT_next =
+                  do_hse ? ppath.lstep[ip] / (2.0 * ppvar_t[ip + 1]) : 0;
+              stepwise_transmission(tra,
+                                    dtra_above,
+                                    dtra_below,
+                                    K[ip],
+                                    K[ip + 1],
+                                    dK_dx,
+                                    dK_none,
+                                    ppath.lstep[ip],
+                                    dr_dT_this,
+                                    dr_dT_next,
+                                    temperature_derivative_position);
+            }
+
+            // The two steps of the radiative transfer loop above that
+            // involve the point, in the same order
+            ArrayOfRadiationVector dlvl(nq, RadiationVector(nf, ns));
+            if (ip < np - 1) {
+              RadiationVector I = lvl_rad[ip + 1];
+              update_radiation_vector(I,
+                                      dlvl,
+                                      dlvl_other,
+                                      src_rad[ip],
+                                      src_rad[ip + 1],
+                                      dsrc,
+                                      dsrc,
+                                      lyr_tra[ip + 1],
+                                      tot_tra[ip],
+                                      dtra_above,
+                                      dtra_above,
+                                      RadiativeTransferSolver::Emission);
+            }
+            if (ip > 0) {
+              RadiationVector I = lvl_rad[ip];
+              update_radiation_vector(I,
+                                      dlvl_other,
+                                      dlvl,
+                                      src_rad[ip - 1],
+                                      src_rad[ip],
+                                      dsrc,
+                                      dsrc,
+                                      lyr_tra[ip],
+                                      tot_tra[ip - 1],
+                                      dtra_below,
+                                      dtra_below,
+                                      RadiativeTransferSolver::Emission);
+            }
+
+            FOR_ANALYTICAL_JACOBIANS_DO(diy_dpath[iq](i, joker, joker) =
+                                            dlvl[iq];);
+          } catch (const std::runtime_error& e) {
+            ostringstream os;
+            os << "Runtime-error in Jacobian calculation at index " << ip
+               << ": \n";
+            os << e.what();
+#pragma omp critical(iyEmissionStandard_jacobian)
+            {
+              do_abort = true;
+              fail_msg.push_back(os.str());
+            }
+          }
+        });
+
+      if (do_abort) {
+        std::ostringstream os;
+        os << "Error messages from failed cases:\n";
+        for (const auto& msg : fail_msg) {
+          os << msg << '\n';
+        }
+        throw std::runtime_error(os.str());
+      }
+
+      rtmethods_jacobian_finalisation(ws,
+                                      diy_dx,
+                                      diy_dpath,
+                                      ns,
+                                      nf,
+                                      n,
+                                      atmosphere_dim,
+                                      ppath,
+                                      ppvar_p,
+                                      ppvar_t,
+                                      ppvar_vmr,
+                                      iy_agenda_call1,
+                                      iy_transmission,
+                                      water_p_eq_agenda,
+                                      jacobian_quantities,
+                                      jac_species_i,
+                                      jac_is_t,
+                                      ip0);
+    }
+  }
+
   // Finalize analytical Jacobians
-  if (j_analytical_do) {
+  if (j_path_do) {
     rtmethods_jacobian_finalisation(ws,
                                     diy_dx,
                                     diy_dpath,
@@ -995,6 +1322,213 @@ void iyEmissionStandard(
   }
 }
 
+/* Workspace method: Doxygen documentation will be auto-generated */
+void iyEmissionStandard(
+    Workspace& ws,
+    Matrix& iy,
+    ArrayOfMatrix& iy_aux,
+    ArrayOfTensor3& diy_dx,
+    Vector& ppvar_p,
+    Vector& ppvar_t,
+    EnergyLevelMap& ppvar_nlte,
+    Matrix& ppvar_vmr,
+    Matrix& ppvar_wind,
+    Matrix& ppvar_mag,
+    Matrix& ppvar_f,
+    Tensor3& ppvar_iy,
+    Tensor4& ppvar_trans_cumulat,
+    Tensor4& ppvar_trans_partial,
+    const Index& iy_id,
+    const Index& stokes_dim,
+    const Vector& f_grid,
+    const Index& atmosphere_dim,
+    const Vector& p_grid,
+    const Tensor3& t_field,
+    const EnergyLevelMap& nlte_field,
+    const Tensor4& vmr_field,
+    const ArrayOfArrayOfSpeciesTag& abs_species,
+    const Tensor3& wind_u_field,
+    const Tensor3& wind_v_field,
+    const Tensor3& wind_w_field,
+    const Tensor3& mag_u_field,
+    const Tensor3& mag_v_field,
+    const Tensor3& mag_w_field,
+    const Index& cloudbox_on,
+    const String& iy_unit,
+    const ArrayOfString& iy_aux_vars,
+    const Index& jacobian_do,
+    const ArrayOfRetrievalQuantity& jacobian_quantities,
+    const Ppath& ppath,
+    const Vector& rte_pos2,
+    const Agenda& propmat_clearsky_agenda,
+    const Agenda& water_p_eq_agenda,
+    const Agenda& iy_main_agenda,
+    const Agenda& iy_space_agenda,
+    const Agenda& iy_surface_agenda,
+    const Agenda& iy_cloudbox_agenda,
+    const Index& iy_agenda_call1,
+    const Tensor3& iy_transmission,
+    const Numeric& rte_alonglos_v,
+    const Tensor3& surface_props_data,
+    const Index& stream_jacobian,
+    const Verbosity& verbosity) {
+  iy_emission_standard(ws,
+                       iy,
+                       iy_aux,
+                       diy_dx,
+                       ppvar_p,
+                       ppvar_t,
+                       ppvar_nlte,
+                       ppvar_vmr,
+                       ppvar_wind,
+                       ppvar_mag,
+                       ppvar_f,
+                       ppvar_iy,
+                       ppvar_trans_cumulat,
+                       ppvar_trans_partial,
+                       iy_id,
+                       stokes_dim,
+                       f_grid,
+                       atmosphere_dim,
+                       p_grid,
+                       t_field,
+                       nlte_field,
+                       vmr_field,
+                       abs_species,
+                       wind_u_field,
+                       wind_v_field,
+                       wind_w_field,
+                       mag_u_field,
+                       mag_v_field,
+                       mag_w_field,
+                       cloudbox_on,
+                       iy_unit,
+                       iy_aux_vars,
+                       jacobian_do,
+                       jacobian_quantities,
+                       ppath,
+                       rte_pos2,
+                       propmat_clearsky_agenda,
+                       water_p_eq_agenda,
+                       iy_main_agenda,
+                       iy_space_agenda,
+                       iy_surface_agenda,
+                       iy_cloudbox_agenda,
+                       iy_agenda_call1,
+                       iy_transmission,
+                       rte_alonglos_v,
+                       surface_props_data,
+                       Tensor7(),
+                       Tensor7(),
+                       false,
+                       stream_jacobian,
+                       verbosity);
+}
+
+/* Workspace method: Doxygen documentation will be auto-generated */
+void iyEmissionStandardFromPropmatField(
+    Workspace& ws,
+    Matrix& iy,
+    ArrayOfMatrix& iy_aux,
+    ArrayOfTensor3& diy_dx,
+    Vector& ppvar_p,
+    Vector& ppvar_t,
+    EnergyLevelMap& ppvar_nlte,
+    Matrix& ppvar_vmr,
+    Matrix& ppvar_wind,
+    Matrix& ppvar_mag,
+    Matrix& ppvar_f,
+    Tensor3& ppvar_iy,
+    Tensor4& ppvar_trans_cumulat,
+    Tensor4& ppvar_trans_partial,
+    const Index& iy_id,
+    const Index& stokes_dim,
+    const Vector& f_grid,
+    const Index& atmosphere_dim,
+    const Vector& p_grid,
+    const Tensor3& t_field,
+    const EnergyLevelMap& nlte_field,
+    const Tensor4& vmr_field,
+    const ArrayOfArrayOfSpeciesTag& abs_species,
+    const Tensor3& wind_u_field,
+    const Tensor3& wind_v_field,
+    const Tensor3& wind_w_field,
+    const Tensor3& mag_u_field,
+    const Tensor3& mag_v_field,
+    const Tensor3& mag_w_field,
+    const Index& cloudbox_on,
+    const String& iy_unit,
+    const ArrayOfString& iy_aux_vars,
+    const Index& jacobian_do,
+    const ArrayOfRetrievalQuantity& jacobian_quantities,
+    const Ppath& ppath,
+    const Vector& rte_pos2,
+    const Tensor7& propmat_clearsky_field,
+    const Tensor7& dpropmat_clearsky_field_dx,
+    const Agenda& water_p_eq_agenda,
+    const Agenda& iy_main_agenda,
+    const Agenda& iy_space_agenda,
+    const Agenda& iy_surface_agenda,
+    const Agenda& iy_cloudbox_agenda,
+    const Index& iy_agenda_call1,
+    const Tensor3& iy_transmission,
+    const Numeric& rte_alonglos_v,
+    const Tensor3& surface_props_data,
+    const Index& stream_jacobian,
+    const Verbosity& verbosity) {
+  iy_emission_standard(ws,
+                       iy,
+                       iy_aux,
+                       diy_dx,
+                       ppvar_p,
+                       ppvar_t,
+                       ppvar_nlte,
+                       ppvar_vmr,
+                       ppvar_wind,
+                       ppvar_mag,
+                       ppvar_f,
+                       ppvar_iy,
+                       ppvar_trans_cumulat,
+                       ppvar_trans_partial,
+                       iy_id,
+                       stokes_dim,
+                       f_grid,
+                       atmosphere_dim,
+                       p_grid,
+                       t_field,
+                       nlte_field,
+                       vmr_field,
+                       abs_species,
+                       wind_u_field,
+                       wind_v_field,
+                       wind_w_field,
+                       mag_u_field,
+                       mag_v_field,
+                       mag_w_field,
+                       cloudbox_on,
+                       iy_unit,
+                       iy_aux_vars,
+                       jacobian_do,
+                       jacobian_quantities,
+                       ppath,
+                       rte_pos2,
+                       Agenda(),
+                       water_p_eq_agenda,
+                       iy_main_agenda,
+                       iy_space_agenda,
+                       iy_surface_agenda,
+                       iy_cloudbox_agenda,
+                       iy_agenda_call1,
+                       iy_transmission,
+                       rte_alonglos_v,
+                       surface_props_data,
+                       propmat_clearsky_field,
+                       dpropmat_clearsky_field_dx,
+                       true,
+                       stream_jacobian,
+                       verbosity);
+}
+
 /* Workspace method: Doxygen documentation will be auto-generated */
 void iyIndependentBeamApproximation(Workspace& ws,
                                     Matrix& iy,
@@ -1780,7 +2314,10 @@ void yCalc(Workspace& ws,
            const Index& jacobian_do,
            const ArrayOfRetrievalQuantity& jacobian_quantities,
            const ArrayOfString& iy_aux_vars,
+           const Index& propmat_cache,
+           const Numeric& propmat_cache_tolerance,
            const Verbosity& verbosity) {
+  CREATE_OUT2;
   CREATE_OUT3;
 
   // Basics
@@ -1816,6 +2353,8 @@ void yCalc(Workspace& ws,
     throw runtime_error(
         "The sensor variables must be flagged to have\n"
         "passed a consistency check (sensor_checked=1).");
+  if (propmat_cache_tolerance < 0)
+    throw runtime_error("*propmat_cache_tolerance* must be >= 0.");
 
   // Some sizes
   const Index nf = f_grid.nelem();
@@ -1863,6 +2402,10 @@ void yCalc(Workspace& ws,
   // The calculations
   //---------------------------------------------------------------------------
 
+  // Shared by all copies of ws made below
+  const PropmatCacheScope propmat_cache_scope(
+      ws, propmat_cache, propmat_cache_tolerance);
+
   String fail_msg;
   bool failed = false;
 
@@ -1969,6 +2512,10 @@ void yCalc(Workspace& ws,
   // Rethrow exception if a runtime error occurred in the mblock loop
   if (failed) throw runtime_error(fail_msg);
 
+  if (const PropmatCache* cache = propmat_cache_scope.cache())
+    out2 << "  Propagation matrix cache: " << cache->size()
+         << " atmospheric states stored, " << cache->hits() << " reused\n";
+
   // Compile y_aux
   //
   const Index nq = iyb_aux_array[0].nelem();
@@ -2039,6 +2586,8 @@ void yCalcAppend(Workspace& ws,
                  const ArrayOfString& iy_aux_vars,
                  const ArrayOfRetrievalQuantity& jacobian_quantities_copy,
                  const Index& append_instrument_wfs,
+                 const Index& propmat_cache,
+                 const Numeric& propmat_cache_tolerance,
                  const Verbosity& verbosity) {
   // The jacobian indices of old and new part (without transformations)
   ArrayOfArrayOfIndex jacobian_indices, jacobian_indices_copy;
@@ -2114,6 +2663,8 @@ void yCalcAppend(Workspace& ws,
         jacobian_do,
         jacobian_quantities,
         iy_aux_vars,
+        propmat_cache,
+        propmat_cache_tolerance,
         verbosity);
 
   // Consistency checks
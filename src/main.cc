@@ -43,6 +43,7 @@
 #include "absorption.h"
 #include "agenda_record.h"
 #include "arts_omp.h"
+#include "arts_server.h"
 #include "auto_md.h"
 #include "auto_version.h"
 #include "docserver.h"
@@ -54,6 +55,7 @@
 #include "mystring.h"
 #include "parameters.h"
 #include "parser.h"
+#include "profiler.h"
 #include "workspace_ng.h"
 #include "wsv_aux.h"
 
@@ -756,6 +758,14 @@ int main(int argc, char** argv) {
 #endif
   }
 
+  // Forked jobs can only use OpenMP if the server never started OpenMP
+  // threads, so the server itself runs on one thread
+  Index server_threads = 0;
+  if ("" != parameters.server) {
+    server_threads = arts_omp_get_max_threads();
+    arts_omp_set_num_threads(1);
+  }
+
   // For the next couple of options we need to have the workspce and
   // method lookup data.
 
@@ -900,6 +910,19 @@ int main(int argc, char** argv) {
     polite_goodby();
   }
 
+  // The control files are run by a server, which reports to our output
+  if ("" != parameters.connect) {
+    try {
+      for (const String& controlfile : parameters.controlfiles)
+        if (ArtsServer::submit(parameters.connect, controlfile) != EXIT_SUCCESS)
+          arts_exit();
+    } catch (const std::runtime_error& x) {
+      cerr << x.what() << "\n";
+      arts_exit();
+    }
+    arts_exit(EXIT_SUCCESS);
+  }
+
   // Set the basename according to the first control file, if not
   // explicitly specified.
   if ("" == parameters.basename) {
@@ -1011,6 +1034,12 @@ int main(int argc, char** argv) {
          << "                    Report file: "
          << verbosity.get_file_verbosity() << "\n";
 
+    // The profile report is written when ARTS exits, also after errors
+    if ("" != parameters.profile) Profiler::enable(parameters.profile);
+
+    // A server keeps the workspace of its control files for the jobs
+    Workspace server_workspace;
+
     out3 << "\nReading control files:\n";
     for (Index i = 0; i < parameters.controlfiles.nelem(); ++i) {
       try {
@@ -1020,7 +1049,9 @@ int main(int argc, char** argv) {
         // the control file.
         Agenda tasklist;
 
-        Workspace workspace;
+        Workspace local_workspace;
+        Workspace& workspace =
+            "" != parameters.server ? server_workspace : local_workspace;
 
         // Call the parser to parse the control text:
         ArtsParser arts_parser(tasklist, parameters.controlfiles[i], verbosity);
@@ -1045,6 +1076,10 @@ int main(int argc, char** argv) {
         throw runtime_error(os.str());
       }
     }
+
+    if ("" != parameters.server)
+      ArtsServer::serve(
+          server_workspace, parameters.server, server_threads, verbosity);
   } catch (const std::runtime_error& x) {
 #ifdef TIME_SUPPORT
     struct tms arts_cputime_end;
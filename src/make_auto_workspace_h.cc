@@ -86,6 +86,9 @@ int main() {
         << "  // List of function pointers to duplication routines\n"
         << "  void *(*duplicatefp[" << wsv_group_names.nelem()
         << "])(void *);\n\n"
+        << "  // List of function pointers to copy routines\n"
+        << "  void (*copyfp[" << wsv_group_names.nelem()
+        << "])(void *, void *);\n\n"
         << "  // Allocation and deallocation routines for workspace groups\n";
     for (Index i = 0; i < wsv_group_names.nelem(); ++i) {
       ofs << "  static void *allocate_wsvg_" << wsv_group_names[i] << "()\n"
@@ -96,7 +99,11 @@ int main() {
           << "  static void *duplicate_wsvg_" << wsv_group_names[i]
           << "(void *vp)\n"
           << "    { return (new " << wsv_group_names[i] << "(*("
-          << wsv_group_names[i] << " *)vp)); }\n\n";
+          << wsv_group_names[i] << " *)vp)); }\n\n"
+          << "  static void copy_wsvg_" << wsv_group_names[i]
+          << "(void *dst, void *src)\n"
+          << "    { *(" << wsv_group_names[i] << " *)dst = *("
+          << wsv_group_names[i] << " *)src; }\n\n";
     }
 
     ofs << "public:\n"
@@ -113,7 +120,9 @@ int main() {
           << "      deallocfp[" << i << "] = deallocate_wsvg_"
           << wsv_group_names[i] << ";\n"
           << "      duplicatefp[" << i << "] = duplicate_wsvg_"
-          << wsv_group_names[i] << ";\n";
+          << wsv_group_names[i] << ";\n"
+          << "      copyfp[" << i << "] = copy_wsvg_" << wsv_group_names[i]
+          << ";\n";
     }
 
     ofs << "    }\n\n"
@@ -137,6 +146,14 @@ int main() {
         << "  void *duplicate (Index wsvg, void *vp)\n"
         << "    {\n"
         << "      return duplicatefp[wsvg](vp);\n"
+        << "    }\n\n"
+        << "  /** Getaway function to call the copy function for the\n"
+        << "      WSV group with the given Index. Assigns src to the\n"
+        << "      existing variable dst.\n"
+        << "  */\n"
+        << "  void copy (Index wsvg, void *dst, void *src)\n"
+        << "    {\n"
+        << "      copyfp[wsvg](dst, src);\n"
         << "    }\n\n";
 
     ofs << "};\n\n";
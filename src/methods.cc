@@ -1889,17 +1889,21 @@ void define_md_data_raw() {
           "\n"
           "The method sets a flag *abs_lookup_is_adapted* to indicate that the\n"
           "table has been checked and that it is ok. Never set this by hand,\n"
-          "always use this method to set it!\n"),
+          "always use this method to set it!\n"
+          "\n"
+          "The adapted table can be stored in single precision, which halves\n"
+          "its memory. See *abs_lookupCalc*.\n"),
       AUTHORS("Stefan Buehler"),
       OUT("abs_lookup", "abs_lookup_is_adapted"),
       GOUT(),
       GOUT_TYPE(),
       GOUT_DESC(),
       IN("abs_lookup", "abs_species", "f_grid"),
-      GIN(),
-      GIN_TYPE(),
-      GIN_DEFAULT(),
-      GIN_DESC()));
+      GIN("single_precision"),
+      GIN_TYPE("Index"),
+      GIN_DEFAULT("-1"),
+      GIN_DESC("Store the adapted table in single precision (1), in double "
+               "precision (0), or in the precision of the input table (-1).")));
 
   md_data_raw.push_back(create_mdrecord(
       NAME("abs_lookupCalc"),
@@ -1917,7 +1921,14 @@ void define_md_data_raw() {
           "generated.\n"
           "\n"
           "Note, that the absorbing gas can be any gas, but the perturbing gas is\n"
-          "always H2O.\n"),
+          "always H2O.\n"
+          "\n"
+          "With *single_precision*, the cross-sections are stored as 32-bit\n"
+          "floats, which halves the memory of the table. They are promoted to\n"
+          "double precision when absorption is extracted. The rounding error is\n"
+          "far below the interpolation error of the table. The precision is kept\n"
+          "by *abs_lookupWriteMapped* and *abs_lookupReadMapped*, while XML and\n"
+          "NetCDF files are always written in double precision.\n"),
       AUTHORS("Stefan Buehler"),
       OUT("abs_lookup", "abs_lookup_is_adapted"),
       GOUT(),
@@ -1932,11 +1943,100 @@ void define_md_data_raw() {
          "abs_t_pert",
          "abs_nls_pert",
          "abs_xsec_agenda"),
+      GIN("single_precision"),
+      GIN_TYPE("Index"),
+      GIN_DEFAULT("0"),
+      GIN_DESC("Flag to store the table in single precision.")));
+
+  md_data_raw.push_back(create_mdrecord(
+      NAME("abs_lookupCalcIncremental"),
+      DESCRIPTION(
+          "Updates a gas absorption lookup table to new species or frequencies.\n"
+          "\n"
+          "Gives the same table as *abs_lookupCalc*, but only calculates the\n"
+          "cross-sections that are not already in *abs_lookup*. These are the\n"
+          "species of *abs_species* that are not in the table, and the\n"
+          "frequencies of *f_grid* that are not in the table for all species.\n"
+          "All other cross-sections are copied from the table. Species and\n"
+          "frequencies of the table that are not requested any more are\n"
+          "dropped. Frequencies must match exactly to be reused.\n"
+          "\n"
+          "This is only possible if the pressure grid, the reference\n"
+          "temperature profile, the reference VMR profiles of the species that\n"
+          "are kept, the perturbations, and the nonlinear species are the same\n"
+          "as for the table. Otherwise, the full table is calculated as by\n"
+          "*abs_lookupCalc*. The precision of the table is kept.\n"),
+      AUTHORS("agent"),
+      OUT("abs_lookup", "abs_lookup_is_adapted"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("abs_lookup",
+         "abs_species",
+         "abs_nls",
+         "f_grid",
+         "abs_p",
+         "abs_vmrs",
+         "abs_t",
+         "abs_t_pert",
+         "abs_nls_pert",
+         "abs_xsec_agenda"),
       GIN(),
       GIN_TYPE(),
       GIN_DEFAULT(),
       GIN_DESC()));
 
+  md_data_raw.push_back(create_mdrecord(
+      NAME("abs_lookupCalcAdaptive"),
+      DESCRIPTION(
+          "Creates a gas absorption lookup table with grids refined to a\n"
+          "given accuracy.\n"
+          "\n"
+          "The table is first calculated as by *abs_lookupCalc*, with the\n"
+          "input grids as starting point. Then the grids are refined until the\n"
+          "interpolation error of the table is below *accuracy*, or until\n"
+          "*max_iterations* refinements are done.\n"
+          "\n"
+          "The interpolation error is estimated separately for the temperature\n"
+          "perturbations, the H2O VMR perturbations, and the pressure grid, with\n"
+          "the interpolation orders that will be used with the table. Each inner\n"
+          "grid point is left out in turn and the cross-sections there are\n"
+          "interpolated from the other points. The error is the largest relative\n"
+          "deviation from the calculated cross-sections. This overestimates the\n"
+          "error of the table, since the interpolation is done over twice the\n"
+          "grid spacing. Where the error is too large, the grid intervals on\n"
+          "both sides of the point are split in the middle, and only the\n"
+          "cross-sections for the new grid points are calculated.\n"
+          "\n"
+          "Reference temperatures and VMRs at new pressure levels are the mean\n"
+          "of the neighbouring levels.\n"
+          "\n"
+          "All calculations for the different species and perturbations are\n"
+          "done in one parallel loop.\n"),
+      AUTHORS("agent"),
+      OUT("abs_lookup", "abs_lookup_is_adapted"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("abs_species",
+         "abs_nls",
+         "f_grid",
+         "abs_p",
+         "abs_vmrs",
+         "abs_t",
+         "abs_t_pert",
+         "abs_nls_pert",
+         "abs_p_interp_order",
+         "abs_t_interp_order",
+         "abs_nls_interp_order",
+         "abs_xsec_agenda"),
+      GIN("accuracy", "max_iterations", "single_precision"),
+      GIN_TYPE("Numeric", "Index", "Index"),
+      GIN_DEFAULT("1", "5", "0"),
+      GIN_DESC("The largest allowed interpolation error [%].",
+               "The largest number of grid refinements.",
+               "Flag to store the table in single precision.")));
+
   md_data_raw.push_back(create_mdrecord(
       NAME("abs_lookupInit"),
       DESCRIPTION(
@@ -1955,6 +2055,37 @@ void define_md_data_raw() {
       GIN_DEFAULT(),
       GIN_DESC()));
 
+  md_data_raw.push_back(create_mdrecord(
+      NAME("abs_lookupReadMapped"),
+      DESCRIPTION(
+          "Reads a gas absorption lookup table in the mapped binary format.\n"
+          "\n"
+          "The file, as written by *abs_lookupWriteMapped*, is mapped read-only\n"
+          "into memory. The grids and reference profiles are copied, but the\n"
+          "absorption cross-sections are used directly from the mapping. This\n"
+          "makes reading even large tables almost instant, and all processes on\n"
+          "a node that read the same file share one copy of it in memory.\n"
+          "\n"
+          "The mapping is kept by *abs_lookupAdapt* as long as the table is\n"
+          "used for exactly its own species and frequencies. Otherwise the\n"
+          "needed parts are copied into memory as usual.\n"
+          "\n"
+          "The file must not be changed while it is in use. The format stores\n"
+          "native numbers and can not be moved between machines of different\n"
+          "byte order.\n"
+          "\n"
+          "Sets *abs_lookup_is_adapted* to 0.\n"),
+      AUTHORS("agent"),
+      OUT("abs_lookup", "abs_lookup_is_adapted"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN(),
+      GIN("filename"),
+      GIN_TYPE("String"),
+      GIN_DEFAULT(NODEF),
+      GIN_DESC("Name of the file to read.")));
+
   md_data_raw.push_back(create_mdrecord(
       NAME("abs_lookupSetup"),
       DESCRIPTION(
@@ -2211,6 +2342,28 @@ void define_md_data_raw() {
       GIN_TYPE(),
       GIN_DEFAULT(),
       GIN_DESC()));
+
+  md_data_raw.push_back(create_mdrecord(
+      NAME("abs_lookupWriteMapped"),
+      DESCRIPTION(
+          "Writes a gas absorption lookup table in the mapped binary format.\n"
+          "\n"
+          "The file holds a small header, the grids and reference profiles,\n"
+          "and the absorption cross-sections as raw binary data starting at a\n"
+          "page-aligned offset. The table is first written to a temporary\n"
+          "file next to *filename*, which is then renamed to *filename*, so\n"
+          "processes that have the old file mapped are not affected.\n"
+          "See *abs_lookupReadMapped*.\n"),
+      AUTHORS("agent"),
+      OUT(),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("abs_lookup"),
+      GIN("filename"),
+      GIN_TYPE("String"),
+      GIN_DEFAULT(NODEF),
+      GIN_DESC("Name of the file to write.")));
   
   md_data_raw.push_back(create_mdrecord(
       NAME("abs_nlteFromRaw"),
@@ -2559,7 +2712,49 @@ void define_md_data_raw() {
       NAME("abs_xsec_per_speciesAddLines"),
       DESCRIPTION(
           "Calculates the line spectrum for both attenuation and phase\n"
-          "for each tag group and adds it to abs_xsec_per_species.\n"),
+          "for each tag group and adds it to abs_xsec_per_species.\n"
+          "\n"
+          "The accuracy of the Faddeeva function used by Voigt line shapes\n"
+          "can be selected by *faddeeva_accuracy*:\n"
+          "  \"Reference\": The Faddeeva package, evaluated point by point.\n"
+          "  \"High\":      Weideman's 32-term rational approximation,\n"
+          "               vectorized over frequency.  Relative error below 1e-12.\n"
+          "  \"Fast\":      Weideman's 16-term rational approximation,\n"
+          "               vectorized over frequency.  Relative error below 1e-6.\n"
+          "The approximations are only used near the line centers, where the\n"
+          "Doppler and pressure broadening are comparable.  Elsewhere, both\n"
+          "options fall back to the Faddeeva package.\n"
+          "\n"
+          "If *line_parameter_cache* is positive, the pressure broadening,\n"
+          "line mixing and LTE line strength parameters of each band are kept\n"
+          "between calls for up to this many atmospheric states (temperature,\n"
+          "pressure and VMRs).  Later calls with an identical state then only\n"
+          "compute the frequency dependent part.  This is useful when the same\n"
+          "atmosphere is evaluated repeatedly, e.g., for many measurement blocks\n"
+          "or for perturbation Jacobians.  The cache belongs to the band in\n"
+          "*abs_lines_per_species* and is dropped whenever the band is changed.\n"
+          "A value of 0 neither uses nor changes the cache.  Each entry holds 10\n"
+          "Numeric per line, and up to 29 with temperature and VMR Jacobians.\n"
+          "\n"
+          "If *sparse_accuracy* is positive, the line wings are computed on a\n"
+          "uniform coarse grid and linearly interpolated onto *f_grid*, while\n"
+          "each line is computed exactly on *f_grid* near its center.  The\n"
+          "coarse grid and the extent of the line centers are chosen so that\n"
+          "the interpolated wings have about this relative error.  This is\n"
+          "only done when *f_grid* is increasing and large enough for it to\n"
+          "be faster, e.g., for wide bands with many lines and frequencies,\n"
+          "and not for line mixing bands that remove negative absorption.\n"
+          "\n"
+          "*parallel_mode* selects how each band is distributed over the\n"
+          "threads.  \"Levels\" computes the pressure levels in parallel.\n"
+          "\"Lines\" and \"Frequencies\" compute the levels one by one, each\n"
+          "in parallel over blocks of lines or frequencies.  The default,\n"
+          "\"Auto\", uses \"Levels\" if there are at least as many levels as\n"
+          "threads, and otherwise one of the block modes.  When called from\n"
+          "within a parallel region, e.g., for a single level by a parallel\n"
+          "radiative transfer method, the work is split into tasks that the\n"
+          "idle threads of that region pick up.  All modes give the same\n"
+          "result to within rounding errors.\n"),
       AUTHORS("Richard Larsson"),
       OUT("abs_xsec_per_species",
           "src_xsec_per_species",
@@ -2584,10 +2779,13 @@ void define_md_data_raw() {
          "isotopologue_ratios",
          "partition_functions",
          "lbl_checked"),
-      GIN(),
-      GIN_TYPE(),
-      GIN_DEFAULT(),
-      GIN_DESC()));
+      GIN("faddeeva_accuracy", "line_parameter_cache", "sparse_accuracy", "parallel_mode"),
+      GIN_TYPE("String", "Index", "Numeric", "String"),
+      GIN_DEFAULT("Reference", "0", "0", "Auto"),
+      GIN_DESC("Accuracy of the Faddeeva function: \"Reference\", \"High\" or \"Fast\"",
+               "Number of atmospheric states to cache per band, 0 disables caching",
+               "Relative accuracy of line wings from a coarse grid, 0 computes all lines on *f_grid*",
+               "Work distribution: \"Auto\", \"Levels\", \"Lines\" or \"Frequencies\"")));
 
   md_data_raw.push_back(create_mdrecord(
       NAME("abs_xsec_per_speciesAddPredefinedO2MPM2020"),
@@ -7606,7 +7804,17 @@ void define_md_data_raw() {
           "    i.e. only fully valid for scalar RT.\n"
           "If nothing else is stated, only the first column of *iy_aux* is filled,\n"
           "i.e. the column matching Stokes element I, while remaing columns are\n"
-          "are filled with zeros.\n"),
+          "are filled with zeros.\n"
+          "\n"
+          "The analytical Jacobians are by default derived from derivatives\n"
+          "stored for all points of the propagation path, for all quantities,\n"
+          "frequencies and Stokes elements. For long paths and many Jacobian\n"
+          "quantities this can be a lot of memory. With *stream_jacobian* set\n"
+          "to 1, the radiative transfer is first done without derivatives. The\n"
+          "derivatives are then computed for a few points at a time and added\n"
+          "to *diy_dx* directly, so that only those points are kept in memory.\n"
+          "The propagation matrix is then calculated twice for each point,\n"
+          "once without and once with derivatives.\n"),
       AUTHORS("Patrick Eriksson", "Richard Larsson", "Oliver Lemke"),
       OUT("iy",
           "iy_aux",
@@ -7657,10 +7865,94 @@ void define_md_data_raw() {
          "iy_transmission",
          "rte_alonglos_v",
          "surface_props_data"),
-      GIN(),
-      GIN_TYPE(),
-      GIN_DEFAULT(),
-      GIN_DESC()));
+      GIN("stream_jacobian"),
+      GIN_TYPE("Index"),
+      GIN_DEFAULT("0"),
+      GIN_DESC("Flag to compute the analytical Jacobians point by point, "
+               "see above.")));
+
+  md_data_raw.push_back(create_mdrecord(
+      NAME("iyEmissionStandardFromPropmatField"),
+      DESCRIPTION(
+          "As *iyEmissionStandard*, but with gas absorption taken from\n"
+          "precalculated fields.\n"
+          "\n"
+          "*propmat_clearsky_agenda* is not executed. The propagation matrix\n"
+          "at each path point is instead interpolated linearly, using the grid\n"
+          "positions of *ppath*, from *propmat_clearsky_field* and, for the\n"
+          "Jacobian quantities handled by the agenda, from\n"
+          "*dpropmat_clearsky_field_dx*. Both are typically set by\n"
+          "*propmat_clearsky_fieldCalcWithDerivatives*, which computes all\n"
+          "points of the atmosphere in parallel and only once, no matter how\n"
+          "many pencil beams pass them.\n"
+          "\n"
+          "This has some limitations:\n"
+          " - The fields are for *f_grid*, so there can be no Doppler shift\n"
+          "   (wind fields or *rte_alonglos_v*).\n"
+          " - The fields hold no NLTE source terms, *nlte_field* must be empty.\n"
+          " - The fields are for a single line of sight, so polarised\n"
+          "   absorption such as Zeeman splitting is not valid.\n"
+          " - The interpolation adds errors if the fields are coarse, as for\n"
+          "   any other interpolated atmospheric quantity.\n"
+          "\n"
+          "Set *dpropmat_clearsky_field_dx* with *Touch* if no Jacobians\n"
+          "other than for absorption species are calculated.\n"),
+      AUTHORS("agent"),
+      OUT("iy",
+          "iy_aux",
+          "diy_dx",
+          "ppvar_p",
+          "ppvar_t",
+          "ppvar_nlte",
+          "ppvar_vmr",
+          "ppvar_wind",
+          "ppvar_mag",
+          "ppvar_f",
+          "ppvar_iy",
+          "ppvar_trans_cumulat",
+          "ppvar_trans_partial"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("diy_dx",
+         "iy_id",
+         "stokes_dim",
+         "f_grid",
+         "atmosphere_dim",
+         "p_grid",
+         "t_field",
+         "nlte_field",
+         "vmr_field",
+         "abs_species",
+         "wind_u_field",
+         "wind_v_field",
+         "wind_w_field",
+         "mag_u_field",
+         "mag_v_field",
+         "mag_w_field",
+         "cloudbox_on",
+         "iy_unit",
+         "iy_aux_vars",
+         "jacobian_do",
+         "jacobian_quantities",
+         "ppath",
+         "rte_pos2",
+         "propmat_clearsky_field",
+         "dpropmat_clearsky_field_dx",
+         "water_p_eq_agenda",
+         "iy_main_agenda",
+         "iy_space_agenda",
+         "iy_surface_agenda",
+         "iy_cloudbox_agenda",
+         "iy_agenda_call1",
+         "iy_transmission",
+         "rte_alonglos_v",
+         "surface_props_data"),
+      GIN("stream_jacobian"),
+      GIN_TYPE("Index"),
+      GIN_DEFAULT("0"),
+      GIN_DESC("Flag to compute the analytical Jacobians point by point, "
+               "see *iyEmissionStandard*.")));
 
   md_data_raw.push_back(create_mdrecord(
       NAME("iyEmissionStandardSequential"),
@@ -9801,7 +10093,11 @@ void define_md_data_raw() {
                   "\n"
                   "Note that checks may become more stringent as ARTS evolves, especially for\n"
                   "\"new\" options.  This test might succeed in one version of ARTS but fail\n"
-                  "in later versions\n"),
+                  "in later versions\n"
+                  "\n"
+                  "Also packs the lines of each band into the contiguous arrays used by\n"
+                  "the line-by-line calculations, so that this is done once rather than\n"
+                  "in every call.  The packed copy is redone if a band is changed\n"),
       AUTHORS("Richard Larsson"),
       OUT("lbl_checked"),
       GOUT(),
@@ -12962,6 +13258,92 @@ void define_md_data_raw() {
                "empty or have same dimension as p_grid.",
                "Line of sight")));
 
+  md_data_raw.push_back(create_mdrecord(
+      NAME("propmat_clearsky_fieldCalcFromLookup"),
+      DESCRIPTION(
+          "Extract gas absorption coefficients from the lookup table for all\n"
+          "points in the atmosphere.\n"
+          "\n"
+          "This gives the same *propmat_clearsky_field* as\n"
+          "*propmat_clearsky_fieldCalc* with a *propmat_clearsky_agenda* that\n"
+          "only calls *propmat_clearskyAddFromLookup*, but without executing\n"
+          "an agenda per point. The grid positions and interpolation weights\n"
+          "of all points are computed up front and the points are extracted\n"
+          "from the table in a few large batches, one per thread.\n"
+          "\n"
+          "With *doppler*, each pressure level is extracted as its own batch on\n"
+          "its shifted frequency grid, which requires *abs_f_interp_order* > 0.\n"
+          "\n"
+          "Only the diagonal of the propagation matrix is set. The source term\n"
+          "field is not touched.\n"),
+      AUTHORS("agent"),
+      OUT("propmat_clearsky_field"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("atmfields_checked",
+         "abs_lookup",
+         "abs_lookup_is_adapted",
+         "abs_p_interp_order",
+         "abs_t_interp_order",
+         "abs_nls_interp_order",
+         "abs_f_interp_order",
+         "f_grid",
+         "stokes_dim",
+         "p_grid",
+         "lat_grid",
+         "lon_grid",
+         "t_field",
+         "vmr_field"),
+      GIN("doppler", "extpolfac"),
+      GIN_TYPE("Vector", "Numeric"),
+      GIN_DEFAULT("[]", "0.5"),
+      GIN_DESC("A vector of doppler shift values in Hz. Must either be "
+               "empty or have same dimension as p_grid.",
+               "Extrapolation factor (for temperature and VMR grid edges).")));
+
+  md_data_raw.push_back(create_mdrecord(
+      NAME("propmat_clearsky_fieldCalcWithDerivatives"),
+      DESCRIPTION(
+          "Calculate gas absorption and its derivatives for all points in the\n"
+          "atmosphere.\n"
+          "\n"
+          "As *propmat_clearsky_fieldCalc*, but *propmat_clearsky_agenda* is\n"
+          "also asked for the derivatives of the propagation matrix for\n"
+          "*jacobian_quantities*, which are stored in\n"
+          "*dpropmat_clearsky_field_dx*. The two fields are the input of\n"
+          "*iyEmissionStandardFromPropmatField*.\n"
+          "\n"
+          "The points are independent and are calculated in parallel. No\n"
+          "Doppler shift is applied and all points use the same *los*. NLTE\n"
+          "is not handled, *nlte_field* must be empty.\n"
+          "\n"
+          "*dpropmat_clearsky_field_dx* is empty if *jacobian_do* is 0.\n"),
+      AUTHORS("agent"),
+      OUT("propmat_clearsky_field", "dpropmat_clearsky_field_dx"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("atmfields_checked",
+         "f_grid",
+         "stokes_dim",
+         "p_grid",
+         "lat_grid",
+         "lon_grid",
+         "t_field",
+         "vmr_field",
+         "nlte_field",
+         "mag_u_field",
+         "mag_v_field",
+         "mag_w_field",
+         "jacobian_do",
+         "jacobian_quantities",
+         "propmat_clearsky_agenda"),
+      GIN("los"),
+      GIN_TYPE("Vector"),
+      GIN_DEFAULT("[]"),
+      GIN_DESC("Line of sight")));
+
   md_data_raw.push_back(create_mdrecord(
       NAME("psdAbelBoutle12"),
       DESCRIPTION(
@@ -20497,6 +20879,15 @@ void define_md_data_raw() {
           "Jacobians are also collected, and stored in output variable *ybatch_jacobians*. \n"
           "(This will be empty if yCalc produces empty Jacobians.)\n"
           "\n"
+          "If *filename* is given, the result of each job is appended to that\n"
+          "binary file as soon as the job is finished, together with its\n"
+          "*ybatch_index*. The results are then not kept in memory, and\n"
+          "*ybatch*, *ybatch_aux* and *ybatch_jacobians* only get empty\n"
+          "entries. With *resume* set to 1, jobs that are already in an\n"
+          "existing file are skipped, so an interrupted batch can be\n"
+          "continued. Otherwise the file is overwritten. Use\n"
+          "*ybatchReadStream* to read the file.\n"
+          "\n"
           "See the user guide for further practical examples.\n"),
       AUTHORS("Stefan Buehler"),
       OUT("ybatch", "ybatch_aux", "ybatch_jacobians"),
@@ -20504,15 +20895,90 @@ void define_md_data_raw() {
       GOUT_TYPE(),
       GOUT_DESC(),
       IN("ybatch_start", "ybatch_n", "ybatch_calc_agenda"),
-      GIN("robust"),
-      GIN_TYPE("Index"),
-      GIN_DEFAULT("0"),
+      GIN("robust", "filename", "resume"),
+      GIN_TYPE("Index", "String", "Index"),
+      GIN_DEFAULT("0", "", "0"),
       GIN_DESC("A flag with value 1 or 0. If set to one, the batch\n"
                "calculation will continue, even if individual jobs fail. In\n"
                "that case, a warning message is written to screen and file\n"
                "(out1 output stream), and the *y* Vector entry for the\n"
-               "failed job in *ybatch* is left empty.")));
+               "failed job in *ybatch* is left empty.",
+               "File to append the result of each job to. Empty to keep\n"
+               "the results in memory.",
+               "A flag with value 1 or 0. If set to one, the jobs already\n"
+               "in *filename* are skipped.")));
   
+  md_data_raw.push_back(create_mdrecord(
+      NAME("ybatchCalcCoordinator"),
+      DESCRIPTION(
+          "Performs batch calculations like *ybatchCalc*, but in separate\n"
+          "worker processes.\n"
+          "\n"
+          "The method listens on a TCP port and hands out the batch indices\n"
+          "to the workers that connect. Each worker executes\n"
+          "*ybatch_calc_agenda* and sends back the results. A job whose\n"
+          "worker fails or dies is handed out again, until it has been tried\n"
+          "*max_attempts* times.\n"
+          "\n"
+          "*nworkers* local workers are started as copies of this process,\n"
+          "so they share the complete workspace, including for example\n"
+          "scattering data and lookup tables, but each has its own memory\n"
+          "once it writes to it. Local workers run single threaded. A\n"
+          "negative *nworkers* starts as many workers as there are threads.\n"
+          "\n"
+          "Workers on other hosts are started with *ybatchCalcWorker*, in a\n"
+          "control file that sets up the same calculation. This requires\n"
+          "an explicit *port*, otherwise only connections from this host are\n"
+          "accepted. There is no authentication, so the port should only be\n"
+          "reachable from trusted hosts. All hosts must have the same byte\n"
+          "order.\n"
+          "\n"
+          "*filename* and *resume* work as for *ybatchCalc*.\n"),
+      AUTHORS("agent"),
+      OUT("ybatch", "ybatch_aux", "ybatch_jacobians"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("ybatch_start", "ybatch_n", "ybatch_calc_agenda"),
+      GIN("nworkers",
+          "port",
+          "robust",
+          "max_attempts",
+          "filename",
+          "resume"),
+      GIN_TYPE("Index", "Index", "Index", "Index", "String", "Index"),
+      GIN_DEFAULT("-1", "0", "0", "2", "", "0"),
+      GIN_DESC("Number of local worker processes.",
+               "TCP port to listen on, 0 to pick a free port that is only\n"
+               "reachable from this host.",
+               "A flag with value 1 or 0. If set to one, the batch\n"
+               "calculation will continue, even if individual jobs fail in\n"
+               "all attempts. The entries for such jobs are left empty.",
+               "How often a job is tried before it counts as failed.",
+               "File to append the result of each job to. Empty to keep\n"
+               "the results in memory.",
+               "A flag with value 1 or 0. If set to one, the jobs already\n"
+               "in *filename* are skipped.")));
+
+  md_data_raw.push_back(create_mdrecord(
+      NAME("ybatchCalcWorker"),
+      DESCRIPTION(
+          "Works on the jobs of *ybatchCalcCoordinator* until it has no more.\n"
+          "\n"
+          "Connects to the coordinator, repeatedly for up to a minute, so\n"
+          "workers can be started before the coordinator. Each job received\n"
+          "sets *ybatch_index* and executes *ybatch_calc_agenda*.\n"),
+      AUTHORS("agent"),
+      OUT(),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("ybatch_calc_agenda"),
+      GIN("host", "port"),
+      GIN_TYPE("String", "Index"),
+      GIN_DEFAULT(NODEF, NODEF),
+      GIN_DESC("Host of the coordinator.", "Port of the coordinator.")));
+
   md_data_raw.push_back(create_mdrecord(
       NAME("yColdAtmHot"),
       DESCRIPTION(
@@ -20625,6 +21091,26 @@ void define_md_data_raw() {
       GIN_DESC("FIXME DOC", "FIXME DOC")));
 
   
+  md_data_raw.push_back(create_mdrecord(
+      NAME("ybatchReadStream"),
+      DESCRIPTION(
+          "Reads the results that *ybatchCalc* has written to a file.\n"
+          "\n"
+          "The output arrays get *ybatch_n* elements. The job with index\n"
+          "*ybatch_index* is placed at *ybatch_index* - *ybatch_start*.\n"
+          "Jobs that are not in the file, for example because they failed,\n"
+          "get empty entries.\n"),
+      AUTHORS("agent"),
+      OUT("ybatch", "ybatch_aux", "ybatch_jacobians"),
+      GOUT(),
+      GOUT_TYPE(),
+      GOUT_DESC(),
+      IN("ybatch_start", "ybatch_n"),
+      GIN("filename"),
+      GIN_TYPE("String"),
+      GIN_DEFAULT(NODEF),
+      GIN_DESC("File written by *ybatchCalc*.")));
+
   md_data_raw.push_back(create_mdrecord(
       NAME("ybatchTimeAveraging"),
       DESCRIPTION(
@@ -20711,7 +21197,22 @@ void define_md_data_raw() {
           "\n"
           "The Jacobian provided (*jacobian*) is adopted to selected retrieval\n"
           "units, but no transformations are applied. Transformations are\n"
-          "included by calling *jacobianAdjustAndTransform*.\n"),
+          "included by calling *jacobianAdjustAndTransform*.\n"
+          "\n"
+          "If *propmat_cache* is positive, the results of\n"
+          "*propmat_clearsky_agenda* are kept for up to this many atmospheric\n"
+          "states during the call, and are shared by all pencil beams and\n"
+          "measurement blocks.  A state is given by the frequencies, pressure,\n"
+          "temperature, VMRs and NLTE values, and by the magnetic field and the\n"
+          "line of sight if the agenda uses them.  For a 1D atmosphere, the\n"
+          "absorption is then mostly computed once per atmospheric level instead\n"
+          "of once per level and pencil beam.  With a positive\n"
+          "*propmat_cache_tolerance*, pressures, temperatures, VMRs and NLTE\n"
+          "values that differ by less than this relative amount mostly share an\n"
+          "entry, and get the result of the first of them.  The cache is only\n"
+          "used by methods that call *propmat_clearsky_agenda* per path point,\n"
+          "e.g., *iyEmissionStandard*.  The agenda must not depend on anything\n"
+          "else that changes during the call.\n"),
       AUTHORS("Patrick Eriksson"),
       OUT("y", "y_f", "y_pol", "y_pos", "y_los", "y_aux", "y_geo", "jacobian"),
       GOUT(),
@@ -20742,10 +21243,11 @@ void define_md_data_raw() {
          "jacobian_do",
          "jacobian_quantities",
          "iy_aux_vars"),
-      GIN(),
-      GIN_TYPE(),
-      GIN_DEFAULT(),
-      GIN_DESC()));
+      GIN("propmat_cache", "propmat_cache_tolerance"),
+      GIN_TYPE("Index", "Numeric"),
+      GIN_DEFAULT("0", "0"),
+      GIN_DESC("Number of atmospheric states to cache, 0 disables caching",
+               "Relative tolerance of cached states, 0 for exact matches")));
 
   md_data_raw.push_back(create_mdrecord(
       NAME("yCalcAppend"),
@@ -20835,12 +21337,17 @@ void define_md_data_raw() {
          "jacobian_do",
          "jacobian_quantities",
          "iy_aux_vars"),
-      GIN("jacobian_quantities_copy", "append_instrument_wfs"),
-      GIN_TYPE("ArrayOfRetrievalQuantity", "Index"),
-      GIN_DEFAULT(NODEF, "0"),
+      GIN("jacobian_quantities_copy",
+          "append_instrument_wfs",
+          "propmat_cache",
+          "propmat_cache_tolerance"),
+      GIN_TYPE("ArrayOfRetrievalQuantity", "Index", "Index", "Numeric"),
+      GIN_DEFAULT(NODEF, "0", "0", "0"),
       GIN_DESC("Copy of *jacobian_quantities* of first measurement.",
                "Flag controlling if instrumental weighting functions are "
-               "appended or treated as different retrieval quantities.")));
+               "appended or treated as different retrieval quantities.",
+               "As for *yCalc*.",
+               "As for *yCalc*.")));
 
   md_data_raw.push_back(create_mdrecord(
       NAME("yActive"),
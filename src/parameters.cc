@@ -128,7 +128,9 @@ bool get_parameters(int argc, char **argv) {
       {"methods", required_argument, NULL, 'm'},
       {"numthreads", required_argument, NULL, 'n'},
       {"outdir", required_argument, NULL, 'o'},
+      {"parse-cache", required_argument, NULL, 'c'},
       {"plain", no_argument, NULL, 'p'},
+      {"profile", required_argument, NULL, 'P'},
       {"reporting", required_argument, NULL, 'r'},
 #ifdef ENABLE_DOCSERVER
       {"docserver", optional_argument, NULL, 's'},
@@ -136,11 +138,13 @@ bool get_parameters(int argc, char **argv) {
       {"baseurl", required_argument, NULL, 'U'},
 #endif
       {"workspacevariables", required_argument, NULL, 'w'},
+      {"server", required_argument, NULL, 'x'},
+      {"connect", required_argument, NULL, 'X'},
       {"version", no_argument, NULL, 'v'},
       {NULL, no_argument, NULL, 0}};
 
   parameters.usage =
-      "Usage: arts [-bBdghimnrsSvw]\n"
+      "Usage: arts [-bBcdghimnPrsSvwxX]\n"
       "       [--basename <name>]\n"
       "       [--describe <method or variable>]\n"
       "       [--groups]\n"
@@ -151,13 +155,17 @@ bool get_parameters(int argc, char **argv) {
       "       [--methods all|<variable>]\n"
       "       [--numthreads <#>\n"
       "       [--outdir <name>]\n"
+      "       [--parse-cache <dir>]\n"
       "       [--plain]\n"
+      "       [--profile <file>]\n"
       "       [--reporting <xyz>]\n"
 #ifdef ENABLE_DOCSERVER
       "       [--docserver[=<port>] --baseurl=BASEURL]\n"
       "       [--docdaemon[=<port>] --baseurl=BASEURL]\n"
 #endif
       "       [--workspacevariables all|<method>]\n"
+      "       [--server <socket>]\n"
+      "       [--connect <socket>]\n"
       "       file1.arts file2.arts ...";
 
   parameters.helptext =
@@ -196,8 +204,18 @@ bool get_parameters(int argc, char **argv) {
       "-o, --outdir        Set the output directory for the report\n"
       "                    file and for other output files with relative paths.\n"
       "                    Default is the current directory.\n"
+      "-c  --parse-cache   Keep parsed control files in this directory and\n"
+      "                    reuse them while neither the control file, its\n"
+      "                    includes nor the ARTS build have changed.\n"
+      "                    Can also be set by the environment variable\n"
+      "                    ARTS_PARSE_CACHE.\n"
       "-p  --plain         Generate plain help output suitable for\n"
       "                    script processing.\n"
+      "-P  --profile       Record wall time and call counts of all agendas\n"
+      "                    and workspace methods, nested by caller and per\n"
+      "                    thread, and write them to the given file at exit.\n"
+      "                    The report is JSON, or the folded stack format of\n"
+      "                    flamegraph.pl if the file name ends with .folded.\n"
       "-r, --reporting     Three digit integer. Sets the reporting\n"
       "                    level for agenda calls (first digit),\n"
       "                    screen (second digit) and file (third \n"
@@ -219,6 +237,13 @@ bool get_parameters(int argc, char **argv) {
       "                    it simply prints a list of all variables.\n"
       "                    If it is given the name of a method, it\n"
       "                    prints all variables needed by this method.\n"
+      "-x, --server        Run the control files, which typically read large\n"
+      "                    input data, then wait for jobs on the given Unix\n"
+      "                    socket. Each job runs in a copy of the prepared\n"
+      "                    workspace. Stop the server with SIGINT or SIGTERM.\n"
+      "-X, --connect       Run the control files on the server listening on\n"
+      "                    the given Unix socket. Output appears here, output\n"
+      "                    files are written to the current directory.\n"
 #ifdef ENABLE_DOCSERVER
       "\nDEVELOPER ONLY:\n\n"
       "-C, --check-docs    Check for broken links in built-in docs.\n"
@@ -274,6 +299,9 @@ bool get_parameters(int argc, char **argv) {
       case 'b':
         parameters.basename = optarg;
         break;
+      case 'c':
+        parameters.parsecache = optarg;
+        break;
       case 'd':
         parameters.describe = optarg;
         break;
@@ -310,6 +338,9 @@ bool get_parameters(int argc, char **argv) {
       case 'p':
         parameters.plain = true;
         break;
+      case 'P':
+        parameters.profile = optarg;
+        break;
       case 'r': {
         //      cout << "optarg = " << optarg << endl;
         istringstream iss(optarg);
@@ -360,6 +391,12 @@ bool get_parameters(int argc, char **argv) {
       case 'w':
         parameters.workspacevariables = optarg;
         break;
+      case 'x':
+        parameters.server = optarg;
+        break;
+      case 'X':
+        parameters.connect = optarg;
+        break;
       default:
         // There were strange options.
         return (1);
@@ -382,6 +419,9 @@ bool get_parameters(int argc, char **argv) {
                               parameters.includepath);
   parse_path_from_environment(String("ARTS_DATA_PATH"), parameters.datapath);
 
+  if (!parameters.parsecache.nelem() && getenv("ARTS_PARSE_CACHE"))
+    parameters.parsecache = getenv("ARTS_PARSE_CACHE");
+
 #ifdef ARTS_DEFAULT_INCLUDE_DIR
   String arts_default_include_path(ARTS_DEFAULT_INCLUDE_DIR);
   if (arts_default_include_path != "" && !parameters.includepath.nelem()) {
@@ -65,6 +65,10 @@ class Parameters {
         baseurl(""),
         daemon(false),
         gui(false),
+        profile(""),
+        parsecache(""),
+        server(""),
+        connect(""),
         check_docs(false) { /* Nothing to be done here */
     }
 
@@ -129,6 +133,19 @@ class Parameters {
   bool daemon;
   /** Flag to run with graphical user interface. */
   bool gui;
+  /** If this is specified (with the -P --profile option), the agendas
+      and workspace methods are profiled and the report is written to
+      this file at exit. */
+  String profile;
+  /** If this is specified (with the -c --parse-cache option), parsed
+      control files are cached in this directory. */
+  String parsecache;
+  /** If this is specified (with the -x --server option), the control
+      files are run and then jobs are accepted on this Unix socket. */
+  String server;
+  /** If this is specified (with the -X --connect option), the control
+      files are run by the server listening on this Unix socket. */
+  String connect;
   /** Flag to check built-in documentation */
   bool check_docs;
 };
@@ -23,6 +23,7 @@
 #include "global_data.h"
 #include "methods.h"
 #include "parameters.h"
+#include "parser_cache.h"
 #include "workspace_ng.h"
 #include "wsv_aux.h"
 
@@ -30,24 +31,46 @@
 
     \param[out] tasklist    Method list read from the controlfile.
     \param[in]  controlfile Path to the controlfile.
+    \param[in]  use_cache   Use the parse cache, if it is enabled. False
+                            for included files, which are cached as part
+                            of the file that includes them.
 
     \author Oliver Lemke
 */
 ArtsParser::ArtsParser(Agenda& tasklist,
                        String controlfile,
-                       const Verbosity& rverbosity)
+                       const Verbosity& rverbosity,
+                       const bool use_cache)
     : mtasklist(tasklist),
       mcfile(controlfile),
       mcfile_version(1),
-      verbosity(rverbosity) {
+      verbosity(rverbosity),
+      muse_cache(use_cache),
+      mfiles(1, controlfile) {
   msource.AppendFile(mcfile);
 }
 
 /** Public interface to the main function of the parser.
 
+    If a parse cache directory is set, a valid cached result is used
+    instead of parsing, and a new result is added to the cache.
+
     \author Oliver Lemke
 */
-void ArtsParser::parse_tasklist() { parse_main(); }
+void ArtsParser::parse_tasklist() {
+  extern Parameters parameters;
+
+  if (!muse_cache || !parameters.parsecache.nelem()) {
+    parse_main();
+    return;
+  }
+
+  ParserCache cache(parameters.parsecache, mcfile);
+  if (cache.load(mtasklist, verbosity)) return;
+
+  parse_main();
+  cache.store(mtasklist, mfiles, verbosity);
+}
 
 /** Find named arguments.
 
@@ -388,8 +411,11 @@ void ArtsParser::parse_agenda(Agenda& tasklist, const String& agenda_name) {
       include_file = matching_files[0];
       out2 << "- Including control file " << include_file << "\n";
 
-      ArtsParser include_parser(tasks, include_file, verbosity);
+      ArtsParser include_parser(tasks, include_file, verbosity, false);
       include_parser.parse_tasklist();
+      mfiles.insert(mfiles.end(),
+                    include_parser.files().begin(),
+                    include_parser.files().end());
 
       for (Index i = 0; i < tasks.nelem(); i++)
         tasklist.push_back(tasks.Methods()[i]);
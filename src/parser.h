@@ -25,10 +25,16 @@
 
 class ArtsParser {
  public:
-  ArtsParser(Agenda& tasklist, String controlfile, const Verbosity& verbosity);
+  ArtsParser(Agenda& tasklist,
+             String controlfile,
+             const Verbosity& verbosity,
+             const bool use_cache = true);
 
   void parse_tasklist();
 
+  /** The control file and all files it included */
+  const ArrayOfString& files() const { return mfiles; }
+
  private:
   typedef struct {
     String name;
@@ -167,6 +173,12 @@ class ArtsParser {
   Index mcfile_version;
 
   const Verbosity& verbosity;
+
+  /** Read and write the parse cache, if it is enabled. */
+  bool muse_cache;
+
+  /** The control file and all files it included */
+  ArrayOfString mfiles;
 };
 
 #endif /* parser_h */
@@ -0,0 +1,440 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   parser_cache.cc
+  \author agent
+  \date   2026-10-16
+
+  \brief  On-disk cache of parsed control files.
+*/
+
+#include "parser_cache.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "auto_version.h"
+#include "global_data.h"
+#include "parameters.h"
+#include "workspace_ng.h"
+#include "wsv_aux.h"
+
+extern Parameters parameters;
+
+namespace {
+
+const char magic[] = "ARTSPARSE1\n";
+const std::size_t magic_size = sizeof(magic) - 1;
+
+/** 64 bit FNV-1a hash */
+class Hash {
+ public:
+  Hash& add(const char* data, const std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+      mh ^= static_cast<unsigned char>(data[i]);
+      mh *= 1099511628211ULL;
+    }
+    return *this;
+  }
+
+  Hash& add(const Index i) {
+    const std::int64_t v = i;
+    return add(reinterpret_cast<const char*>(&v), sizeof(v));
+  }
+
+  Hash& add(const String& s) {
+    add(Index(s.size()));
+    return add(s.data(), s.size());
+  }
+
+  Hash& add(const ArrayOfIndex& a) {
+    add(a.nelem());
+    for (const Index i : a) add(i);
+    return *this;
+  }
+
+  Hash& add(const ArrayOfString& a) {
+    add(a.nelem());
+    for (const String& s : a) add(s);
+    return *this;
+  }
+
+  std::uint64_t value() const { return mh; }
+
+ private:
+  std::uint64_t mh{14695981039346656037ULL};
+};
+
+bool read_file(const String& filename, std::string& data) {
+  std::ifstream is(filename.c_str(), std::ios::binary);
+  if (!is) return false;
+  data.assign(std::istreambuf_iterator<char>(is),
+              std::istreambuf_iterator<char>());
+  return !is.bad();
+}
+
+bool file_hash(const String& filename, std::uint64_t& hash) {
+  std::string data;
+  if (!read_file(filename, data)) return false;
+  hash = Hash().add(data.data(), data.size()).value();
+  return true;
+}
+
+class Writer {
+ public:
+  void put(const Index i) {
+    const std::int64_t v = i;
+    mbuffer.append(reinterpret_cast<const char*>(&v), sizeof(v));
+  }
+
+  void put(const Numeric x) {
+    mbuffer.append(reinterpret_cast<const char*>(&x), sizeof(x));
+  }
+
+  void put(const String& s) {
+    put(Index(s.size()));
+    mbuffer.append(s);
+  }
+
+  void put(const ArrayOfIndex& a) {
+    put(a.nelem());
+    for (const Index i : a) put(i);
+  }
+
+  void put(const ArrayOfString& a) {
+    put(a.nelem());
+    for (const String& s : a) put(s);
+  }
+
+  void put(const TokVal& tv) {
+    put(Index(tv.type()));
+    switch (tv.type()) {
+      case String_t: {
+        const String v = tv;
+        put(v);
+        break;
+      }
+      case Index_t:
+        put(Index(tv));
+        break;
+      case Numeric_t:
+        put(Numeric(tv));
+        break;
+      case Array_String_t: {
+        const ArrayOfString v = tv;
+        put(v);
+        break;
+      }
+      case Array_Index_t: {
+        const ArrayOfIndex v = tv;
+        put(v);
+        break;
+      }
+      case Vector_t: {
+        const Vector v = tv;
+        put(v.nelem());
+        for (const Numeric x : v) put(x);
+        break;
+      }
+      case Matrix_t: {
+        const Matrix m = tv;
+        put(m.nrows());
+        put(m.ncols());
+        for (Index r = 0; r < m.nrows(); r++)
+          for (Index c = 0; c < m.ncols(); c++) put(m(r, c));
+        break;
+      }
+      case undefined_t:
+        break;
+    }
+  }
+
+  void put(const Agenda& a) {
+    put(a.nelem());
+    for (const MRecord& m : a.Methods()) {
+      put(m.Id());
+      put(m.Out());
+      put(m.In());
+      put(m.SetValue());
+      put(Index(m.isInternal()));
+      put(m.Tasks());
+    }
+  }
+
+  const std::string& buffer() const { return mbuffer; }
+
+ private:
+  std::string mbuffer;
+};
+
+/** Reads what Writer wrote, throws if the data ends early */
+class Reader {
+ public:
+  Reader(const std::string& data) : mdata(data), mpos(0) {}
+
+  void raw(char* dst, const std::size_t n) {
+    if (mdata.size() - mpos < n)
+      throw std::runtime_error("Parse cache entry is incomplete");
+    std::memcpy(dst, mdata.data() + mpos, n);
+    mpos += n;
+  }
+
+  Index index() {
+    std::int64_t v;
+    raw(reinterpret_cast<char*>(&v), sizeof(v));
+    return v;
+  }
+
+  Index size() {
+    const Index n = index();
+    if (n < 0 || std::size_t(n) > mdata.size() - mpos)
+      throw std::runtime_error("Parse cache entry is corrupt");
+    return n;
+  }
+
+  Numeric numeric() {
+    Numeric x;
+    raw(reinterpret_cast<char*>(&x), sizeof(x));
+    return x;
+  }
+
+  String string() {
+    String s(std::size_t(size()), ' ');
+    if (s.size()) raw(&s[0], s.size());
+    return s;
+  }
+
+  ArrayOfIndex indices() {
+    ArrayOfIndex a(size());
+    for (Index& i : a) i = index();
+    return a;
+  }
+
+  ArrayOfString strings() {
+    ArrayOfString a(size());
+    for (String& s : a) s = string();
+    return a;
+  }
+
+  TokVal tokval() {
+    switch (index()) {
+      case String_t:
+        return TokVal(string());
+      case Index_t:
+        return TokVal(index());
+      case Numeric_t:
+        return TokVal(numeric());
+      case Array_String_t:
+        return TokVal(strings());
+      case Array_Index_t:
+        return TokVal(indices());
+      case Vector_t: {
+        Vector v(size());
+        for (Index i = 0; i < v.nelem(); i++) v[i] = numeric();
+        return TokVal(v);
+      }
+      case Matrix_t: {
+        const Index nr = size();
+        const Index nc = size();
+        Matrix m(nr, nc);
+        for (Index r = 0; r < nr; r++)
+          for (Index c = 0; c < nc; c++) m(r, c) = numeric();
+        return TokVal(m);
+      }
+      case undefined_t:
+        return TokVal();
+    }
+    throw std::runtime_error("Parse cache entry is corrupt");
+  }
+
+  /** Reads an agenda and checks that all ids are valid */
+  void agenda(Agenda& a, const Index nwsv) {
+    using global_data::md_data;
+
+    const Index n = size();
+    for (Index i = 0; i < n; i++) {
+      const Index id = index();
+      const ArrayOfIndex out = indices();
+      const ArrayOfIndex in = indices();
+      const TokVal value = tokval();
+      const bool internal = index();
+      Agenda tasks;
+      agenda(tasks, nwsv);
+
+      bool valid = id >= 0 && id < md_data.nelem();
+      for (const Index v : out) valid = valid && v >= 0 && v < nwsv;
+      for (const Index v : in) valid = valid && v >= 0 && v < nwsv;
+      if (!valid) throw std::runtime_error("Parse cache entry is corrupt");
+
+      a.push_back(MRecord(id, out, in, value, tasks, internal));
+    }
+  }
+
+  bool at_end() const { return mpos == mdata.size(); }
+
+ private:
+  const std::string& mdata;
+  std::size_t mpos;
+};
+
+}  // namespace
+
+ParserCache::ParserCache(const String& cachedir, const String& controlfile)
+    : mfilename(), mkey(0), mnwsv(Workspace::wsv_data.nelem()) {
+  using global_data::md_data;
+
+  Hash h;
+  h.add(String(ARTS_FULL_VERSION));
+
+  h.add(md_data.nelem());
+  for (const MdRecord& m : md_data) {
+    h.add(m.Name());
+    h.add(m.Out()).add(m.GOutType());
+    h.add(m.In()).add(m.GIn()).add(m.GInType()).add(m.GInDefault());
+    h.add(m.ActualGroups());
+    h.add(Index(m.SetMethod())).add(Index(m.AgendaMethod()));
+  }
+
+  h.add(mnwsv);
+  for (const WsvRecord& w : Workspace::wsv_data) h.add(w.Name()).add(w.Group());
+
+  h.add(parameters.includepath).add(parameters.datapath);
+
+  char cwd[4096];
+  h.add(String(::getcwd(cwd, sizeof(cwd)) ? cwd : ""));
+
+  std::uint64_t content = 0;
+  file_hash(controlfile, content);
+  h.add(controlfile).add(Index(content));
+
+  mkey = h.value();
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.parse", (unsigned long long)mkey);
+  mfilename = cachedir + "/" + name;
+}
+
+bool ParserCache::load(Agenda& tasklist, const Verbosity& verbosity) {
+  CREATE_OUT2;
+
+  std::string data;
+  if (!read_file(mfilename, data)) return false;
+
+  std::vector<WsvRecord> wsvs;
+  ArrayOfString datapath;
+  Agenda methods;
+
+  try {
+    Reader r(data);
+
+    char head[magic_size];
+    r.raw(head, magic_size);
+    if (std::memcmp(head, magic, magic_size) != 0) return false;
+    if (std::uint64_t(r.index()) != mkey) return false;
+
+    const Index nfiles = r.size();
+    for (Index i = 0; i < nfiles; i++) {
+      const String file = r.string();
+      const std::uint64_t hash = std::uint64_t(r.index());
+      std::uint64_t current;
+      if (!file_hash(file, current) || current != hash) return false;
+    }
+
+    const Index nnew = r.size();
+    for (Index i = 0; i < nnew; i++) {
+      const String name = r.string();
+      const String description = r.string();
+      const Index group = r.index();
+      const bool implicit = r.index();
+      if (group < 0 || group >= global_data::wsv_group_names.nelem())
+        return false;
+      wsvs.emplace_back(name.c_str(), description.c_str(), group, implicit);
+    }
+
+    datapath = r.strings();
+    r.agenda(methods, mnwsv + nnew);
+    if (!r.at_end()) return false;
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  for (const WsvRecord& w : wsvs) Workspace::add_wsv(w);
+  parameters.datapath = datapath;
+  tasklist.set_methods(methods.Methods());
+
+  out2 << "- Using cached parse result " << mfilename << "\n";
+  return true;
+}
+
+void ParserCache::store(const Agenda& tasklist,
+                        const ArrayOfString& files,
+                        const Verbosity& verbosity) const {
+  CREATE_OUT1;
+
+  Writer w;
+  w.put(Index(mkey));
+
+  w.put(files.nelem());
+  for (const String& file : files) {
+    std::uint64_t hash;
+    if (!file_hash(file, hash)) return;
+    w.put(file);
+    w.put(Index(hash));
+  }
+
+  w.put(Workspace::wsv_data.nelem() - mnwsv);
+  for (Index i = mnwsv; i < Workspace::wsv_data.nelem(); i++) {
+    const WsvRecord& wsv = Workspace::wsv_data[i];
+    w.put(wsv.Name());
+    w.put(wsv.Description());
+    w.put(wsv.Group());
+    w.put(Index(wsv.Implicit()));
+  }
+
+  w.put(parameters.datapath);
+  w.put(tasklist);
+
+  // Written under a temporary name and renamed, so that concurrent runs
+  // never see a partial entry
+  const std::size_t slash = mfilename.rfind('/');
+  if (slash != std::string::npos) ::mkdir(mfilename.substr(0, slash).c_str(), 0777);
+
+  const String tmpname = mfilename + "." + std::to_string(::getpid());
+  {
+    std::ofstream os(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+    os.write(magic, magic_size);
+    os.write(w.buffer().data(), std::streamsize(w.buffer().size()));
+    if (os) os.close();
+    if (!os) {
+      std::remove(tmpname.c_str());
+      out1 << "  Cannot write parse cache file " << tmpname << "\n";
+      return;
+    }
+  }
+
+  if (std::rename(tmpname.c_str(), mfilename.c_str()) != 0) {
+    out1 << "  Cannot write parse cache file " << mfilename << ": "
+         << std::strerror(errno) << "\n";
+    std::remove(tmpname.c_str());
+  }
+}
@@ -0,0 +1,89 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   parser_cache.h
+  \author agent
+  \date   2026-10-16
+
+  \brief  On-disk cache of parsed control files.
+
+  A cache entry holds the method list that the parser made from a control
+  file and its includes, with method and variable ids already resolved and
+  literal values already converted. It also holds the workspace variables
+  that the parser created, and the data path, which the parser extends by
+  the directories of include files.
+
+  Entries are found by a key that covers everything the parse result
+  depends on: the ARTS version, the method and variable tables, the
+  include and data paths, the working directory, and the name and
+  content of the control file. An entry also lists the content hashes of
+  all included files and is only used if none of them has changed.
+
+  All numbers are stored in the native binary format of the machine, the
+  cache is not meant to be shared between different machines.
+*/
+
+#ifndef parser_cache_h
+#define parser_cache_h
+
+#include <cstdint>
+#include "agenda_class.h"
+#include "messages.h"
+#include "mystring.h"
+
+/** The cache entry of one control file */
+class ParserCache {
+ public:
+  /** Computes the key of the control file
+   *
+   * Must be called before the control file is parsed, as parsing
+   * changes the state that is part of the key.
+   *
+   * @param[in] cachedir Directory of the cache files
+   * @param[in] controlfile The control file
+   */
+  ParserCache(const String& cachedir, const String& controlfile);
+
+  /** Loads the entry, if there is a valid one
+   *
+   * On success, the workspace variables of the entry are created and the
+   * data path is set as after the parse. Nothing is changed otherwise.
+   *
+   * @param[out] tasklist The methods of the control file
+   * @param[in] verbosity Verbosity
+   * @return True if the entry was found and is valid
+   */
+  bool load(Agenda& tasklist, const Verbosity& verbosity);
+
+  /** Stores the entry after the control file was parsed
+   *
+   * @param[in] tasklist The methods of the control file
+   * @param[in] files The control file and all files it included
+   * @param[in] verbosity Verbosity
+   */
+  void store(const Agenda& tasklist,
+             const ArrayOfString& files,
+             const Verbosity& verbosity) const;
+
+ private:
+  String mfilename;
+  std::uint64_t mkey;
+  Index mnwsv;
+};
+
+#endif  // parser_cache_h
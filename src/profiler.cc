@@ -0,0 +1,261 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   profiler.cc
+  \author agent
+  \date   2026-10-16
+
+  \brief  Hierarchical wall time profiler for agendas and workspace methods.
+*/
+
+#include "profiler.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "arts.h"
+#include "arts_omp.h"
+
+namespace Profiler {
+
+std::atomic<bool> is_enabled{false};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** One agenda or method in the context of its callers */
+struct Node {
+  Kind kind;
+  String name;
+  Index parent;
+  Index calls{0};
+  Numeric inclusive{0};
+  Numeric children{0};
+  std::map<std::pair<Kind, String>, Index> child_index{};
+};
+
+/** The call tree of one thread, node 0 is the root */
+struct ThreadProfile {
+  Index id;
+  Index omp_thread;
+  std::vector<Node> nodes;
+  Index current{0};
+  std::vector<Clock::time_point> starts{};
+
+  ThreadProfile(Index i, Index t)
+      : id(i), omp_thread(t), nodes{{Kind::Agenda, "", -1}} {}
+};
+
+/** All threads that have been profiled, and the report file */
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadProfile>> threads;
+  String filename;
+  bool at_exit{false};
+};
+
+Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+ThreadProfile& this_thread() {
+  thread_local ThreadProfile* tp = nullptr;
+  if (not tp) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.emplace_back(new ThreadProfile(Index(r.threads.size()),
+                                             arts_omp_get_thread_num()));
+    tp = r.threads.back().get();
+  }
+  return *tp;
+}
+
+void report_at_exit() {
+  const String filename = registry().filename;
+  if (filename.nelem()) {
+    try {
+      write_report(filename);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << '\n';
+    }
+  }
+}
+
+const char* kind_name(Kind kind) {
+  return kind == Kind::Agenda ? "agenda" : "method";
+}
+
+/** Writes a JSON string, only quotes and backslashes need escaping */
+void write_json_string(std::ostream& os, const String& s) {
+  os << '"';
+  for (const char c : s) {
+    if (c == '"' or c == '\\') os << '\\';
+    os << c;
+  }
+  os << '"';
+}
+
+void write_json_node(std::ostream& os,
+                     const ThreadProfile& tp,
+                     const Index i,
+                     const String& indent) {
+  const Node& n = tp.nodes[i];
+  os << indent << "{\"type\": \"" << kind_name(n.kind) << "\", \"name\": ";
+  write_json_string(os, n.name);
+  os << ", \"calls\": " << n.calls << ", \"inclusive\": " << n.inclusive
+     << ", \"exclusive\": " << n.inclusive - n.children
+     << ", \"children\": [";
+  bool first = true;
+  for (const auto& c : n.child_index) {
+    os << (first ? "\n" : ",\n");
+    write_json_node(os, tp, c.second, indent + "  ");
+    first = false;
+  }
+  if (not first) os << '\n' << indent;
+  os << "]}";
+}
+
+void write_folded_node(std::ostream& os,
+                       const ThreadProfile& tp,
+                       const Index i,
+                       const String& path) {
+  const Node& n = tp.nodes[i];
+  const String this_path = path + ';' + n.name;
+  const Numeric exclusive = n.inclusive - n.children;
+  if (exclusive > 0)
+    os << this_path << ' ' << Index(exclusive * 1e6 + 0.5) << '\n';
+  for (const auto& c : n.child_index)
+    write_folded_node(os, tp, c.second, this_path);
+}
+
+}  // namespace
+
+void enable(const String& filename) {
+  Registry& r = registry();
+  {
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.filename = filename;
+    if (not r.at_exit) {
+      std::atexit(report_at_exit);
+      r.at_exit = true;
+    }
+  }
+  is_enabled = true;
+}
+
+void disable() { is_enabled = false; }
+
+void clear() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto& tp : r.threads) {
+    tp->nodes.resize(1);
+    tp->nodes[0].calls = 0;
+    tp->nodes[0].inclusive = 0;
+    tp->nodes[0].children = 0;
+    tp->nodes[0].child_index.clear();
+    tp->current = 0;
+    tp->starts.clear();
+  }
+}
+
+void write_json(std::ostream& os) {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  os << "{\"unit\": \"s\", \"threads\": [";
+  bool first = true;
+  for (const auto& tp : r.threads) {
+    if (tp->nodes[0].child_index.empty()) continue;
+    os << (first ? "\n" : ",\n") << "  {\"id\": " << tp->id
+       << ", \"omp_thread\": " << tp->omp_thread << ", \"calls\": [";
+    bool first_call = true;
+    for (const auto& c : tp->nodes[0].child_index) {
+      os << (first_call ? "\n" : ",\n");
+      write_json_node(os, *tp, c.second, "    ");
+      first_call = false;
+    }
+    os << "\n  ]}";
+    first = false;
+  }
+  os << "\n]}\n";
+}
+
+void write_folded(std::ostream& os) {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (const auto& tp : r.threads)
+    for (const auto& c : tp->nodes[0].child_index)
+      write_folded_node(os, *tp, c.second, "thread " + std::to_string(tp->id));
+}
+
+void write_report(const String& filename) {
+  std::ofstream os(filename.c_str());
+  if (not os)
+    throw std::runtime_error("Cannot open profile report file " + filename);
+
+  os << std::setprecision(9);
+  const String folded = ".folded";
+  if (filename.nelem() >= folded.nelem() and
+      filename.compare(
+          filename.nelem() - folded.nelem(), folded.nelem(), folded) == 0)
+    write_folded(os);
+  else
+    write_json(os);
+
+  if (not os)
+    throw std::runtime_error("Error writing profile report file " + filename);
+}
+
+void Scope::enter(Kind kind, const String& name) {
+  ThreadProfile& tp = this_thread();
+  auto key = std::make_pair(kind, name);
+  auto child = tp.nodes[tp.current].child_index.find(key);
+  Index i;
+  if (child == tp.nodes[tp.current].child_index.end()) {
+    i = Index(tp.nodes.size());
+    tp.nodes[tp.current].child_index.emplace(std::move(key), i);
+    tp.nodes.push_back({kind, name, tp.current});
+  } else {
+    i = child->second;
+  }
+  tp.current = i;
+  tp.starts.push_back(Clock::now());
+}
+
+void Scope::leave() {
+  ThreadProfile& tp = this_thread();
+  const Numeric dt =
+      std::chrono::duration<Numeric>(Clock::now() - tp.starts.back()).count();
+  tp.starts.pop_back();
+
+  Node& n = tp.nodes[tp.current];
+  n.calls++;
+  n.inclusive += dt;
+  tp.current = n.parent;
+  tp.nodes[tp.current].children += dt;
+}
+
+}  // namespace Profiler
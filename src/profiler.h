@@ -0,0 +1,118 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   profiler.h
+  \author agent
+  \date   2026-10-16
+
+  \brief  Hierarchical wall time profiler for agendas and workspace methods.
+
+  When enabled, every agenda execution and every workspace method call
+  is timed. The calls are kept as one call tree per thread, where each
+  node is an agenda or method in the context of its callers. For each
+  node the number of calls and the inclusive and exclusive wall time
+  are recorded.
+
+  When disabled, which is the default, a Scope costs one relaxed atomic
+  load.
+*/
+
+#ifndef profiler_h
+#define profiler_h
+
+#include <atomic>
+#include <iosfwd>
+#include "mystring.h"
+
+namespace Profiler {
+
+/** The kind of a profiled call */
+enum class Kind : char { Agenda, Method };
+
+/** Profiling is on if this is true, use enabled() to read it */
+extern std::atomic<bool> is_enabled;
+
+/** True if calls are profiled */
+inline bool enabled() noexcept {
+  return is_enabled.load(std::memory_order_relaxed);
+}
+
+/** Starts profiling
+ *
+ * The report is written to filename when the program exits.  The
+ * report is in JSON, or in the folded stack format of flamegraph.pl if
+ * filename ends with ".folded".  An empty filename disables the report
+ * at exit, the report can then be written with write_report.
+ *
+ * @param[in] filename The report file, or empty
+ */
+void enable(const String& filename);
+
+/** Stops profiling, the recorded calls are kept */
+void disable();
+
+/** Drops all recorded calls
+ *
+ * Must not be called while profiled calls are running.
+ */
+void clear();
+
+/** Writes the report of all threads as JSON */
+void write_json(std::ostream& os);
+
+/** Writes the report of all threads in the folded stack format
+ *
+ * One line per call path with the exclusive time in microseconds, as
+ * read by flamegraph.pl
+ */
+void write_folded(std::ostream& os);
+
+/** Writes the report to a file
+ *
+ * @param[in] filename The file, folded stack format if it ends with
+ * ".folded" and JSON otherwise
+ */
+void write_report(const String& filename);
+
+/** Times one call while it is in scope
+ *
+ * The call is a child of the innermost Scope of this thread.
+ */
+class Scope {
+ public:
+  Scope(Kind kind, const String& name) : mactive(enabled()) {
+    if (mactive) enter(kind, name);
+  }
+
+  ~Scope() {
+    if (mactive) leave();
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  bool mactive;
+
+  static void enter(Kind kind, const String& name);
+  static void leave();
+};
+
+}  // namespace Profiler
+
+#endif  // profiler_h
@@ -0,0 +1,161 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   propmat_cache.cc
+  \author agent
+  \date   2026-10-16
+
+  \brief  Cache of clearsky propagation matrices keyed by atmospheric state.
+*/
+
+#include "propmat_cache.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "workspace_ng.h"
+
+PropmatCache::PropmatCache(Index n, Numeric tolerance)
+    : mcapacity(n),
+      mtolerance(tolerance),
+      mlogbin(tolerance > 0 ? std::log1p(tolerance) : 0),
+      mhits(0) {}
+
+void PropmatCache::add(Key& key, Numeric x) const {
+  if (mtolerance > 0) {
+    // Sign and logarithmic bin, so that the bins have a relative width
+    key.push_back(Numeric((x > 0) - (x < 0)));
+    key.push_back(x == 0 ? 0
+                         : std::nearbyint(std::log(std::abs(x)) / mlogbin));
+  } else {
+    key.push_back(x + 0.0);  // No negative zero
+  }
+}
+
+PropmatCache::Key PropmatCache::MakeKey(ConstVectorView f_grid,
+                                        ConstVectorView mag,
+                                        ConstVectorView los,
+                                        const EnergyLevelMap& nlte,
+                                        ConstVectorView vmrs,
+                                        Numeric t,
+                                        Numeric p,
+                                        Index nq,
+                                        bool jacobian_do) const {
+  const Tensor4& nlte_data = nlte.Data();
+  const Index nnlte = nlte_data.nbooks() * nlte_data.npages() *
+                      nlte_data.nrows() * nlte_data.ncols();
+
+  Key key;
+  key.reserve(f_grid.nelem() + mag.nelem() + los.nelem() +
+              2 * (nnlte + vmrs.nelem() + 2) + 8);
+
+  // The sizes keep the parts apart
+  key.push_back(Numeric(nq));
+  key.push_back(Numeric(jacobian_do));
+  key.push_back(Numeric(f_grid.nelem()));
+  key.push_back(Numeric(mag.nelem()));
+  key.push_back(Numeric(los.nelem()));
+  key.push_back(Numeric(nnlte));
+  key.push_back(Numeric(vmrs.nelem()));
+
+  for (Index i = 0; i < f_grid.nelem(); i++) key.push_back(f_grid[i]);
+  for (Index i = 0; i < mag.nelem(); i++) key.push_back(mag[i] + 0.0);
+  for (Index i = 0; i < los.nelem(); i++) key.push_back(los[i] + 0.0);
+
+  add(key, p);
+  add(key, t);
+  for (Index i = 0; i < vmrs.nelem(); i++) add(key, vmrs[i]);
+  for (Index i = 0; i < nlte_data.nbooks(); i++)
+    for (Index j = 0; j < nlte_data.npages(); j++)
+      for (Index k = 0; k < nlte_data.nrows(); k++)
+        for (Index l = 0; l < nlte_data.ncols(); l++)
+          add(key, nlte_data(i, j, k, l));
+
+  return key;
+}
+
+std::size_t PropmatCache::KeyHash::operator()(const Key& key) const noexcept {
+  // FNV-1a on 64 bit words, the keys hold thousands of frequencies
+  std::uint64_t h = 14695981039346656037ull;
+  for (const Numeric x : key) {
+    std::uint64_t w;
+    std::memcpy(&w, &x, sizeof(w));
+    h ^= w;
+    h *= 1099511628211ull;
+  }
+  return std::size_t(h ^ (h >> 32));
+}
+
+std::shared_ptr<const PropmatCache::Value> PropmatCache::Find(const Key& key) {
+  std::shared_ptr<const Value> out;
+#pragma omp critical(PropmatCache)
+  {
+    auto pos = mindex.find(key);
+    if (pos not_eq mindex.end()) {
+      mentries.splice(mentries.begin(), mentries, pos->second);
+      out = pos->second->second;
+      mhits++;
+    }
+  }
+  return out;
+}
+
+void PropmatCache::Insert(const Key& key, std::shared_ptr<const Value> value) {
+#pragma omp critical(PropmatCache)
+  {
+    auto pos = mindex.find(key);
+    if (pos not_eq mindex.end()) {
+      pos->second->second = std::move(value);
+      mentries.splice(mentries.begin(), mentries, pos->second);
+    } else if (mcapacity > 0) {
+      mentries.emplace_front(key, std::move(value));
+      mindex[key] = mentries.begin();
+      while (Index(mentries.size()) > mcapacity) {
+        mindex.erase(mentries.back().first);
+        mentries.pop_back();
+      }
+    }
+  }
+}
+
+Index PropmatCache::size() const {
+  Index n;
+#pragma omp critical(PropmatCache)
+  n = Index(mentries.size());
+  return n;
+}
+
+Index PropmatCache::hits() const {
+  Index n;
+#pragma omp critical(PropmatCache)
+  n = mhits;
+  return n;
+}
+
+PropmatCacheScope::PropmatCacheScope(Workspace& ws, Index n, Numeric tolerance)
+    : mws(ws), mold(ws.propmat_cache), minstalled(n > 0) {
+  if (minstalled)
+    mws.propmat_cache = std::make_shared<PropmatCache>(n, tolerance);
+}
+
+PropmatCacheScope::~PropmatCacheScope() {
+  if (minstalled) mws.propmat_cache = mold;
+}
+
+const PropmatCache* PropmatCacheScope::cache() const {
+  return minstalled ? mws.propmat_cache.get() : nullptr;
+}
@@ -0,0 +1,177 @@
+/* Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA. */
+
+/*!
+  \file   propmat_cache.h
+  \author agent
+  \date   2026-10-16
+
+  \brief  Cache of clearsky propagation matrices keyed by atmospheric state.
+
+  Pencil beams of a measurement often pass through identical atmospheric
+  states, e.g. the levels of a 1D atmosphere seen by the beams of an
+  antenna pattern.  yCalc can install a PropmatCache in its workspace for
+  the duration of the call.  get_stepwise_clearsky_propmat then executes
+  propmat_clearsky_agenda only once per state, and the absorption work
+  scales with the number of distinct states instead of the number of
+  beams times path points.
+*/
+
+#ifndef propmat_cache_h
+#define propmat_cache_h
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "energylevelmap.h"
+#include "propagationmatrix.h"
+
+class Workspace;
+
+/** Outputs of get_stepwise_clearsky_propmat for atmospheric states
+ *
+ * The key of a state is made of the frequencies, the pressure, the
+ * temperature, the VMRs and the NLTE values, and of the magnetic field
+ * and the line of sight if propmat_clearsky_agenda uses them.  All other
+ * input of the agenda must stay constant while the cache is in use.
+ *
+ * With a positive tolerance, the pressure, temperature, VMRs and NLTE
+ * values are rounded to bins of that relative width, so states that
+ * differ by less than the tolerance mostly share an entry.  The result of
+ * the first state of a bin is then used for all of them.
+ *
+ * The least recently used entries are removed once more than Capacity()
+ * entries are stored.  All methods may be called concurrently from OpenMP
+ * threads.
+ */
+class PropmatCache {
+ public:
+  /** The outputs of get_stepwise_clearsky_propmat */
+  struct Value {
+    PropagationMatrix K;
+    StokesVector S;
+    Index lte;
+
+    /** Positions of the set derivatives in dK_dx and dS_dx */
+    ArrayOfIndex derivatives;
+    ArrayOfPropagationMatrix dK_dx;
+    ArrayOfStokesVector dS_dx;
+  };
+
+  /** The atmospheric state and the kind of call */
+  using Key = std::vector<Numeric>;
+
+  /** Creates an empty cache
+   *
+   * @param[in] n Maximum number of entries
+   * @param[in] tolerance Relative width of the bins of the state, 0 for
+   * exact matches
+   */
+  PropmatCache(Index n, Numeric tolerance);
+
+  /** Maximum number of entries */
+  Index Capacity() const noexcept { return mcapacity; }
+
+  /** Relative width of the bins of the state */
+  Numeric Tolerance() const noexcept { return mtolerance; }
+
+  /** Returns the key of a state
+   *
+   * Empty mag or los views leave them out of the key.
+   *
+   * @param[in] f_grid Frequencies
+   * @param[in] mag Magnetic field
+   * @param[in] los Line of sight
+   * @param[in] nlte NLTE values
+   * @param[in] vmrs Volume mixing ratios
+   * @param[in] t Temperature
+   * @param[in] p Pressure
+   * @param[in] nq Number of Jacobian quantities
+   * @param[in] jacobian_do Whether derivatives are computed
+   */
+  Key MakeKey(ConstVectorView f_grid,
+              ConstVectorView mag,
+              ConstVectorView los,
+              const EnergyLevelMap& nlte,
+              ConstVectorView vmrs,
+              Numeric t,
+              Numeric p,
+              Index nq,
+              bool jacobian_do) const;
+
+  /** Returns the value stored for key, or nullptr if there is none */
+  std::shared_ptr<const Value> Find(const Key& key);
+
+  /** Stores the value of key */
+  void Insert(const Key& key, std::shared_ptr<const Value> value);
+
+  /** Number of stored entries */
+  Index size() const;
+
+  /** Number of successful Find calls */
+  Index hits() const;
+
+ private:
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const noexcept;
+  };
+
+  using List = std::list<std::pair<Key, std::shared_ptr<const Value>>>;
+
+  /** Appends x to key, rounded to a bin if there is a tolerance */
+  void add(Key& key, Numeric x) const;
+
+  Index mcapacity;
+  Numeric mtolerance;
+  Numeric mlogbin;
+  Index mhits;
+  List mentries;  // Most recently used first
+  std::unordered_map<Key, List::iterator, KeyHash> mindex;
+};
+
+/** Installs a propagation matrix cache in a workspace
+ *
+ * The cache is shared by all copies of the workspace made while this
+ * object exists.  The previous cache of the workspace, if any, is put back
+ * by the destructor.  Nothing is installed if n is not positive.
+ */
+class PropmatCacheScope {
+ public:
+  /** Installs a new cache
+   *
+   * @param[in,out] ws The workspace
+   * @param[in] n Maximum number of entries
+   * @param[in] tolerance Relative width of the bins of the state
+   */
+  PropmatCacheScope(Workspace& ws, Index n, Numeric tolerance);
+
+  PropmatCacheScope(const PropmatCacheScope&) = delete;
+  PropmatCacheScope& operator=(const PropmatCacheScope&) = delete;
+
+  ~PropmatCacheScope();
+
+  /** The installed cache, or nullptr */
+  const PropmatCache* cache() const;
+
+ private:
+  Workspace& mws;
+  std::shared_ptr<PropmatCache> mold;
+  bool minstalled;
+};
+
+#endif  // propmat_cache_h
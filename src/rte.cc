@@ -30,18 +30,21 @@
   ===========================================================================*/
 
 #include "rte.h"
+#include <array>
 #include <cmath>
 #include <stdexcept>
 #include "auto_md.h"
 #include "check_input.h"
 #include "legacy_continua.h"
 #include "geodetic.h"
+#include "global_data.h"
 #include "lin_alg.h"
 #include "logic.h"
 #include "math_funcs.h"
 #include "montecarlo.h"
 #include "physics_funcs.h"
 #include "ppath.h"
+#include "propmat_cache.h"
 #include "refraction.h"
 #include "special_interp.h"
 
@@ -1319,6 +1322,19 @@ void get_stepwise_blackbody_radiation(VectorView B,
       dB_dT[i] = dplanck_dt(ppath_f_grid[i], ppath_temperature);
 }
 
+/** Whether a method of the agenda other than Ignore reads var
+ *
+ * Agendas that do not need rtp_mag or rtp_los pass them to Ignore to
+ * satisfy the agenda check.
+ */
+static bool agenda_reads(Workspace& ws, const Agenda& agenda, const Index var) {
+  using global_data::md_data;
+  Agenda used;
+  for (const MRecord& m : agenda.Methods())
+    if (md_data[m.Id()].Name() != "Ignore") used.push_back(m);
+  return used.is_input(ws, var);
+}
+
 void get_stepwise_clearsky_propmat(
     Workspace& ws,
     PropagationMatrix& K,
@@ -1340,6 +1356,41 @@ void get_stepwise_clearsky_propmat(
   // All relevant quantities are extracted first
   const Index nq = jacobian_quantities.nelem();
 
+  // A cache installed by yCalc may already have the result of this state
+  PropmatCache* cache = ws.propmat_cache.get();
+  PropmatCache::Key key;
+  if (cache) {
+    static const Index rtp_mag_id = get_wsv_id("rtp_mag");
+    static const Index rtp_los_id = get_wsv_id("rtp_los");
+    const Vector none(0);
+    const ConstVectorView unused = none;
+    key = cache->MakeKey(
+        ppath_f_grid,
+        agenda_reads(ws, propmat_clearsky_agenda, rtp_mag_id)
+            ? ppath_magnetic_field
+            : unused,
+        agenda_reads(ws, propmat_clearsky_agenda, rtp_los_id)
+            ? ppath_line_of_sight
+            : unused,
+        ppath_nlte,
+        ppath_vmrs,
+        ppath_temperature,
+        ppath_pressure,
+        nq,
+        jacobian_do);
+
+    if (const auto value = cache->Find(key)) {
+      K = value->K;
+      S = value->S;
+      lte = value->lte;
+      for (Index k = 0; k < value->derivatives.nelem(); k++) {
+        dK_dx[value->derivatives[k]] = value->dK_dx[k];
+        dS_dx[value->derivatives[k]] = value->dS_dx[k];
+      }
+      return;
+    }
+  }
+
   // Local variables inside Agenda
   ArrayOfPropagationMatrix propmat_clearsky, dpropmat_clearsky_dx;
   ArrayOfStokesVector nlte_source, dnlte_dx_source, nlte_dx_dsource_dx;
@@ -1381,11 +1432,13 @@ void get_stepwise_clearsky_propmat(
   }
 
   // Set the partial derivatives
+  ArrayOfIndex derivatives;
   if (jacobian_do) {
     for (Index i = 0; i < nq; i++) {
       if (jacobian_quantities[i].MainTag() == SCATSPECIES_MAINTAG) {
         dK_dx[i].SetZero();
         dS_dx[i].SetZero();
+        derivatives.push_back(i);
       } else if (jacobian_quantities[i].SubSubtag() == PROPMAT_SUBSUBTAG) {
         // Find position of index in ppd
         const Index j = equivalent_propmattype_index(jacobian_quantities, i);
@@ -1403,6 +1456,7 @@ void get_stepwise_clearsky_propmat(
           // Have to setup perturbation test-case to study which is most
           // reasonable...
         }
+        derivatives.push_back(i);
       } else if (jacobian_species[i] > -1)  // Did not compute values in Agenda
       {
         dK_dx[i] = propmat_clearsky[jacobian_species[i]];
@@ -1419,9 +1473,117 @@ void get_stepwise_clearsky_propmat(
           throw std::runtime_error(os.str());
         }
         dS_dx[i].SetZero();
+        derivatives.push_back(i);
+      }
+    }
+  }
+
+  if (cache) {
+    auto value = std::make_shared<PropmatCache::Value>();
+    value->K = K;
+    value->S = S;
+    value->lte = lte;
+    value->derivatives = derivatives;
+    for (const Index i : derivatives) {
+      value->dK_dx.push_back(dK_dx[i]);
+      value->dS_dx.push_back(dS_dx[i]);
+    }
+    cache->Insert(key, std::move(value));
+  }
+}
+
+void get_stepwise_clearsky_propmat_from_field(
+    PropagationMatrix& K,
+    StokesVector& S,
+    Index& lte,
+    ArrayOfPropagationMatrix& dK_dx,
+    ArrayOfStokesVector& dS_dx,
+    const Tensor7& propmat_clearsky_field,
+    const Tensor7& dpropmat_clearsky_field_dx,
+    const ArrayOfRetrievalQuantity& jacobian_quantities,
+    const Ppath& ppath,
+    const Index& ip,
+    const Index& atmosphere_dim,
+    const ArrayOfIndex& jacobian_species,
+    const bool& jacobian_do) {
+  // The corners of the grid cell of the point and their weights.  Corners
+  // without weight are left out, so that points on the grid get the field
+  // values as they are.
+  Index ncorner = 0;
+  std::array<Index, 8> cp, clat, clon;
+  std::array<Numeric, 8> cw;
+  const Index nlat = atmosphere_dim > 1 ? 2 : 1;
+  const Index nlon = atmosphere_dim > 2 ? 2 : 1;
+  for (Index i = 0; i < 2; i++) {
+    const Numeric wp = ppath.gp_p[ip].fd[1 - i];
+    for (Index j = 0; j < nlat; j++) {
+      const Numeric wlat = nlat > 1 ? ppath.gp_lat[ip].fd[1 - j] : 1;
+      for (Index k = 0; k < nlon; k++) {
+        const Numeric wlon = nlon > 1 ? ppath.gp_lon[ip].fd[1 - k] : 1;
+        const Numeric w = wp * wlat * wlon;
+        if (w == 0) continue;
+        cp[ncorner] = ppath.gp_p[ip].idx + i;
+        clat[ncorner] = nlat > 1 ? ppath.gp_lat[ip].idx + j : 0;
+        clon[ncorner] = nlon > 1 ? ppath.gp_lon[ip].idx + k : 0;
+        cw[ncorner] = w;
+        ncorner++;
       }
     }
   }
+
+  // Position in the Stokes matrix of the elements of a propagation matrix,
+  // see PropagationMatrix::SetAtPosition
+  const Index nf = K.NumberOfFrequencies();
+  const Index ne = K.NumberOfNeededVectors();
+  std::array<Index, 7> row{{0, 0, 0, 0, 1, 1, 2}};
+  std::array<Index, 7> col{{0, 1, 2, 3, 2, 3, 3}};
+  if (K.StokesDimensions() == 3) {
+    row[3] = 1;
+    col[3] = 2;
+  }
+
+  // Sets x to the field interpolated to the point and summed over the
+  // leading dimension from i0 to i1
+  auto interp_field = [&](PropagationMatrix& x,
+                          const Tensor7& field,
+                          const Index i0,
+                          const Index i1) {
+    MatrixView data = x.Data()(0, 0, joker, joker);
+    for (Index iv = 0; iv < nf; iv++) {
+      for (Index ie = 0; ie < ne; ie++) {
+        Numeric sum = 0;
+        for (Index i = i0; i < i1; i++)
+          for (Index ic = 0; ic < ncorner; ic++)
+            sum += cw[ic] *
+                   field(i, iv, row[ie], col[ie], cp[ic], clat[ic], clon[ic]);
+        data(iv, ie) = sum;
+      }
+    }
+  };
+
+  // The field holds no NLTE source terms
+  lte = 1;
+  S.SetZero();
+  interp_field(
+      K, propmat_clearsky_field, 0, propmat_clearsky_field.nlibraries());
+
+  if (not jacobian_do) return;
+
+  for (Index i = 0; i < jacobian_quantities.nelem(); i++) {
+    if (jacobian_quantities[i].MainTag() == SCATSPECIES_MAINTAG) {
+      dK_dx[i].SetZero();
+      dS_dx[i].SetZero();
+    } else if (jacobian_quantities[i].SubSubtag() == PROPMAT_SUBSUBTAG) {
+      const Index j = equivalent_propmattype_index(jacobian_quantities, i);
+      interp_field(dK_dx[i], dpropmat_clearsky_field_dx, j, j + 1);
+      dS_dx[i].SetZero();
+    } else if (jacobian_species[i] > -1) {
+      // As from the agenda, the absorption of the species alone
+      const Index j = jacobian_species[i];
+      interp_field(dK_dx[i], propmat_clearsky_field, j, j + 1);
+      dS_dx[i].SetZero();
+    }
+  }
 }
 
 void get_stepwise_effective_source(
@@ -2430,7 +2592,8 @@ void rtmethods_jacobian_finalisation(
     const Agenda& water_p_eq_agenda,
     const ArrayOfRetrievalQuantity& jacobian_quantities,
     const ArrayOfIndex jac_species_i,
-    const ArrayOfIndex jac_is_t) {
+    const ArrayOfIndex jac_is_t,
+    const Index ip0) {
   // Weight with iy_transmission
   if (!iy_agenda_call1) {
     Matrix X, Y;
@@ -2448,6 +2611,9 @@ void rtmethods_jacobian_finalisation(
   //
   Tensor3 water_p_eq(0, 0, 0);
   //
+  // The ppath points of diy_dpath
+  const Range path_part(ip0, np);
+  //
   // Conversion for abs species itself
   for (Index iq = 0; iq < jacobian_quantities.nelem(); iq++) {
     // Let x be VMR, and z the selected retrieval unit.
@@ -2460,7 +2626,8 @@ void rtmethods_jacobian_finalisation(
       else if (jacobian_quantities[iq].Mode() == "rel") {
         // Here x = vmr*z
         for (Index ip = 0; ip < np; ip++) {
-          diy_dpath[iq](ip, joker, joker) *= ppvar_vmr(jac_species_i[iq], ip);
+          diy_dpath[iq](ip, joker, joker) *=
+              ppvar_vmr(jac_species_i[iq], ip0 + ip);
         }
       }
 
@@ -2468,17 +2635,18 @@ void rtmethods_jacobian_finalisation(
         // Here x = z/nd_tot
         for (Index ip = 0; ip < np; ip++) {
           diy_dpath[iq](ip, joker, joker) /=
-              number_density(ppvar_p[ip], ppvar_t[ip]);
+              number_density(ppvar_p[ip0 + ip], ppvar_t[ip0 + ip]);
         }
       }
 
       else if (jacobian_quantities[iq].Mode() == "rh") {
         // Here x = (p_sat/p) * z
-        Tensor3 t_data(ppvar_t.nelem(), 1, 1);
-        t_data(joker, 0, 0) = ppvar_t;
+        Tensor3 t_data(np, 1, 1);
+        t_data(joker, 0, 0) = ppvar_t[path_part];
         water_p_eq_agendaExecute(ws, water_p_eq, t_data, water_p_eq_agenda);
         for (Index ip = 0; ip < np; ip++) {
-          diy_dpath[iq](ip, joker, joker) *= water_p_eq(ip, 0, 0) / ppvar_p[ip];
+          diy_dpath[iq](ip, joker, joker) *=
+              water_p_eq(ip, 0, 0) / ppvar_p[ip0 + ip];
         }
       }
 
@@ -2508,14 +2676,15 @@ void rtmethods_jacobian_finalisation(
           if (jacobian_quantities[ia].Mode() == "nd") {
             for (Index ip = 0; ip < np; ip++) {
               Matrix ddterm = diy_dpath[ia](ip, joker, joker);
-              ddterm *= ppvar_vmr(jac_species_i[ia], ip) *
-                        (number_density(ppvar_p[ip], ppvar_t[ip] + 1) -
-                         number_density(ppvar_p[ip], ppvar_t[ip]));
+              ddterm *=
+                  ppvar_vmr(jac_species_i[ia], ip0 + ip) *
+                  (number_density(ppvar_p[ip0 + ip], ppvar_t[ip0 + ip] + 1) -
+                   number_density(ppvar_p[ip0 + ip], ppvar_t[ip0 + ip]));
               diy_dpath[iq](ip, joker, joker) += ddterm;
             }
           } else if (jacobian_quantities[ia].Mode() == "rh") {
-            Tensor3 t_data(ppvar_t.nelem(), 1, 1);
-            t_data(joker, 0, 0) = ppvar_t;
+            Tensor3 t_data(np, 1, 1);
+            t_data(joker, 0, 0) = ppvar_t[path_part];
             // Calculate water sat. pressure if not already done
             if (water_p_eq.npages() == 0) {
               water_p_eq_agendaExecute(
@@ -2531,8 +2700,8 @@ void rtmethods_jacobian_finalisation(
               const Numeric p_eq = water_p_eq(ip, 0, 0);
               const Numeric p_eq1K = water_p_eq1K(ip, 0, 0);
               Matrix ddterm = diy_dpath[ia](ip, joker, joker);
-              ddterm *= ppvar_vmr(jac_species_i[ia], ip) *
-                        (ppvar_p[ip] / pow(p_eq, 2.0)) * (p_eq1K - p_eq);
+              ddterm *= ppvar_vmr(jac_species_i[ia], ip0 + ip) *
+                        (ppvar_p[ip0 + ip] / pow(p_eq, 2.0)) * (p_eq1K - p_eq);
               diy_dpath[iq](ip, joker, joker) += ddterm;
             }
           }
@@ -2547,7 +2716,8 @@ void rtmethods_jacobian_finalisation(
                                                       diy_dpath[iq],
                                                       atmosphere_dim,
                                                       ppath,
-                                                      ppvar_p);)
+                                                      ppvar_p,
+                                                      ip0);)
 }
 
 void rtmethods_unit_conversion(
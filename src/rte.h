@@ -578,6 +578,43 @@ void get_stepwise_clearsky_propmat(
   const ArrayOfIndex& jacobian_species,
   const bool& jacobian_do);
 
+/** Gets the clearsky propagation matrix from precomputed fields
+ *
+ * The counterpart of get_stepwise_clearsky_propmat for
+ * propmat_clearsky_field and dpropmat_clearsky_field_dx.  The fields are
+ * interpolated linearly to the propagation path point, as the atmospheric
+ * fields are in get_ppath_atmvars.  The fields hold no NLTE source terms,
+ * so lte is always set.
+ *
+ * @param[in,out] K Propagation matrix at propagation path point
+ * @param[in,out] S NLTE source adjustment at propagation path point
+ * @param[in,out] lte Boolean index for whether or not the atmosphere is in LTE at propagation path point
+ * @param[in,out] dK_dx Propagation matrix derivatives at propagation path point
+ * @param[in,out] dS_dx NLTE source adjustment derivatives at propagation path point
+ * @param[in] propmat_clearsky_field As WSV
+ * @param[in] dpropmat_clearsky_field_dx As WSV
+ * @param[in] jacobian_quantities As WSV
+ * @param[in] ppath As WSV
+ * @param[in] ip Index of the propagation path point
+ * @param[in] atmosphere_dim As WSV
+ * @param[in] jacobian_species Index list showing where and how the Jacobian needs to compute VMRs
+ * @param[in] jacobian_do As WSV
+ */
+void get_stepwise_clearsky_propmat_from_field(
+    PropagationMatrix& K,
+    StokesVector& S,
+    Index& lte,
+    ArrayOfPropagationMatrix& dK_dx,
+    ArrayOfStokesVector& dS_dx,
+    const Tensor7& propmat_clearsky_field,
+    const Tensor7& dpropmat_clearsky_field_dx,
+    const ArrayOfRetrievalQuantity& jacobian_quantities,
+    const Ppath& ppath,
+    const Index& ip,
+    const Index& atmosphere_dim,
+    const ArrayOfIndex& jacobian_species,
+    const bool& jacobian_do);
+
 /** Gets the effective source at propagation path point
  * 
  *  Computes
@@ -917,6 +954,10 @@ void rtmethods_jacobian_init(
     radiative transfer WSMs. The method applies iy_transmission, maps from
     ppath to the retrieval grids and applies non-standard Jacobian units.
 
+    The path can be handled in parts. diy_dpath then holds the np points
+    starting at ppath point ip0, and the parts are added to diy_dx in
+    order.
+
     See iyEmissonStandard for usage example.
 
     @author Patrick Eriksson 
@@ -939,7 +980,8 @@ void rtmethods_jacobian_finalisation(
     const Agenda& water_p_eq_agenda,
     const ArrayOfRetrievalQuantity& jacobian_quantities,
     const ArrayOfIndex jac_species_i,
-    const ArrayOfIndex jac_is_t);
+    const ArrayOfIndex jac_is_t,
+    const Index ip0 = 0);
 
 /** This function handles the unit conversion to be done at the end of some
     radiative transfer WSMs. 
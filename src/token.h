@@ -107,6 +107,9 @@ class TokVal {
   /** Return Matrix. */
   operator Matrix() const;
 
+  /** Return the type. */
+  TokValType type() const { return mtype; }
+
   /** Output operator. */
   friend std::ostream& operator<<(std::ostream& os, const TokVal& a);
 
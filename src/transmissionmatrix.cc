@@ -32,73 +32,6 @@
 
 constexpr Numeric lower_is_considered_zero_for_sinc_likes = 1e-4;
 
-inline Numeric vector1(const StokesVector& a,
-                       const ConstVectorView& B,
-                       const StokesVector& da,
-                       const ConstVectorView& dB_dT,
-                       const StokesVector& dS,
-                       bool dT,
-                       Index i) noexcept {
-  if (dT)
-    return dS.Kjj()[i] + da.Kjj()[i] * B[i] + a.Kjj()[i] * dB_dT[i];
-  else
-    return dS.Kjj()[i] + da.Kjj()[i] * B[i];
-}
-
-inline Eigen::Vector2d vector2(const StokesVector& a,
-                               const ConstVectorView& B,
-                               const StokesVector& da,
-                               const ConstVectorView& dB_dT,
-                               const StokesVector& dS,
-                               bool dT,
-                               Index i) noexcept {
-  if (dT)
-    return Eigen::Vector2d(
-        dS.Kjj()[i] + da.Kjj()[i] * B[i] + a.Kjj()[i] * dB_dT[i],
-        dS.K12()[i] + da.K12()[i] * B[i] + a.K12()[i] * dB_dT[i]);
-  else
-    return Eigen::Vector2d(dS.Kjj()[i] + da.Kjj()[i] * B[i],
-                           dS.K12()[i] + da.K12()[i] * B[i]);
-}
-
-inline Eigen::Vector3d vector3(const StokesVector& a,
-                               const ConstVectorView& B,
-                               const StokesVector& da,
-                               const ConstVectorView& dB_dT,
-                               const StokesVector& dS,
-                               bool dT,
-                               Index i) noexcept {
-  if (dT)
-    return Eigen::Vector3d(
-        dS.Kjj()[i] + da.Kjj()[i] * B[i] + a.Kjj()[i] * dB_dT[i],
-        dS.K12()[i] + da.K12()[i] * B[i] + a.K12()[i] * dB_dT[i],
-        dS.K13()[i] + da.K13()[i] * B[i] + a.K13()[i] * dB_dT[i]);
-  else
-    return Eigen::Vector3d(dS.Kjj()[i] + da.Kjj()[i] * B[i],
-                           dS.K12()[i] + da.K12()[i] * B[i],
-                           dS.K13()[i] + da.K13()[i] * B[i]);
-}
-
-inline Eigen::Vector4d vector4(const StokesVector& a,
-                               const ConstVectorView& B,
-                               const StokesVector& da,
-                               const ConstVectorView& dB_dT,
-                               const StokesVector& dS,
-                               bool dT,
-                               Index i) noexcept {
-  if (dT)
-    return Eigen::Vector4d(
-        dS.Kjj()[i] + da.Kjj()[i] * B[i] + a.Kjj()[i] * dB_dT[i],
-        dS.K12()[i] + da.K12()[i] * B[i] + a.K12()[i] * dB_dT[i],
-        dS.K13()[i] + da.K13()[i] * B[i] + a.K13()[i] * dB_dT[i],
-        dS.K14()[i] + da.K14()[i] * B[i] + a.K14()[i] * dB_dT[i]);
-  else
-    return Eigen::Vector4d(dS.Kjj()[i] + da.Kjj()[i] * B[i],
-                           dS.K12()[i] + da.K12()[i] * B[i],
-                           dS.K13()[i] + da.K13()[i] * B[i],
-                           dS.K14()[i] + da.K14()[i] * B[i]);
-}
-
 inline Eigen::Matrix<double, 1, 1> matrix1(const Numeric& a) noexcept {
   return Eigen::Matrix<double, 1, 1>(a);
 }
@@ -335,125 +268,477 @@ inline void transmat3(TransmissionMatrix& T,
   }
 }
 
+/** Number of frequencies in the batches of the stokes_dim 4 exponential */
+constexpr Index exp4_batch_size = 64;
+
+/** The closed form exponential of stokes_dim 4 propagation matrices for a
+ * batch of frequencies
+ *
+ * The seven independent elements of -r (K1 + K2) / 2 are kept in separate
+ * frequency-contiguous arrays, and so are all intermediate values, so that
+ * the loops over the batch vectorize.  The eigenvalues of the matrix are
+ * a ± x and a ± iy with real x and y, so everything is done in real
+ * arithmetic.  The results are even functions of y, so y is taken positive.
+ */
+struct Exp4Batch {
+  Index n;
+  Numeric a[exp4_batch_size], b[exp4_batch_size], c[exp4_batch_size],
+      d[exp4_batch_size], u[exp4_batch_size], v[exp4_batch_size],
+      w[exp4_batch_size];
+  Numeric Const1[exp4_batch_size], x[exp4_batch_size], y[exp4_batch_size];
+  Numeric exp_a[exp4_batch_size], cx[exp4_batch_size], sx[exp4_batch_size],
+      cy[exp4_batch_size], sy[exp4_batch_size];
+  Numeric inv_x2y2[exp4_batch_size], C0[exp4_batch_size], C1[exp4_batch_size],
+      C2[exp4_batch_size], C3[exp4_batch_size];
+};
+
+/** Computes the exponential of the frequencies [first, first + e.n)
+ *
+ * @param[out] e The batch
+ * @param[in] K1 Propagation matrix at the first level
+ * @param[in] K2 Propagation matrix at the second level
+ * @param[in] r Distance between the levels
+ * @param[in] first The first frequency of the batch
+ * @param[in] iz Zenith index
+ * @param[in] ia Azimuth index
+ */
+inline void exp4_batch(Exp4Batch& e,
+                       const PropagationMatrix& K1,
+                       const PropagationMatrix& K2,
+                       const Numeric& r,
+                       const Index first,
+                       const Index iz,
+                       const Index ia) noexcept {
+  static constexpr Numeric sqrt_05 = Constant::inv_sqrt_2;
+  e.n = std::min(exp4_batch_size, K1.NumberOfFrequencies() - first);
+
+  const ConstVectorView k1[7] = {K1.Kjj(iz, ia),
+                                 K1.K12(iz, ia),
+                                 K1.K13(iz, ia),
+                                 K1.K14(iz, ia),
+                                 K1.K23(iz, ia),
+                                 K1.K24(iz, ia),
+                                 K1.K34(iz, ia)};
+  const ConstVectorView k2[7] = {K2.Kjj(iz, ia),
+                                 K2.K12(iz, ia),
+                                 K2.K13(iz, ia),
+                                 K2.K14(iz, ia),
+                                 K2.K23(iz, ia),
+                                 K2.K24(iz, ia),
+                                 K2.K34(iz, ia)};
+  Numeric* const out[7] = {e.a, e.b, e.c, e.d, e.u, e.v, e.w};
+  for (Index j = 0; j < 7; j++)
+    for (Index k = 0; k < e.n; k++)
+      out[j][k] = -0.5 * r * (k1[j][first + k] + k2[j][first + k]);
+
+#pragma omp simd
+  for (Index k = 0; k < e.n; k++) {
+    const Numeric b = e.b[k], c = e.c[k], d = e.d[k], u = e.u[k], v = e.v[k],
+                  w = e.w[k];
+    const Numeric b2 = b * b, c2 = c * c, d2 = d * d, u2 = u * u, v2 = v * v,
+                  w2 = w * w;
+    const Numeric tmp =
+        w2 * w2 + 2 * (b2 * (b2 * 0.5 + c2 + d2 - u2 - v2 + w2) +
+                       c2 * (c2 * 0.5 + d2 - u2 + v2 - w2) +
+                       d2 * (d2 * 0.5 + u2 - v2 - w2) +
+                       u2 * (u2 * 0.5 + v2 + w2) + v2 * (v2 * 0.5 + w2) +
+                       4 * (b * d * u * w - b * c * v * w - c * d * u * v));
+
+    // tmp and Const2 + Const1 are never negative but for rounding errors
+    const Numeric Const1 = std::sqrt(std::max(tmp, 0.0));
+    const Numeric Const2 = b2 + c2 + d2 - u2 - v2 - w2;
+    e.Const1[k] = Const1;
+    e.x[k] = std::sqrt(std::max(Const2 + Const1, 0.0)) * sqrt_05;
+    e.y[k] = std::sqrt(std::max(Const1 - Const2, 0.0)) * sqrt_05;
+  }
+
+  // Only vectorized where the compiler has vector versions of these
+  for (Index k = 0; k < e.n; k++) {
+    e.exp_a[k] = std::exp(e.a[k]);
+    e.cx[k] = std::cosh(e.x[k]);
+    e.sx[k] = std::sinh(e.x[k]);
+    e.cy[k] = std::cos(e.y[k]);
+    e.sy[k] = std::sin(e.y[k]);
+  }
+
+#pragma omp simd
+  for (Index k = 0; k < e.n; k++) {
+    const Numeric x = e.x[k], y = e.y[k], x2 = x * x, y2 = y * y;
+    const Numeric cx = e.cx[k], sx = e.sx[k], cy = e.cy[k], sy = e.sy[k];
+
+    const bool x_zero = x < lower_is_considered_zero_for_sinc_likes;
+    const bool y_zero = y < lower_is_considered_zero_for_sinc_likes;
+    const bool both_zero = y_zero and x_zero;
+    const bool either_zero = y_zero or x_zero;
+
+    /* Using:
+     *    lim x→0 [({cosh(x),cos(x)} - 1) / x^2] → 1/2
+     *    lim x→0 [{sinh(x),sin(x)} / x]  → 1
+     *    inv_x2 := 1 for x == 0,
+     *    C0, C1, C2 ∝ [1/x^2]
+     */
+    const Numeric ix = x_zero ? 0.0 : 1.0 / x;
+    const Numeric iy = y_zero ? 0.0 : 1.0 / y;
+    const Numeric inv_x2y2 = both_zero ? 1.0 : 1.0 / (x2 + y2);
+
+    e.inv_x2y2[k] = inv_x2y2;
+    e.C0[k] = either_zero ? 1.0 : (cy * x2 + cx * y2) * inv_x2y2;
+    e.C1[k] = either_zero ? 1.0 : (sy * x2 * iy + sx * y2 * ix) * inv_x2y2;
+    e.C2[k] = both_zero ? 0.5 : (cx - cy) * inv_x2y2;
+    e.C3[k] = both_zero
+                  ? 1.0 / 6.0
+                  : (x_zero ? 1.0 - sy * iy
+                            : y_zero ? sx * ix - 1.0 : sx * ix - sy * iy) *
+                        inv_x2y2;
+  }
+}
+
+/** True if the element k of the batch is a diagonal matrix */
+inline bool exp4_diagonal(const Exp4Batch& e, const Index k) noexcept {
+  return e.b[k] == 0. and e.c[k] == 0. and e.d[k] == 0. and e.u[k] == 0. and
+         e.v[k] == 0. and e.w[k] == 0.;
+}
+
+/** The transmission matrix of the element k of the batch */
+inline Eigen::Matrix4d exp4_matrix(const Exp4Batch& e, const Index k) noexcept {
+  const Numeric b = e.b[k], c = e.c[k], d = e.d[k], u = e.u[k], v = e.v[k],
+                w = e.w[k];
+  const Numeric b2 = b * b, c2 = c * c, d2 = d * d, u2 = u * u, v2 = v * v,
+                w2 = w * w;
+  const Numeric exp_a = e.exp_a[k];
+  const Numeric C0 = e.C0[k], C1 = e.C1[k], C2 = e.C2[k], C3 = e.C3[k];
+  return exp_a * (Eigen::Matrix4d() << C0 + C2 * (b2 + c2 + d2),
+             C1 * b + C2 * (-c * u - d * v) +
+                 C3 * (b * (b2 + c2 + d2) - u * (b * u - d * w) -
+                       v * (b * v + c * w)),
+             C1 * c + C2 * (b * u - d * w) +
+                 C3 * (c * (b2 + c2 + d2) - u * (c * u + d * v) -
+                       w * (b * v + c * w)),
+             C1 * d + C2 * (b * v + c * w) +
+                 C3 * (d * (b2 + c2 + d2) - v * (c * u + d * v) +
+                       w * (b * u - d * w)),
+
+             C1 * b + C2 * (c * u + d * v) +
+                 C3 * (-b * (-b2 + u2 + v2) + c * (b * c - v * w) +
+                       d * (b * d + u * w)),
+             C0 + C2 * (b2 - u2 - v2),
+             C2 * (b * c - v * w) + C1 * u +
+                 C3 * (c * (c * u + d * v) - u * (-b2 + u2 + v2) -
+                       w * (b * d + u * w)),
+             C2 * (b * d + u * w) + C1 * v +
+                 C3 * (d * (c * u + d * v) - v * (-b2 + u2 + v2) +
+                       w * (b * c - v * w)),
+
+             C1 * c + C2 * (-b * u + d * w) +
+                 C3 * (b * (b * c - v * w) - c * (-c2 + u2 + w2) +
+                       d * (c * d - u * v)),
+             C2 * (b * c - v * w) - C1 * u +
+                 C3 * (-b * (b * u - d * w) + u * (-c2 + u2 + w2) -
+                       v * (c * d - u * v)),
+             C0 + C2 * (c2 - u2 - w2),
+             C2 * (c * d - u * v) + C1 * w +
+                 C3 * (-d * (b * u - d * w) + v * (b * c - v * w) -
+                       w * (-c2 + u2 + w2)),
+
+             C1 * d + C2 * (-b * v - c * w) +
+                 C3 * (b * (b * d + u * w) + c * (c * d - u * v) -
+                       d * (-d2 + v2 + w2)),
+             C2 * (b * d + u * w) - C1 * v +
+                 C3 * (-b * (b * v + c * w) - u * (c * d - u * v) +
+                       v * (-d2 + v2 + w2)),
+             C2 * (c * d - u * v) - C1 * w +
+                 C3 * (-c * (b * v + c * w) + u * (b * d + u * w) +
+                       w * (-d2 + v2 + w2)),
+             C0 + C2 * (d2 - v2 - w2))
+                .finished();
+}
+
+/** Derivatives of the exponential for a batch of frequencies */
+struct DExp4Batch {
+  Numeric da[exp4_batch_size], db[exp4_batch_size], dc[exp4_batch_size],
+      dd[exp4_batch_size], du[exp4_batch_size], dv[exp4_batch_size],
+      dw[exp4_batch_size];
+  Numeric dC0[exp4_batch_size], dC1[exp4_batch_size], dC2[exp4_batch_size],
+      dC3[exp4_batch_size];
+};
+
+/** Computes the derivatives of the exponential of a batch
+ *
+ * @param[out] de The derivatives
+ * @param[in] e The batch
+ * @param[in] dK Derivative of the propagation matrix at one of the levels
+ * @param[in] K1 Propagation matrix at the first level
+ * @param[in] K2 Propagation matrix at the second level
+ * @param[in] r Distance between the levels
+ * @param[in] dr Derivative of the distance
+ * @param[in] first The first frequency of the batch
+ * @param[in] iz Zenith index
+ * @param[in] ia Azimuth index
+ */
+inline void dexp4_batch(DExp4Batch& de,
+                        const Exp4Batch& e,
+                        const PropagationMatrix& dK,
+                        const PropagationMatrix& K1,
+                        const PropagationMatrix& K2,
+                        const Numeric& r,
+                        const Numeric& dr,
+                        const Index first,
+                        const Index iz,
+                        const Index ia) noexcept {
+  const ConstVectorView dk[7] = {dK.Kjj(iz, ia),
+                                 dK.K12(iz, ia),
+                                 dK.K13(iz, ia),
+                                 dK.K14(iz, ia),
+                                 dK.K23(iz, ia),
+                                 dK.K24(iz, ia),
+                                 dK.K34(iz, ia)};
+  const ConstVectorView k1[7] = {K1.Kjj(iz, ia),
+                                 K1.K12(iz, ia),
+                                 K1.K13(iz, ia),
+                                 K1.K14(iz, ia),
+                                 K1.K23(iz, ia),
+                                 K1.K24(iz, ia),
+                                 K1.K34(iz, ia)};
+  const ConstVectorView k2[7] = {K2.Kjj(iz, ia),
+                                 K2.K12(iz, ia),
+                                 K2.K13(iz, ia),
+                                 K2.K14(iz, ia),
+                                 K2.K23(iz, ia),
+                                 K2.K24(iz, ia),
+                                 K2.K34(iz, ia)};
+  Numeric* const out[7] = {de.da, de.db, de.dc, de.dd, de.du, de.dv, de.dw};
+  for (Index j = 0; j < 7; j++)
+    for (Index k = 0; k < e.n; k++)
+      out[j][k] = -0.5 * (r * dk[j][first + k] +
+                          dr * (k1[j][first + k] + k2[j][first + k]));
+
+  // The values of diagonal elements are not used, see dexp4_matrix
+#pragma omp simd
+  for (Index k = 0; k < e.n; k++) {
+    const Numeric b = e.b[k], c = e.c[k], d = e.d[k], u = e.u[k], v = e.v[k],
+                  w = e.w[k];
+    const Numeric db = de.db[k], dc = de.dc[k], dd = de.dd[k], du = de.du[k],
+                  dv = de.dv[k], dw = de.dw[k];
+    const Numeric b2 = b * b, c2 = c * c, d2 = d * d, u2 = u * u, v2 = v * v,
+                  w2 = w * w;
+    const Numeric x = e.x[k], y = e.y[k], x2 = x * x, y2 = y * y;
+    const Numeric cx = e.cx[k], sx = e.sx[k], cy = e.cy[k], sy = e.sy[k];
+    const Numeric inv_x2y2 = e.inv_x2y2[k];
+    const Numeric C0 = e.C0[k], C1 = e.C1[k], C2 = e.C2[k], C3 = e.C3[k];
+
+    const bool x_zero = x < lower_is_considered_zero_for_sinc_likes;
+    const bool y_zero = y < lower_is_considered_zero_for_sinc_likes;
+    const bool both_zero = y_zero and x_zero;
+    const bool either_zero = y_zero or x_zero;
+    const Numeric ix = x_zero ? 0.0 : 1.0 / x;
+    const Numeric iy = y_zero ? 0.0 : 1.0 / y;
+
+    const Numeric db2 = 2 * db * b, dc2 = 2 * dc * c, dd2 = 2 * dd * d,
+                  du2 = 2 * du * u, dv2 = 2 * dv * v, dw2 = 2 * dw * w;
+    const Numeric dtmp =
+        2 * w2 * dw2 +
+        2 * (db2 * (b2 * 0.5 + c2 + d2 - u2 - v2 + w2) +
+             b2 * (db2 * 0.5 + dc2 + dd2 - du2 - dv2 + dw2) +
+             dc2 * (c2 * 0.5 + d2 - u2 + v2 - w2) +
+             c2 * (dc2 * 0.5 + dd2 - du2 + dv2 - dw2) +
+             dd2 * (d2 * 0.5 + u2 - v2 - w2) +
+             d2 * (dd2 * 0.5 + du2 - dv2 - dw2) +
+             du2 * (u2 * 0.5 + v2 + w2) + u2 * (du2 * 0.5 + dv2 + dw2) +
+             dv2 * (v2 * 0.5 + w2) + v2 * (dv2 * 0.5 + dw2) +
+             4 * (db * d * u * w - db * c * v * w - dc * d * u * v +
+                  b * dd * u * w - b * dc * v * w - c * dd * u * v +
+                  b * d * du * w - b * c * dv * w - c * d * du * v +
+                  b * d * u * dw - b * c * v * dw - c * d * u * dv));
+    const Numeric dConst1 = 0.5 * dtmp / e.Const1[k];
+    const Numeric dConst2 = db2 + dc2 + dd2 - du2 - dv2 - dw2;
+
+    // From x^2 = (Const2 + Const1) / 2 and y^2 = (Const1 - Const2) / 2
+    const Numeric dx = x_zero ? 0.0 : 0.25 * (dConst2 + dConst1) * ix;
+    const Numeric dy = y_zero ? 0.0 : 0.25 * (dConst1 - dConst2) * iy;
+    const Numeric dx2 = 2 * x * dx;
+    const Numeric dy2 = 2 * y * dy;
+    const Numeric dcy = -sy * dy;
+    const Numeric dsy = cy * dy;
+    const Numeric dcx = sx * dx;
+    const Numeric dsx = cx * dx;
+    const Numeric dix = -dx * ix * ix;
+    const Numeric diy = -dy * iy * iy;
+    const Numeric dx2dy2 = dx2 + dy2;
+    de.dC0[k] = either_zero ? 0.0
+                            : (dcy * x2 + cy * dx2 + dcx * y2 + cx * dy2 -
+                               C0 * dx2dy2) *
+                                  inv_x2y2;
+    de.dC1[k] = either_zero ? 0.0
+                            : (dsy * x2 * iy + sy * dx2 * iy + sy * x2 * diy +
+                               dsx * y2 * ix + sx * dy2 * ix + sx * y2 * dix -
+                               C1 * dx2dy2) *
+                                  inv_x2y2;
+    de.dC2[k] = both_zero ? 0.0 : (dcx - dcy - C2 * dx2dy2) * inv_x2y2;
+    de.dC3[k] = both_zero ? 0.0
+                          : ((x_zero ? -dsy * iy - sy * diy
+                                     : y_zero ? dsx * ix + sx * dix
+                                              : dsx * ix + sx * dix -
+                                                    dsy * iy - sy * diy) -
+                             C3 * dx2dy2) *
+                                inv_x2y2;
+  }
+}
+
+/** The derivative of the transmission matrix of the element k of a batch
+ *
+ * Only the derivative of the diagonal is considered for diagonal elements.
+ *
+ * @param[in] e The batch
+ * @param[in] de The derivatives of the batch
+ * @param[in] k The element
+ * @param[in] T The transmission matrix of the element
+ */
+inline Eigen::Matrix4d dexp4_matrix(const Exp4Batch& e,
+                                    const DExp4Batch& de,
+                                    const Index k,
+                                    const Eigen::Matrix4d& T) noexcept {
+  const Numeric da = de.da[k];
+  if (exp4_diagonal(e, k)) return T * da;
+
+  const Numeric b = e.b[k], c = e.c[k], d = e.d[k], u = e.u[k], v = e.v[k],
+                w = e.w[k];
+  const Numeric db = de.db[k], dc = de.dc[k], dd = de.dd[k], du = de.du[k],
+                dv = de.dv[k], dw = de.dw[k];
+  const Numeric b2 = b * b, c2 = c * c, d2 = d * d, u2 = u * u, v2 = v * v,
+                w2 = w * w;
+  const Numeric db2 = 2 * db * b, dc2 = 2 * dc * c, dd2 = 2 * dd * d,
+                du2 = 2 * du * u, dv2 = 2 * dv * v, dw2 = 2 * dw * w;
+  const Numeric exp_a = e.exp_a[k];
+  const Numeric C1 = e.C1[k], C2 = e.C2[k], C3 = e.C3[k];
+  const Numeric dC0 = de.dC0[k], dC1 = de.dC1[k], dC2 = de.dC2[k],
+                dC3 = de.dC3[k];
+  return T * da +
+    exp_a *
+        (Eigen::Matrix4d()
+             << dC0 + dC2 * (b2 + c2 + d2) + C2 * (db2 + dc2 + dd2),
+         db * C1 + b * dC1 + dC2 * (-c * u - d * v) +
+             C2 * (-dc * u - dd * v - c * du - d * dv) +
+             dC3 * (b * (b2 + c2 + d2) - u * (b * u - d * w) -
+                    v * (b * v + c * w)) +
+             C3 * (db * (b2 + c2 + d2) - du * (b * u - d * w) -
+                   dv * (b * v + c * w) + b * (db2 + dc2 + dd2) -
+                   u * (db * u - dd * w) - v * (db * v + dc * w) -
+                   u * (b * du - d * dw) - v * (b * dv + c * dw)),
+         dC1 * c + C1 * dc + dC2 * (b * u - d * w) +
+             C2 * (db * u - dd * w + b * du - d * dw) +
+             dC3 * (c * (b2 + c2 + d2) - u * (c * u + d * v) -
+                    w * (b * v + c * w)) +
+             C3 * (dc * (b2 + c2 + d2) - du * (c * u + d * v) -
+                   dw * (b * v + c * w) + c * (db2 + dc2 + dd2) -
+                   u * (dc * u + dd * v) - w * (db * v + dc * w) -
+                   u * (c * du + d * dv) - w * (b * dv + c * dw)),
+         dC1 * d + C1 * dd + dC2 * (b * v + c * w) +
+             C2 * (db * v + dc * w + b * dv + c * dw) +
+             dC3 * (d * (b2 + c2 + d2) - v * (c * u + d * v) +
+                    w * (b * u - d * w)) +
+             C3 * (dd * (b2 + c2 + d2) - dv * (c * u + d * v) +
+                   dw * (b * u - d * w) + d * (db2 + dc2 + dd2) -
+                   v * (dc * u + dd * v) + w * (db * u - dd * w) -
+                   v * (c * du + d * dv) + w * (b * du - d * dw)),
+
+         db * C1 + b * dC1 + dC2 * (c * u + d * v) +
+             C2 * (dc * u + dd * v + c * du + d * dv) +
+             dC3 * (-b * (-b2 + u2 + v2) + c * (b * c - v * w) +
+                    d * (b * d + u * w)) +
+             C3 * (-db * (-b2 + u2 + v2) + dc * (b * c - v * w) +
+                   dd * (b * d + u * w) - b * (-db2 + du2 + dv2) +
+                   c * (db * c - dv * w) + d * (db * d + du * w) +
+                   c * (b * dc - v * dw) + d * (b * dd + u * dw)),
+         dC0 + dC2 * (b2 - u2 - v2) + C2 * (db2 - du2 - dv2),
+         dC2 * (b * c - v * w) +
+             C2 * (db * c + b * dc - dv * w - v * dw) + dC1 * u +
+             C1 * du +
+             dC3 * (c * (c * u + d * v) - u * (-b2 + u2 + v2) -
+                    w * (b * d + u * w)) +
+             C3 * (dc * (c * u + d * v) - du * (-b2 + u2 + v2) -
+                   dw * (b * d + u * w) + c * (dc * u + dd * v) -
+                   u * (-db2 + du2 + dv2) - w * (db * d + du * w) +
+                   c * (c * du + d * dv) - w * (b * dd + u * dw)),
+         dC2 * (b * d + u * w) +
+             C2 * (db * d + b * dd + du * w + u * dw) + dC1 * v +
+             C1 * dv +
+             dC3 * (d * (c * u + d * v) - v * (-b2 + u2 + v2) +
+                    w * (b * c - v * w)) +
+             C3 * (dd * (c * u + d * v) - dv * (-b2 + u2 + v2) +
+                   dw * (b * c - v * w) + d * (dc * u + dd * v) -
+                   v * (-db2 + du2 + dv2) + w * (db * c - dv * w) +
+                   d * (c * du + d * dv) + w * (b * dc - v * dw)),
+
+         dC1 * c + C1 * dc + dC2 * (-b * u + d * w) +
+             C2 * (-db * u + dd * w - b * du + d * dw) +
+             dC3 * (b * (b * c - v * w) - c * (-c2 + u2 + w2) +
+                    d * (c * d - u * v)) +
+             C3 * (db * (b * c - v * w) - dc * (-c2 + u2 + w2) +
+                   dd * (c * d - u * v) + b * (db * c - dv * w) -
+                   c * (-dc2 + du2 + dw2) + d * (dc * d - du * v) +
+                   b * (b * dc - v * dw) + d * (c * dd - u * dv)),
+         dC2 * (b * c - v * w) +
+             C2 * (db * c + b * dc - dv * w - v * dw) - dC1 * u -
+             C1 * du +
+             dC3 * (-b * (b * u - d * w) + u * (-c2 + u2 + w2) -
+                    v * (c * d - u * v)) +
+             C3 * (-db * (b * u - d * w) + du * (-c2 + u2 + w2) -
+                   dv * (c * d - u * v) - b * (db * u - dd * w) +
+                   u * (-dc2 + du2 + dw2) - v * (dc * d - du * v) -
+                   b * (b * du - d * dw) - v * (c * dd - u * dv)),
+         dC0 + dC2 * (c2 - u2 - w2) + C2 * (dc2 - du2 - dw2),
+         dC2 * (c * d - u * v) +
+             C2 * (dc * d + c * dd - du * v - u * dv) + dC1 * w +
+             C1 * dw +
+             dC3 * (-d * (b * u - d * w) + v * (b * c - v * w) -
+                    w * (-c2 + u2 + w2)) +
+             C3 * (-dd * (b * u - d * w) + dv * (b * c - v * w) -
+                   dw * (-c2 + u2 + w2) - d * (db * u - dd * w) +
+                   v * (db * c - dv * w) - w * (-dc2 + du2 + dw2) -
+                   d * (b * du - d * dw) + v * (b * dc - v * dw)),
+
+         dC1 * d + C1 * dd + dC2 * (-b * v - c * w) +
+             C2 * (-db * v - dc * w - b * dv - c * dw) +
+             dC3 * (b * (b * d + u * w) + c * (c * d - u * v) -
+                    d * (-d2 + v2 + w2)) +
+             C3 * (db * (b * d + u * w) + dc * (c * d - u * v) -
+                   dd * (-d2 + v2 + w2) + b * (db * d + du * w) +
+                   c * (dc * d - du * v) - d * (-dd2 + dv2 + dw2) +
+                   b * (b * dd + u * dw) + c * (c * dd - u * dv)),
+         dC2 * (b * d + u * w) +
+             C2 * (db * d + b * dd + du * w + u * dw) - dC1 * v -
+             C1 * dv +
+             dC3 * (-b * (b * v + c * w) - u * (c * d - u * v) +
+                    v * (-d2 + v2 + w2)) +
+             C3 * (-db * (b * v + c * w) - du * (c * d - u * v) +
+                   dv * (-d2 + v2 + w2) - b * (db * v + dc * w) -
+                   u * (dc * d - du * v) + v * (-dd2 + dv2 + dw2) -
+                   b * (b * dv + c * dw) - u * (c * dd - u * dv)),
+         dC2 * (c * d - u * v) +
+             C2 * (dc * d + c * dd - du * v - u * dv) - dC1 * w -
+             C1 * dw +
+             dC3 * (-c * (b * v + c * w) + u * (b * d + u * w) +
+                    w * (-d2 + v2 + w2)) +
+             C3 * (-dc * (b * v + c * w) + du * (b * d + u * w) +
+                   dw * (-d2 + v2 + w2) - c * (db * v + dc * w) +
+                   u * (db * d + du * w) + w * (-dd2 + dv2 + dw2) -
+                   c * (b * dv + c * dw) + u * (b * dd + u * dw)),
+         dC0 + dC2 * (d2 - v2 - w2) + C2 * (dd2 - dv2 - dw2))
+            .finished();
+}
+
 inline void transmat4(TransmissionMatrix& T,
                       const PropagationMatrix& K1,
                       const PropagationMatrix& K2,
                       const Numeric& r,
                       const Index iz = 0,
                       const Index ia = 0) noexcept {
-  static constexpr Numeric sqrt_05 = Constant::inv_sqrt_2;
-  for (Index i = 0; i < K1.NumberOfFrequencies(); i++) {
-    const Numeric a = -0.5 * r * (K1.Kjj(iz, ia)[i] + K2.Kjj(iz, ia)[i]),
-                  b = -0.5 * r * (K1.K12(iz, ia)[i] + K2.K12(iz, ia)[i]),
-                  c = -0.5 * r * (K1.K13(iz, ia)[i] + K2.K13(iz, ia)[i]),
-                  d = -0.5 * r * (K1.K14(iz, ia)[i] + K2.K14(iz, ia)[i]),
-                  u = -0.5 * r * (K1.K23(iz, ia)[i] + K2.K23(iz, ia)[i]),
-                  v = -0.5 * r * (K1.K24(iz, ia)[i] + K2.K24(iz, ia)[i]),
-                  w = -0.5 * r * (K1.K34(iz, ia)[i] + K2.K34(iz, ia)[i]);
-    const Numeric exp_a = std::exp(a);
-
-    if (b == 0. and c == 0. and d == 0. and u == 0. and v == 0. and w == 0.)
-      T.Mat4(i).noalias() = Eigen::Matrix4d::Identity() * exp_a;
-    else {
-      const Numeric b2 = b * b, c2 = c * c, d2 = d * d, u2 = u * u, v2 = v * v,
-                    w2 = w * w;
-
-      const Numeric tmp =
-          w2 * w2 + 2 * (b2 * (b2 * 0.5 + c2 + d2 - u2 - v2 + w2) +
-                         c2 * (c2 * 0.5 + d2 - u2 + v2 - w2) +
-                         d2 * (d2 * 0.5 + u2 - v2 - w2) +
-                         u2 * (u2 * 0.5 + v2 + w2) + v2 * (v2 * 0.5 + w2) +
-                         4 * (b * d * u * w - b * c * v * w - c * d * u * v));
-      const Complex Const1 = std::sqrt(Complex(tmp, 0));
-      const Numeric Const2 = b2 + c2 + d2 - u2 - v2 - w2;
-
-      const Complex x = std::sqrt(Const2 + Const1) * sqrt_05;
-      const Complex y = std::sqrt(Const2 - Const1) * sqrt_05 * Complex(0, 1);
-      const Complex x2 = x * x;
-      const Complex y2 = y * y;
-      const Complex cy = std::cos(y);
-      const Complex sy = std::sin(y);
-      const Complex cx = std::cosh(x);
-      const Complex sx = std::sinh(x);
-
-      const bool x_zero = std::abs(x) < lower_is_considered_zero_for_sinc_likes;
-      const bool y_zero = std::abs(y) < lower_is_considered_zero_for_sinc_likes;
-      const bool both_zero = y_zero and x_zero;
-      const bool either_zero = y_zero or x_zero;
-
-      /* Using:
-         *    lim x→0 [({cosh(x),cos(x)} - 1) / x^2] → 1/2
-         *    lim x→0 [{sinh(x),sin(x)} / x]  → 1
-         *    inv_x2 := 1 for x == 0,
-         *    -i sin(ix) → sinh(x)
-         *    cos(ix) → cosh(x)
-         *    C0, C1, C2 ∝ [1/x^2]
-         */
-      const Complex ix = x_zero ? 0.0 : 1.0 / x;
-      const Complex iy = y_zero ? 0.0 : 1.0 / y;
-      const Complex inv_x2y2 =
-          both_zero
-              ? 1.0
-              : 1.0 /
-                    (x2 + y2);  // The first "1.0" is the trick for above limits
-
-      const Numeric C0 =
-          either_zero ? 1.0 : ((cy * x2 + cx * y2) * inv_x2y2).real();
-      const Numeric C1 =
-          either_zero ? 1.0 : ((sy * x2 * iy + sx * y2 * ix) * inv_x2y2).real();
-      const Numeric C2 = both_zero ? 0.5 : ((cx - cy) * inv_x2y2).real();
-      const Numeric C3 =
-          both_zero ? 1.0 / 6.0
-                    : ((x_zero ? 1.0 - sy * iy
-                               : y_zero ? sx * ix - 1.0 : sx * ix - sy * iy) *
-                       inv_x2y2)
-                          .real();
-      T.Mat4(i).noalias() =
-          exp_a * (Eigen::Matrix4d() << C0 + C2 * (b2 + c2 + d2),
-                   C1 * b + C2 * (-c * u - d * v) +
-                       C3 * (b * (b2 + c2 + d2) - u * (b * u - d * w) -
-                             v * (b * v + c * w)),
-                   C1 * c + C2 * (b * u - d * w) +
-                       C3 * (c * (b2 + c2 + d2) - u * (c * u + d * v) -
-                             w * (b * v + c * w)),
-                   C1 * d + C2 * (b * v + c * w) +
-                       C3 * (d * (b2 + c2 + d2) - v * (c * u + d * v) +
-                             w * (b * u - d * w)),
-
-                   C1 * b + C2 * (c * u + d * v) +
-                       C3 * (-b * (-b2 + u2 + v2) + c * (b * c - v * w) +
-                             d * (b * d + u * w)),
-                   C0 + C2 * (b2 - u2 - v2),
-                   C2 * (b * c - v * w) + C1 * u +
-                       C3 * (c * (c * u + d * v) - u * (-b2 + u2 + v2) -
-                             w * (b * d + u * w)),
-                   C2 * (b * d + u * w) + C1 * v +
-                       C3 * (d * (c * u + d * v) - v * (-b2 + u2 + v2) +
-                             w * (b * c - v * w)),
-
-                   C1 * c + C2 * (-b * u + d * w) +
-                       C3 * (b * (b * c - v * w) - c * (-c2 + u2 + w2) +
-                             d * (c * d - u * v)),
-                   C2 * (b * c - v * w) - C1 * u +
-                       C3 * (-b * (b * u - d * w) + u * (-c2 + u2 + w2) -
-                             v * (c * d - u * v)),
-                   C0 + C2 * (c2 - u2 - w2),
-                   C2 * (c * d - u * v) + C1 * w +
-                       C3 * (-d * (b * u - d * w) + v * (b * c - v * w) -
-                             w * (-c2 + u2 + w2)),
-
-                   C1 * d + C2 * (-b * v - c * w) +
-                       C3 * (b * (b * d + u * w) + c * (c * d - u * v) -
-                             d * (-d2 + v2 + w2)),
-                   C2 * (b * d + u * w) - C1 * v +
-                       C3 * (-b * (b * v + c * w) - u * (c * d - u * v) +
-                             v * (-d2 + v2 + w2)),
-                   C2 * (c * d - u * v) - C1 * w +
-                       C3 * (-c * (b * v + c * w) + u * (b * d + u * w) +
-                             w * (-d2 + v2 + w2)),
-                   C0 + C2 * (d2 - v2 - w2))
-                      .finished();
-    }
+  Exp4Batch e;
+  for (Index first = 0; first < K1.NumberOfFrequencies();
+       first += exp4_batch_size) {
+    exp4_batch(e, K1, K2, r, first, iz, ia);
+    for (Index k = 0; k < e.n; k++)
+      T.Mat4(first + k).noalias() = exp4_matrix(e, k);
   }
 }
 
@@ -760,542 +1045,28 @@ inline void dtransmat4(TransmissionMatrix& T,
                        const Index it,
                        const Index iz,
                        const Index ia) noexcept {
-  static constexpr Numeric sqrt_05 = Constant::inv_sqrt_2;
-  for (Index i = 0; i < K1.NumberOfFrequencies(); i++) {
-    const Numeric a = -0.5 * r * (K1.Kjj(iz, ia)[i] + K2.Kjj(iz, ia)[i]),
-                  b = -0.5 * r * (K1.K12(iz, ia)[i] + K2.K12(iz, ia)[i]),
-                  c = -0.5 * r * (K1.K13(iz, ia)[i] + K2.K13(iz, ia)[i]),
-                  d = -0.5 * r * (K1.K14(iz, ia)[i] + K2.K14(iz, ia)[i]),
-                  u = -0.5 * r * (K1.K23(iz, ia)[i] + K2.K23(iz, ia)[i]),
-                  v = -0.5 * r * (K1.K24(iz, ia)[i] + K2.K24(iz, ia)[i]),
-                  w = -0.5 * r * (K1.K34(iz, ia)[i] + K2.K34(iz, ia)[i]);
-    const Numeric exp_a = std::exp(a);
-
-    if (b == 0. and c == 0. and d == 0. and u == 0. and v == 0. and w == 0.) {
-      T.Mat4(i).noalias() = Eigen::Matrix4d::Identity() * exp_a;
-      for (Index j = 0; j < dK1.nelem(); j++) {
-        if (dK1[j].NumberOfFrequencies())
-          dT1[j].Mat4(i).noalias() =
-              T.Mat4(i) *
-              (-0.5 *
-               (r * dK1[j].Kjj(iz, ia)[i] +
-                ((j == it) ? dr_dT1 * (K1.Kjj(iz, ia)[i] + K2.Kjj(iz, ia)[i])
-                           : 0.0)));
-        if (dK2[j].NumberOfFrequencies())
-          dT2[j].Mat4(i).noalias() =
-              T.Mat4(i) *
-              (-0.5 *
-               (r * dK2[j].Kjj(iz, ia)[i] +
-                ((j == it) ? dr_dT2 * (K1.Kjj(iz, ia)[i] + K2.Kjj(iz, ia)[i])
-                           : 0.0)));
+  Exp4Batch e;
+  DExp4Batch de;
+  for (Index first = 0; first < K1.NumberOfFrequencies();
+       first += exp4_batch_size) {
+    exp4_batch(e, K1, K2, r, first, iz, ia);
+    for (Index k = 0; k < e.n; k++)
+      T.Mat4(first + k).noalias() = exp4_matrix(e, k);
+
+    for (Index j = 0; j < dK1.nelem(); j++) {
+      if (dK1[j].NumberOfFrequencies()) {
+        dexp4_batch(
+            de, e, dK1[j], K1, K2, r, j == it ? dr_dT1 : 0.0, first, iz, ia);
+        for (Index k = 0; k < e.n; k++)
+          dT1[j].Mat4(first + k).noalias() =
+              dexp4_matrix(e, de, k, T.Mat4(first + k));
       }
-    } else {
-      const Numeric b2 = b * b, c2 = c * c, d2 = d * d, u2 = u * u, v2 = v * v,
-                    w2 = w * w;
-      const Numeric tmp =
-          w2 * w2 + 2 * (b2 * (b2 * 0.5 + c2 + d2 - u2 - v2 + w2) +
-                         c2 * (c2 * 0.5 + d2 - u2 + v2 - w2) +
-                         d2 * (d2 * 0.5 + u2 - v2 - w2) +
-                         u2 * (u2 * 0.5 + v2 + w2) + v2 * (v2 * 0.5 + w2) +
-                         4 * (b * d * u * w - b * c * v * w - c * d * u * v));
-      const Complex Const1 = std::sqrt(Complex(tmp, 0));
-      const Numeric Const2 = b2 + c2 + d2 - u2 - v2 - w2;
-      const Complex tmp_x_sqrt = std::sqrt(Const2 + Const1);
-      const Complex tmp_y_sqrt = std::sqrt(Const2 - Const1);
-      const Complex x = tmp_x_sqrt * sqrt_05;
-      const Complex y = tmp_y_sqrt * sqrt_05 * Complex(0, 1);
-      const Complex x2 = x * x;
-      const Complex y2 = y * y;
-      const Complex cy = std::cos(y);
-      const Complex sy = std::sin(y);
-      const Complex cx = std::cosh(x);
-      const Complex sx = std::sinh(x);
-
-      const bool x_zero = std::abs(x) < lower_is_considered_zero_for_sinc_likes;
-      const bool y_zero = std::abs(y) < lower_is_considered_zero_for_sinc_likes;
-      const bool both_zero = y_zero and x_zero;
-      const bool either_zero = y_zero or x_zero;
-
-      /* Using:
-       *    lim x→0 [({cosh(x),cos(x)} - 1) / x^2] → 1/2
-       *    lim x→0 [{sinh(x),sin(x)} / x]  → 1
-       *    inv_x2 := 1 for x == 0,
-       *    -i sin(ix) → sinh(x)
-       *    cos(ix) → cosh(x)
-       *    C0, C1, C2 ∝ [1/x^2]
-       */
-      const Complex ix = x_zero ? 0.0 : 1.0 / x;
-      const Complex iy = y_zero ? 0.0 : 1.0 / y;
-      const Complex inv_x2y2 =
-          both_zero
-              ? 1.0
-              : 1.0 /
-                    (x2 + y2);  // The first "1.0" is the trick for above limits
-      const Complex C0c = either_zero ? 1.0 : (cy * x2 + cx * y2) * inv_x2y2;
-      const Complex C1c =
-          either_zero ? 1.0 : (sy * x2 * iy + sx * y2 * ix) * inv_x2y2;
-      const Complex C2c = both_zero ? 0.5 : (cx - cy) * inv_x2y2;
-      const Complex C3c =
-          both_zero ? 1.0 / 6.0
-                    : (x_zero ? 1.0 - sy * iy
-                              : y_zero ? sx * ix - 1.0 : sx * ix - sy * iy) *
-                          inv_x2y2;
-
-      const Numeric& C0 = reinterpret_cast<const Numeric(&)[2]>(C0c)[0];
-      const Numeric& C1 = reinterpret_cast<const Numeric(&)[2]>(C1c)[0];
-      const Numeric& C2 = reinterpret_cast<const Numeric(&)[2]>(C2c)[0];
-      const Numeric& C3 = reinterpret_cast<const Numeric(&)[2]>(C3c)[0];
-      T.Mat4(i).noalias() =
-          exp_a * (Eigen::Matrix4d() << C0 + C2 * (b2 + c2 + d2),
-                   C1 * b + C2 * (-c * u - d * v) +
-                       C3 * (b * (b2 + c2 + d2) - u * (b * u - d * w) -
-                             v * (b * v + c * w)),
-                   C1 * c + C2 * (b * u - d * w) +
-                       C3 * (c * (b2 + c2 + d2) - u * (c * u + d * v) -
-                             w * (b * v + c * w)),
-                   C1 * d + C2 * (b * v + c * w) +
-                       C3 * (d * (b2 + c2 + d2) - v * (c * u + d * v) +
-                             w * (b * u - d * w)),
-
-                   C1 * b + C2 * (c * u + d * v) +
-                       C3 * (-b * (-b2 + u2 + v2) + c * (b * c - v * w) +
-                             d * (b * d + u * w)),
-                   C0 + C2 * (b2 - u2 - v2),
-                   C2 * (b * c - v * w) + C1 * u +
-                       C3 * (c * (c * u + d * v) - u * (-b2 + u2 + v2) -
-                             w * (b * d + u * w)),
-                   C2 * (b * d + u * w) + C1 * v +
-                       C3 * (d * (c * u + d * v) - v * (-b2 + u2 + v2) +
-                             w * (b * c - v * w)),
-
-                   C1 * c + C2 * (-b * u + d * w) +
-                       C3 * (b * (b * c - v * w) - c * (-c2 + u2 + w2) +
-                             d * (c * d - u * v)),
-                   C2 * (b * c - v * w) - C1 * u +
-                       C3 * (-b * (b * u - d * w) + u * (-c2 + u2 + w2) -
-                             v * (c * d - u * v)),
-                   C0 + C2 * (c2 - u2 - w2),
-                   C2 * (c * d - u * v) + C1 * w +
-                       C3 * (-d * (b * u - d * w) + v * (b * c - v * w) -
-                             w * (-c2 + u2 + w2)),
-
-                   C1 * d + C2 * (-b * v - c * w) +
-                       C3 * (b * (b * d + u * w) + c * (c * d - u * v) -
-                             d * (-d2 + v2 + w2)),
-                   C2 * (b * d + u * w) - C1 * v +
-                       C3 * (-b * (b * v + c * w) - u * (c * d - u * v) +
-                             v * (-d2 + v2 + w2)),
-                   C2 * (c * d - u * v) - C1 * w +
-                       C3 * (-c * (b * v + c * w) + u * (b * d + u * w) +
-                             w * (-d2 + v2 + w2)),
-                   C0 + C2 * (d2 - v2 - w2))
-                      .finished();
-
-      for (Index j = 0; j < dK1.nelem(); j++) {
-        if (dK1[j].NumberOfFrequencies()) {
-          const Numeric da = -0.5 * (r * dK1[j].Kjj(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.Kjj(iz, ia)[i] +
-                                                            K2.Kjj(iz, ia)[i])
-                                                : 0.0)),
-                        db = -0.5 * (r * dK1[j].K12(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.K12(iz, ia)[i] +
-                                                            K2.K12(iz, ia)[i])
-                                                : 0.0)),
-                        dc = -0.5 * (r * dK1[j].K13(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.K13(iz, ia)[i] +
-                                                            K2.K13(iz, ia)[i])
-                                                : 0.0)),
-                        dd = -0.5 * (r * dK1[j].K14(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.K14(iz, ia)[i] +
-                                                            K2.K14(iz, ia)[i])
-                                                : 0.0)),
-                        du = -0.5 * (r * dK1[j].K23(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.K23(iz, ia)[i] +
-                                                            K2.K23(iz, ia)[i])
-                                                : 0.0)),
-                        dv = -0.5 * (r * dK1[j].K24(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.K24(iz, ia)[i] +
-                                                            K2.K24(iz, ia)[i])
-                                                : 0.0)),
-                        dw = -0.5 * (r * dK1[j].K34(iz, ia)[i] +
-                                     ((j == it) ? dr_dT1 * (K1.K34(iz, ia)[i] +
-                                                            K2.K34(iz, ia)[i])
-                                                : 0.0));
-          const Numeric db2 = 2 * db * b, dc2 = 2 * dc * c, dd2 = 2 * dd * d,
-                        du2 = 2 * du * u, dv2 = 2 * dv * v, dw2 = 2 * dw * w;
-          const Numeric dtmp =
-              2 * w2 * dw2 +
-              2 * (db2 * (b2 * 0.5 + c2 + d2 - u2 - v2 + w2) +
-                   b2 * (db2 * 0.5 + dc2 + dd2 - du2 - dv2 + dw2) +
-                   dc2 * (c2 * 0.5 + d2 - u2 + v2 - w2) +
-                   c2 * (dc2 * 0.5 + dd2 - du2 + dv2 - dw2) +
-                   dd2 * (d2 * 0.5 + u2 - v2 - w2) +
-                   d2 * (dd2 * 0.5 + du2 - dv2 - dw2) +
-                   du2 * (u2 * 0.5 + v2 + w2) + u2 * (du2 * 0.5 + dv2 + dw2) +
-                   dv2 * (v2 * 0.5 + w2) + v2 * (dv2 * 0.5 + dw2) +
-                   4 * (db * d * u * w - db * c * v * w - dc * d * u * v +
-                        b * dd * u * w - b * dc * v * w - c * dd * u * v +
-                        b * d * du * w - b * c * dv * w - c * d * du * v +
-                        b * d * u * dw - b * c * v * dw - c * d * u * dv));
-          const Complex dConst1 = 0.5 * dtmp / Const1;
-          const Numeric dConst2 = db2 + dc2 + dd2 - du2 - dv2 - dw2;
-          const Complex dx =
-              x_zero ? 0 : (0.5 * (dConst2 + dConst1) / tmp_x_sqrt) * sqrt_05;
-          const Complex dy = y_zero ? 0
-                                    : (0.5 * (dConst2 - dConst1) / tmp_y_sqrt) *
-                                          sqrt_05 * Complex(0, 1);
-          const Complex dx2 = 2 * x * dx;
-          const Complex dy2 = 2 * y * dy;
-          const Complex dcy = -sy * dy;
-          const Complex dsy = cy * dy;
-          const Complex dcx = sx * dx;
-          const Complex dsx = cx * dx;
-          const Complex dix = -dx * ix * ix;
-          const Complex diy = -dy * iy * iy;
-          const Complex dx2dy2 = dx2 + dy2;
-          const Complex dC0c =
-              either_zero
-                  ? 0.0
-                  : (dcy * x2 + cy * dx2 + dcx * y2 + cx * dy2 - C0c * dx2dy2) *
-                        inv_x2y2;
-          const Complex dC1c =
-              either_zero ? 0.0
-                          : (dsy * x2 * iy + sy * dx2 * iy + sy * x2 * diy +
-                             dsx * y2 * ix + sx * dy2 * ix + sx * y2 * dix -
-                             C1c * dx2dy2) *
-                                inv_x2y2;
-          const Complex dC2c =
-              both_zero ? 0.0 : (dcx - dcy - C2c * dx2dy2) * inv_x2y2;
-          const Complex dC3c =
-              both_zero ? 0.0
-                        : ((x_zero ? -dsy * iy - sy * diy
-                                   : y_zero ? dsx * ix + sx * dix
-                                            : dsx * ix + sx * dix - dsy * iy -
-                                                  sy * diy) -
-                           C3c * dx2dy2) *
-                              inv_x2y2;
-
-          const Numeric& dC0 = reinterpret_cast<const Numeric(&)[2]>(dC0c)[0];
-          const Numeric& dC1 = reinterpret_cast<const Numeric(&)[2]>(dC1c)[0];
-          const Numeric& dC2 = reinterpret_cast<const Numeric(&)[2]>(dC2c)[0];
-          const Numeric& dC3 = reinterpret_cast<const Numeric(&)[2]>(dC3c)[0];
-          dT1[j].Mat4(i).noalias() =
-              T.Mat4(i) * da +
-              exp_a *
-                  (Eigen::Matrix4d()
-                       << dC0 + dC2 * (b2 + c2 + d2) + C2 * (db2 + dc2 + dd2),
-                   db * C1 + b * dC1 + dC2 * (-c * u - d * v) +
-                       C2 * (-dc * u - dd * v - c * du - d * dv) +
-                       dC3 * (b * (b2 + c2 + d2) - u * (b * u - d * w) -
-                              v * (b * v + c * w)) +
-                       C3 * (db * (b2 + c2 + d2) - du * (b * u - d * w) -
-                             dv * (b * v + c * w) + b * (db2 + dc2 + dd2) -
-                             u * (db * u - dd * w) - v * (db * v + dc * w) -
-                             u * (b * du - d * dw) - v * (b * dv + c * dw)),
-                   dC1 * c + C1 * dc + dC2 * (b * u - d * w) +
-                       C2 * (db * u - dd * w + b * du - d * dw) +
-                       dC3 * (c * (b2 + c2 + d2) - u * (c * u + d * v) -
-                              w * (b * v + c * w)) +
-                       C3 * (dc * (b2 + c2 + d2) - du * (c * u + d * v) -
-                             dw * (b * v + c * w) + c * (db2 + dc2 + dd2) -
-                             u * (dc * u + dd * v) - w * (db * v + dc * w) -
-                             u * (c * du + d * dv) - w * (b * dv + c * dw)),
-                   dC1 * d + C1 * dd + dC2 * (b * v + c * w) +
-                       C2 * (db * v + dc * w + b * dv + c * dw) +
-                       dC3 * (d * (b2 + c2 + d2) - v * (c * u + d * v) +
-                              w * (b * u - d * w)) +
-                       C3 * (dd * (b2 + c2 + d2) - dv * (c * u + d * v) +
-                             dw * (b * u - d * w) + d * (db2 + dc2 + dd2) -
-                             v * (dc * u + dd * v) + w * (db * u - dd * w) -
-                             v * (c * du + d * dv) + w * (b * du - d * dw)),
-
-                   db * C1 + b * dC1 + dC2 * (c * u + d * v) +
-                       C2 * (dc * u + dd * v + c * du + d * dv) +
-                       dC3 * (-b * (-b2 + u2 + v2) + c * (b * c - v * w) +
-                              d * (b * d + u * w)) +
-                       C3 * (-db * (-b2 + u2 + v2) + dc * (b * c - v * w) +
-                             dd * (b * d + u * w) - b * (-db2 + du2 + dv2) +
-                             c * (db * c - dv * w) + d * (db * d + du * w) +
-                             c * (b * dc - v * dw) + d * (b * dd + u * dw)),
-                   dC0 + dC2 * (b2 - u2 - v2) + C2 * (db2 - du2 - dv2),
-                   dC2 * (b * c - v * w) +
-                       C2 * (db * c + b * dc - dv * w - v * dw) + dC1 * u +
-                       C1 * du +
-                       dC3 * (c * (c * u + d * v) - u * (-b2 + u2 + v2) -
-                              w * (b * d + u * w)) +
-                       C3 * (dc * (c * u + d * v) - du * (-b2 + u2 + v2) -
-                             dw * (b * d + u * w) + c * (dc * u + dd * v) -
-                             u * (-db2 + du2 + dv2) - w * (db * d + du * w) +
-                             c * (c * du + d * dv) - w * (b * dd + u * dw)),
-                   dC2 * (b * d + u * w) +
-                       C2 * (db * d + b * dd + du * w + u * dw) + dC1 * v +
-                       C1 * dv +
-                       dC3 * (d * (c * u + d * v) - v * (-b2 + u2 + v2) +
-                              w * (b * c - v * w)) +
-                       C3 * (dd * (c * u + d * v) - dv * (-b2 + u2 + v2) +
-                             dw * (b * c - v * w) + d * (dc * u + dd * v) -
-                             v * (-db2 + du2 + dv2) + w * (db * c - dv * w) +
-                             d * (c * du + d * dv) + w * (b * dc - v * dw)),
-
-                   dC1 * c + C1 * dc + dC2 * (-b * u + d * w) +
-                       C2 * (-db * u + dd * w - b * du + d * dw) +
-                       dC3 * (b * (b * c - v * w) - c * (-c2 + u2 + w2) +
-                              d * (c * d - u * v)) +
-                       C3 * (db * (b * c - v * w) - dc * (-c2 + u2 + w2) +
-                             dd * (c * d - u * v) + b * (db * c - dv * w) -
-                             c * (-dc2 + du2 + dw2) + d * (dc * d - du * v) +
-                             b * (b * dc - v * dw) + d * (c * dd - u * dv)),
-                   dC2 * (b * c - v * w) +
-                       C2 * (db * c + b * dc - dv * w - v * dw) - dC1 * u -
-                       C1 * du +
-                       dC3 * (-b * (b * u - d * w) + u * (-c2 + u2 + w2) -
-                              v * (c * d - u * v)) +
-                       C3 * (-db * (b * u - d * w) + du * (-c2 + u2 + w2) -
-                             dv * (c * d - u * v) - b * (db * u - dd * w) +
-                             u * (-dc2 + du2 + dw2) - v * (dc * d - du * v) -
-                             b * (b * du - d * dw) - v * (c * dd - u * dv)),
-                   dC0 + dC2 * (c2 - u2 - w2) + C2 * (dc2 - du2 - dw2),
-                   dC2 * (c * d - u * v) +
-                       C2 * (dc * d + c * dd - du * v - u * dv) + dC1 * w +
-                       C1 * dw +
-                       dC3 * (-d * (b * u - d * w) + v * (b * c - v * w) -
-                              w * (-c2 + u2 + w2)) +
-                       C3 * (-dd * (b * u - d * w) + dv * (b * c - v * w) -
-                             dw * (-c2 + u2 + w2) - d * (db * u - dd * w) +
-                             v * (db * c - dv * w) - w * (-dc2 + du2 + dw2) -
-                             d * (b * du - d * dw) + v * (b * dc - v * dw)),
-
-                   dC1 * d + C1 * dd + dC2 * (-b * v - c * w) +
-                       C2 * (-db * v - dc * w - b * dv - c * dw) +
-                       dC3 * (b * (b * d + u * w) + c * (c * d - u * v) -
-                              d * (-d2 + v2 + w2)) +
-                       C3 * (db * (b * d + u * w) + dc * (c * d - u * v) -
-                             dd * (-d2 + v2 + w2) + b * (db * d + du * w) +
-                             c * (dc * d - du * v) - d * (-dd2 + dv2 + dw2) +
-                             b * (b * dd + u * dw) + c * (c * dd - u * dv)),
-                   dC2 * (b * d + u * w) +
-                       C2 * (db * d + b * dd + du * w + u * dw) - dC1 * v -
-                       C1 * dv +
-                       dC3 * (-b * (b * v + c * w) - u * (c * d - u * v) +
-                              v * (-d2 + v2 + w2)) +
-                       C3 * (-db * (b * v + c * w) - du * (c * d - u * v) +
-                             dv * (-d2 + v2 + w2) - b * (db * v + dc * w) -
-                             u * (dc * d - du * v) + v * (-dd2 + dv2 + dw2) -
-                             b * (b * dv + c * dw) - u * (c * dd - u * dv)),
-                   dC2 * (c * d - u * v) +
-                       C2 * (dc * d + c * dd - du * v - u * dv) - dC1 * w -
-                       C1 * dw +
-                       dC3 * (-c * (b * v + c * w) + u * (b * d + u * w) +
-                              w * (-d2 + v2 + w2)) +
-                       C3 * (-dc * (b * v + c * w) + du * (b * d + u * w) +
-                             dw * (-d2 + v2 + w2) - c * (db * v + dc * w) +
-                             u * (db * d + du * w) + w * (-dd2 + dv2 + dw2) -
-                             c * (b * dv + c * dw) + u * (b * dd + u * dw)),
-                   dC0 + dC2 * (d2 - v2 - w2) + C2 * (dd2 - dv2 - dw2))
-                      .finished();
-        }
-        if (dK2[j].NumberOfFrequencies()) {
-          const Numeric da = -0.5 * (r * dK2[j].Kjj(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.Kjj(iz, ia)[i] +
-                                                            K2.Kjj(iz, ia)[i])
-                                                : 0.0)),
-                        db = -0.5 * (r * dK2[j].K12(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.K12(iz, ia)[i] +
-                                                            K2.K12(iz, ia)[i])
-                                                : 0.0)),
-                        dc = -0.5 * (r * dK2[j].K13(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.K13(iz, ia)[i] +
-                                                            K2.K13(iz, ia)[i])
-                                                : 0.0)),
-                        dd = -0.5 * (r * dK2[j].K14(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.K14(iz, ia)[i] +
-                                                            K2.K14(iz, ia)[i])
-                                                : 0.0)),
-                        du = -0.5 * (r * dK2[j].K23(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.K23(iz, ia)[i] +
-                                                            K2.K23(iz, ia)[i])
-                                                : 0.0)),
-                        dv = -0.5 * (r * dK2[j].K24(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.K24(iz, ia)[i] +
-                                                            K2.K24(iz, ia)[i])
-                                                : 0.0)),
-                        dw = -0.5 * (r * dK2[j].K34(iz, ia)[i] +
-                                     ((j == it) ? dr_dT2 * (K1.K34(iz, ia)[i] +
-                                                            K2.K34(iz, ia)[i])
-                                                : 0.0));
-          const Numeric db2 = 2 * db * b, dc2 = 2 * dc * c, dd2 = 2 * dd * d,
-                        du2 = 2 * du * u, dv2 = 2 * dv * v, dw2 = 2 * dw * w;
-          const Numeric dtmp =
-              2 * w2 * dw2 +
-              2 * (db2 * (b2 * 0.5 + c2 + d2 - u2 - v2 + w2) +
-                   b2 * (db2 * 0.5 + dc2 + dd2 - du2 - dv2 + dw2) +
-                   dc2 * (c2 * 0.5 + d2 - u2 + v2 - w2) +
-                   c2 * (dc2 * 0.5 + dd2 - du2 + dv2 - dw2) +
-                   dd2 * (d2 * 0.5 + u2 - v2 - w2) +
-                   d2 * (dd2 * 0.5 + du2 - dv2 - dw2) +
-                   du2 * (u2 * 0.5 + v2 + w2) + u2 * (du2 * 0.5 + dv2 + dw2) +
-                   dv2 * (v2 * 0.5 + w2) + v2 * (dv2 * 0.5 + dw2) +
-                   4 * (db * d * u * w - db * c * v * w - dc * d * u * v +
-                        b * dd * u * w - b * dc * v * w - c * dd * u * v +
-                        b * d * du * w - b * c * dv * w - c * d * du * v +
-                        b * d * u * dw - b * c * v * dw - c * d * u * dv));
-          const Complex dConst1 = 0.5 * dtmp / Const1;
-          const Numeric dConst2 = db2 + dc2 + dd2 - du2 - dv2 - dw2;
-          const Complex dx =
-              x_zero ? 0 : (0.5 * (dConst2 + dConst1) / tmp_x_sqrt) * sqrt_05;
-          const Complex dy = y_zero ? 0
-                                    : (0.5 * (dConst2 - dConst1) / tmp_y_sqrt) *
-                                          sqrt_05 * Complex(0, 1);
-          const Complex dx2 = 2 * x * dx;
-          const Complex dy2 = 2 * y * dy;
-          const Complex dcy = -sy * dy;
-          const Complex dsy = cy * dy;
-          const Complex dcx = sx * dx;
-          const Complex dsx = cx * dx;
-          const Complex dix = -dx * ix * ix;
-          const Complex diy = -dy * iy * iy;
-          const Complex dx2dy2 = dx2 + dy2;
-          const Complex dC0c =
-              either_zero
-                  ? 0.0
-                  : (dcy * x2 + cy * dx2 + dcx * y2 + cx * dy2 - C0c * dx2dy2) *
-                        inv_x2y2;
-          const Complex dC1c =
-              either_zero ? 0.0
-                          : (dsy * x2 * iy + sy * dx2 * iy + sy * x2 * diy +
-                             dsx * y2 * ix + sx * dy2 * ix + sx * y2 * dix -
-                             C1c * dx2dy2) *
-                                inv_x2y2;
-          const Complex dC2c =
-              both_zero ? 0.0 : (dcx - dcy - C2c * dx2dy2) * inv_x2y2;
-          const Complex dC3c =
-              both_zero ? 0.0
-                        : ((x_zero ? -dsy * iy - sy * diy
-                                   : y_zero ? dsx * ix + sx * dix
-                                            : dsx * ix + sx * dix - dsy * iy -
-                                                  sy * diy) -
-                           C3c * dx2dy2) *
-                              inv_x2y2;
-
-          const Numeric& dC0 = reinterpret_cast<const Numeric(&)[2]>(dC0c)[0];
-          const Numeric& dC1 = reinterpret_cast<const Numeric(&)[2]>(dC1c)[0];
-          const Numeric& dC2 = reinterpret_cast<const Numeric(&)[2]>(dC2c)[0];
-          const Numeric& dC3 = reinterpret_cast<const Numeric(&)[2]>(dC3c)[0];
-          dT2[j].Mat4(i).noalias() =
-              T.Mat4(i) * da +
-              exp_a *
-                  (Eigen::Matrix4d()
-                       << dC0 + dC2 * (b2 + c2 + d2) + C2 * (db2 + dc2 + dd2),
-                   db * C1 + b * dC1 + dC2 * (-c * u - d * v) +
-                       C2 * (-dc * u - dd * v - c * du - d * dv) +
-                       dC3 * (b * (b2 + c2 + d2) - u * (b * u - d * w) -
-                              v * (b * v + c * w)) +
-                       C3 * (db * (b2 + c2 + d2) - du * (b * u - d * w) -
-                             dv * (b * v + c * w) + b * (db2 + dc2 + dd2) -
-                             u * (db * u - dd * w) - v * (db * v + dc * w) -
-                             u * (b * du - d * dw) - v * (b * dv + c * dw)),
-                   dC1 * c + C1 * dc + dC2 * (b * u - d * w) +
-                       C2 * (db * u - dd * w + b * du - d * dw) +
-                       dC3 * (c * (b2 + c2 + d2) - u * (c * u + d * v) -
-                              w * (b * v + c * w)) +
-                       C3 * (dc * (b2 + c2 + d2) - du * (c * u + d * v) -
-                             dw * (b * v + c * w) + c * (db2 + dc2 + dd2) -
-                             u * (dc * u + dd * v) - w * (db * v + dc * w) -
-                             u * (c * du + d * dv) - w * (b * dv + c * dw)),
-                   dC1 * d + C1 * dd + dC2 * (b * v + c * w) +
-                       C2 * (db * v + dc * w + b * dv + c * dw) +
-                       dC3 * (d * (b2 + c2 + d2) - v * (c * u + d * v) +
-                              w * (b * u - d * w)) +
-                       C3 * (dd * (b2 + c2 + d2) - dv * (c * u + d * v) +
-                             dw * (b * u - d * w) + d * (db2 + dc2 + dd2) -
-                             v * (dc * u + dd * v) + w * (db * u - dd * w) -
-                             v * (c * du + d * dv) + w * (b * du - d * dw)),
-
-                   db * C1 + b * dC1 + dC2 * (c * u + d * v) +
-                       C2 * (dc * u + dd * v + c * du + d * dv) +
-                       dC3 * (-b * (-b2 + u2 + v2) + c * (b * c - v * w) +
-                              d * (b * d + u * w)) +
-                       C3 * (-db * (-b2 + u2 + v2) + dc * (b * c - v * w) +
-                             dd * (b * d + u * w) - b * (-db2 + du2 + dv2) +
-                             c * (db * c - dv * w) + d * (db * d + du * w) +
-                             c * (b * dc - v * dw) + d * (b * dd + u * dw)),
-                   dC0 + dC2 * (b2 - u2 - v2) + C2 * (db2 - du2 - dv2),
-                   dC2 * (b * c - v * w) +
-                       C2 * (db * c + b * dc - dv * w - v * dw) + dC1 * u +
-                       C1 * du +
-                       dC3 * (c * (c * u + d * v) - u * (-b2 + u2 + v2) -
-                              w * (b * d + u * w)) +
-                       C3 * (dc * (c * u + d * v) - du * (-b2 + u2 + v2) -
-                             dw * (b * d + u * w) + c * (dc * u + dd * v) -
-                             u * (-db2 + du2 + dv2) - w * (db * d + du * w) +
-                             c * (c * du + d * dv) - w * (b * dd + u * dw)),
-                   dC2 * (b * d + u * w) +
-                       C2 * (db * d + b * dd + du * w + u * dw) + dC1 * v +
-                       C1 * dv +
-                       dC3 * (d * (c * u + d * v) - v * (-b2 + u2 + v2) +
-                              w * (b * c - v * w)) +
-                       C3 * (dd * (c * u + d * v) - dv * (-b2 + u2 + v2) +
-                             dw * (b * c - v * w) + d * (dc * u + dd * v) -
-                             v * (-db2 + du2 + dv2) + w * (db * c - dv * w) +
-                             d * (c * du + d * dv) + w * (b * dc - v * dw)),
-
-                   dC1 * c + C1 * dc + dC2 * (-b * u + d * w) +
-                       C2 * (-db * u + dd * w - b * du + d * dw) +
-                       dC3 * (b * (b * c - v * w) - c * (-c2 + u2 + w2) +
-                              d * (c * d - u * v)) +
-                       C3 * (db * (b * c - v * w) - dc * (-c2 + u2 + w2) +
-                             dd * (c * d - u * v) + b * (db * c - dv * w) -
-                             c * (-dc2 + du2 + dw2) + d * (dc * d - du * v) +
-                             b * (b * dc - v * dw) + d * (c * dd - u * dv)),
-                   dC2 * (b * c - v * w) +
-                       C2 * (db * c + b * dc - dv * w - v * dw) - dC1 * u -
-                       C1 * du +
-                       dC3 * (-b * (b * u - d * w) + u * (-c2 + u2 + w2) -
-                              v * (c * d - u * v)) +
-                       C3 * (-db * (b * u - d * w) + du * (-c2 + u2 + w2) -
-                             dv * (c * d - u * v) - b * (db * u - dd * w) +
-                             u * (-dc2 + du2 + dw2) - v * (dc * d - du * v) -
-                             b * (b * du - d * dw) - v * (c * dd - u * dv)),
-                   dC0 + dC2 * (c2 - u2 - w2) + C2 * (dc2 - du2 - dw2),
-                   dC2 * (c * d - u * v) +
-                       C2 * (dc * d + c * dd - du * v - u * dv) + dC1 * w +
-                       C1 * dw +
-                       dC3 * (-d * (b * u - d * w) + v * (b * c - v * w) -
-                              w * (-c2 + u2 + w2)) +
-                       C3 * (-dd * (b * u - d * w) + dv * (b * c - v * w) -
-                             dw * (-c2 + u2 + w2) - d * (db * u - dd * w) +
-                             v * (db * c - dv * w) - w * (-dc2 + du2 + dw2) -
-                             d * (b * du - d * dw) + v * (b * dc - v * dw)),
-
-                   dC1 * d + C1 * dd + dC2 * (-b * v - c * w) +
-                       C2 * (-db * v - dc * w - b * dv - c * dw) +
-                       dC3 * (b * (b * d + u * w) + c * (c * d - u * v) -
-                              d * (-d2 + v2 + w2)) +
-                       C3 * (db * (b * d + u * w) + dc * (c * d - u * v) -
-                             dd * (-d2 + v2 + w2) + b * (db * d + du * w) +
-                             c * (dc * d - du * v) - d * (-dd2 + dv2 + dw2) +
-                             b * (b * dd + u * dw) + c * (c * dd - u * dv)),
-                   dC2 * (b * d + u * w) +
-                       C2 * (db * d + b * dd + du * w + u * dw) - dC1 * v -
-                       C1 * dv +
-                       dC3 * (-b * (b * v + c * w) - u * (c * d - u * v) +
-                              v * (-d2 + v2 + w2)) +
-                       C3 * (-db * (b * v + c * w) - du * (c * d - u * v) +
-                             dv * (-d2 + v2 + w2) - b * (db * v + dc * w) -
-                             u * (dc * d - du * v) + v * (-dd2 + dv2 + dw2) -
-                             b * (b * dv + c * dw) - u * (c * dd - u * dv)),
-                   dC2 * (c * d - u * v) +
-                       C2 * (dc * d + c * dd - du * v - u * dv) - dC1 * w -
-                       C1 * dw +
-                       dC3 * (-c * (b * v + c * w) + u * (b * d + u * w) +
-                              w * (-d2 + v2 + w2)) +
-                       C3 * (-dc * (b * v + c * w) + du * (b * d + u * w) +
-                             dw * (-d2 + v2 + w2) - c * (db * v + dc * w) +
-                             u * (db * d + du * w) + w * (-dd2 + dv2 + dw2) -
-                             c * (b * dv + c * dw) + u * (b * dd + u * dw)),
-                   dC0 + dC2 * (d2 - v2 - w2) + C2 * (dd2 - dv2 - dw2))
-                      .finished();
-        }
+      if (dK2[j].NumberOfFrequencies()) {
+        dexp4_batch(
+            de, e, dK2[j], K1, K2, r, j == it ? dr_dT2 : 0.0, first, iz, ia);
+        for (Index k = 0; k < e.n; k++)
+          dT2[j].Mat4(first + k).noalias() =
+              dexp4_matrix(e, de, k, T.Mat4(first + k));
       }
     }
   }
@@ -1368,6 +1139,230 @@ void stepwise_transmission(TransmissionMatrix& T,
         T, dT1, dT2, K1, K2, dK1, dK2, r, dr_dtemp1, dr_dtemp2, temp_deriv_pos);
 }
 
+/** The parts of the clearsky solver that depend on the Stokes dimension
+ *
+ * The solver loops over frequencies are templates on the Stokes dimension,
+ * so that the dimension is selected once per call instead of once per
+ * frequency, and the stokes_dim 1 loops reduce to scalar arithmetic.
+ * Propagation matrices and Stokes vectors are read from the frequency rows
+ * of their data, see propmat_rows.
+ */
+template <int N>
+struct StokesSolver;
+
+template <>
+struct StokesSolver<1> {
+  using Vec = Eigen::Matrix<double, 1, 1>;
+  using Mat = Eigen::Matrix<double, 1, 1>;
+
+  static Vec& R(RadiationVector& I, size_t i) { return I.Vec1(i); }
+  static const Vec& R(const RadiationVector& I, size_t i) { return I.Vec1(i); }
+  static const Mat& T(const TransmissionMatrix& T, size_t i) {
+    return T.Mat1(i);
+  }
+
+  static Vec vec(const ConstMatrixView& a, Index i) { return Vec(a(i, 0)); }
+  static Mat K(const ConstMatrixView& K, Index i) { return matrix1(K(i, 0)); }
+  static Mat invK(const ConstMatrixView& K, Index i) { return inv1(K(i, 0)); }
+};
+
+template <>
+struct StokesSolver<2> {
+  using Vec = Eigen::Vector2d;
+  using Mat = Eigen::Matrix2d;
+
+  static Vec& R(RadiationVector& I, size_t i) { return I.Vec2(i); }
+  static const Vec& R(const RadiationVector& I, size_t i) { return I.Vec2(i); }
+  static const Mat& T(const TransmissionMatrix& T, size_t i) {
+    return T.Mat2(i);
+  }
+
+  static Vec vec(const ConstMatrixView& a, Index i) {
+    return Vec(a(i, 0), a(i, 1));
+  }
+  static Mat K(const ConstMatrixView& K, Index i) {
+    return matrix2(K(i, 0), K(i, 1));
+  }
+  static Mat invK(const ConstMatrixView& K, Index i) {
+    return inv2(K(i, 0), K(i, 1));
+  }
+};
+
+template <>
+struct StokesSolver<3> {
+  using Vec = Eigen::Vector3d;
+  using Mat = Eigen::Matrix3d;
+
+  static Vec& R(RadiationVector& I, size_t i) { return I.Vec3(i); }
+  static const Vec& R(const RadiationVector& I, size_t i) { return I.Vec3(i); }
+  static const Mat& T(const TransmissionMatrix& T, size_t i) {
+    return T.Mat3(i);
+  }
+
+  static Vec vec(const ConstMatrixView& a, Index i) {
+    return Vec(a(i, 0), a(i, 1), a(i, 2));
+  }
+  static Mat K(const ConstMatrixView& K, Index i) {
+    return matrix3(K(i, 0), K(i, 1), K(i, 2), K(i, 3));
+  }
+  static Mat invK(const ConstMatrixView& K, Index i) {
+    return inv3(K(i, 0), K(i, 1), K(i, 2), K(i, 3));
+  }
+};
+
+template <>
+struct StokesSolver<4> {
+  using Vec = Eigen::Vector4d;
+  using Mat = Eigen::Matrix4d;
+
+  static Vec& R(RadiationVector& I, size_t i) { return I.Vec4(i); }
+  static const Vec& R(const RadiationVector& I, size_t i) { return I.Vec4(i); }
+  static const Mat& T(const TransmissionMatrix& T, size_t i) {
+    return T.Mat4(i);
+  }
+
+  static Vec vec(const ConstMatrixView& a, Index i) {
+    return Vec(a(i, 0), a(i, 1), a(i, 2), a(i, 3));
+  }
+  static Mat K(const ConstMatrixView& K, Index i) {
+    return matrix4(
+        K(i, 0), K(i, 1), K(i, 2), K(i, 3), K(i, 4), K(i, 5), K(i, 6));
+  }
+  static Mat invK(const ConstMatrixView& K, Index i) {
+    return inv4(K(i, 0), K(i, 1), K(i, 2), K(i, 3), K(i, 4), K(i, 5), K(i, 6));
+  }
+};
+
+/** The data of a propagation matrix or Stokes vector as [frequency, element]
+ *
+ * The elements are in the order Kjj, K12, K13, K14, K23, K24, K34, with K23
+ * directly after the Stokes vector part.
+ */
+inline ConstMatrixView propmat_rows(const PropagationMatrix& K) {
+  assert(K.NumberOfAzimuthAngles() == 1);
+  assert(K.NumberOfZenithAngles() == 1);
+  return K.Data()(0, 0, joker, joker);
+}
+
+template <int N>
+void stepwise_source_impl(RadiationVector& J,
+                          ArrayOfRadiationVector& dJ,
+                          const PropagationMatrix& K,
+                          const StokesVector& a,
+                          const StokesVector& S,
+                          const ArrayOfPropagationMatrix& dK,
+                          const ArrayOfStokesVector& da,
+                          const ArrayOfStokesVector& dS,
+                          const ConstVectorView B,
+                          const ConstVectorView dB_dT,
+                          const ArrayOfRetrievalQuantity& jacobian_quantities,
+                          const bool& jacobian_do) {
+  using SS = StokesSolver<N>;
+
+  const ConstMatrixView Km = propmat_rows(K);
+  const ConstMatrixView am = propmat_rows(a);
+  const bool scattering = not S.IsEmpty();
+  const ConstMatrixView Sm = scattering ? propmat_rows(S) : am;
+
+  // The analytical derivatives, with whether they are for the temperature
+  struct Derivative {
+    RadiationVector& dJ;
+    ConstMatrixView dK, da, dS;
+    bool dT;
+  };
+  std::vector<Derivative> derivs;
+  if (jacobian_do)
+    for (Index j = 0; j < jacobian_quantities.nelem(); j++)
+      if (jacobian_quantities[j].Analytical())
+        derivs.push_back(
+            {dJ[j],
+             propmat_rows(dK[j]),
+             propmat_rows(da[j]),
+             propmat_rows(dS[j]),
+             jacobian_quantities[j] == JacPropMatType::Temperature});
+
+  for (Index i = 0; i < K.NumberOfFrequencies(); i++) {
+    auto& Ji = SS::R(J, i);
+    if (Km(i, 0) == 0.0) {
+      Ji.setZero();
+      for (auto& d : derivs) SS::R(d.dJ, i).setZero();
+    } else {
+      if (scattering)
+        Ji.noalias() = SS::vec(am, i) * B[i] + SS::vec(Sm, i);
+      else
+        Ji.noalias() = SS::vec(am, i) * B[i];
+
+      const auto invK = SS::invK(Km, i);
+      Ji = invK * Ji;
+      for (auto& d : derivs) {
+        typename SS::Vec dsrc = SS::vec(d.dS, i) + SS::vec(d.da, i) * B[i];
+        if (d.dT) dsrc += SS::vec(am, i) * dB_dT[i];
+        SS::R(d.dJ, i).noalias() = 0.5 * invK * (dsrc - SS::K(d.dK, i) * Ji);
+      }
+    }
+  }
+}
+
+template <int N>
+void update_radiation_vector_impl(RadiationVector& I,
+                                  ArrayOfRadiationVector& dI1,
+                                  ArrayOfRadiationVector& dI2,
+                                  const RadiationVector& J1,
+                                  const RadiationVector& J2,
+                                  const ArrayOfRadiationVector& dJ1,
+                                  const ArrayOfRadiationVector& dJ2,
+                                  const TransmissionMatrix& T,
+                                  const TransmissionMatrix& PiT,
+                                  const ArrayOfTransmissionMatrix& dT1,
+                                  const ArrayOfTransmissionMatrix& dT2,
+                                  const RadiativeTransferSolver solver) {
+  using SS = StokesSolver<N>;
+  const size_t nf = size_t(I.Frequencies());
+
+  switch (solver) {
+    case RadiativeTransferSolver::Emission: {
+      // I - (J1 + J2) / 2 is kept in I until the end
+      for (size_t iv = 0; iv < nf; iv++)
+        SS::R(I, iv).noalias() -= 0.5 * (SS::R(J1, iv) + SS::R(J2, iv));
+
+      for (size_t i = 0; i < dI1.size(); i++) {
+        for (size_t iv = 0; iv < nf; iv++) {
+          SS::R(dI1[i], iv).noalias() +=
+              SS::T(PiT, iv) *
+              (SS::T(dT1[i], iv) * SS::R(I, iv) + SS::R(dJ1[i], iv) -
+               SS::T(T, iv) * SS::R(dJ1[i], iv));
+          SS::R(dI2[i], iv).noalias() +=
+              SS::T(PiT, iv) *
+              (SS::T(dT2[i], iv) * SS::R(I, iv) + SS::R(dJ2[i], iv) -
+               SS::T(T, iv) * SS::R(dJ2[i], iv));
+        }
+      }
+
+      for (size_t iv = 0; iv < nf; iv++) {
+        auto& Iv = SS::R(I, iv);
+        Iv = SS::T(T, iv) * Iv;
+        Iv.noalias() += 0.5 * (SS::R(J1, iv) + SS::R(J2, iv));
+      }
+    } break;
+
+    case RadiativeTransferSolver::Transmission: {
+      for (size_t i = 0; i < dI1.size(); i++) {
+        for (size_t iv = 0; iv < nf; iv++) {
+          SS::R(dI1[i], iv).noalias() +=
+              SS::T(PiT, iv) * SS::T(dT1[i], iv) * SS::R(I, iv);
+          SS::R(dI2[i], iv).noalias() +=
+              SS::T(PiT, iv) * SS::T(dT2[i], iv) * SS::R(I, iv);
+        }
+      }
+
+      for (size_t iv = 0; iv < nf; iv++) {
+        auto& Iv = SS::R(I, iv);
+        Iv = SS::T(T, iv) * Iv;
+      }
+    } break;
+  }
+}
+
 void stepwise_source(RadiationVector& J,
                      ArrayOfRadiationVector& dJ,
                      const PropagationMatrix& K,
@@ -1380,104 +1375,23 @@ void stepwise_source(RadiationVector& J,
                      const ConstVectorView dB_dT,
                      const ArrayOfRetrievalQuantity& jacobian_quantities,
                      const bool& jacobian_do) {
-  for (Index i = 0; i < K.NumberOfFrequencies(); i++) {
-    if (K.IsRotational(i)) {
-      J.SetZero(i);
-      if (jacobian_do) {
-        for (Index j = 0; j < jacobian_quantities.nelem(); j++)
-          if (jacobian_quantities[j].Analytical()) dJ[j].SetZero(i);
-      }
-    } else {
-      J.setSource(a, B, S, i);
-      switch (J.StokesDim()) {
-        case 4: {
-          const auto invK = inv4(K.Kjj()[i],
-                                 K.K12()[i],
-                                 K.K13()[i],
-                                 K.K14()[i],
-                                 K.K23()[i],
-                                 K.K24()[i],
-                                 K.K34()[i]);
-          J.Vec4(i) = invK * J.Vec4(i);
-          if (jacobian_do)
-            for (Index j = 0; j < jacobian_quantities.nelem(); j++)
-              if (jacobian_quantities[j].Analytical())
-                dJ[j].Vec4(i).noalias() =
-                    0.5 * invK *
-                    (vector4(a,
-                             B,
-                             da[j],
-                             dB_dT,
-                             dS[j],
-                             jacobian_quantities[j] == JacPropMatType::Temperature,
-                             i) -
-                     matrix4(dK[j].Kjj()[i],
-                             dK[j].K12()[i],
-                             dK[j].K13()[i],
-                             dK[j].K14()[i],
-                             dK[j].K23()[i],
-                             dK[j].K24()[i],
-                             dK[j].K34()[i]) *
-                         J.Vec4(i));
-        } break;
-        case 3: {
-          const auto invK =
-              inv3(K.Kjj()[i], K.K12()[i], K.K13()[i], K.K23()[i]);
-          J.Vec3(i) = invK * J.Vec3(i);
-          if (jacobian_do)
-            for (Index j = 0; j < jacobian_quantities.nelem(); j++)
-              if (jacobian_quantities[j].Analytical())
-                dJ[j].Vec3(i).noalias() =
-                    0.5 * invK *
-                    (vector3(a,
-                             B,
-                             da[j],
-                             dB_dT,
-                             dS[j],
-                             jacobian_quantities[j] == JacPropMatType::Temperature,
-                             i) -
-                     matrix3(dK[j].Kjj()[i],
-                             dK[j].K12()[i],
-                             dK[j].K13()[i],
-                             dK[j].K23()[i]) *
-                         J.Vec3(i));
-        } break;
-        case 2: {
-          const auto invK = inv2(K.Kjj()[i], K.K12()[i]);
-          J.Vec2(i) = invK * J.Vec2(i);
-          if (jacobian_do)
-            for (Index j = 0; j < jacobian_quantities.nelem(); j++)
-              if (jacobian_quantities[j].Analytical())
-                dJ[j].Vec2(i).noalias() =
-                    0.5 * invK *
-                    (vector2(a,
-                             B,
-                             da[j],
-                             dB_dT,
-                             dS[j],
-                             jacobian_quantities[j] == JacPropMatType::Temperature,
-                             i) -
-                     matrix2(dK[j].Kjj()[i], dK[j].K12()[i]) * J.Vec2(i));
-        } break;
-        default: {
-          const auto invK = 1 / K.Kjj()[i];
-          J.Vec1(i)[0] *= invK;
-          if (jacobian_do)
-            for (Index j = 0; j < jacobian_quantities.nelem(); j++)
-              if (jacobian_quantities[j].Analytical())
-                dJ[j].Vec1(i)[0] =
-                    0.5 * invK *
-                    (vector1(a,
-                             B,
-                             da[j],
-                             dB_dT,
-                             dS[j],
-                             jacobian_quantities[j] == JacPropMatType::Temperature,
-                             i) -
-                     dK[j].Kjj()[i] * J.Vec1(i)[0]);
-        } break;
-      }
-    }
+  switch (J.StokesDim()) {
+    case 4:
+      stepwise_source_impl<4>(
+          J, dJ, K, a, S, dK, da, dS, B, dB_dT, jacobian_quantities, jacobian_do);
+      break;
+    case 3:
+      stepwise_source_impl<3>(
+          J, dJ, K, a, S, dK, da, dS, B, dB_dT, jacobian_quantities, jacobian_do);
+      break;
+    case 2:
+      stepwise_source_impl<2>(
+          J, dJ, K, a, S, dK, da, dS, B, dB_dT, jacobian_quantities, jacobian_do);
+      break;
+    default:
+      stepwise_source_impl<1>(
+          J, dJ, K, a, S, dK, da, dS, B, dB_dT, jacobian_quantities, jacobian_do);
+      break;
   }
 }
 
@@ -1493,24 +1407,23 @@ void update_radiation_vector(RadiationVector& I,
                              const ArrayOfTransmissionMatrix& dT1,
                              const ArrayOfTransmissionMatrix& dT2,
                              const RadiativeTransferSolver solver) {
-  switch (solver) {
-    case RadiativeTransferSolver::Emission: {
-      I.rem_avg(J1, J2);
-      for (size_t i = 0; i < dI1.size(); i++) {
-        dI1[i].addDerivEmission(PiT, dT1[i], T, I, dJ1[i]);
-        dI2[i].addDerivEmission(PiT, dT2[i], T, I, dJ2[i]);
-      }
-      I.leftMul(T);
-      I.add_avg(J1, J2);
-    } break;
-
-    case RadiativeTransferSolver::Transmission: {
-      for (size_t i = 0; i < dI1.size(); i++) {
-        dI1[i].addDerivTransmission(PiT, dT1[i], I);
-        dI2[i].addDerivTransmission(PiT, dT2[i], I);
-      }
-      I.leftMul(T);
-    } break;
+  switch (I.StokesDim()) {
+    case 4:
+      update_radiation_vector_impl<4>(
+          I, dI1, dI2, J1, J2, dJ1, dJ2, T, PiT, dT1, dT2, solver);
+      break;
+    case 3:
+      update_radiation_vector_impl<3>(
+          I, dI1, dI2, J1, J2, dJ1, dJ2, T, PiT, dT1, dT2, solver);
+      break;
+    case 2:
+      update_radiation_vector_impl<2>(
+          I, dI1, dI2, J1, J2, dJ1, dJ2, T, PiT, dT1, dT2, solver);
+      break;
+    default:
+      update_radiation_vector_impl<1>(
+          I, dI1, dI2, J1, J2, dJ1, dJ2, T, PiT, dT1, dT2, solver);
+      break;
   }
 }
 
@@ -1481,6 +1481,24 @@ void Workspace::define_wsv_data() {
           "Unit: 1/m/jacobian_quantity\n"),
       GROUP("ArrayOfPropagationMatrix")));
 
+  wsv_data.push_back(WsvRecord(
+      NAME("dpropmat_clearsky_field_dx"),
+      DESCRIPTION(
+          "Partial derivatives of *propmat_clearsky_field*.\n"
+          "\n"
+          "Holds the derivatives of the total gas absorption for all\n"
+          "*jacobian_quantities* that *propmat_clearsky_agenda* provides\n"
+          "derivatives for (temperature, wind, magnetic field, line\n"
+          "parameters etc.). Derivatives with respect to absorption species are\n"
+          "not stored, they are given by *propmat_clearsky_field* itself.\n"
+          "\n"
+          "Set by *propmat_clearsky_fieldCalcWithDerivatives*.\n"
+          "\n"
+          "Unit:       1/m/jacobian_quantity\n"
+          "\n"
+          "Dimensions: [quantities, f_grid, *stokes_dim*, stokes_dim, p_grid, lat_grid, lon_grid]\n"),
+      GROUP("Tensor7")));
+
   wsv_data.push_back(WsvRecord(
       NAME("dpsd_data_dx"),
       DESCRIPTION(
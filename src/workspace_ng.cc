@@ -25,15 +25,98 @@
 #include "workspace_ng.h"
 #include "auto_workspace.h"
 #include "wsv_aux.h"
+#include <vector>
 
 WorkspaceMemoryHandler wsmh;
 
+/** Per-thread free lists of stack frames and WSV payloads.
+ *
+ * Agendas duplicate their outputs on every call and free them on return.
+ * Instead of freeing, the frames are kept here, and the last freed
+ * payload of each WSV is kept to be reused by the next duplication of
+ * the same WSV. Assigning to the kept payload reuses its memory if the
+ * size did not change.
+ */
+struct Workspace::WsvPool {
+  /** Largest number of free stack frames to keep. */
+  static constexpr std::size_t max_frames = 1024;
+
+  /** A freed payload and the group it belongs to. */
+  struct Payload {
+    Index group;
+    void *wsv;
+  };
+
+  std::vector<WsvStruct *> frames;
+
+  /** Indexed by WSV, wsv is NULL if there is no payload. */
+  std::vector<Payload> payloads;
+
+  WsvPool() : frames(), payloads() {}
+  WsvPool(const WsvPool &) = delete;
+  WsvPool &operator=(const WsvPool &) = delete;
+
+  ~WsvPool() {
+    for (auto &f : frames) delete f;
+    for (auto &p : payloads)
+      if (p.wsv) wsmh.deallocate(p.group, p.wsv);
+  }
+
+  /** Duplicate src, reusing the freed payload of WSV i if possible. */
+  void *duplicate(Index i, Index group, void *src) {
+    if (static_cast<std::size_t>(i) < payloads.size() && payloads[i].wsv) {
+      Payload &p = payloads[i];
+      void *wsv = p.wsv;
+      p.wsv = NULL;
+      if (p.group == group) {
+        wsmh.copy(group, wsv, src);
+        return wsv;
+      }
+      wsmh.deallocate(p.group, wsv);
+    }
+    return wsmh.duplicate(group, src);
+  }
+
+  /** Keep the payload of WSV i for the next duplicate. */
+  void release(Index i, Index group, void *wsv) {
+    if (static_cast<std::size_t>(i) >= payloads.size())
+      payloads.resize(i + 1, Payload{0, NULL});
+    Payload &p = payloads[i];
+    if (p.wsv) wsmh.deallocate(p.group, p.wsv);
+    p.group = group;
+    p.wsv = wsv;
+  }
+};
+
+Workspace::WsvPool &Workspace::pool() {
+  thread_local WsvPool p;
+  return p;
+}
+
+Workspace::WsvStruct *Workspace::new_wsvs() {
+  std::vector<WsvStruct *> &frames = pool().frames;
+  if (frames.empty()) return new WsvStruct;
+  WsvStruct *wsvs = frames.back();
+  frames.pop_back();
+  return wsvs;
+}
+
+void Workspace::free_wsvs(WsvStruct *wsvs) {
+  std::vector<WsvStruct *> &frames = pool().frames;
+  if (frames.size() < WsvPool::max_frames)
+    frames.push_back(wsvs);
+  else
+    delete wsvs;
+}
+
 Array<WsvRecord> Workspace::wsv_data;
 
 map<String, Index> Workspace::WsvMap;
 
 Workspace::Workspace()
-    : ws(0)
+    : ws(0),
+      mparent(NULL),
+      mlinked()
 #ifndef NDEBUG
       ,
       context("")
@@ -54,6 +137,7 @@ Index Workspace::add_wsv(const WsvRecord &wsv) {
 }
 
 void Workspace::del(Index i) {
+  resolve(i);
   WsvStruct *wsvs = ws[i].top();
 
   if (wsvs && wsvs->wsv) {
@@ -65,11 +149,13 @@ void Workspace::del(Index i) {
 }
 
 void Workspace::duplicate(Index i) {
-  WsvStruct *wsvs = new WsvStruct;
+  resolve(i);
+  WsvStruct *wsvs = new_wsvs();
 
   wsvs->auto_allocated = true;
   if (ws[i].size() && ws[i].top()->wsv) {
-    wsvs->wsv = wsmh.duplicate(wsv_data[i].Group(), ws[i].top()->wsv);
+    wsvs->wsv =
+        pool().duplicate(i, wsv_data[i].Group(), ws[i].top()->wsv);
     wsvs->initialized = true;
   } else {
     wsvs->wsv = NULL;
@@ -78,22 +164,34 @@ void Workspace::duplicate(Index i) {
   ws[i].push(wsvs);
 }
 
-Workspace::Workspace(const Workspace &workspace) : ws(workspace.ws.nelem()) {
+Workspace::Workspace(const Workspace &workspace)
+    : ws(workspace.ws.nelem()),
+      mparent(&workspace),
+      mlinked(workspace.ws.nelem(), false),
+      propmat_cache(workspace.propmat_cache) {
 #ifndef NDEBUG
   context = workspace.context;
 #endif
-  for (Index i = 0; i < workspace.ws.nelem(); i++) {
-    WsvStruct *wsvs = new WsvStruct;
-    wsvs->auto_allocated = false;
-    if (workspace.ws[i].size() && workspace.ws[i].top()->wsv) {
-      wsvs->wsv = workspace.ws[i].top()->wsv;
-      wsvs->initialized = workspace.ws[i].top()->initialized;
-    } else {
-      wsvs->wsv = NULL;
-      wsvs->initialized = false;
-    }
-    ws[i].push(wsvs);
+}
+
+const Workspace::WsvStruct *Workspace::top_frame(Index i) const {
+  if (mparent && !mlinked[i]) return mparent->top_frame(i);
+  return ws[i].size() ? ws[i].top() : NULL;
+}
+
+void Workspace::link(Index i) {
+  const WsvStruct *parent_wsvs = mparent->top_frame(i);
+  WsvStruct *wsvs = new_wsvs();
+  wsvs->auto_allocated = false;
+  if (parent_wsvs && parent_wsvs->wsv) {
+    wsvs->wsv = parent_wsvs->wsv;
+    wsvs->initialized = parent_wsvs->initialized;
+  } else {
+    wsvs->wsv = NULL;
+    wsvs->initialized = false;
   }
+  ws[i].push(wsvs);
+  mlinked[i] = true;
 }
 
 Workspace::~Workspace() {
@@ -109,7 +207,7 @@ Workspace::~Workspace() {
       if (wsvs->auto_allocated && wsvs->wsv) {
         wsmh.deallocate(wsv_data[i].Group(), wsvs->wsv);
       }
-      delete (wsvs);
+      free_wsvs(wsvs);
       ws[i].pop();
     }
   }
@@ -117,29 +215,32 @@ Workspace::~Workspace() {
 }
 
 void *Workspace::pop(Index i) {
+  resolve(i);
   WsvStruct *wsvs = ws[i].top();
   void *vp = NULL;
   if (wsvs) {
     vp = wsvs->wsv;
-    delete wsvs;
+    free_wsvs(wsvs);
     ws[i].pop();
   }
   return vp;
 }
 
 void Workspace::pop_free(Index i) {
+  resolve(i);
   WsvStruct *wsvs = ws[i].top();
 
   if (wsvs) {
-    if (wsvs->wsv) wsmh.deallocate(wsv_data[i].Group(), wsvs->wsv);
+    if (wsvs->wsv) pool().release(i, wsv_data[i].Group(), wsvs->wsv);
 
-    delete wsvs;
+    free_wsvs(wsvs);
     ws[i].pop();
   }
 }
 
 void Workspace::push(Index i, void *wsv) {
-  WsvStruct *wsvs = new WsvStruct;
+  resolve(i);
+  WsvStruct *wsvs = new_wsvs();
   wsvs->auto_allocated = false;
   wsvs->initialized = true;
   wsvs->wsv = wsv;
@@ -147,7 +248,8 @@ void Workspace::push(Index i, void *wsv) {
 }
 
 void Workspace::push_uninitialized(Index i, void *wsv) {
-  WsvStruct *wsvs = new WsvStruct;
+  resolve(i);
+  WsvStruct *wsvs = new_wsvs();
   wsvs->auto_allocated = false;
   wsvs->initialized = false;
   wsvs->wsv = wsv;
@@ -155,6 +257,7 @@ void Workspace::push_uninitialized(Index i, void *wsv) {
 }
 
 void *Workspace::operator[](Index i) {
+  resolve(i);
   if (!ws[i].size()) push(i, NULL);
 
   if (!ws[i].top()->wsv) {
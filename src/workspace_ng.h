@@ -26,9 +26,12 @@
 #define WORKSPACE_NG_INCLUDED
 
 #include <map>
+#include <memory>
 #include <stack>
+#include <vector>
 
 class Workspace;
+class PropmatCache;
 
 #include "array.h"
 #include "wsv_aux.h"
@@ -45,8 +48,40 @@ class Workspace {
     bool auto_allocated;
   };
 
+  /** Stack of the scopes of one WSV. */
+  typedef stack<WsvStruct *, std::vector<WsvStruct *> > WsvStack;
+
   /** Workspace variable container. */
-  Array<stack<WsvStruct *> > ws;
+  Array<WsvStack> ws;
+
+  /** The workspace this one is a copy of, or NULL. */
+  const Workspace *mparent;
+
+  /** Per WSV, true if its stack no longer refers to mparent. */
+  std::vector<bool> mlinked;
+
+  /** Top of the WSV stack, looked up in mparent if not yet linked. */
+  const WsvStruct *top_frame(Index i) const;
+
+  /** Put the top of the WSV in mparent onto the stack of this one. */
+  void link(Index i);
+
+  /** Make the stack of WSV i local before it is used. */
+  void resolve(Index i) {
+    if (mparent && !mlinked[i]) link(i);
+  }
+
+  /** Per-thread free lists of stack frames and WSV payloads. */
+  struct WsvPool;
+
+  /** The pool of this thread. */
+  static WsvPool &pool();
+
+  /** Get a stack frame, from the pool of this thread if possible. */
+  static WsvStruct *new_wsvs();
+
+  /** Return a stack frame to the pool of this thread. */
+  static void free_wsvs(WsvStruct *wsvs);
 
  public:
 #ifndef NDEBUG
@@ -54,6 +89,12 @@ class Workspace {
   String context;
 #endif
 
+  /** Propagation matrix cache of an enclosing yCalc, or NULL.
+   *
+   * Copies of the workspace share the cache of their parent.
+   */
+  std::shared_ptr<PropmatCache> propmat_cache;
+
   /** Global WSV data. */
   static Array<WsvRecord> wsv_data;
 
@@ -71,6 +112,12 @@ class Workspace {
    * Make a copy of a workspace. The copy constructor will only copy the topmost
    * layer of the workspace variable stacks.
    *
+   * The copy shares the values of the WSVs with the given workspace, as
+   * before, but the topmost layer of a WSV is only taken over on its first
+   * use. This makes the copies that are made for every thread of a
+   * parallel region cheap. The given workspace must not be changed and
+   * must outlive the copy.
+   *
    * @param[in] workspace The workspace to be copied
    */
   Workspace(const Workspace &workspace);
@@ -116,11 +163,15 @@ class Workspace {
    * @return true if the WSV exists, otherwise false.
    */
   bool is_initialized(Index i) {
+    resolve(i);
     return ((ws[i].size() != 0) && (ws[i].top()->initialized == true));
   }
 
   /** Return scoping level of the given WSV. */
-  Index depth(Index i) { return (Index)ws[i].size(); }
+  Index depth(Index i) {
+    resolve(i);
+    return (Index)ws[i].size();
+  }
 
   /** Remove the topmost WSV from its stack.
    *
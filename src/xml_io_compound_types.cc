@@ -371,6 +371,8 @@ void xml_read_from_stream(istream& is_xml,
   xml_read_from_stream(is_xml, gal.t_pert, pbifs, verbosity);
   xml_read_from_stream(is_xml, gal.nls_pert, pbifs, verbosity);
   xml_read_from_stream(is_xml, gal.xsec, pbifs, verbosity);
+  gal.xsec_mapping.reset();
+  gal.xsec_single.reset();
 
   tag.read_from_stream(is_xml);
   tag.check_name("/GasAbsLookup");
@@ -411,8 +413,14 @@ void xml_write_to_stream(ostream& os_xml,
                       pbofs,
                       "NonlinearSpeciesVmrPerturbations",
                       verbosity);
-  xml_write_to_stream(
-      os_xml, gal.xsec, pbofs, "AbsorptionCrossSections", verbosity);
+  // Mapped and single precision tables are written in double precision
+  const bool copy_xsec = gal.IsMapped() or gal.IsSinglePrecision();
+  const Tensor4 copied_xsec = copy_xsec ? gal.xsec_copy() : Tensor4();
+  xml_write_to_stream(os_xml,
+                      copy_xsec ? copied_xsec : gal.xsec,
+                      pbofs,
+                      "AbsorptionCrossSections",
+                      verbosity);
 
   close_tag.set_name("/GasAbsLookup");
   close_tag.write_to_stream(os_xml);